@@ -4,11 +4,60 @@
 
 #include "../source/Irrlicht/CGeometryCreator.h"
 #include "../source/Irrlicht/CBAWMeshWriter.h"
+#include "../source/Irrlicht/CBAWMeshFileLoader.h"
+#include "../source/Irrlicht/COBJMeshFileLoader.h"
+
+#include <thread>
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 using namespace irr;
 using namespace core;
 
 
+//! Resident set size of the process in bytes, 0 where it's not known
+static size_t getResidentSetSize()
+{
+#ifdef __linux__
+	size_t totalPages = 0u, residentPages = 0u;
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (!statm)
+		return 0u;
+	if (fscanf(statm, "%zu %zu", &totalPages, &residentPages) != 2)
+		residentPages = 0u;
+	fclose(statm);
+	return residentPages*sysconf(_SC_PAGESIZE);
+#else
+	return 0u;
+#endif
+}
+
+//! Whether meshes have the same buffers with the same indices and vertex positions
+static bool sameGeometry(const scene::ICPUMesh* _a, const scene::ICPUMesh* _b)
+{
+	if (!_a || !_b || _a->getMeshBufferCount() != _b->getMeshBufferCount())
+		return false;
+	for (uint32_t i = 0u; i < _a->getMeshBufferCount(); ++i)
+	{
+		const scene::ICPUMeshBuffer* a = _a->getMeshBuffer(i);
+		const scene::ICPUMeshBuffer* b = _b->getMeshBuffer(i);
+		if (a->getIndexCount() != b->getIndexCount() || a->getIndexType() != b->getIndexType() || a->calcVertexCount() != b->calcVertexCount())
+			return false;
+		const size_t indexSize = a->getIndexType() == video::EIT_32BIT ? 4u : 2u;
+		if (a->getIndices() && (!b->getIndices() || memcmp(a->getIndices(), b->getIndices(), a->getIndexCount()*indexSize)))
+			return false;
+		for (size_t v = 0u; v < a->calcVertexCount(); ++v)
+		{
+			const core::vectorSIMDf posA = a->getPosition(v), posB = b->getPosition(v);
+			if (memcmp(posA.pointer, posB.pointer, 3u*sizeof(float)))
+				return false;
+		}
+	}
+	return true;
+}
+
+
 //!Same As Last Example
 class MyEventReceiver : public IEventReceiver
 {
@@ -156,6 +205,10 @@ int main()
 	file = fs->createAndWriteFile("cow.baw");
 	writer->writeMesh(file, cpumesh, scene::EMWF_WRITE_COMPRESSED);
 	file->drop();
+	// uncompressed copy for the benchmark of parsing mapped files in place
+	file = fs->createAndWriteFile("cow_raw.baw");
+	writer->writeMesh(file, cpumesh, scene::EMWF_NONE);
+	file->drop();
 	writer->drop();
 	// end export
 
@@ -163,6 +216,189 @@ int main()
 	cpumesh = smgr->getMesh("cow.baw");
 	// end import
 
+	//! Benchmark of .baw loading with blobs decoded on different number of threads
+	scene::CBAWMeshFileLoader* bawLoader = NULL;
+	for (uint32_t i = 0u; i < smgr->getMeshLoaderCount() && !bawLoader; ++i)
+		bawLoader = dynamic_cast<scene::CBAWMeshFileLoader*>(smgr->getMeshLoader(i));
+	if (bawLoader)
+	{
+		const uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		for (uint32_t threads = 1u; threads <= maxThreads; threads *= 2u)
+		{
+			bawLoader->setDecodingThreadCount(threads);
+			const uint32_t iterations = 16u;
+			const uint64_t start = device->getTimer()->getRealTime();
+			for (uint32_t i = 0u; i < iterations; ++i)
+			{
+				io::IReadFile* bawFile = fs->createAndOpenFile("cow.baw");
+				scene::ICPUMesh* loaded = bawLoader->createMesh(bawFile);
+				if (loaded)
+					loaded->drop();
+				bawFile->drop();
+			}
+			printf("cow.baw loaded %u times with %u decoding thread(s) in %u ms\n", iterations, threads, uint32_t(device->getTimer()->getRealTime()-start));
+		}
+		bawLoader->setDecodingThreadCount(1u);
+	}
+
+	//! Round trip of a multi-mesh .baw archive, loading each mesh by its name and the first one by default
+	scene::CBAWMeshWriter* bawWriter = dynamic_cast<scene::CBAWMeshWriter*>(smgr->createMeshWriter(irr::scene::EMWT_BAW));
+	if (bawLoader && bawWriter)
+	{
+		core::array<scene::ICPUMesh*> meshes;
+		core::array<io::path> names;
+		meshes.push_back(smgr->getMesh("../../media/cow.obj"));
+		names.push_back("cow");
+		meshes.push_back(smgr->getMesh("../../media/extrusionLogo_TEST_fixed.stl"));
+		names.push_back("extrusionLogo");
+
+		scene::CBAWMeshWriter::WriteProperties properties;
+		properties.encryptBlobBitField = scene::CBAWMeshWriter::EET_NOTHING;
+		file = fs->createAndWriteFile("multi.baw");
+		bool passed = meshes[0] && meshes[1] && bawWriter->writeMeshes(file, meshes, names, properties);
+		file->drop();
+
+		unsigned char pwd[16] = "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0";
+		for (uint32_t i = 0u; i <= names.size(); ++i)
+		{
+			// after the named meshes, the one loaded without a name
+			io::IReadFile* bawFile = fs->createAndOpenFile("multi.baw");
+			scene::ICPUMesh* loaded = bawLoader->createMesh(bawFile, i < names.size() ? names[i].c_str() : NULL, pwd);
+			passed = passed && sameGeometry(loaded, meshes[i < names.size() ? i : 0u]);
+			if (loaded)
+				loaded->drop();
+			bawFile->drop();
+		}
+		io::IReadFile* bawFile = fs->createAndOpenFile("multi.baw");
+		scene::ICPUMesh* missing = bawLoader->createMesh(bawFile, "teapot", pwd);
+		passed = passed && !missing;
+		if (missing)
+			missing->drop();
+		bawFile->drop();
+		printf("multi-mesh .baw round trip %s\n", passed ? "PASSED" : "FAILED");
+	}
+	if (bawWriter)
+		bawWriter->drop();
+
+	//! Benchmark of loading files read through stdio versus memory-mapped ones parsed in place (raw .baw buffers even alias the mapping)
+	{
+		const char* benchFiles[] = {"cow.baw", "cow_raw.baw", "../../media/cow.obj"};
+		for (uint32_t mapped = 0u; mapped < 2u; ++mapped)
+		{
+			fs->setFileMappingEnabled(mapped != 0u);
+			for (uint32_t f = 0u; f < 3u; ++f)
+			{
+				scene::IMeshLoader* loader = NULL;
+				for (uint32_t i = 0u; i < smgr->getMeshLoaderCount() && !loader; ++i)
+				if (smgr->getMeshLoader(i)->isALoadableFileExtension(benchFiles[f]))
+					loader = smgr->getMeshLoader(i);
+				if (!loader)
+					continue;
+
+				// keep the meshes alive to see how much memory they really hold on to
+				const uint32_t iterations = 16u;
+				std::vector<scene::ICPUMesh*> loaded;
+				const size_t rssBefore = getResidentSetSize();
+				const uint64_t start = device->getTimer()->getRealTime();
+				for (uint32_t i = 0u; i < iterations; ++i)
+				{
+					io::IReadFile* benchFile = fs->createAndOpenFile(benchFiles[f]);
+					if (!benchFile)
+						break;
+					loaded.push_back(loader->createMesh(benchFile));
+					benchFile->drop();
+				}
+				const uint64_t elapsed = device->getTimer()->getRealTime()-start;
+				const size_t rssAfter = getResidentSetSize();
+				printf("%s loaded %u times %s in %u ms, resident memory grew by %u kB\n", benchFiles[f], uint32_t(loaded.size()), mapped ? "from mapped file":"through stdio", uint32_t(elapsed), uint32_t((rssAfter>rssBefore ? rssAfter-rssBefore:0u)/1024u));
+				for (size_t i = 0u; i < loaded.size(); ++i)
+				if (loaded[i])
+					loaded[i]->drop();
+			}
+		}
+		fs->setFileMappingEnabled(false);
+	}
+
+	//! Benchmark of .obj parsing throughput with file split into chunks parsed on different number of threads
+	scene::COBJMeshFileLoader* objLoader = NULL;
+	for (uint32_t i = 0u; i < smgr->getMeshLoaderCount() && !objLoader; ++i)
+		objLoader = dynamic_cast<scene::COBJMeshFileLoader*>(smgr->getMeshLoader(i));
+	if (objLoader)
+	{
+		const uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		for (uint32_t threads = 1u; threads <= maxThreads; threads *= 2u)
+		{
+			objLoader->setParsingThreadCount(threads);
+			const uint32_t iterations = 16u;
+			size_t bytes = 0u;
+			const uint64_t start = device->getTimer()->getRealTime();
+			for (uint32_t i = 0u; i < iterations; ++i)
+			{
+				io::IReadFile* objFile = fs->createAndOpenFile("../../media/cow.obj");
+				bytes += objFile->getSize();
+				scene::ICPUMesh* loaded = objLoader->createMesh(objFile);
+				if (loaded)
+					loaded->drop();
+				objFile->drop();
+			}
+			const uint64_t elapsed = std::max<uint64_t>(device->getTimer()->getRealTime()-start, 1u);
+			printf("cow.obj parsed %u times with %u thread(s) in %u ms (%.2f MB/s)\n", iterations, threads, uint32_t(elapsed), double(bytes)/double(elapsed)*1000.0/double(0x1u<<20));
+		}
+		objLoader->setParsingThreadCount(0u);
+	}
+
+	//! Benchmark of .ply decoding throughput on synthetic binary and ASCII point clouds
+	scene::IMeshLoader* plyLoader = NULL;
+	for (uint32_t i = 0u; i < smgr->getMeshLoaderCount() && !plyLoader; ++i)
+	if (smgr->getMeshLoader(i)->isALoadableFileExtension("bench.ply"))
+		plyLoader = smgr->getMeshLoader(i);
+	if (plyLoader)
+	{
+		const uint32_t pointCount = 1u<<20;
+		const char* formats[] = {"binary_little_endian", "binary_big_endian", "ascii"};
+		for (uint32_t f = 0u; f < 3u; ++f)
+		{
+			io::IWriteFile* plyFile = fs->createAndWriteFile("bench.ply");
+			char header[256];
+			sprintf(header, "ply\nformat %s 1.0\nelement vertex %u\nproperty float x\nproperty float y\nproperty float z\nproperty float nx\nproperty float ny\nproperty float nz\nend_header\n", formats[f], pointCount);
+			plyFile->write(header, strlen(header));
+			for (uint32_t i = 0u; i < pointCount; ++i)
+			{
+				float v[6] = {float(i%1024u)*0.01f, float(i/1024u)*0.01f, float(i%7u)*0.125f, 0.f, 0.f, 1.f};
+				if (f == 2u)
+				{
+					char line[128];
+					sprintf(line, "%f %f %f %f %f %f\n", v[0], v[1], v[2], v[3], v[4], v[5]);
+					plyFile->write(line, strlen(line));
+					continue;
+				}
+				if (f == 1u)
+				for (uint32_t j = 0u; j < 6u; ++j)
+				{
+					uint32_t& bits = reinterpret_cast<uint32_t&>(v[j]);
+					bits = (bits>>24)|((bits>>8)&0xff00u)|((bits<<8)&0xff0000u)|(bits<<24);
+				}
+				plyFile->write(v, sizeof(v));
+			}
+			plyFile->drop();
+
+			const uint32_t iterations = 8u;
+			size_t bytes = 0u;
+			const uint64_t start = device->getTimer()->getRealTime();
+			for (uint32_t i = 0u; i < iterations; ++i)
+			{
+				io::IReadFile* readFile = fs->createAndOpenFile("bench.ply");
+				bytes += readFile->getSize();
+				scene::ICPUMesh* loaded = plyLoader->createMesh(readFile);
+				if (loaded)
+					loaded->drop();
+				readFile->drop();
+			}
+			const uint64_t elapsed = std::max<uint64_t>(device->getTimer()->getRealTime()-start, 1u);
+			printf("%s .ply with %u points decoded %u times in %u ms (%.2f MB/s)\n", formats[f], pointCount, iterations, uint32_t(elapsed), double(bytes)/double(elapsed)*1000.0/double(0x1u<<20));
+		}
+	}
+
     if (cpumesh)
     {
         scene::IGPUMesh* gpumesh = driver->createGPUMeshesFromCPU(std::vector<scene::ICPUMesh*>(1,cpumesh))[0];
@@ -1,10 +1,227 @@
 #define _IRR_STATIC_LIB_
 #include <irrlicht.h>
 #include "../source/Irrlicht/COpenGLExtensionHandler.h"
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <chrono>
 
 using namespace irr;
 using namespace core;
 
+//! Compares brute force ray casts against every triangle with BVH accelerated closest-hit and any-hit queries of STriangleMeshCollider
+void benchmarkTriangleMeshCollider()
+{
+    // bumpy UV sphere of ~500k triangles
+    const uint32_t rings = 500u, segments = 500u;
+    std::vector<float> vertices;
+    vertices.reserve((rings+1u)*(segments+1u)*3u);
+    for (uint32_t r=0u; r<=rings; r++)
+    for (uint32_t s=0u; s<=segments; s++)
+    {
+        const float theta = core::PI*float(r)/float(rings);
+        const float phi = 2.f*core::PI*float(s)/float(segments);
+        const float radius = 2.f+0.1f*sinf(theta*17.f)*cosf(phi*13.f);
+        vertices.push_back(radius*sinf(theta)*cosf(phi));
+        vertices.push_back(radius*cosf(theta));
+        vertices.push_back(radius*sinf(theta)*sinf(phi));
+    }
+    std::vector<uint32_t> indices;
+    indices.reserve(rings*segments*6u);
+    for (uint32_t r=0u; r<rings; r++)
+    for (uint32_t s=0u; s<segments; s++)
+    {
+        const uint32_t i0 = r*(segments+1u)+s, i1 = i0+1u, i2 = i0+segments+1u, i3 = i2+1u;
+        const uint32_t quad[6] = {i0,i2,i1, i1,i2,i3};
+        indices.insert(indices.end(),quad,quad+6);
+    }
+
+    core::STriangleMeshCollider* collider = new core::STriangleMeshCollider();
+    auto start = std::chrono::high_resolution_clock::now();
+    collider->Init(vertices.data(),indices.size(),indices.data());
+    printf("BVH over %u triangles (%u nodes) built in %.1f ms\n", (uint32_t)collider->getTriangleCount(), (uint32_t)collider->getBVHNodeCount(),
+        std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count());
+
+    std::vector<core::STriangleCollider> flat;
+    for (size_t i=0u; i<indices.size(); i+=3u)
+    {
+        bool valid;
+        core::STriangleCollider tri(vectorSIMDf(&vertices[indices[i]*3u]),vectorSIMDf(&vertices[indices[i+1u]*3u]),vectorSIMDf(&vertices[indices[i+2u]*3u]),valid);
+        if (valid)
+            flat.push_back(tri);
+    }
+
+    // rays from outside the sphere roughly towards it, a part of them misses
+    const uint32_t rayCount = 256u;
+    std::mt19937 gen(0u);
+    std::uniform_real_distribution<float> dist(-1.f,1.f);
+    std::vector<vectorSIMDf> origins, directions;
+    for (uint32_t i=0u; i<rayCount; i++)
+    {
+        vectorSIMDf o(dist(gen),dist(gen),dist(gen),0.f);
+        o = normalize(o)*vectorSIMDf(6.f);
+        vectorSIMDf target(dist(gen)*2.5f,dist(gen)*2.5f,dist(gen)*2.5f,0.f);
+        vectorSIMDf d = normalize(target-o);
+        o.W = d.W = 0.f;
+        origins.push_back(o);
+        directions.push_back(d);
+    }
+
+    uint32_t hits[3] = {0u,0u,0u};
+    double times[3];
+
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i=0u; i<rayCount; i++)
+    {
+        float closest = FLT_MAX, d;
+        bool hit = false;
+        for (size_t t=0u; t<flat.size(); t++)
+        if (flat[t].CollideWithRay(d,origins[i],directions[i],closest))
+        {
+            closest = d;
+            hit = true;
+        }
+        hits[0] += hit;
+    }
+    times[0] = std::chrono::duration<double,std::micro>(std::chrono::high_resolution_clock::now()-start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i=0u; i<rayCount; i++)
+    {
+        float d;
+        hits[1] += collider->CollideWithRay(d,origins[i],directions[i],FLT_MAX);
+    }
+    times[1] = std::chrono::duration<double,std::micro>(std::chrono::high_resolution_clock::now()-start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i=0u; i<rayCount; i++)
+    {
+        float d;
+        hits[2] += collider->CollideWithRayAnyHit(d,origins[i],directions[i],FLT_MAX);
+    }
+    times[2] = std::chrono::duration<double,std::micro>(std::chrono::high_resolution_clock::now()-start).count();
+
+    const char* names[3] = {"brute force", "BVH closest-hit", "BVH any-hit"};
+    for (uint32_t i=0u; i<3u; i++)
+        printf("%16s: %10.2f us/ray, %u/%u hits\n", names[i], times[i]/double(rayCount), hits[i], rayCount);
+
+    // scalar vs packet rays through collision engine, coherent rays of a 512x512 pinhole camera
+    core::SCollisionEngine* engine = new core::SCollisionEngine();
+    core::SCompoundCollider* compound = new core::SCompoundCollider();
+    compound->AddTriangleMesh(collider);
+    engine->addCompoundCollider(compound);
+    compound->drop();
+    compound = new core::SCompoundCollider();
+    compound->AddBox(core::SAABoxCollider(core::aabbox3df(-3.f,-3.f,3.f,3.f,3.f,3.5f)));
+    engine->addCompoundCollider(compound);
+    compound->drop();
+
+    const uint32_t res = 512u, pixelCount = res*res;
+    std::vector<float> soa[6]; // origin XYZ, direction XYZ
+    for (uint32_t j=0u; j<6u; j++)
+        soa[j].resize(pixelCount);
+    for (uint32_t y=0u; y<res; y++)
+    for (uint32_t x=0u; x<res; x++)
+    {
+        const uint32_t ix = y*res+x;
+        vectorSIMDf d = normalize(vectorSIMDf((float(x)+0.5f)/float(res)-0.5f,(float(y)+0.5f)/float(res)-0.5f,1.f,0.f));
+        soa[0][ix] = 0.f;
+        soa[1][ix] = 0.f;
+        soa[2][ix] = -6.f;
+        soa[3][ix] = d.X;
+        soa[4][ix] = d.Y;
+        soa[5][ix] = d.Z;
+    }
+
+    std::vector<core::SColliderData> hitData(pixelCount);
+    std::vector<float> scalarDist(pixelCount), packetDist(pixelCount);
+    uint32_t scalarHits = 0u;
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i=0u; i<pixelCount; i++)
+    {
+        scalarHits += engine->FastCollide(hitData[i],scalarDist[i],vectorSIMDf(soa[0][i],soa[1][i],soa[2][i]),vectorSIMDf(soa[3][i],soa[4][i],soa[5][i]),100.f);
+    }
+    const double scalarTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    const uint32_t packetHits = engine->FastCollideBatch(hitData.data(),packetDist.data(),soa[0].data(),soa[1].data(),soa[2].data(),soa[3].data(),soa[4].data(),soa[5].data(),pixelCount,100.f);
+    const double packetTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-start).count();
+
+    uint32_t mismatches = 0u;
+    for (uint32_t i=0u; i<pixelCount; i++)
+        if (fabsf(scalarDist[i]-packetDist[i])>0.0001f)
+            mismatches++;
+    printf("  scalar rays: %10.0f rays/s, %u hits\n", double(pixelCount)/scalarTime, scalarHits);
+    printf("4-wide packets: %10.0f rays/s, %u hits, %u results differ from scalar\n", double(pixelCount)/packetTime, packetHits, mismatches);
+
+    delete engine;
+    collider->drop();
+}
+
+//! Compares looping over all colliders with the dynamic AABB tree broadphase of SCollisionEngine, on a field of many small colliders
+void benchmarkCollisionEngineBroadphase()
+{
+    const uint32_t colliderCount = 20000u, rayCount = 20000u;
+    std::mt19937 gen(7u);
+    std::uniform_real_distribution<float> position(-100.f,100.f), size(0.1f,1.f), dirComponent(-1.f,1.f);
+
+    core::SCollisionEngine* engine = new core::SCollisionEngine();
+    std::vector<core::SCompoundCollider*> colliders(colliderCount);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i=0u; i<colliderCount; i++)
+    {
+        const core::vector3df center(position(gen),position(gen),position(gen));
+        const core::vector3df halfExtent(size(gen));
+        colliders[i] = new core::SCompoundCollider();
+        colliders[i]->AddBox(core::SAABoxCollider(core::aabbox3df(center-halfExtent,center+halfExtent)));
+        engine->addCompoundCollider(colliders[i]);
+    }
+    const double buildTime = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+
+    std::vector<vectorSIMDf> origins(rayCount), directions(rayCount);
+    for (uint32_t i=0u; i<rayCount; i++)
+    {
+        origins[i] = vectorSIMDf(position(gen),position(gen),position(gen));
+        directions[i] = normalize(vectorSIMDf(dirComponent(gen),dirComponent(gen),dirComponent(gen),0.f));
+    }
+
+    uint32_t hits[2] = {0u,0u};
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i=0u; i<rayCount; i++)
+    {
+        float closest = 50.f;
+        bool hit = false;
+        for (uint32_t j=0u; j<colliderCount; j++)
+        {
+            float dist;
+            if (colliders[j]->CollideWithRay(dist,origins[i],directions[i],closest)&&dist<closest)
+            {
+                closest = dist;
+                hit = true;
+            }
+        }
+        hits[0] += hit;
+    }
+    const double bruteTime = std::chrono::duration<double,std::micro>(std::chrono::high_resolution_clock::now()-start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i=0u; i<rayCount; i++)
+    {
+        core::SColliderData hitData;
+        float dist;
+        hits[1] += engine->FastCollide(hitData,dist,origins[i],directions[i],50.f);
+    }
+    const double treeTime = std::chrono::duration<double,std::micro>(std::chrono::high_resolution_clock::now()-start).count();
+
+    printf("%u colliders, broadphase built in %.2f ms\n", colliderCount, buildTime);
+    printf("    all colliders: %10.2f us/ray, %u/%u hits\n", bruteTime/double(rayCount), hits[0], rayCount);
+    printf("      broadphase: %10.2f us/ray, %u/%u hits\n", treeTime/double(rayCount), hits[1], rayCount);
+
+    delete engine;
+    for (uint32_t i=0u; i<colliderCount; i++)
+        colliders[i]->drop();
+}
+
 //!Same As Last Example
 class MyEventReceiver : public IEventReceiver
 {
@@ -38,6 +255,9 @@ private:
 
 int main()
 {
+    benchmarkTriangleMeshCollider();
+    benchmarkCollisionEngineBroadphase();
+
 	// create device with full flexibility over creation parameters
 	// you can add more parameters if desired, check irr::SIrrlichtCreationParameters
 	irr::SIrrlichtCreationParameters params;
@@ -115,6 +335,8 @@ int main()
         //! This animates (moves) the camera and sets the transforms
         //! Also draws the meshbuffer
         smgr->drawAll();
+        //! colliders need to know where their nodes are after animation
+        gCollEng->updateColliders();
 
 		driver->endScene();
 
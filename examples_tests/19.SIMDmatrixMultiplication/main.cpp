@@ -1,489 +1,124 @@
 #define _IRR_STATIC_LIB_
 #include <irrlicht.h>
-//#include <intrin.h>
-#include <immintrin.h>
-
-#include <chrono>
-#include <random>
-#include <cstdlib>
+#include "matrix3x4SIMD.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
-#include <limits>
+#include <random>
+#include <chrono>
+#include <vector>
 
-// _mm256_extractf128_ps for extracting hi part
-// _mm256_castps256_ps128 for extracting lo part (no cycles!)
+using namespace irr;
+using namespace core;
 
-#define EXEC_CNT (1e6)
-#define BROADCAST32(fpx) _MM_SHUFFLE(fpx, fpx, fpx, fpx)
+#define REPEATS 16u
 
-#define AVX 1 // set to 0 or 1 (sse3/avx), set appropriate compiler flags and run
-#define COL_MAJOR 1 // set to 0 or 1 (col-major/row-major)
-#define VERIFY 0
+static const char* levelNames[matrix3x4SIMD::ESL_COUNT] = {"SSE3", "AVX2"};
 
-#if AVX
-#define ALIGN 32
-namespace avx
+//! Random inputs shared by all benchmarks, matrices have translations and negative entries so every box corner gets picked.
+struct Inputs
 {
-#ifdef _IRR_WINDOWS_
-	__declspec(align(ALIGN))
-#endif
-		struct matrix4x3_row
-	{
-		float m[4][4];
-
-		matrix4x3_row(const float* _data = 0)
-		{
-			if (!_data)
-				return;
-			memcpy(m, _data, 16*4);
-		}
-
-		inline matrix4x3_row concatenate(const matrix4x3_row& _other)
-		{
-			__m256 A01 = _mm256_load_ps(&m[0][0]);
-			__m256 A23 = _mm256_load_ps(&m[2][0]);
-
-			matrix4x3_row out;
-
-			_mm256_store_ps(&out.m[0][0], doJob(A01, _other));
-			_mm256_store_ps(&out.m[2][0], doJob(A23, _other));//do special AVX 128bit ops to only load, calculate and store only one row
-
-			return out;
-		}
-
-		float& operator()(size_t _i, size_t _j) { return m[_i][_j]; }
-		const float& operator()(size_t _i, size_t _j) const { return m[_i][_j]; }
-
-	private:
-		static inline __m256 doJob(__m256 _A01, const matrix4x3_row& _mtx)
-		{
-			__m256 mask = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, 0xffffffff, 0, 0, 0, 0xffffffff));
-
-			__m256 r01 = _mm256_load_ps(&_mtx.m[0][0]);
-			__m256 r23 = _mm256_load_ps(&_mtx.m[2][0]);
-			__m128 r0 = _mm256_extractf128_ps(r01, 0);
-			__m128 r1 = _mm256_extractf128_ps(r01, 1);
-			__m128 r2 = _mm256_extractf128_ps(r23, 0);
-			__m128 r3 = _mm256_extractf128_ps(r23, 1);
-
-			__m256 res;
-			res = _mm256_mul_ps(_mm256_shuffle_ps(_A01, _A01, BROADCAST32(0)), _mm256_broadcast_ps(&r0));
-			res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(_A01, _A01, BROADCAST32(1)), _mm256_broadcast_ps(&r1)));
-			res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(_A01, _A01, BROADCAST32(2)), _mm256_broadcast_ps(&r2)));
-			res = _mm256_add_ps(res, _mm256_and_ps(_A01,mask));
-			return res;
-		}
-	}
-#ifndef _IRR_WINDOWS_
-	__attribute__((__aligned__(ALIGN)));
-#endif
-	; // matrix4x3_row
-
-#ifdef _IRR_WINDOWS_
-	__declspec(align(ALIGN))
-#endif
-		struct matrix4x3_col
-	{
-		float m[4][4];
-
-		matrix4x3_col(const float* _data = 0)
-		{
-			if (!_data)
-				return;
-			//printf("avx col ctor:\n");
-			//for (size_t i = 0; i < 16; ++i)
-			//	printf("%f ", _data[i]);
-			//printf("\n");
-			memcpy(m, _data, 16 * 4);
-		}
-
-		inline matrix4x3_col concatenate(const matrix4x3_col& _other)
-		{
-			__m256 A01 = _mm256_load_ps(&_other.m[0][0]);
-			__m256 A23 = _mm256_load_ps(&_other.m[2][0]);
-
-			matrix4x3_col out;
-
-			_mm256_store_ps(&out.m[0][0], doJob(A01, 0, *this));
-			_mm256_store_ps(&out.m[2][0], doJob(A23, 2, *this));
-
-			return out;
-		}
-
-		float& operator()(size_t _i, size_t _j) { return m[_j][_i]; }
-		const float& operator()(size_t _i, size_t _j) const { return m[_j][_i]; }
-
-	private:
-		static inline __m256 doJob(__m256 _A01, size_t j, const matrix4x3_col& _mtx)
-		{
-			__m256 c01 = _mm256_load_ps(&_mtx.m[0][0]);
-			__m256 c23 = _mm256_load_ps(&_mtx.m[2][0]);
-			__m128 c0 = _mm256_extractf128_ps(c01, 0);
-			__m128 c1 = _mm256_extractf128_ps(c01, 1);
-			__m128 c2 = _mm256_extractf128_ps(c23, 0);
-			__m128 c3 = _mm256_extractf128_ps(c23, 1);
-
-			__m256 res;
-			res = _mm256_mul_ps(_mm256_shuffle_ps(_A01, _A01, BROADCAST32(0)), _mm256_broadcast_ps(&c0));
-			res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(_A01, _A01, BROADCAST32(1)), _mm256_broadcast_ps(&c1)));
-			res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(_A01, _A01, BROADCAST32(2)), _mm256_broadcast_ps(&c2)));
-			if (j)
+    Inputs(size_t _count) : matsA(_count), matsB(_count), vectors(_count), boxes(_count)
+    {
+        std::mt19937 gen(_count);
+        std::uniform_real_distribution<float> dist(-100.f, 100.f);
+        for (size_t i = 0u; i < _count; ++i)
+        {
+            for (uint32_t r = 0u; r < 3u; ++r)
             {
-                __m256 mask = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, 0, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff));
-                res = _mm256_add_ps(res, _mm256_and_ps(mask, _mm256_broadcast_ps(&c3)));
+                matsA[i].rows[r] = vectorSIMDf(dist(gen), dist(gen), dist(gen), dist(gen));
+                matsB[i].rows[r] = vectorSIMDf(dist(gen), dist(gen), dist(gen), dist(gen));
             }
-			return res;
-		}
-	}
-#ifndef _IRR_WINDOWS_
-	__attribute__((__aligned__(ALIGN)));
-#endif
-	; // matrix4x3_row
-} // avx
-#endif
-
-#if !AVX
-#define ALIGN 16
-namespace sse3
-{
-#ifdef _IRR_WINDOWS_
-	__declspec(align(ALIGN))
-#endif
-		struct matrix4x3_row
-	{
-		float m[4][4];
-
-		matrix4x3_row(const float* _data = 0)
-		{
-			if (!_data)
-				return;
-			memcpy(m, _data, 16 * 4);
-		}
-
-		inline matrix4x3_row concatenate(const matrix4x3_row& _other)
-		{
-			matrix4x3_row out;
-
-			__m128 r0 = _mm_load_ps(m[0]);
-			__m128 r1 = _mm_load_ps(m[1]);
-			__m128 r2 = _mm_load_ps(m[2]);
-			__m128 r3 = _mm_load_ps(m[3]);
-
-			_mm_store_ps(out.m[0], doJob(r0, _other));
-			_mm_store_ps(out.m[1], doJob(r1, _other));
-			_mm_store_ps(out.m[2], doJob(r2, _other));
-			_mm_store_ps(out.m[3], r3); // 0 0 0 1
-
-			return out;
-		}
-
-		float& operator()(size_t _i, size_t _j) { return m[_i][_j]; }
-		const float& operator()(size_t _i, size_t _j) const { return m[_i][_j]; }
-
-	private:
-		static inline __m128 doJob(const __m128& a, const matrix4x3_row& _mtx)
-		{
-			__m128 res;
-
-			__m128 r0 = _mm_load_ps(_mtx.m[0]);
-			__m128 r1 = _mm_load_ps(_mtx.m[1]);
-			__m128 r2 = _mm_load_ps(_mtx.m[2]);
-			__m128 r3 = _mm_load_ps(_mtx.m[3]);
-
-			__m128 mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, 0xffffffff));
-
-			res = _mm_mul_ps(_mm_shuffle_ps(a, a, BROADCAST32(0)), r0);
-			res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(a, a, BROADCAST32(1)), r1));
-			res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(a, a, BROADCAST32(2)), r2));
-			res = _mm_add_ps(res, _mm_and_ps(a, mask)); // always 0 0 0 a3 -- no shuffle needed
-			return res;
-		}
-	}
-#ifndef _IRR_WINDOWS_
-	__attribute__((__aligned__(ALIGN)));
-#endif
-	; // matrix4x3_row
-
-#ifdef _IRR_WINDOWS_
-	__declspec(align(ALIGN))
-#endif
-		struct matrix4x3_col
-	{
-		float m[4][4];
-
-		matrix4x3_col(const float* _data = 0)
-		{
-			if (!_data)
-				return;
-			memcpy(m, _data, 16 * 4);
-		}
-
-		inline matrix4x3_col concatenate(const matrix4x3_col& _other)
-		{
-			matrix4x3_col out;
-
-			__m128 c0 = _mm_load_ps(_other.m[0]);
-			__m128 c1 = _mm_load_ps(_other.m[1]);
-			__m128 c2 = _mm_load_ps(_other.m[2]);
-			__m128 c3 = _mm_load_ps(_other.m[3]);
-
-			_mm_store_ps(out.m[0], doJob(c0, 0, *this));
-			_mm_store_ps(out.m[1], doJob(c1, 1, *this));
-			_mm_store_ps(out.m[2], doJob(c2, 2, *this));
-			_mm_store_ps(out.m[3], doJob(c3, 3, *this));
-
-			return out;
-		}
-
-		float& operator()(size_t _i, size_t _j) { return m[_j][_i]; }
-		const float& operator()(size_t _i, size_t _j) const { return m[_j][_i]; }
-
-	private:
-		static inline __m128 doJob(__m128 a, size_t j, const matrix4x3_col& _mtx)
-		{
-			__m128 res;
-
-			__m128 c0 = _mm_load_ps(_mtx.m[0]);
-			__m128 c1 = _mm_load_ps(_mtx.m[1]);
-			__m128 c2 = _mm_load_ps(_mtx.m[2]);
-			__m128 c3 = _mm_load_ps(_mtx.m[3]);
-
-			res = _mm_mul_ps(_mm_shuffle_ps(a, a, BROADCAST32(0)), c0);
-			res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(a, a, BROADCAST32(1)), c1));
-			res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(a, a, BROADCAST32(2)), c2));
-			if (j == 3) // w of every column except last one is 0; in the last one it's 1
-				res = _mm_add_ps(res, c3);
-			return res;
-		}
-	}
-#ifndef _IRR_WINDOWS_
-	__attribute__((__aligned__(ALIGN)));
-#endif
-	; // matrix4x3_col
-} // sse3
-#endif
-
-struct matrix4x3_col_nosimd
-{
-	float m[4][4];
-
-	matrix4x3_col_nosimd(const float* _data = 0)
-	{
-		if (!_data)
-			return;
-		//printf("nosimd col ctor:\n");
-		//for (size_t i = 0; i < 16; ++i)
-		//	printf("%f ", _data[i]);
-		//printf("\n");
-		memcpy(m, _data, 16*4);
-	}
-
-	inline matrix4x3_col_nosimd concatenate(const matrix4x3_col_nosimd& _other)
-	{
-		matrix4x3_col_nosimd ret;
-		memset(ret.m, 0, 15*4);
-		ret.m[3][3] = 1.f;
-		for (int j = 0; j < 4; j++)
-		{
-			for (int i = 0; i < 3; i++)
-			{
-				float sum = 0;
-				for (int e = 0; e < 3; e++)
-					sum += (*this)(i, e) * _other(e, j);
-				if (j == 3)
-					sum += (*this)(i, 3);
-				ret(i, j) = sum;
-			}
-		}
-		return ret;
-	}
-
-	float& operator()(size_t _i, size_t _j) { return m[_j][_i]; }
-	const float& operator()(size_t _i, size_t _j) const { return m[_j][_i]; }
-};
-
-struct matrix4x3_row_nosimd
-{
-	float m[4][4];
-
-	matrix4x3_row_nosimd(const float* _data = 0)
-	{
-		if (!_data)
-			return;
-		//printf("nosimd row ctor:\n");
-		//for (size_t i = 0; i < 16; ++i)
-		//	printf("%f ", _data[i]);
-		//printf("\n");
-		memcpy(m, _data, 16 * 4);
-	}
-
-	inline matrix4x3_row_nosimd concatenate(const matrix4x3_row_nosimd& _other)
-	{
-		matrix4x3_row_nosimd ret;
-		for (size_t i = 0; i < 4; i++)
-		{
-			for (size_t j = 0; j < 4; j++)
-			{
-				float sum = 0.f;
-				for (size_t e = 0; e < 4; e++)
-				{
-					sum += m[i][e] * _other.m[e][j];
-				}
-				ret.m[i][j] = sum;
-			}
-		}
-		return ret;
-	}
+            vectors[i] = vectorSIMDf(dist(gen), dist(gen), dist(gen), dist(gen));
+            const vector3df a(dist(gen), dist(gen), dist(gen)), b(dist(gen), dist(gen), dist(gen));
+            boxes[i].reset(a);
+            boxes[i].addInternalPoint(b);
+        }
+    }
 
-	float& operator()(size_t _i, size_t _j) { return m[_i][_j]; }
-	const float& operator()(size_t _i, size_t _j) const { return m[_i][_j]; }
+    std::vector<matrix3x4SIMD> matsA, matsB;
+    std::vector<vectorSIMDf> vectors;
+    std::vector<aabbox3df> boxes;
 };
 
-namespace measure
+//! Bitwise comparison, matrices may have padding which never gets written
+template<typename T>
+static bool identical(const T& _a, const T& _b)
 {
-	using Clock = std::chrono::high_resolution_clock;
-	using TimePoint = std::chrono::time_point<Clock>;
-	using Duration = std::chrono::duration<double, std::micro>;
+    return !memcmp(&_a, &_b, sizeof(T));
 }
-
-template<typename T>
-static bool compare(T* _m1, T* _m2);
-template<typename T>
-static double run(void*, void*, void*);
-
-int main()
+static bool identical(const matrix3x4SIMD& _a, const matrix3x4SIMD& _b)
 {
-	void* data = malloc(16*4*(size_t)EXEC_CNT*3+ALIGN);
-
-	uint8_t* alignedData = reinterpret_cast<uint8_t*>(data);
-	size_t offset = reinterpret_cast<const size_t&>(alignedData)%ALIGN;
-	alignedData += ALIGN-offset;
-
-	{
-	size_t i = 1;
-	for (float* p = (float*)alignedData; (void*)p != (void*)(alignedData + (size_t)EXEC_CNT * 16 * 4); ++p, ++i)
-	{
-#if COL_MAJOR
-		if (i % 16 == 0)
-			*p = 1.f;
-		else if (i % 4 == 0)
-			*p = 0.f;
-		else
-			*p = rand();
-#else
-		size_t mod = i % 16;
-		if (mod == 0)
-			*p = 1.f;
-		else if (mod >= 13 && mod <= 15)
-			*p = 0.f;
-		else
-			*p = rand();
-#endif
-	}
-	}
-
-	void* dataOut = alignedData+(16*4*(size_t)EXEC_CNT);
-	void* nosimdOut = alignedData+2*(16*4*(size_t)EXEC_CNT);
-
-	double nosimdtime = 0.0;
-	double simdtime = 0.0;
-
-	for (size_t i = 0; i < 10; ++i)
-	{
-#if COL_MAJOR
-		nosimdtime += run<matrix4x3_col_nosimd>(alignedData, nosimdOut, 0);
-#else
-		nosimdtime += run<matrix4x3_row_nosimd>(alignedData, nosimdOut, 0);
-#endif
-	}
-
-	for (size_t i = 0; i < 100; ++i)
-	{
-#if AVX
-	#if COL_MAJOR
-		simdtime += run<avx::matrix4x3_col>(alignedData, dataOut, nosimdOut);
-	#else
-		simdtime += run<avx::matrix4x3_row>(alignedData, dataOut, nosimdOut);
-	#endif
-#else
-	#if COL_MAJOR
-		simdtime += run<sse3::matrix4x3_col>(alignedData, dataOut, nosimdOut);
-	#else
-		simdtime += run<sse3::matrix4x3_row>(alignedData, dataOut, nosimdOut);
-	#endif
-#endif
-	}
-
-	printf("nosimd  : %f\n", nosimdtime);
-#if VERIFY
-	printf("SIMD time distorted by comparisons!\n");
-#endif
-#if AVX
-#if COL_MAJOR
-    printf("avx  col: %f\n", simdtime);
-#else
-	printf("avx  row: %f\n", simdtime);
-#endif
-#else
-#if COL_MAJOR
-    printf("sse3 col: %f\n", simdtime);
-#else
-    printf("sse3 row: %f\n", simdtime);
-#endif
-#endif
-	free(data);
-
-	return 0;
+    return !memcmp(_a.rows, _b.rows, sizeof(_a.rows));
 }
 
-template<typename T>
-static bool compare(T* _m1, T* _m2)
+//! Runs `_job` at every SIMD level, the output of each level has to match the SSE3 output bit for bit.
+template<typename T, class F>
+static bool runBenchmark(const char* _name, size_t _count, std::vector<T>& _out, F _job, matrix3x4SIMD::E_SIMD_LEVEL _bestLevel)
 {
-    const float size_thresh = 0.000001f;
-
-	for (size_t i=0; i<4; i++)
-	for (size_t j=0; j<4; j++)
+    std::vector<T> reference;
+    bool retval = true;
+    printf("%-14s %8u", _name, uint32_t(_count));
+    for (uint32_t level = matrix3x4SIMD::ESL_SSE3; level <= uint32_t(_bestLevel); ++level)
     {
-        const float a = (*_m1)(i,j);
-        const float b = (*_m2)(i,j);
-        const uint32_t& aAsInt = reinterpret_cast<const uint32_t&>(a);
-        const uint32_t& bAsInt = reinterpret_cast<const uint32_t&>(b);
-
-        if (abs(b)>size_thresh)
-        {
-            if (abs(1.f-abs(a/b))>0.001f)
-            {
-                //printf("%f,%f\n",a,b);
-                return false;
-            }
-        }
-        else if ( (aAsInt&0x80000000ull)!=(bAsInt&0x80000000ull) || abs(a)>size_thresh)
-        {
-            //printf("ZERO %f,%f\n",a,b);
-            return false;
-        }
+        matrix3x4SIMD::setMaxSIMDLevel(matrix3x4SIMD::E_SIMD_LEVEL(level));
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t r = 0u; r < REPEATS; ++r)
+            _job();
+        const double secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        if (level == matrix3x4SIMD::ESL_SSE3)
+            reference = _out;
+        else
+        for (size_t i = 0u; i < _count && retval; ++i)
+            retval = identical(reference[i], _out[i]);
+        printf(" %s %8.1f M/s", levelNames[level], double(_count)*REPEATS/secs/1000000.0);
     }
-	return true;
+    printf(retval ? "\n" : "  MISMATCH\n");
+    return retval;
 }
 
-template<typename T>
-static double run(void* _data, void* _out, void* _cmp)
+int main()
 {
-	const measure::TimePoint start = measure::Clock::now();
+    const matrix3x4SIMD::E_SIMD_LEVEL bestLevel = matrix3x4SIMD::setMaxSIMDLevel(matrix3x4SIMD::ESL_AVX2);
+    printf("Best instruction set supported: %s\n", levelNames[bestLevel]);
 
-	const float* const mtx = (float*)_data;
-	T* out = (T*)_out;
-	for (size_t i = 0; i < (size_t)EXEC_CNT-1; ++i)
-	{
-		T* m1 = (T*)(mtx+16*i), *m2 = (T*)(mtx+16*(i+1));
-		out[i] = m1->concatenate(*m2);
-#if VERIFY
-		if (_cmp && !compare<T>(out+i, ((T*)_cmp)+i))
-		{
-			printf("Matrices don't match!\n");
-		}
-#endif
-	}
+    // from fitting in L1 to way past the last level cache, odd counts leave a tail for the SSE3 code in wider kernels
+    const size_t counts[] = {255u, 4095u, 65535u, 1048575u};
+    bool allMatch = true;
+    for (size_t c = 0u; c < sizeof(counts)/sizeof(size_t); ++c)
+    {
+        const size_t count = counts[c];
+        const Inputs in(count);
+
+        std::vector<matrix3x4SIMD> outMats(count);
+        allMatch = runBenchmark("concatenate", count, outMats, [&]() {
+            matrix3x4SIMD::concatenateBFollowedByA(outMats.data(), in.matsA.data(), in.matsB.data(), count);
+        }, bestLevel) && allMatch;
+
+        // results depend on the inputs only, so overwriting them in place has to give the same output
+        allMatch = runBenchmark("concat inplace", count, outMats, [&]() {
+            std::copy(in.matsA.begin(), in.matsA.end(), outMats.begin());
+            matrix3x4SIMD::concatenateBFollowedByA(outMats.data(), outMats.data(), in.matsB.data(), count);
+        }, bestLevel) && allMatch;
+
+        std::vector<vectorSIMDf> outVectors(count);
+        allMatch = runBenchmark("points", count, outVectors, [&]() {
+            in.matsA[0].transformVect(outVectors.data(), in.vectors.data(), count);
+        }, bestLevel) && allMatch;
+
+        allMatch = runBenchmark("normals", count, outVectors, [&]() {
+            in.matsA[0].mulSub3x3With3x1(outVectors.data(), in.vectors.data(), count);
+        }, bestLevel) && allMatch;
+
+        std::vector<aabbox3df> outBoxes(count);
+        allMatch = runBenchmark("boxes", count, outBoxes, [&]() {
+            transformBoxEx(outBoxes.data(), in.boxes.data(), in.matsA.data(), count);
+        }, bestLevel) && allMatch;
+    }
 
-	const measure::Duration dt = measure::Clock::now() - start;
-	return dt.count();
+    matrix3x4SIMD::setMaxSIMDLevel(bestLevel);
+    printf(allMatch ? "All outputs identical to SSE3 code\n" : "SIMD OUTPUT DIFFERS FROM SSE3 CODE\n");
+    return allMatch ? 0 : 1;
 }
@@ -6,6 +6,9 @@
 #include "../source/Irrlicht/CSkinnedMesh.h"
 #include "../source/Irrlicht/COpenGLDriver.h"
 #include "../source/Irrlicht/COpenGLTextureBufferObject.h"
+#include "../source/Irrlicht/CSkinningStateManager.h"
+#include <chrono>
+#include <thread>
 
 using namespace irr;
 using namespace core;
@@ -259,6 +262,87 @@ private:
     video::IDriverFence* fence[4];
 };
 
+//! Measures how CPU boning of many instances of `_mesh` scales with number of threads performBoning() may use
+void benchmarkCPUBoning(video::IVideoDriver* _driver, scene::ICPUMesh* _mesh)
+{
+    scene::ICPUSkinnedMesh* skinnedMesh = dynamic_cast<scene::ICPUSkinnedMesh*>(_mesh);
+    if (!skinnedMesh)
+        return;
+
+    const uint32_t instanceCnt = 4096u, frameCnt = 100u;
+    const uint32_t maxThreadCnt = std::max(std::thread::hardware_concurrency(), 1u);
+    for (uint32_t threadCnt = 1u; ; threadCnt = std::min(threadCnt*2u, maxThreadCnt))
+    {
+        scene::CSkinningStateManager* mgr = new scene::CSkinningStateManager(scene::ISkinningStateManager::EBUM_NONE, _driver, skinnedMesh->getBoneReferenceHierarchy());
+        mgr->setBoningThreadCount(threadCnt);
+        std::vector<uint32_t> ids(instanceCnt);
+        for (uint32_t i = 0u; i < instanceCnt; ++i)
+            ids[i] = mgr->addInstance();
+
+        double elapsed = 0.0;
+        for (uint32_t f = 0u; f < frameCnt; ++f)
+        {
+            // desynchronized animations, so that every instance needs to be boned every frame
+            for (uint32_t i = 0u; i < instanceCnt; ++i)
+                mgr->setFrame(float((i*7u + f) % 60u) + 0.5f, ids[i]);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            mgr->performBoning();
+            elapsed += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        mgr->drop();
+
+        std::stringstream ss;
+        ss << "CPU boning of " << instanceCnt << " instances, " << threadCnt << " threads [ms/frame]";
+        os::Printer::log(ss.str(), std::to_string(elapsed/frameCnt));
+
+        if (threadCnt == maxThreadCnt)
+            break;
+    }
+}
+
+//! Checks that with EBUM_CONTROL an instance whose attached node hangs off another instance's bone gets that bone's transform of the same frame
+bool checkBoneAttachedInstance(scene::ISceneManager* _smgr, scene::IGPUSkinnedMesh* _mesh)
+{
+    bool passed = true;
+    for (uint32_t threadCnt : {1u, 4u})
+    {
+        scene::CSkinningStateManager* mgr = new scene::CSkinningStateManager(scene::ISkinningStateManager::EBUM_CONTROL, _smgr->getVideoDriver(), _mesh->getBoneReferenceHierarchy());
+        mgr->setBoningThreadCount(threadCnt);
+
+        // the rider comes before the carrier it rides on, so it has to be boned in a later pass
+        scene::ISkinnedMeshSceneNode* rider = _smgr->addSkinnedMeshSceneNode(_mesh);
+        mgr->addInstance(rider);
+        for (uint32_t i = 0u; i < 255u; ++i)
+            mgr->addInstance();
+        scene::ISkinnedMeshSceneNode* carrier = _smgr->addSkinnedMeshSceneNode(_mesh);
+        const uint32_t carrierID = mgr->addInstance(carrier);
+
+        // a root bone, so it follows the carrier every frame
+        scene::ISkinningStateManager::IBoneSceneNode* saddle = mgr->getBone(0u, carrierID);
+        rider->setParent(saddle);
+
+        for (uint32_t f = 0u; f < 8u; ++f)
+        {
+            carrier->setPosition(core::vector3df(float(f), 0.f, 0.5f*float(f)));
+            rider->setPosition(core::vector3df(0.f, 1.f + 0.25f*float(f), 0.f));
+            mgr->performBoning();
+
+            const core::matrix4x3 expected = concatenateBFollowedByA(saddle->getAbsoluteTransformation(), rider->getRelativeTransformationMatrix());
+            if (memcmp(expected.pointer(), rider->getAbsoluteTransformation().pointer(), sizeof(float)*12u))
+                passed = false;
+        }
+
+        // the rider is a child of the carrier's bone, so it must go before the bones do
+        rider->remove();
+        mgr->drop();
+        carrier->remove();
+    }
+
+    os::Printer::log("Boning of an instance attached to another instance's bone", passed ? "PASSED" : "FAILED", passed ? ELL_INFORMATION : ELL_ERROR);
+    return passed;
+}
+
 //#define BENCH
 
 int main(int _argCnt, char** _args)
@@ -327,6 +411,7 @@ int main(int _argCnt, char** _args)
     // todo: fill ubo with MVP matrix (how to get this from engine?)
 
 	scene::ICPUMesh* cpumesh = smgr->getMesh("dwarf.baw");
+    benchmarkCPUBoning(driver, cpumesh);
 
     using convfptr_t = size_t(*)(const float*, float*, const size_t, const size_t);
     convfptr_t convFunctions[5]{ &convertBuf1, &convertBuf2, &convertBuf3, &convertBuf4, &convertBuf5 };
@@ -336,6 +421,8 @@ int main(int _argCnt, char** _args)
 
 #define INSTANCE_CNT 100
     scene::IGPUMesh* gpumesh = driver->createGPUMeshesFromCPU({ cpumesh })[0];
+    if (gpumesh->getMeshType() == scene::EMT_ANIMATED_SKINNED)
+        checkBoneAttachedInstance(smgr, static_cast<scene::IGPUSkinnedMesh*>(gpumesh));
     for (size_t i = 0u; i < gpumesh->getMeshBufferCount(); ++i)
         gpumesh->getMeshBuffer(i)->setInstanceCount(INSTANCE_CNT);
 
@@ -0,0 +1,80 @@
+#include <irrlicht.h>
+#include <CConcurrentObjectCache.h>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace irr;
+
+class CachedObject : public IReferenceCounted {};
+
+#define PRELOADED_CNT (1u<<14)
+#define INSERTED_CNT (1u<<12)
+#define READS_PER_THREAD (1u<<20)
+
+//! Readers look up random keys (of which some are being inserted concurrently) while single writer streams new objects in.
+template<size_t ShardCnt>
+void runBenchmark(uint32_t _readerCnt)
+{
+    core::CConcurrentObjectCache<std::string, CachedObject, std::vector, ShardCnt> cache(
+        [](CachedObject* _obj) { _obj->grab(); },
+        [](CachedObject* _obj) { _obj->drop(); }
+    );
+
+    std::vector<std::string> keys(PRELOADED_CNT + INSERTED_CNT);
+    for (size_t i = 0u; i < keys.size(); ++i)
+        keys[i] = "asset/path/number_" + std::to_string(i) + ".baw";
+    std::vector<CachedObject*> objects(keys.size());
+    for (size_t i = 0u; i < objects.size(); ++i)
+        objects[i] = new CachedObject();
+
+    for (size_t i = 0u; i < PRELOADED_CNT; ++i)
+        cache.insert(keys[i], objects[i]);
+
+    std::atomic<uint32_t> hits(0u);
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    std::thread writer([&]() {
+        for (size_t i = PRELOADED_CNT; i < keys.size(); ++i)
+            cache.insert(keys[i], objects[i]);
+    });
+    std::vector<std::thread> readers;
+    for (uint32_t t = 0u; t < _readerCnt; ++t)
+        readers.push_back(std::thread([&, t]() {
+            std::mt19937 gen(t);
+            std::uniform_int_distribution<uint32_t> dist(0u, keys.size()-1u);
+            uint32_t localHits = 0u;
+            for (uint32_t i = 0u; i < READS_PER_THREAD; ++i)
+                if (cache.getByKey(keys[dist(gen)]))
+                    ++localHits;
+            hits += localHits;
+        }));
+
+    writer.join();
+    for (size_t t = 0u; t < readers.size(); ++t)
+        readers[t].join();
+
+    const double secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    printf("%3u shard(s), %2u reader(s): %8.3f ms, %10.0f lookups/s, %u hits, %u objects\n",
+        static_cast<uint32_t>(ShardCnt), _readerCnt, secs*1000.0, double(_readerCnt)*READS_PER_THREAD/secs, hits.load(), static_cast<uint32_t>(cache.getSize()));
+
+    for (size_t i = 0u; i < objects.size(); ++i)
+        objects[i]->drop();
+}
+
+int main()
+{
+    const uint32_t maxReaders = std::max(std::thread::hardware_concurrency(), 2u);
+    for (uint32_t readers = 1u; readers <= maxReaders; readers *= 2u)
+    {
+        runBenchmark<1u>(readers); // equivalent of old single-lock cache
+        runBenchmark<16u>(readers);
+        runBenchmark<64u>(readers);
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <irrlicht.h>
+#include "../source/Irrlicht/CColorConverter.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <chrono>
+#include <vector>
+
+using namespace irr;
+using namespace video;
+
+#define REPEATS 8u
+
+struct Conversion
+{
+    const char* name;
+    ECOLOR_FORMAT srcFormat, dstFormat;
+    void (*convert)(const void*, int32_t, void*);
+    uint32_t srcBytes, dstBytes;
+};
+
+#define CONVERSION(SRC,DST,SRCBYTES,DSTBYTES) {#SRC " -> " #DST, ECF_##SRC, ECF_##DST, CColorConverter::convert_##SRC##to##DST, SRCBYTES, DSTBYTES}
+#define SWIZZLE(SRC,DST,SRCBYTES,DSTBYTES) {#SRC " -> " #DST, ECF_UNKNOWN, ECF_UNKNOWN, CColorConverter::convert_##SRC##to##DST, SRCBYTES, DSTBYTES}
+
+static const Conversion conversions[] = {
+    CONVERSION(R8G8B8,A8R8G8B8,3u,4u),
+    CONVERSION(A8R8G8B8,R8G8B8,4u,3u),
+    CONVERSION(A8R8G8B8,R5G6B5,4u,2u),
+    CONVERSION(A8R8G8B8,A1R5G5B5,4u,2u),
+    CONVERSION(R5G6B5,A8R8G8B8,2u,4u),
+    CONVERSION(A1R5G5B5,A8R8G8B8,2u,4u),
+    CONVERSION(R8G8B8,R5G6B5,3u,2u),
+    CONVERSION(R5G6B5,R8G8B8,2u,3u),
+    CONVERSION(A1R5G5B5,R5G6B5,2u,2u),
+    SWIZZLE(B8G8R8,A8R8G8B8,3u,4u),
+    SWIZZLE(B8G8R8A8,A8R8G8B8,4u,4u)
+};
+
+static const char* levelNames[CColorConverter::ESL_COUNT] = {"scalar", "SSE2", "SSSE3", "AVX2"};
+
+//! Converts whole images row by row like image loaders do, every SIMD level has to match the scalar output bit for bit.
+static bool runBenchmark(const Conversion& _conv, uint32_t _side, CColorConverter::E_SIMD_LEVEL _bestLevel)
+{
+    const size_t pixelCnt = size_t(_side)*_side;
+    std::vector<uint8_t> src(pixelCnt*_conv.srcBytes);
+    std::mt19937 gen(_side);
+    for (size_t i = 0u; i < src.size(); ++i)
+        src[i] = gen();
+
+    std::vector<uint8_t> reference;
+    bool retval = true;
+    printf("%-24s %4ux%-4u", _conv.name, _side, _side);
+    for (uint32_t level = CColorConverter::ESL_SCALAR; level <= uint32_t(_bestLevel); ++level)
+    {
+        CColorConverter::setMaxSIMDLevel(CColorConverter::E_SIMD_LEVEL(level));
+        std::vector<uint8_t> dst(pixelCnt*_conv.dstBytes);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t r = 0u; r < REPEATS; ++r)
+        for (uint32_t y = 0u; y < _side; ++y)
+        {
+            const size_t row = size_t(y)*_side;
+            if (_conv.srcFormat != ECF_UNKNOWN)
+                CColorConverter::convert_viaFormat(src.data()+row*_conv.srcBytes, _conv.srcFormat, _side, dst.data()+row*_conv.dstBytes, _conv.dstFormat);
+            else
+                _conv.convert(src.data()+row*_conv.srcBytes, _side, dst.data()+row*_conv.dstBytes);
+        }
+        const double secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        if (level == CColorConverter::ESL_SCALAR)
+            reference.swap(dst);
+        else if (memcmp(reference.data(), dst.data(), reference.size()))
+            retval = false;
+        printf(" %s %8.1f MPix/s", levelNames[level], double(pixelCnt)*REPEATS/secs/1000000.0);
+    }
+    printf(retval ? "\n" : "  MISMATCH\n");
+    return retval;
+}
+
+int main()
+{
+    const CColorConverter::E_SIMD_LEVEL bestLevel = CColorConverter::setMaxSIMDLevel(CColorConverter::ESL_AVX2);
+    printf("Best instruction set supported: %s\n", levelNames[bestLevel]);
+
+    const uint32_t sides[] = {256u, 512u, 1024u, 2048u, 4096u};
+    bool allMatch = true;
+    for (size_t c = 0u; c < sizeof(conversions)/sizeof(Conversion); ++c)
+    for (size_t s = 0u; s < sizeof(sides)/sizeof(uint32_t); ++s)
+        allMatch = runBenchmark(conversions[c], sides[s], bestLevel) && allMatch;
+
+    CColorConverter::setMaxSIMDLevel(bestLevel);
+    printf(allMatch ? "All outputs identical to scalar code\n" : "SIMD OUTPUT DIFFERS FROM SCALAR CODE\n");
+    return allMatch ? 0 : 1;
+}
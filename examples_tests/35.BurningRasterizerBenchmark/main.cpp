@@ -0,0 +1,140 @@
+#include <irrlicht.h>
+#include "../source/Irrlicht/CSoftwareDriver2.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace irr;
+using namespace video;
+
+#define FRAMES 8u
+#define TRIANGLES_PER_BATCH 2048u
+#define BATCHES 6u
+
+//! Keeps a copy of the last frame instead of showing it.
+class CFrameGrabber : public IImagePresenter
+{
+    public:
+        virtual bool present(IImage* surface, void* windowId=0, core::rect<int32_t>* src=0)
+        {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(surface->getData());
+            Frame.assign(data, data+surface->getImageDataSizeInBytes());
+            return true;
+        }
+
+        std::vector<uint8_t> Frame;
+};
+
+//! Fills the vertices of random triangles in device coordinates, the way clipping and projection leave them for the rasterizer.
+static void makeTriangles(std::vector<s4DVertex>& _vertices, uint32_t _width, uint32_t _height, uint32_t _seed, const core::dimension2du& _texSize)
+{
+    std::mt19937 gen(_seed);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    _vertices.resize(TRIANGLES_PER_BATCH*3u);
+    for (uint32_t i = 0u; i < TRIANGLES_PER_BATCH; ++i)
+    {
+        // triangles of all sizes, some spanning many tiles
+        const float size = (unit(gen) < 0.05f ? 0.5f : 0.08f)*float(_width);
+        const float cx = unit(gen)*_width, cy = unit(gen)*_height;
+        for (uint32_t j = 0u; j < 3u; ++j)
+        {
+            s4DVertex& v = _vertices[i*3u+j];
+            memset(static_cast<void*>(&v), 0, sizeof(s4DVertex));
+            v.flag = VERTEX4D_FORMAT_TEXTURE_1|VERTEX4D_FORMAT_COLOR_1|VERTEX4D_PROJECTED;
+            v.Pos.x = core::clamp(cx+(unit(gen)-0.5f)*size, 0.f, float(_width)-0.01f);
+            v.Pos.y = core::clamp(cy+(unit(gen)-0.5f)*size, 0.f, float(_height)-0.01f);
+            const float w = 1.f+unit(gen)*99.f;
+            v.Pos.w = 1.f/w;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+            v.Color[0].set(unit(gen)*v.Pos.w, unit(gen)*v.Pos.w, unit(gen)*v.Pos.w, unit(gen)*v.Pos.w);
+#endif
+            v.Tex[0].x = unit(gen)*(_texSize.Width-0.25f)*v.Pos.w;
+            v.Tex[0].y = unit(gen)*(_texSize.Height-0.25f)*v.Pos.w;
+        }
+    }
+}
+
+int main()
+{
+    const core::dimension2du resolutions[] = {
+        core::dimension2du(640u, 480u),
+        core::dimension2du(1280u, 720u),
+        core::dimension2du(1920u, 1080u),
+        core::dimension2du(3840u, 2160u)
+    };
+    // always bin with at least 2 threads, so the binning overhead shows even on a single core
+    const uint32_t hwThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t t = 1u; t < std::max(hwThreads, 2u); t *= 2u)
+        threadCounts.push_back(t);
+    threadCounts.push_back(std::max(hwThreads, 2u));
+
+    // solid, additive, alpha tested and vertex alpha batches exercise depth testing and blending order
+    const E_MATERIAL_TYPE materialTypes[BATCHES] = {EMT_SOLID, EMT_TRANSPARENT_ADD_COLOR, EMT_SOLID, EMT_TRANSPARENT_ALPHA_CHANNEL, EMT_TRANSPARENT_VERTEX_ALPHA, EMT_SOLID};
+
+    printf("%u hardware threads, %u triangles a frame\n", hwThreads, TRIANGLES_PER_BATCH*BATCHES);
+    for (size_t r = 0u; r < sizeof(resolutions)/sizeof(core::dimension2du); ++r)
+    {
+        SIrrlichtCreationParameters params;
+        params.WindowSize = resolutions[r];
+        CFrameGrabber grabber;
+        CBurningVideoDriver* driver = new CBurningVideoDriver(params, 0, &grabber);
+
+        CImage* image = new CImage(BURNINGSHADER_COLOR_FORMAT, core::dimension2du(256u, 256u));
+        for (uint32_t y = 0u; y < 256u; ++y)
+        for (uint32_t x = 0u; x < 256u; ++x)
+            image->setPixel(x, y, SColor((x^y)&0xffu, x, y, 255u-x));
+        std::vector<CImageData*> mipLevels(1u, new CImageData(image));
+        image->drop();
+        ITexture* texture = driver->addTexture(ITexture::ETT_2D, mipLevels, "checker", BURNINGSHADER_COLOR_FORMAT);
+        mipLevels[0]->drop();
+
+        std::vector<s4DVertex> batches[BATCHES];
+        for (uint32_t b = 0u; b < BATCHES; ++b)
+            makeTriangles(batches[b], resolutions[r].Width, resolutions[r].Height, b, *reinterpret_cast<const core::dimension2du*>(texture->getSize()));
+
+        printf("%4ux%-4u", resolutions[r].Width, resolutions[r].Height);
+        std::vector<uint8_t> reference;
+        for (size_t t = 0u; t < threadCounts.size(); ++t)
+        {
+            driver->setRasterizerThreadCount(threadCounts[t]);
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (uint32_t f = 0u; f < FRAMES; ++f)
+            {
+                driver->beginScene(true, true, SColor(255u, 32u, 32u, 64u));
+                for (uint32_t b = 0u; b < BATCHES; ++b)
+                {
+                    SMaterial material;
+                    material.MaterialType = materialTypes[b];
+                    material.MaterialTypeParam = 0.5f;
+                    material.BackfaceCulling = false;
+                    if (b)
+                        material.setTexture(0, texture);
+                    driver->setMaterial(material);
+                    driver->drawDeviceTriangles(batches[b].data(), batches[b].size());
+                }
+                driver->endScene();
+            }
+            const double secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+            // tiles interpolate from their own top and left edge instead of stepping all the way from the triangle's,
+            // so a few colors round differently and a few pixels on triangle edges or depth ties flip
+            size_t differing = 0u;
+            if (t == 0u)
+                reference = grabber.Frame;
+            else
+            for (size_t i = 0u; i < reference.size(); i += 4u)
+                differing += memcmp(reference.data()+i, grabber.Frame.data()+i, 4u) ? 1u:0u;
+            printf("  %2u threads %7.1f fps", threadCounts[t], FRAMES/secs);
+            if (t)
+                printf(" (%.3f%% px differ)", 400.0*differing/reference.size());
+        }
+        printf("\n");
+        driver->drop();
+    }
+    return 0;
+}
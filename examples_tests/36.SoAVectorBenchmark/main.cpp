@@ -0,0 +1,171 @@
+#include <irrlicht.h>
+#include "vectorSIMDBatch.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <chrono>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+#define REPEATS 16u
+
+//! How positions are laid out and indexed
+struct Layout
+{
+    const char* name;
+    E_COMPONENTS_PER_ATTRIBUTE components;
+    size_t stride;
+    video::E_INDEX_TYPE indexType;
+};
+
+static const Layout layouts[] = {
+    {"xyz packed, no indices", ECPA_THREE, 12u, video::EIT_UNKNOWN},
+    {"xyz packed, 16bit", ECPA_THREE, 12u, video::EIT_16BIT},
+    {"xyz packed, 32bit", ECPA_THREE, 12u, video::EIT_32BIT},
+    {"xyzw interleaved, 32bit", ECPA_FOUR, 32u, video::EIT_32BIT}
+};
+
+static ICPUMeshBuffer* createMeshBuffer(const Layout& _layout, uint32_t _vertexCount, uint32_t _indexCount, std::mt19937& _gen)
+{
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    ICPUBuffer* vertices = new ICPUBuffer(_vertexCount*_layout.stride);
+    for (uint32_t i = 0u; i < _vertexCount; ++i)
+    {
+        float* pos = reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(vertices->getPointer())+i*_layout.stride);
+        for (uint32_t j = 0u; j < _layout.stride/sizeof(float); ++j)
+            pos[j] = dist(_gen);
+    }
+
+    ICPUMeshDataFormatDesc* desc = new ICPUMeshDataFormatDesc();
+    ICPUMeshBuffer* buffer = new ICPUMeshBuffer();
+    buffer->setMeshDataAndFormat(desc);
+    desc->drop();
+    desc->mapVertexAttrBuffer(vertices, EVAI_ATTR0, _layout.components, ECT_FLOAT, _layout.stride);
+    vertices->drop();
+
+    if (_layout.indexType == video::EIT_UNKNOWN)
+        buffer->setIndexCount(_vertexCount);
+    else
+    {
+        const size_t indexSize = _layout.indexType == video::EIT_16BIT ? sizeof(uint16_t):sizeof(uint32_t);
+        ICPUBuffer* indices = new ICPUBuffer(_indexCount*indexSize);
+        std::uniform_int_distribution<uint32_t> indexDist(0u, _vertexCount-1u);
+        for (uint32_t i = 0u; i < _indexCount; ++i)
+        {
+            const uint32_t index = indexDist(_gen);
+            if (indexSize == sizeof(uint16_t))
+                reinterpret_cast<uint16_t*>(indices->getPointer())[i] = index;
+            else
+                reinterpret_cast<uint32_t*>(indices->getPointer())[i] = index;
+        }
+        desc->mapIndexBuffer(indices);
+        indices->drop();
+        buffer->setIndexType(_layout.indexType);
+        buffer->setIndexCount(_indexCount);
+    }
+    return buffer;
+}
+
+//! What ICPUMeshBuffer::recalculateBoundingBox() did for every layout, one getPosition() at a time
+static aabbox3df referenceBoundingBox(const ICPUMeshBuffer* _buffer)
+{
+    aabbox3df box;
+    const void* indices = _buffer->getIndices();
+    for (size_t j = 0u; j < _buffer->getIndexCount(); ++j)
+    {
+        size_t ix = j;
+        if (indices)
+            ix = _buffer->getIndexType() == video::EIT_16BIT ? reinterpret_cast<const uint16_t*>(indices)[j]:reinterpret_cast<const uint32_t*>(indices)[j];
+        if (j)
+            box.addInternalPoint(_buffer->getPosition(ix).getAsVector3df());
+        else
+            box.reset(_buffer->getPosition(ix).getAsVector3df());
+    }
+    return box;
+}
+
+static bool runBoundingBoxBenchmark(const Layout& _layout, uint32_t _vertexCount)
+{
+    std::mt19937 gen(_vertexCount);
+    // odd index counts leave a partial batch at the end
+    ICPUMeshBuffer* buffer = createMeshBuffer(_layout, _vertexCount, _vertexCount*3u-1u, gen);
+
+    aabbox3df reference;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t r = 0u; r < REPEATS; ++r)
+        reference = referenceBoundingBox(buffer);
+    const double referenceSecs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t r = 0u; r < REPEATS; ++r)
+        buffer->recalculateBoundingBox();
+    const double batchSecs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    const bool retval = reference == buffer->getBoundingBox();
+    const double indexCount = double(buffer->getIndexCount())*REPEATS/1000000.0;
+    printf("%-24s %8u vertices  getPosition %7.1f M/s  SoA batches %7.1f M/s  x%.1f%s\n", _layout.name, _vertexCount,
+        indexCount/referenceSecs, indexCount/batchSecs, referenceSecs/batchSecs, retval ? "":"  MISMATCH");
+    buffer->drop();
+    return retval;
+}
+
+//! Face normals of a triangle soup, the way flat shading recalculates them
+static bool runFaceNormalBenchmark(uint32_t _triangleCount)
+{
+    std::mt19937 gen(_triangleCount);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    std::vector<float> positions(_triangleCount*9u);
+    for (size_t i = 0u; i < positions.size(); ++i)
+        positions[i] = dist(gen);
+    std::vector<float> aosNormals(_triangleCount*3u), soaNormals(_triangleCount*3u);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t r = 0u; r < REPEATS; ++r)
+    for (uint32_t i = 0u; i < _triangleCount; ++i)
+    {
+        const float* tri = positions.data()+i*9u;
+        const vectorSIMDf a(tri[0], tri[1], tri[2]), b(tri[3], tri[4], tri[5]), c(tri[6], tri[7], tri[8]);
+        const vectorSIMDf normal = normalize(cross(b-a, c-a));
+        memcpy(aosNormals.data()+i*3u, normal.pointer, 3u*sizeof(float));
+    }
+    const double aosSecs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t r = 0u; r < REPEATS; ++r)
+    for (uint32_t i = 0u; i < _triangleCount; i += vector3dfSIMDBatch::BATCH_SIZE)
+    {
+        const uint32_t count = std::min<uint32_t>(_triangleCount-i, vector3dfSIMDBatch::BATCH_SIZE);
+        const float* tris = positions.data()+i*9u;
+        const vector3dfSIMDBatch a = vector3dfSIMDBatch::loadStrided(tris, 9u*sizeof(float), count);
+        const vector3dfSIMDBatch b = vector3dfSIMDBatch::loadStrided(tris+3u, 9u*sizeof(float), count);
+        const vector3dfSIMDBatch c = vector3dfSIMDBatch::loadStrided(tris+6u, 9u*sizeof(float), count);
+        normalize(cross(b-a, c-a)).storeStrided(soaNormals.data()+i*3u, 3u*sizeof(float), count);
+    }
+    const double soaSecs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    // both do the same operations in the same order
+    const bool retval = !memcmp(aosNormals.data(), soaNormals.data(), aosNormals.size()*sizeof(float));
+    const double triangles = double(_triangleCount)*REPEATS/1000000.0;
+    printf("%-24s %8u triangles vectorSIMDf %7.1f M/s  SoA batches %7.1f M/s  x%.1f%s\n", "face normals", _triangleCount,
+        triangles/aosSecs, triangles/soaSecs, aosSecs/soaSecs, retval ? "":"  MISMATCH");
+    return retval;
+}
+
+int main()
+{
+    bool allMatch = true;
+    const uint32_t vertexCounts[] = {1000u, 30000u, 65536u};
+    for (size_t l = 0u; l < sizeof(layouts)/sizeof(Layout); ++l)
+    for (size_t v = 0u; v < sizeof(vertexCounts)/sizeof(uint32_t); ++v)
+        allMatch = runBoundingBoxBenchmark(layouts[l], vertexCounts[v]) && allMatch;
+
+    const uint32_t triangleCounts[] = {1001u, 100001u, 1000001u};
+    for (size_t t = 0u; t < sizeof(triangleCounts)/sizeof(uint32_t); ++t)
+        allMatch = runFaceNormalBenchmark(triangleCounts[t]) && allMatch;
+
+    printf(allMatch ? "All results identical\n" : "RESULTS DIFFER\n");
+    return allMatch ? 0 : 1;
+}
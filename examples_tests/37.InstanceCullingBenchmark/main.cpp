@@ -0,0 +1,227 @@
+#include <irrlicht.h>
+#include "CInstanceCuller.h"
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+#define REPEATS 16u
+#define LOD_COUNT 3u
+
+static const char* levelNames[CInstanceCuller::ESL_COUNT] = {"SSE3", "AVX2"};
+
+//! Instances of a unit box scattered around the camera, like CMeshSceneNodeInstanced keeps them
+struct Scene
+{
+    Scene(size_t _count) : transforms(_count), boxes(_count)
+    {
+        std::mt19937 gen(_count);
+        std::uniform_real_distribution<float> position(-1500.f, 1500.f);
+        std::uniform_real_distribution<float> angle(0.f, 360.f);
+        std::uniform_real_distribution<float> scale(0.5f, 20.f);
+        const aabbox3df LoDInvariantBox(-1.f, -1.f, -1.f, 1.f, 1.f, 1.f);
+        for (size_t i = 0u; i < _count; ++i)
+        {
+            transforms[i].setRotationDegrees(vector3df(angle(gen), angle(gen), angle(gen)));
+            transforms[i].setScale(scale(gen));
+            transforms[i].setTranslation(vector3df(position(gen), position(gen), position(gen)));
+            boxes[i] = LoDInvariantBox;
+            transforms[i].transformBoxEx(boxes[i]);
+            // removed instances leave empty boxes behind
+            if (i%13u == 5u)
+            {
+                boxes[i].MinEdge.set( FLT_MAX, FLT_MAX, FLT_MAX);
+                boxes[i].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+            }
+        }
+
+        nodeTransform.setRotationDegrees(vector3df(0.f, 30.f, 0.f));
+        nodeTransform.setTranslation(vector3df(10.f, -20.f, 30.f));
+
+        matrix4 proj;
+        proj.buildProjectionMatrixPerspectiveFovLH(PI/2.5f, 16.f/9.f, 1.f, 4000.f);
+        matrix4x3 view;
+        view.buildCameraLookAtMatrixLH(vector3df(100.f, 50.f, -200.f), vector3df(300.f, 0.f, 500.f), vector3df(0.f, 1.f, 0.f));
+        projView = concatenateBFollowedByA(proj, view);
+        frustum.setFrom(projView);
+        frustum.cameraPosition.set(100.f, 50.f, -200.f);
+
+        const float distances[LOD_COUNT] = {400.f, 900.f, 1800.f};
+        for (uint32_t l = 0u; l < LOD_COUNT; ++l)
+            lodDistancesSQ[l] = distances[l]*distances[l];
+    }
+
+    std::vector<matrix4x3> transforms;
+    std::vector<aabbox3df> boxes;
+    matrix4x3 nodeTransform;
+    matrix4 projView;
+    SViewFrustum frustum;
+    float lodDistancesSQ[LOD_COUNT];
+};
+
+//! Per LoD index lists
+struct Result
+{
+    Result(size_t _count) : indices(LOD_COUNT*_count), stride(_count) {}
+
+    void cull(const Scene& _scene, uint32_t _threadCount)
+    {
+        uint32_t* outputs[LOD_COUNT];
+        for (uint32_t l = 0u; l < LOD_COUNT; ++l)
+            outputs[l] = indices.data()+l*stride;
+        CInstanceCuller::cull(outputs, counts, _scene.boxes.data(), _scene.boxes.size(), _scene.frustum, _scene.nodeTransform, _scene.lodDistancesSQ, LOD_COUNT, _threadCount);
+    }
+
+    bool operator==(const Result& _other) const
+    {
+        for (uint32_t l = 0u; l < LOD_COUNT; ++l)
+        {
+            if (counts[l] != _other.counts[l] || !std::equal(indices.begin()+l*stride, indices.begin()+l*stride+counts[l], _other.indices.begin()+l*stride))
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<uint32_t> indices;
+    size_t stride;
+    size_t counts[LOD_COUNT];
+};
+
+//! What a CPUCullingFunc like the one of example 08 does, one instance and one matrix4 at a time
+static size_t cullOneByOne(const Scene& _scene)
+{
+    const matrix4 projViewWorld = concatenateBFollowedByA(_scene.projView, _scene.nodeTransform);
+    const aabbox3df LoDInvariantBox(-1.f, -1.f, -1.f, 1.f, 1.f, 1.f);
+    size_t visible = 0u;
+    for (size_t i = 0u; i < _scene.transforms.size(); ++i)
+    {
+        if (_scene.boxes[i].MinEdge.X > _scene.boxes[i].MaxEdge.X)
+            continue;
+
+        vector3df center = _scene.transforms[i].getTranslation();
+        _scene.nodeTransform.transformVect(&center.X);
+        if (center.getDistanceFromSQ(_scene.frustum.cameraPosition.getAsVector3df()) >= _scene.lodDistancesSQ[LOD_COUNT-1u])
+            continue;
+
+        matrix4 instanceProjViewWorld = concatenateBFollowedByA(projViewWorld, _scene.transforms[i]);
+        if (instanceProjViewWorld.isBoxInsideFrustum(LoDInvariantBox))
+            visible++;
+    }
+    return visible;
+}
+
+//! Counts boxes put in the wrong LoD or culled wrongly, worked out in doubles one plane corner at a time.
+/** Boxes whose corner is within `_tolerance` of a plane or whose center is that close to a LoD distance can go either way. */
+static size_t countWrong(const Scene& _scene, const Result& _result, double _tolerance)
+{
+    std::vector<uint32_t> lods(_scene.boxes.size(), LOD_COUNT);
+    for (uint32_t l = 0u; l < LOD_COUNT; ++l)
+    for (size_t i = 0u; i < _result.counts[l]; ++i)
+        lods[_result.indices[l*_result.stride+i]] = l;
+
+    size_t wrong = 0u;
+    for (size_t i = 0u; i < _scene.boxes.size(); ++i)
+    {
+        const aabbox3df& box = _scene.boxes[i];
+        uint32_t expected = LOD_COUNT;
+        bool unsure = false;
+        if (box.MinEdge.X <= box.MaxEdge.X)
+        {
+            vector3df corners[8];
+            box.getEdges(corners);
+            double mostOutside = -INFINITY;
+            for (uint32_t p = 0u; p < SViewFrustum::VF_PLANE_COUNT; ++p)
+            {
+                double closest = INFINITY;
+                for (uint32_t c = 0u; c < 8u; ++c)
+                {
+                    vector3df world = corners[c];
+                    _scene.nodeTransform.transformVect(&world.X);
+                    const plane3df& plane = _scene.frustum.planes[p];
+                    closest = std::min(closest, double(plane.Normal.X)*world.X+double(plane.Normal.Y)*world.Y+double(plane.Normal.Z)*world.Z+plane.D);
+                }
+                mostOutside = std::max(mostOutside, closest);
+            }
+            unsure = std::abs(mostOutside) < _tolerance;
+
+            vector3df center = box.getCenter();
+            _scene.nodeTransform.transformVect(&center.X);
+            const vector3df eye = _scene.frustum.cameraPosition.getAsVector3df();
+            const double distance = std::sqrt(double(center.X-eye.X)*(center.X-eye.X)+double(center.Y-eye.Y)*(center.Y-eye.Y)+double(center.Z-eye.Z)*(center.Z-eye.Z));
+            uint32_t lod = 0u;
+            for (; lod < LOD_COUNT && distance >= std::sqrt(double(_scene.lodDistancesSQ[lod])); ++lod)
+                unsure = unsure || std::abs(distance-std::sqrt(double(_scene.lodDistancesSQ[lod]))) < _tolerance;
+            if (lod < LOD_COUNT)
+                unsure = unsure || std::abs(distance-std::sqrt(double(_scene.lodDistancesSQ[lod]))) < _tolerance;
+            if (mostOutside <= 0.0)
+                expected = lod;
+        }
+        if (!unsure && expected != lods[i])
+            wrong++;
+    }
+    return wrong;
+}
+
+template<class F>
+static double timeIt(F _job)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t r = 0u; r < REPEATS; ++r)
+        _job();
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static bool runBenchmark(size_t _count, CInstanceCuller::E_SIMD_LEVEL _bestLevel, uint32_t _hwThreads)
+{
+    const Scene scene(_count);
+    const double instances = double(_count)*REPEATS/1000000.0;
+
+    size_t oneByOneVisible = 0u;
+    printf("%8u instances  one by one %7.1f M/s", uint32_t(_count), instances/timeIt([&]() { oneByOneVisible = cullOneByOne(scene); }));
+
+    // every level and thread count has to give exactly what SSE3 on one thread gives
+    Result reference(_count), result(_count);
+    bool retval = true;
+    for (uint32_t level = CInstanceCuller::ESL_SSE3; level <= uint32_t(_bestLevel); ++level)
+    {
+        CInstanceCuller::setMaxSIMDLevel(CInstanceCuller::E_SIMD_LEVEL(level));
+        Result& out = level == CInstanceCuller::ESL_SSE3 ? reference:result;
+        printf("  %s %7.1f M/s", levelNames[level], instances/timeIt([&]() { out.cull(scene, 1u); }));
+        retval = retval && out == reference;
+    }
+    printf("  %u threads %7.1f M/s", _hwThreads, instances/timeIt([&]() { result.cull(scene, 0u); }));
+    retval = retval && result == reference;
+    // more threads than cores still has to merge chunks in order
+    result.cull(scene, 7u);
+    retval = retval && result == reference;
+
+    const size_t wrong = countWrong(scene, reference, 1e-2);
+    size_t visible = 0u;
+    for (uint32_t l = 0u; l < LOD_COUNT; ++l)
+        visible += reference.counts[l];
+    printf("  visible %u (one by one %u)%s\n", uint32_t(visible), uint32_t(oneByOneVisible), retval&&!wrong ? "":"  MISMATCH");
+    return retval && !wrong;
+}
+
+int main()
+{
+    const CInstanceCuller::E_SIMD_LEVEL bestLevel = CInstanceCuller::setMaxSIMDLevel(CInstanceCuller::ESL_AVX2);
+    const uint32_t hwThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    printf("Best instruction set supported: %s, %u hardware threads\n", levelNames[bestLevel], hwThreads);
+
+    // odd counts leave partial batches of 8 at the end of the array and of every thread's chunk
+    const size_t counts[] = {1001u, 16383u, 262145u, 1048577u};
+    bool allMatch = true;
+    for (size_t c = 0u; c < sizeof(counts)/sizeof(size_t); ++c)
+        allMatch = runBenchmark(counts[c], bestLevel, hwThreads) && allMatch;
+
+    CInstanceCuller::setMaxSIMDLevel(bestLevel);
+    printf(allMatch ? "All results match\n" : "CULLING RESULTS DIFFER\n");
+    return allMatch ? 0 : 1;
+}
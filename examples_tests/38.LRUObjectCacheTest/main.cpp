@@ -0,0 +1,131 @@
+#include <irrlicht.h>
+#include <CLRUObjectCache.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace irr;
+
+//! Object weighted by its size, counting live instances to check the cache drops what it evicts
+class CachedObject : public IReferenceCounted
+{
+    public:
+        CachedObject(size_t _size) : size(_size) { ++alive; }
+
+        size_t size;
+        static int32_t alive;
+
+    protected:
+        ~CachedObject() { --alive; }
+};
+int32_t CachedObject::alive = 0;
+
+typedef core::CLRUObjectCache<std::string, CachedObject> CacheT;
+
+static bool allPassed = true;
+
+static void check(bool _condition, const char* _what)
+{
+    printf("%s: %s\n", _condition ? "PASS" : "FAIL", _what);
+    allPassed = allPassed && _condition;
+}
+
+//! Whether exactly the keys in `_present` are in the cache
+static bool holds(const CacheT& _cache, const std::vector<std::string>& _present)
+{
+    for (size_t i = 0u; i < _present.size(); ++i)
+        if (!_cache.getByKey(_present[i]))
+            return false;
+    return _cache.getSize() == _present.size();
+}
+
+static bool sameStats(const CacheT::SStats& _stats, uint64_t _hits, uint64_t _misses, uint64_t _evictions)
+{
+    return _stats.hits == _hits && _stats.misses == _misses && _stats.evictions == _evictions;
+}
+
+//! Objects counting 1 each, so capacity is the max object count
+static void testCountBounded()
+{
+    {
+        CacheT cache(3u, nullptr, [](CachedObject* _obj) { _obj->grab(); }, [](CachedObject* _obj) { _obj->drop(); });
+        for (const char* key : {"a", "b", "c"})
+        {
+            CachedObject* obj = new CachedObject(1u);
+            cache.insert(key, obj);
+            obj->drop();
+        }
+        check(holds(cache, {"a", "b", "c"}) && cache.getResidentSize() == 3u, "filling up to capacity evicts nothing");
+
+        // "a" becomes most recently used, so "b" is the least recently used one
+        check(cache.getByKey("a") != nullptr, "hit marks object as most recently used");
+        check(cache.getByKey("x") == nullptr, "missing key is a miss");
+
+        CachedObject* obj = new CachedObject(1u);
+        cache.insert("d", obj);
+        obj->drop();
+        check(holds(cache, {"a", "c", "d"}), "insert past capacity evicts least recently used object");
+        check(CachedObject::alive == 3, "evicted object is disposed of");
+        check(sameStats(cache.getStats(), 1u, 1u, 1u), "stats count 1 hit, 1 miss, 1 eviction");
+        check(cache.getStats().getHitRate() == 0.5, "hit rate is 0.5");
+
+        // the const lookups of holds() don't count, so order is still c, a, d from least recently used
+        cache.setCapacity(1u);
+        check(holds(cache, {"d"}) && cache.getResidentSize() == 1u, "shrinking capacity evicts least recently used objects first");
+        check(sameStats(cache.getStats(), 1u, 1u, 3u), "shrinking counts evictions");
+
+        cache.resetStats();
+        check(sameStats(cache.getStats(), 0u, 0u, 0u) && cache.getStats().getHitRate() == 0.0, "resetStats() zeroes stats");
+
+        obj = new CachedObject(1u);
+        check(!cache.insert("d", obj), "inserting existing key fails");
+        obj->drop();
+        check(!cache.insert("e", nullptr), "inserting NULL fails");
+    }
+    check(CachedObject::alive == 0, "destructor disposes of remaining objects");
+}
+
+//! Objects weighted by size function, so capacity is a memory budget
+static void testSizeBounded()
+{
+    {
+        CacheT cache(100u, [](const CachedObject* _obj) { return _obj->size; }, [](CachedObject* _obj) { _obj->grab(); }, [](CachedObject* _obj) { _obj->drop(); });
+        const size_t sizes[] = {40u, 30u, 20u};
+        const char* keys[] = {"a", "b", "c"};
+        for (size_t i = 0u; i < 3u; ++i)
+        {
+            CachedObject* obj = new CachedObject(sizes[i]);
+            cache.insert(keys[i], obj);
+            obj->drop();
+        }
+        check(cache.getResidentSize() == 90u, "resident size is sum of object sizes");
+
+        // a 60 sized object needs both 40 sized "a" and 30 sized "b" gone
+        CachedObject* obj = new CachedObject(60u);
+        cache.insert("d", obj);
+        obj->drop();
+        check(holds(cache, {"c", "d"}) && cache.getResidentSize() == 80u, "big insert evicts as many least recently used objects as it takes");
+        check(sameStats(cache.getStats(), 0u, 0u, 2u), "stats count 2 evictions");
+
+        obj = new CachedObject(101u);
+        check(!cache.insert("e", obj) && holds(cache, {"c", "d"}), "object bigger than capacity is rejected without evicting anything");
+        obj->drop();
+
+        cache.removeByKey("c");
+        check(holds(cache, {"d"}) && cache.getResidentSize() == 60u, "removeByKey() frees object's size");
+        check(sameStats(cache.getStats(), 0u, 0u, 2u), "removal isn't an eviction");
+
+        cache.setCapacity(59u);
+        check(cache.getSize() == 0u && cache.getResidentSize() == 0u, "shrinking below single object's size empties cache");
+    }
+    check(CachedObject::alive == 0, "all objects disposed of");
+}
+
+int main()
+{
+    testCountBounded();
+    testSizeBounded();
+
+    printf(allPassed ? "All tests passed\n" : "SOME TESTS FAILED\n");
+    return allPassed ? 0 : 1;
+}
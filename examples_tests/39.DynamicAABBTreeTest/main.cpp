@@ -0,0 +1,143 @@
+#include <irrlicht.h>
+#include <SDynamicAABBTree.h>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+using namespace irr;
+using namespace core;
+
+typedef SDynamicAABBTree<uint32_t> TreeT;
+
+static bool allPassed = true;
+
+static void check(bool _condition, const char* _what)
+{
+    printf("%s: %s\n", _condition ? "PASS" : "FAIL", _what);
+    allPassed = allPassed && _condition;
+}
+
+//! Sorted user data of proxies whose boxes queryBox() reports intersecting `_box`
+static std::vector<uint32_t> queryBox(const TreeT& _tree, const aabbox3df& _box)
+{
+    std::vector<uint32_t> found;
+    _tree.queryBox(_box, [&](int32_t _proxy) { found.push_back(_tree.getUserData(_proxy)); return true; });
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+//! Sorted user data of proxies whose fat boxes queryRay() reports hit
+static std::vector<uint32_t> queryRay(const TreeT& _tree, const vectorSIMDf& _origin, const vectorSIMDf& _direction, float _maxDistance)
+{
+    std::vector<uint32_t> found;
+    _tree.queryRay(_origin, _direction, _maxDistance, [&](int32_t _proxy, float _distance) { found.push_back(_tree.getUserData(_proxy)); return _distance; });
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+static void testMoveProxy()
+{
+    TreeT tree(0.1f);
+    const aabbox3df box(-1.f, -1.f, -1.f, 1.f, 1.f, 1.f);
+    const int32_t proxy = tree.createProxy(box, 7u);
+    // a second proxy far away, so the tree has inner nodes whose boxes have to be refit
+    tree.createProxy(aabbox3df(100.f, 100.f, 100.f, 101.f, 101.f, 101.f), 8u);
+
+    check(box.isFullInside(tree.getFatBox(proxy)) && !tree.getFatBox(proxy).isFullInside(box), "stored box is fattened");
+
+    const aabbox3df nudged(-0.95f, -1.f, -1.f, 1.05f, 1.f, 1.f);
+    check(!tree.moveProxy(proxy, nudged), "move within the fat box doesn't reinsert");
+    check(nudged.isFullInside(tree.getFatBox(proxy)), "fat box still contains nudged box");
+
+    const aabbox3df shifted(9.f, -1.f, -1.f, 11.f, 1.f, 1.f);
+    check(tree.moveProxy(proxy, shifted), "move out of the fat box reinserts");
+    check(queryBox(tree, aabbox3df(10.f, 0.f, 0.f, 10.f, 0.f, 0.f)) == std::vector<uint32_t>{7u}, "moved proxy is found at its new place");
+    check(queryBox(tree, aabbox3df(0.f, 0.f, 0.f, 0.f, 0.f, 0.f)).empty(), "moved proxy is no longer found at its old place");
+
+    // growing to enclose the fat box fits none of the old boxes
+    const aabbox3df grown(0.f, -20.f, -20.f, 20.f, 20.f, 20.f);
+    check(tree.moveProxy(proxy, grown), "growing past the fat box reinserts");
+    check(grown.isFullInside(tree.getFatBox(proxy)), "fat box contains grown box");
+    check(queryBox(tree, aabbox3df(19.f, 19.f, 19.f, 19.5f, 19.5f, 19.5f)) == std::vector<uint32_t>{7u}, "grown proxy is found in the newly covered region");
+    check(queryRay(tree, vectorSIMDf(1.f, 15.f, -50.f), vectorSIMDf(0.f, 0.f, 1.f), 100.f) == std::vector<uint32_t>{7u}, "ray through the newly covered region hits grown proxy");
+}
+
+//! Every query has to report at least the proxies whose actual boxes qualify and no proxy whose fat box doesn't
+static void testAgainstBruteForce()
+{
+    TreeT tree(0.1f);
+    std::mt19937 gen(42u);
+    std::uniform_real_distribution<float> position(-100.f, 100.f);
+    std::uniform_real_distribution<float> extent(0.1f, 5.f);
+    std::uniform_real_distribution<float> step(-2.f, 2.f);
+    std::uniform_real_distribution<float> growth(0.5f, 3.f);
+    auto randomBox = [&]() {
+        const vector3df center(position(gen), position(gen), position(gen));
+        const vector3df halfExtent(extent(gen), extent(gen), extent(gen));
+        return aabbox3df(center-halfExtent, center+halfExtent);
+    };
+
+    const uint32_t PROXY_COUNT = 1000u;
+    std::vector<aabbox3df> boxes(PROXY_COUNT);
+    std::vector<int32_t> proxies(PROXY_COUNT);
+    for (uint32_t i = 0u; i < PROXY_COUNT; ++i)
+    {
+        boxes[i] = randomBox();
+        proxies[i] = tree.createProxy(boxes[i], i);
+    }
+
+    bool boxesMatch = true, raysMatch = true;
+    uint32_t reinserted = 0u;
+    for (uint32_t frame = 0u; frame < 50u; ++frame)
+    {
+        // move every proxy a bit and scale some of them up or down around their centers
+        for (uint32_t i = 0u; i < PROXY_COUNT; ++i)
+        {
+            const vector3df offset(step(gen), step(gen), step(gen));
+            const vector3df center = boxes[i].getCenter()+offset;
+            const float scale = i%5u ? 1.f:growth(gen);
+            const vector3df halfExtent = boxes[i].getExtent()*0.5f*scale;
+            boxes[i] = aabbox3df(center-halfExtent, center+halfExtent);
+            if (tree.moveProxy(proxies[i], boxes[i]))
+                reinserted++;
+            boxesMatch = boxesMatch && boxes[i].isFullInside(tree.getFatBox(proxies[i]));
+        }
+
+        for (uint32_t q = 0u; q < 20u; ++q)
+        {
+            const aabbox3df queryRegion = randomBox();
+            const std::vector<uint32_t> found = queryBox(tree, queryRegion);
+            for (uint32_t i = 0u; i < PROXY_COUNT; ++i)
+            {
+                const bool reported = std::binary_search(found.begin(), found.end(), i);
+                if (boxes[i].intersectsWithBox(queryRegion) && !reported)
+                    boxesMatch = false;
+                if (!tree.getFatBox(proxies[i]).intersectsWithBox(queryRegion) && reported)
+                    boxesMatch = false;
+            }
+
+            const vector3df from(position(gen), position(gen), -150.f);
+            const vector3df to(position(gen), position(gen), 150.f);
+            const std::vector<uint32_t> hit = queryRay(tree, vectorSIMDf(from.X, from.Y, from.Z), vectorSIMDf(to.X-from.X, to.Y-from.Y, to.Z-from.Z), 1.f);
+            const line3df ray(from, to);
+            for (uint32_t i = 0u; i < PROXY_COUNT; ++i)
+            {
+                if (boxes[i].intersectsWithLine(ray) && !std::binary_search(hit.begin(), hit.end(), i))
+                    raysMatch = false;
+            }
+        }
+    }
+    printf("%u of %u moves reinserted proxies, tree height %d\n", reinserted, PROXY_COUNT*50u, tree.getHeight());
+    check(boxesMatch, "box queries find every moved proxy and nothing outside fat boxes");
+    check(raysMatch, "ray queries hit every moved proxy");
+}
+
+int main()
+{
+    testMoveProxy();
+    testAgainstBruteForce();
+
+    printf(allPassed ? "All tests passed\n" : "SOME TESTS FAILED\n");
+    return allPassed ? 0 : 1;
+}
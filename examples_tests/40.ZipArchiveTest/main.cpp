@@ -0,0 +1,248 @@
+#include <irrlicht.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace irr;
+
+static bool allPassed = true;
+
+static void check(bool _condition, const char* _what)
+{
+    printf("%s: %s\n", _condition ? "PASS" : "FAIL", _what);
+    allPassed = allPassed && _condition;
+}
+
+static const uint32_t ENTRY_COUNT = 3000u;
+static const size_t STREAMING_THRESHOLD = 0x1u<<16;
+
+//! Two of every 100 entries are above the streaming threshold, the rest are a few kilobytes
+static size_t entrySize(uint32_t _entry)
+{
+    return _entry%100u<2u ? STREAMING_THRESHOLD+_entry*13u:(_entry*7919u)%8192u;
+}
+
+//! Deterministic contents, so nothing needs to be kept to check them
+static std::vector<uint8_t> entryContents(uint32_t _entry)
+{
+    std::vector<uint8_t> data(entrySize(_entry));
+    uint32_t state = _entry*2654435761u+1u;
+    for (size_t i=0u; i<data.size(); i++)
+    {
+        state = state*1664525u+1013904223u;
+        data[i] = uint8_t(state>>24);
+    }
+    return data;
+}
+
+static uint32_t crc32(const std::vector<uint8_t>& _data)
+{
+    uint32_t crc = 0xffffffffu;
+    for (size_t i=0u; i<_data.size(); i++)
+    {
+        crc ^= _data[i];
+        for (uint32_t k=0u; k<8u; k++)
+            crc = (crc>>1)^(0xedb88320u&(0u-(crc&1u)));
+    }
+    return ~crc;
+}
+
+//! Deflate stream of uncompressed blocks, any inflater reads it and nothing has to compress
+static std::vector<uint8_t> storedDeflate(const std::vector<uint8_t>& _data)
+{
+    std::vector<uint8_t> out;
+    size_t pos = 0u;
+    do
+    {
+        const size_t len = std::min<size_t>(_data.size()-pos,0xffffu);
+        out.push_back(pos+len==_data.size() ? 1u:0u);
+        const uint16_t header[2] = {uint16_t(len),uint16_t(~len)};
+        out.insert(out.end(),reinterpret_cast<const uint8_t*>(header),reinterpret_cast<const uint8_t*>(header+2));
+        out.insert(out.end(),_data.begin()+pos,_data.begin()+pos+len);
+        pos += len;
+    } while (pos<_data.size());
+    return out;
+}
+
+template<typename T>
+static void put(std::vector<uint8_t>& _out, T _value)
+{
+    _out.insert(_out.end(),reinterpret_cast<const uint8_t*>(&_value),reinterpret_cast<const uint8_t*>(&_value+1));
+}
+
+//! Writes a zip of ENTRY_COUNT entries, odd ones deflated and even ones stored
+static bool writeArchive(io::IFileSystem* _fs, const char* _name)
+{
+    std::vector<uint8_t> zip, directory;
+    for (uint32_t i=0u; i<ENTRY_COUNT; i++)
+    {
+        char name[32];
+        sprintf(name,"dir%u/entry%04u.bin",i%10u,i);
+        const uint16_t nameLength = strlen(name);
+        const std::vector<uint8_t> data = entryContents(i);
+        const uint16_t method = i&1u ? 8u:0u;
+        const std::vector<uint8_t> packed = method ? storedDeflate(data):data;
+        const uint32_t crc = crc32(data);
+
+        put<uint32_t>(directory,0x02014b50u);
+        put<uint16_t>(directory,20u);
+        put<uint16_t>(directory,20u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,method);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,crc);
+        put<uint32_t>(directory,packed.size());
+        put<uint32_t>(directory,data.size());
+        put<uint16_t>(directory,nameLength);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,zip.size());
+        directory.insert(directory.end(),name,name+nameLength);
+
+        // local headers get an extra field the central directory doesn't have, so data offsets must come from them
+        put<uint32_t>(zip,0x04034b50u);
+        put<uint16_t>(zip,20u);
+        put<uint16_t>(zip,0u);
+        put<uint16_t>(zip,method);
+        put<uint32_t>(zip,0u);
+        put<uint32_t>(zip,crc);
+        put<uint32_t>(zip,packed.size());
+        put<uint32_t>(zip,data.size());
+        put<uint16_t>(zip,nameLength);
+        put<uint16_t>(zip,i%3u*4u);
+        zip.insert(zip.end(),name,name+nameLength);
+        zip.insert(zip.end(),i%3u*4u,0xabu);
+        zip.insert(zip.end(),packed.begin(),packed.end());
+    }
+
+    const uint32_t directoryOffset = zip.size();
+    zip.insert(zip.end(),directory.begin(),directory.end());
+    put<uint32_t>(zip,0x06054b50u);
+    put<uint16_t>(zip,0u);
+    put<uint16_t>(zip,0u);
+    put<uint16_t>(zip,ENTRY_COUNT);
+    put<uint16_t>(zip,ENTRY_COUNT);
+    put<uint32_t>(zip,directory.size());
+    put<uint32_t>(zip,directoryOffset);
+    put<uint16_t>(zip,0u);
+
+    io::IWriteFile* file = _fs->createAndWriteFile(_name);
+    if (!file)
+        return false;
+    const bool retval = size_t(file->write(zip.data(),zip.size()))==zip.size();
+    file->drop();
+    return retval;
+}
+
+//! Entry number encoded in the file's name
+static uint32_t entryOf(const io::IFileList* _list, uint32_t _index)
+{
+    uint32_t entry = 0xdeadbeefu;
+    const char* name = strrchr(_list->getFileName(_index).c_str(),'y');
+    if (name)
+        sscanf(name+1,"%u",&entry);
+    return entry;
+}
+
+static bool hasContents(io::IReadFile* _file, uint32_t _entry)
+{
+    const std::vector<uint8_t> expected = entryContents(_entry);
+    std::vector<uint8_t> data(expected.size()+1u);
+    return _file && _file->getSize()==expected.size() && _file->seek(0u) &&
+        size_t(_file->read(data.data(),data.size()))==expected.size() &&
+        std::equal(expected.begin(),expected.end(),data.begin());
+}
+
+//! Opens all entries at once on `_threadCount` threads and reads them back on 4 threads at once
+static bool openAndReadAll(io::IFileArchive* _archive, uint32_t _threadCount)
+{
+    const io::IFileList* list = _archive->getFileList();
+    std::vector<uint32_t> indices, entries;
+    for (uint32_t i=0u; i<list->getFileCount(); i++)
+    if (!list->isDirectory(i))
+    {
+        indices.push_back(i);
+        entries.push_back(entryOf(list,i));
+    }
+    if (indices.size()!=ENTRY_COUNT)
+        return false;
+
+    std::vector<io::IReadFile*> files(indices.size());
+    const uint32_t opened = _archive->createAndOpenFiles(indices.data(),indices.size(),files.data(),_threadCount);
+
+    // stored entries of an archive which isn't mapped share its read position
+    std::vector<uint8_t> good(files.size(),0u);
+    std::vector<std::thread> readers;
+    for (uint32_t t=0u; t<4u; t++)
+        readers.push_back(std::thread([&,t]()
+            {
+                for (size_t i=t; i<files.size(); i+=4u)
+                    good[i] = hasContents(files[i],entries[i]);
+            }));
+    for (size_t t=0u; t<readers.size(); t++)
+        readers[t].join();
+
+    bool retval = opened==files.size();
+    for (size_t i=0u; i<files.size(); i++)
+    {
+        retval = retval&&good[i];
+        if (files[i])
+            files[i]->drop();
+    }
+    return retval;
+}
+
+static void testArchive(io::IFileSystem* _fs, const char* _name, bool _mapped)
+{
+    printf("%s archive\n", _mapped ? "Memory mapped":"Unmapped");
+    _fs->setFileMappingEnabled(_mapped);
+    io::IFileArchive* archive = 0;
+    check(_fs->addFileArchive(_name,true,false,io::EFAT_ZIP,"",&archive) && archive, "archive mounts");
+    if (!archive)
+        return;
+    check(archive->getFileList()->getFileCount()>=ENTRY_COUNT, "all entries listed");
+    archive->setStreamingThreshold(STREAMING_THRESHOLD);
+
+    check(openAndReadAll(archive,1u), "entries opened on 1 thread read back");
+    check(openAndReadAll(archive,4u), "entries opened on 4 threads read back");
+
+    archive->setDecompressedCacheSize(4u<<20);
+    check(openAndReadAll(archive,4u), "entries read back while filling the cache");
+    check(openAndReadAll(archive,4u), "entries read back from the cache");
+
+    // a file keeps its decompressed contents and its archive when the cache or the file system let go of them
+    io::IReadFile* deflated = archive->createAndOpenFile(io::path("dir3/entry0003.bin"));
+    io::IReadFile* stored = archive->createAndOpenFile(io::path("dir2/entry0002.bin"));
+    archive->setDecompressedCacheSize(0u);
+    _fs->removeFileArchive(archive);
+    check(hasContents(deflated,3u), "deflated file outlives its cache entry");
+    check(hasContents(stored,2u), "stored file outlives its archive");
+    if (deflated)
+        deflated->drop();
+    if (stored)
+        stored->drop();
+}
+
+int main()
+{
+    IrrlichtDevice* device = createDevice(video::EDT_NULL);
+    if (!device)
+        return 1;
+    io::IFileSystem* fs = device->getFileSystem();
+
+    const char* name = "ZipArchiveTest.zip";
+    check(writeArchive(fs,name), "test archive written");
+    testArchive(fs,name,false);
+    testArchive(fs,name,true);
+    remove(name);
+
+    device->drop();
+
+    printf(allPassed ? "All tests passed\n" : "SOME TESTS FAILED\n");
+    return allPassed ? 0 : 1;
+}
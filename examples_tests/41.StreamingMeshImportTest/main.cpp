@@ -0,0 +1,203 @@
+#include <irrlicht.h>
+#include "IStreamingMeshLoader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace irr;
+
+static bool allPassed = true;
+
+static void check(bool _condition, const char* _what)
+{
+    printf("%s: %s\n", _condition ? "PASS" : "FAIL", _what);
+    allPassed = allPassed && _condition;
+}
+
+static const uint32_t TRIANGLE_COUNT = 60000u;
+
+//! Limits far below the size of the test file, so clusters get emitted early and split
+static scene::SStreamingMeshImportParams importParams()
+{
+    scene::SStreamingMeshImportParams params;
+    params.ReadWindowSize = 4096u;
+    params.MaxResidentBytes = 0x1u<<18;
+    params.MaxVerticesPerBuffer = 3072u;
+    params.GridResolution = 4u;
+    return params;
+}
+
+//! Positions, color and normal of a triangle as the STL loader lays out its vertices
+struct STriangle
+{
+    float positions[3][3];
+    uint32_t color;
+    uint32_t normal;
+
+    //! normals are quantized differently by createMesh() and streamMesh(), so they're left out of the ordering
+    bool operator<(const STriangle& _other) const
+    {
+        return memcmp(this,&_other,offsetof(STriangle,normal))<0;
+    }
+};
+
+//! Writes a binary STL of small colored triangles scattered over a box, with a handful of distinct normals
+static bool writeSTL(io::IFileSystem* _fs, const char* _name)
+{
+    static const float normals[8][3] = {{1.f,0.f,0.f},{0.f,1.f,0.f},{0.f,0.f,1.f},{-1.f,0.f,0.f},{0.f,-1.f,0.f},{0.f,0.f,-1.f},{0.6f,0.8f,0.f},{0.f,0.6f,-0.8f}};
+
+    std::vector<uint8_t> stl(84u+TRIANGLE_COUNT*50u,0u);
+    memcpy(stl.data(),"binary STL written by StreamingMeshImportTest",45u);
+    memcpy(stl.data()+80u,&TRIANGLE_COUNT,4u);
+    uint32_t state = 12345u;
+    auto random = [&state]() {state = state*1664525u+1013904223u; return state>>8;};
+    for (uint32_t i=0u; i<TRIANGLE_COUNT; i++)
+    {
+        uint8_t* record = stl.data()+84u+i*50u;
+        memcpy(record,normals[i%8u],12u);
+        float center[3];
+        for (uint32_t j=0u; j<3u; j++)
+            center[j] = float(random()%20000u)*0.01f-100.f;
+        for (uint32_t v=0u; v<3u; v++)
+        {
+            float position[3];
+            for (uint32_t j=0u; j<3u; j++)
+                position[j] = center[j]+float(random()%100u)*0.01f;
+            memcpy(record+12u+v*12u,position,12u);
+        }
+        // color in the attribute, with the bit telling it's there
+        const uint16_t attrib = 0x8000u|(random()&0x7fffu);
+        memcpy(record+48u,&attrib,2u);
+    }
+
+    io::IWriteFile* file = _fs->createAndWriteFile(_name);
+    if (!file)
+        return false;
+    const bool retval = size_t(file->write(stl.data(),stl.size()))==stl.size();
+    file->drop();
+    return retval;
+}
+
+//! Appends triangles of a non-indexed mesh buffer in the STL loader's vertex layout
+static bool appendTriangles(const scene::ICPUMeshBuffer* _meshbuffer, std::vector<STriangle>& _out)
+{
+    const scene::IMeshDataFormatDesc<core::ICPUBuffer>* desc = _meshbuffer->getMeshDataAndFormat();
+    const core::ICPUBuffer* buffer = desc->getMappedBuffer(scene::EVAI_ATTR0);
+    const size_t stride = desc->getMappedBufferStride(scene::EVAI_ATTR0);
+    if (_meshbuffer->getIndices() || !buffer || stride!=20u || _meshbuffer->getIndexCount()%3u || buffer->getSize()<_meshbuffer->getIndexCount()*stride)
+        return false;
+
+    const uint8_t* vertices = reinterpret_cast<const uint8_t*>(buffer->getPointer());
+    for (size_t i=0u; i<_meshbuffer->getIndexCount(); i+=3u)
+    {
+        STriangle triangle;
+        for (uint32_t v=0u; v<3u; v++)
+            memcpy(triangle.positions[v],vertices+(i+v)*stride,12u);
+        memcpy(&triangle.normal,vertices+i*stride+12u,4u);
+        memcpy(&triangle.color,vertices+i*stride+16u,4u);
+        _out.push_back(triangle);
+    }
+    return true;
+}
+
+//! Whether two 2_10_10_10 normals point the same way, up to quantization
+static bool similarNormals(uint32_t _a, uint32_t _b)
+{
+    float dot = 0.f, lengthA = 0.f, lengthB = 0.f;
+    for (uint32_t i=0u; i<3u; i++)
+    {
+        const float a = float(int32_t(_a<<(22u-i*10u))>>22);
+        const float b = float(int32_t(_b<<(22u-i*10u))>>22);
+        dot += a*b;
+        lengthA += a*a;
+        lengthB += b*b;
+    }
+    return dot>0.999f*sqrtf(lengthA*lengthB);
+}
+
+static void testStreaming(io::IFileSystem* _fs, scene::IMeshLoader* _loader, scene::IStreamingMeshLoader* _streamingLoader, const char* _name, bool _mapped)
+{
+    printf("%s file\n", _mapped ? "Memory mapped":"Unmapped");
+    _fs->setFileMappingEnabled(_mapped);
+    const scene::SStreamingMeshImportParams params = importParams();
+
+    std::vector<STriangle> reference;
+    io::IReadFile* file = _fs->createAndOpenFile(_name);
+    scene::ICPUMesh* mesh = file ? _loader->createMesh(file):NULL;
+    check(mesh && mesh->getMeshBufferCount()==1u && appendTriangles(mesh->getMeshBuffer(0u),reference) && reference.size()==TRIANGLE_COUNT, "createMesh() loads every triangle");
+    if (mesh)
+        mesh->drop();
+
+    std::vector<STriangle> streamed;
+    uint32_t bufferCount = 0u;
+    bool buffersValid = true;
+    const bool finished = file && _streamingLoader->streamMesh(file,
+        [&](scene::ICPUMeshBuffer* _meshbuffer, uint32_t _cluster)
+        {
+            bufferCount++;
+            const size_t first = streamed.size();
+            buffersValid = buffersValid && _cluster<params.GridResolution*params.GridResolution*params.GridResolution &&
+                _meshbuffer->getIndexCount()<=params.MaxVerticesPerBuffer && appendTriangles(_meshbuffer,streamed);
+            // every vertex lies within the buffer's bounding box
+            const core::aabbox3df& bounds = _meshbuffer->getBoundingBox();
+            for (size_t i=first; buffersValid&&i<streamed.size(); i++)
+            for (uint32_t v=0u; v<3u; v++)
+                buffersValid = buffersValid && bounds.isPointInside(core::vector3df(streamed[i].positions[v][0],streamed[i].positions[v][1],streamed[i].positions[v][2]));
+            return true;
+        }, params);
+    check(finished, "streamMesh() finishes");
+    check(buffersValid, "buffers are within their limits and bounds");
+    check(size_t(file ? file->getSize():0)>params.MaxResidentBytes && bufferCount>params.GridResolution*params.GridResolution*params.GridResolution, "file is bigger than the budget and gets split into more buffers than clusters");
+
+    // same triangles with the same positions and colors in whatever order, normals only differ by quantization
+    std::sort(reference.begin(),reference.end());
+    std::sort(streamed.begin(),streamed.end());
+    bool same = streamed.size()==reference.size();
+    for (size_t i=0u; same&&i<reference.size(); i++)
+        same = !(reference[i]<streamed[i]) && !(streamed[i]<reference[i]) && similarNormals(reference[i].normal,streamed[i].normal);
+    check(same, "streamed triangles match createMesh()");
+
+    uint32_t callCount = 0u;
+    const bool aborted = file && !_streamingLoader->streamMesh(file,[&callCount](scene::ICPUMeshBuffer*, uint32_t) {return ++callCount<3u;}, params);
+    check(aborted && callCount==3u, "callback aborts the import");
+
+    if (file)
+        file->drop();
+}
+
+int main()
+{
+    IrrlichtDevice* device = createDevice(video::EDT_NULL);
+    if (!device)
+        return 1;
+    io::IFileSystem* fs = device->getFileSystem();
+    scene::ISceneManager* smgr = device->getSceneManager();
+
+    // the STL loader is the one which streams
+    const char* name = "StreamingMeshImportTest.stl";
+    scene::IMeshLoader* loader = NULL;
+    scene::IStreamingMeshLoader* streamingLoader = NULL;
+    for (uint32_t i=0u; !streamingLoader&&i<smgr->getMeshLoaderCount(); i++)
+    {
+        loader = smgr->getMeshLoader(i);
+        if (loader->isALoadableFileExtension(name))
+            streamingLoader = dynamic_cast<scene::IStreamingMeshLoader*>(loader);
+    }
+    check(streamingLoader, "STL loader implements IStreamingMeshLoader");
+
+    if (streamingLoader)
+    {
+        check(writeSTL(fs,name), "test file written");
+        testStreaming(fs,loader,streamingLoader,name,false);
+        testStreaming(fs,loader,streamingLoader,name,true);
+        remove(name);
+    }
+
+    device->drop();
+
+    printf(allPassed ? "All tests passed\n" : "SOME TESTS FAILED\n");
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+#include <irrlicht.h>
+#include "../source/Irrlicht/CZipStreamReadFile.h"
+#include "../source/Irrlicht/zlib/zlib.h"
+#include "../source/Irrlicht/bzip2/bzlib.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace irr;
+
+static bool allPassed = true;
+
+static void check(bool _condition, const char* _what)
+{
+    printf("%s: %s\n", _condition ? "PASS" : "FAIL", _what);
+    allPassed = allPassed && _condition;
+}
+
+//! Entries are streamed from this size on, so both compressed entries are
+static const size_t STREAMING_THRESHOLD = 0x1u<<20;
+static const size_t DEFLATED_SIZE = 6u<<20;
+//! bzip2 starts over from the beginning on every far backward seek, so it gets a smaller file
+static const size_t BZIP2_SIZE = 2u<<20;
+
+//! Text of random words and numbers, compressible enough for deflate to make many blocks of it
+static std::vector<uint8_t> makeContents(size_t _size, uint32_t _seed)
+{
+    static const char* words[] = {"mesh ","buffer ","vertex ","index ","archive ","stream ","window ","\n"};
+    std::vector<uint8_t> data;
+    data.reserve(_size+16u);
+    uint32_t state = _seed;
+    while (data.size()<_size)
+    {
+        state = state*1664525u+1013904223u;
+        const char* word = words[state>>29];
+        data.insert(data.end(),word,word+strlen(word));
+        char number[16];
+        const int length = sprintf(number,"%u ",(state>>8)%1000u);
+        data.insert(data.end(),number,number+length);
+    }
+    data.resize(_size);
+    return data;
+}
+
+static std::vector<uint8_t> deflateRaw(const std::vector<uint8_t>& _data)
+{
+    z_stream stream;
+    memset(&stream,0,sizeof(stream));
+    std::vector<uint8_t> out;
+    if (deflateInit2(&stream,Z_DEFAULT_COMPRESSION,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY)!=Z_OK)
+        return out;
+    out.resize(deflateBound(&stream,_data.size()));
+    stream.next_in = const_cast<Bytef*>(_data.data());
+    stream.avail_in = _data.size();
+    stream.next_out = out.data();
+    stream.avail_out = out.size();
+    const bool finished = deflate(&stream,Z_FINISH)==Z_STREAM_END;
+    out.resize(finished ? stream.total_out:0u);
+    deflateEnd(&stream);
+    return out;
+}
+
+static std::vector<uint8_t> compressBzip2(const std::vector<uint8_t>& _data)
+{
+    std::vector<uint8_t> out(_data.size()+_data.size()/100u+600u);
+    unsigned int size = out.size();
+    if (BZ2_bzBuffToBuffCompress(reinterpret_cast<char*>(out.data()),&size,reinterpret_cast<char*>(const_cast<uint8_t*>(_data.data())),_data.size(),1,0,0)!=BZ_OK)
+        size = 0u;
+    out.resize(size);
+    return out;
+}
+
+template<typename T>
+static void put(std::vector<uint8_t>& _out, T _value)
+{
+    _out.insert(_out.end(),reinterpret_cast<const uint8_t*>(&_value),reinterpret_cast<const uint8_t*>(&_value+1));
+}
+
+struct SEntry
+{
+    const char* name;
+    uint16_t method;
+    const std::vector<uint8_t>* data;
+    std::vector<uint8_t> packed;
+};
+
+//! Writes the entries into a zip, without a CRC since the reader doesn't check it
+static bool writeArchive(io::IFileSystem* _fs, const char* _name, const std::vector<SEntry>& _entries)
+{
+    std::vector<uint8_t> zip, directory;
+    for (size_t i=0u; i<_entries.size(); i++)
+    {
+        const SEntry& entry = _entries[i];
+        const uint16_t nameLength = strlen(entry.name);
+
+        put<uint32_t>(directory,0x02014b50u);
+        put<uint16_t>(directory,46u);
+        put<uint16_t>(directory,46u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,entry.method);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,entry.packed.size());
+        put<uint32_t>(directory,entry.data->size());
+        put<uint16_t>(directory,nameLength);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,zip.size());
+        directory.insert(directory.end(),entry.name,entry.name+nameLength);
+
+        put<uint32_t>(zip,0x04034b50u);
+        put<uint16_t>(zip,46u);
+        put<uint16_t>(zip,0u);
+        put<uint16_t>(zip,entry.method);
+        put<uint32_t>(zip,0u);
+        put<uint32_t>(zip,0u);
+        put<uint32_t>(zip,entry.packed.size());
+        put<uint32_t>(zip,entry.data->size());
+        put<uint16_t>(zip,nameLength);
+        put<uint16_t>(zip,0u);
+        zip.insert(zip.end(),entry.name,entry.name+nameLength);
+        zip.insert(zip.end(),entry.packed.begin(),entry.packed.end());
+    }
+
+    const uint32_t directoryOffset = zip.size();
+    zip.insert(zip.end(),directory.begin(),directory.end());
+    put<uint32_t>(zip,0x06054b50u);
+    put<uint16_t>(zip,0u);
+    put<uint16_t>(zip,0u);
+    put<uint16_t>(zip,uint16_t(_entries.size()));
+    put<uint16_t>(zip,uint16_t(_entries.size()));
+    put<uint32_t>(zip,directory.size());
+    put<uint32_t>(zip,directoryOffset);
+    put<uint16_t>(zip,0u);
+
+    io::IWriteFile* file = _fs->createAndWriteFile(_name);
+    if (!file)
+        return false;
+    const bool retval = size_t(file->write(zip.data(),zip.size()))==zip.size();
+    file->drop();
+    return retval;
+}
+
+//! Seeks to `_pos` and checks that `_length` bytes read from there match `_expected`
+static bool readsAt(io::IReadFile* _file, const std::vector<uint8_t>& _expected, size_t _pos, size_t _length)
+{
+    _length = core::min_(_length,_expected.size()-_pos);
+    std::vector<uint8_t> data(_length);
+    return _file->seek(_pos) && _file->getPos()==_pos && size_t(_file->read(data.data(),_length))==_length &&
+        _file->getPos()==_pos+_length && !memcmp(data.data(),_expected.data()+_pos,_length);
+}
+
+//! Reads a streamed entry sequentially, then seeks back and forth over its restart points and at random
+static void testEntry(io::IFileArchive* _archive, const char* _name, const std::vector<uint8_t>& _expected, uint32_t _randomSeeks)
+{
+    printf("  %s\n", _name);
+    io::IReadFile* file = _archive->createAndOpenFile(io::path(_name));
+    io::CZipStreamReadFile* stream = dynamic_cast<io::CZipStreamReadFile*>(file);
+    check(stream && stream->isValid() && file->getSize()==_expected.size(), "entry is streamed");
+    if (!stream)
+    {
+        if (file)
+            file->drop();
+        return;
+    }
+
+    // odd sized reads, so they straddle both the window and the blocks
+    bool sequential = true;
+    std::vector<uint8_t> data(12345u);
+    for (size_t pos=0u; sequential&&pos<_expected.size(); pos+=data.size())
+    {
+        const size_t length = core::min_(data.size(),_expected.size()-pos);
+        sequential = size_t(file->read(data.data(),data.size()))==length && !memcmp(data.data(),_expected.data()+pos,length);
+    }
+    check(sequential && file->read(data.data(),1u)==0, "sequential read");
+
+    // deflated entries got a restart point at the first block boundary past every span, bzip2 ones get none
+    const size_t span = stream->getRestartSpan();
+    bool restarts = true;
+    for (size_t k=(_expected.size()-1u)/span; restarts&&k>0u; k--)
+    {
+        const size_t point = k*span;
+        restarts = readsAt(file,_expected,point-100u,200u) && readsAt(file,_expected,point+span/2u,5000u);
+        restarts = restarts && readsAt(file,_expected,point-io::CZipStreamReadFile::WINDOW_SIZE-1u,io::CZipStreamReadFile::WINDOW_SIZE+2u);
+    }
+    check(restarts, "backward seeks across restart points");
+
+    // within the window kept behind the read position, then just out of it
+    const size_t middle = _expected.size()/2u;
+    bool window = readsAt(file,_expected,middle,1000u) && readsAt(file,_expected,middle+1000u-io::CZipStreamReadFile::WINDOW_SIZE,10u);
+    window = window && readsAt(file,_expected,middle-io::CZipStreamReadFile::WINDOW_SIZE,10u);
+    window = window && file->seek(size_t(0u)-20000u,true) && file->getPos()==middle-io::CZipStreamReadFile::WINDOW_SIZE-19990u;
+    window = window && file->read(data.data(),100u)==100 && !memcmp(data.data(),_expected.data()+file->getPos()-100u,100u);
+    check(window, "short backward seeks");
+
+    const bool ends = readsAt(file,_expected,0u,1u) && readsAt(file,_expected,_expected.size()-1u,10u) &&
+        file->seek(_expected.size()) && file->read(data.data(),1u)==0 && !file->seek(_expected.size()+1u) && readsAt(file,_expected,1u,10u);
+    check(ends, "seeks to both ends");
+
+    bool random = true;
+    uint32_t state = 7u;
+    for (uint32_t i=0u; random&&i<_randomSeeks; i++)
+    {
+        state = state*1664525u+1013904223u;
+        const size_t pos = (size_t(state)*2654435761u)%_expected.size();
+        random = readsAt(file,_expected,pos,(state>>8)%70000u);
+    }
+    check(random, "random seeks");
+
+    // every file keeps its own decoder, interleaved reads of the same entry don't disturb each other
+    io::IReadFile* other = _archive->createAndOpenFile(io::path(_name));
+    bool interleaved = other!=NULL;
+    for (size_t pos=0u; interleaved&&pos<_expected.size(); pos+=_expected.size()/7u)
+        interleaved = readsAt(file,_expected,pos,3000u) && readsAt(other,_expected,_expected.size()-1u-pos,3000u);
+    check(interleaved, "two files of the same entry");
+    if (other)
+        other->drop();
+
+    file->drop();
+}
+
+int main()
+{
+    IrrlichtDevice* device = createDevice(video::EDT_NULL);
+    if (!device)
+        return 1;
+    io::IFileSystem* fs = device->getFileSystem();
+
+    const std::vector<uint8_t> deflated = makeContents(DEFLATED_SIZE,1u);
+    const std::vector<uint8_t> bzipped = makeContents(BZIP2_SIZE,2u);
+    std::vector<SEntry> entries(2u);
+    entries[0].name = "deflated.txt";
+    entries[0].method = 8u;
+    entries[0].data = &deflated;
+    entries[0].packed = deflateRaw(deflated);
+    entries[1].name = "bzipped.txt";
+    entries[1].method = 12u;
+    entries[1].data = &bzipped;
+    entries[1].packed = compressBzip2(bzipped);
+
+    const char* name = "ZipStreamReadTest.zip";
+    check(!entries[0].packed.empty() && !entries[1].packed.empty() && writeArchive(fs,name,entries), "test archive written");
+    for (uint32_t mapped=0u; mapped<2u; mapped++)
+    {
+        printf("%s archive\n", mapped ? "Memory mapped":"Unmapped");
+        fs->setFileMappingEnabled(mapped!=0u);
+        io::IFileArchive* archive = NULL;
+        check(fs->addFileArchive(name,true,false,io::EFAT_ZIP,"",&archive) && archive, "archive mounts");
+        if (!archive)
+            continue;
+        archive->setStreamingThreshold(STREAMING_THRESHOLD);
+        testEntry(archive,entries[0].name,deflated,500u);
+        testEntry(archive,entries[1].name,bzipped,50u);
+        fs->removeFileArchive(archive);
+    }
+    remove(name);
+
+    device->drop();
+
+    printf(allPassed ? "All tests passed\n" : "SOME TESTS FAILED\n");
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+#include <irrlicht.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace irr;
+
+static bool allPassed = true;
+
+static void check(bool _condition, const char* _what)
+{
+    printf("%s: %s\n", _condition ? "PASS" : "FAIL", _what);
+    allPassed = allPassed && _condition;
+}
+
+//! Query as CFileList compares it, with forward slashes, no trailing slash and no path if the list ignores paths
+static io::path normalizedQuery(const io::path& _query, bool _ignorePaths, bool& _isDirectory)
+{
+    io::path name(_query);
+    name.replace('\\','/');
+    _isDirectory = name.lastChar()=='/';
+    if (_isDirectory)
+        name = name.subString(0u,name.size()-1u);
+    if (_ignorePaths)
+        core::deletePathFromFilename(name);
+    return name;
+}
+
+//! Looks the name up by going through the whole list, names are compared ignoring case like CFileList does
+static bool linearFind(const io::IFileList* _list, bool _ignorePaths, const io::path& _query)
+{
+    bool isDirectory;
+    const io::path name = normalizedQuery(_query,_ignorePaths,isDirectory);
+    for (uint32_t i=0u; i<_list->getFileCount(); i++)
+    if (_list->isDirectory(i)==isDirectory && _list->getFullFileName(i).equals_ignore_case(name))
+        return true;
+    return false;
+}
+
+//! Same name in other case and with backslashes, its bare name, and a name nothing has
+static void addVariants(std::vector<io::path>& _queries, const io::path& _name)
+{
+    _queries.push_back(_name);
+    io::path upper(_name);
+    upper.make_upper();
+    _queries.push_back(upper);
+    io::path backslashed(_name);
+    backslashed.replace('/','\\');
+    _queries.push_back(backslashed);
+    io::path bare(_name);
+    if (bare.lastChar()!='/')
+    {
+        core::deletePathFromFilename(bare);
+        _queries.push_back(bare);
+    }
+    _queries.push_back(_name+"~");
+}
+
+//! Checks findFile() of sorted and unsorted lists against a search through all entries, for every combination of flags
+static void testFileList(io::IFileSystem* _fs)
+{
+    for (uint32_t flags=0u; flags<4u; flags++)
+    {
+        const bool ignoreCase = flags&1u, ignorePaths = flags&2u;
+        io::IFileList* list = _fs->createEmptyFileList("",ignoreCase,ignorePaths);
+        std::vector<io::path> queries;
+        for (uint32_t i=0u; i<2000u; i++)
+        {
+            char name[64];
+            if (i%50u==0u)
+                sprintf(name,"Dir%02u/Sub%u/",i/50u,i%3u);
+            else
+                sprintf(name,i%3u ? "Dir%02u/Sub%u/File%04u.txt":"Dir%02u\\Sub%u\\File%04u.TXT",i/50u,i%3u,i);
+            list->addItem(name,0u,i,false);
+            addVariants(queries,name);
+        }
+        list->sort();
+
+        // added after sorting, so the list has to be searched without its index
+        io::IFileList* unsorted = _fs->createEmptyFileList("",ignoreCase,ignorePaths);
+        for (uint32_t i=0u; i<list->getFileCount(); i++)
+            unsorted->addItem(list->getFullFileName(i)+(list->isDirectory(i) ? "/":""),0u,0u,false);
+        unsorted->sort();
+        unsorted->addItem("Late/Addition.txt",0u,0u,false);
+        queries.push_back("late/addition.txt");
+
+        bool sorted = true, notSorted = true;
+        for (size_t i=0u; i<queries.size(); i++)
+        {
+            const int32_t found = list->findFile(queries[i]);
+            bool isDirectory;
+            const io::path name = normalizedQuery(queries[i],ignorePaths,isDirectory);
+            if (found<0)
+                sorted = sorted && !linearFind(list,ignorePaths,queries[i]);
+            else
+                sorted = sorted && list->isDirectory(found)==isDirectory && list->getFullFileName(found).equals_ignore_case(name);
+            notSorted = notSorted && (unsorted->findFile(queries[i])>=0)==linearFind(unsorted,ignorePaths,queries[i]);
+        }
+        char what[128];
+        sprintf(what,"sorted list lookups, ignoreCase %d ignorePaths %d",int(ignoreCase),int(ignorePaths));
+        check(sorted,what);
+        sprintf(what,"unsorted list lookups, ignoreCase %d ignorePaths %d",int(ignoreCase),int(ignorePaths));
+        check(notSorted && unsorted->findFile("Late\\Addition.TXT")>=0,what);
+        list->drop();
+        unsorted->drop();
+    }
+}
+
+//! File list of an archive that isn't a CFileList, which only finds names of exactly the same case
+class CExactFileList : public io::IFileList
+{
+    public:
+        CExactFileList(const std::vector<io::path>& _names) : Names(_names) {}
+
+        virtual uint32_t getFileCount() const { return Names.size(); }
+        virtual const io::path& getFileName(uint32_t index) const { return Names[index]; }
+        virtual const io::path& getFullFileName(uint32_t index) const { return Names[index]; }
+        virtual uint32_t getFileSize(uint32_t index) const { return 0u; }
+        virtual uint32_t getFileOffset(uint32_t index) const { return 0u; }
+        virtual uint32_t getID(uint32_t index) const { return index; }
+        virtual bool isDirectory(uint32_t index) const { return false; }
+        virtual int32_t findFile(const io::path& filename, bool isFolder=false) const
+        {
+            for (size_t i=0u; i<Names.size(); i++)
+            if (!isFolder && Names[i]==filename)
+                return i;
+            return -1;
+        }
+        virtual const io::path& getPath() const { return Path; }
+        virtual uint32_t addItem(const io::path& fullPath, uint32_t offset, uint32_t size, bool isDirectory, uint32_t id=0) { Names.push_back(fullPath); return Names.size()-1u; }
+        virtual void sort() {}
+
+    private:
+        std::vector<io::path> Names;
+        io::path Path;
+};
+
+//! Archive asked by name, its files contain "X:" and their name
+class CExactArchive : public io::IFileArchive
+{
+    public:
+        CExactArchive(io::IFileSystem* _fs, const std::vector<io::path>& _names) : FileSystem(_fs), List(new CExactFileList(_names)) {}
+
+        virtual io::IReadFile* createAndOpenFile(const io::path& filename)
+        {
+            const int32_t index = List->findFile(filename);
+            return index<0 ? NULL:createAndOpenFile(uint32_t(index));
+        }
+        virtual io::IReadFile* createAndOpenFile(uint32_t index)
+        {
+            const std::string contents = std::string("X:")+List->getFullFileName(index).c_str();
+            char* memory = new char[contents.size()];
+            memcpy(memory,contents.data(),contents.size());
+            return FileSystem->createMemoryReadFile(memory,contents.size(),List->getFullFileName(index),true);
+        }
+        virtual const io::IFileList* getFileList() const { return List; }
+
+    protected:
+        virtual ~CExactArchive() { List->drop(); }
+
+    private:
+        io::IFileSystem* FileSystem;
+        CExactFileList* List;
+};
+
+template<typename T>
+static void put(std::vector<uint8_t>& _out, T _value)
+{
+    _out.insert(_out.end(),reinterpret_cast<const uint8_t*>(&_value),reinterpret_cast<const uint8_t*>(&_value+1));
+}
+
+//! Writes a zip of stored entries whose contents are the tag, a colon and the entry's name, names ending with a slash are directories
+static bool writeArchive(io::IFileSystem* _fs, const char* _name, char _tag, const std::vector<std::string>& _entries)
+{
+    std::vector<uint8_t> zip, directory;
+    for (size_t i=0u; i<_entries.size(); i++)
+    {
+        const std::string& name = _entries[i];
+        const std::string data = name[name.size()-1u]=='/' ? std::string():_tag+(":"+name);
+
+        put<uint32_t>(directory,0x02014b50u);
+        put<uint16_t>(directory,20u);
+        put<uint16_t>(directory,20u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,data.size());
+        put<uint32_t>(directory,data.size());
+        put<uint16_t>(directory,uint16_t(name.size()));
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint16_t>(directory,0u);
+        put<uint32_t>(directory,0u);
+        put<uint32_t>(directory,zip.size());
+        directory.insert(directory.end(),name.begin(),name.end());
+
+        put<uint32_t>(zip,0x04034b50u);
+        put<uint16_t>(zip,20u);
+        put<uint16_t>(zip,0u);
+        put<uint16_t>(zip,0u);
+        put<uint32_t>(zip,0u);
+        put<uint32_t>(zip,0u);
+        put<uint32_t>(zip,data.size());
+        put<uint32_t>(zip,data.size());
+        put<uint16_t>(zip,uint16_t(name.size()));
+        put<uint16_t>(zip,0u);
+        zip.insert(zip.end(),name.begin(),name.end());
+        zip.insert(zip.end(),data.begin(),data.end());
+    }
+
+    const uint32_t directoryOffset = zip.size();
+    zip.insert(zip.end(),directory.begin(),directory.end());
+    put<uint32_t>(zip,0x06054b50u);
+    put<uint16_t>(zip,0u);
+    put<uint16_t>(zip,0u);
+    put<uint16_t>(zip,uint16_t(_entries.size()));
+    put<uint16_t>(zip,uint16_t(_entries.size()));
+    put<uint32_t>(zip,directory.size());
+    put<uint32_t>(zip,directoryOffset);
+    put<uint16_t>(zip,0u);
+
+    io::IWriteFile* file = _fs->createAndWriteFile(_name);
+    if (!file)
+        return false;
+    const bool retval = size_t(file->write(zip.data(),zip.size()))==zip.size();
+    file->drop();
+    return retval;
+}
+
+//! An archive mounted by the test, with what's needed to look files up in it without the file system
+struct SMountedArchive
+{
+    io::IFileArchive* archive;
+    char tag;
+    bool ignorePaths;
+};
+
+//! Checks createAndOpenFile() and existFile() against asking each archive in turn, like the file system did before it had an index
+static bool lookupsMatch(io::IFileSystem* _fs, const std::vector<SMountedArchive>& _mounted, const std::vector<io::path>& _queries)
+{
+    uint32_t mismatches = 0u;
+    for (size_t q=0u; q<_queries.size(); q++)
+    {
+        char expected = 0;
+        for (uint32_t i=0u; !expected&&i<_fs->getFileArchiveCount(); i++)
+        {
+            const io::IFileArchive* archive = _fs->getFileArchive(i);
+            for (size_t j=0u; j<_mounted.size(); j++)
+            if (_mounted[j].archive==archive)
+            {
+                const bool found = _mounted[j].tag=='X' ? archive->getFileList()->findFile(_queries[q])>=0:linearFind(archive->getFileList(),_mounted[j].ignorePaths,_queries[q]);
+                if (found)
+                    expected = _mounted[j].tag;
+            }
+        }
+
+        bool isDirectory;
+        normalizedQuery(_queries[q],false,isDirectory);
+        io::IReadFile* file = _fs->createAndOpenFile(_queries[q]);
+        char contents[256] = {0};
+        if (file)
+        {
+            file->read(contents,sizeof(contents)-1u);
+            file->drop();
+        }
+        // directories open as nothing, but exist
+        const char opened = contents[0];
+        const bool exists = _fs->existFile(_queries[q]);
+        const bool matches = exists==(expected!=0) && (isDirectory ? !opened:opened==expected);
+        if (!matches && mismatches++<10u)
+            printf("  \"%s\": expected %c, opened %c, exists %d\n", _queries[q].c_str(), expected ? expected:'-', opened ? opened:'-', int(exists));
+    }
+    return !mismatches;
+}
+
+//! Mounts zips with every combination of flags and an archive of another file list type, then moves and removes them
+static void testFileSystem(io::IFileSystem* _fs)
+{
+    const char tags[] = "ABCDEF";
+    std::vector<SMountedArchive> mounted;
+    std::vector<io::path> queries;
+    std::vector<std::string> zipNames;
+    bool written = true;
+    for (uint32_t k=0u; k<6u; k++)
+    {
+        // every archive has the shared files and a directory of its own, neighbours share half of their directory's files
+        std::vector<std::string> entries;
+        entries.push_back("shared/common.txt");
+        entries.push_back("Shared/Upper"+std::to_string(k)+".txt");
+        entries.push_back("pack"+std::to_string(k)+"/");
+        for (uint32_t i=0u; i<200u; i++)
+            entries.push_back("pack"+std::to_string(i<100u ? k/2u*2u:k)+"/File"+std::to_string(i)+".txt");
+        for (size_t i=0u; i<entries.size(); i++)
+            addVariants(queries,entries[i].c_str());
+
+        zipNames.push_back("FileLookupTest"+std::to_string(k)+".zip");
+        written = written && writeArchive(_fs,zipNames.back().c_str(),tags[k],entries);
+        const bool ignoreCase = k%2u==0u, ignorePaths = k%3u==2u;
+        SMountedArchive archive = {NULL, tags[k], ignorePaths};
+        written = written && _fs->addFileArchive(zipNames.back().c_str(),ignoreCase,ignorePaths,io::EFAT_ZIP,"",&archive.archive);
+        mounted.push_back(archive);
+
+        if (k==2u)
+        {
+            std::vector<io::path> names;
+            names.push_back("shared/common.txt");
+            names.push_back("Exact/Only.txt");
+            const SMountedArchive exact = {new CExactArchive(_fs,names), 'X', false};
+            // the file system takes over the reference
+            _fs->addFileArchive(exact.archive);
+            mounted.push_back(exact);
+            addVariants(queries,"Exact/Only.txt");
+        }
+    }
+    check(written && _fs->getFileArchiveCount()==7u, "archives written and mounted");
+
+    check(lookupsMatch(_fs,mounted,queries), "lookups in order of mounting");
+    check(_fs->moveFileArchive(5u,-5) && lookupsMatch(_fs,mounted,queries), "lookups after moving an archive to the front");
+    check(_fs->moveFileArchive(0u,3) && lookupsMatch(_fs,mounted,queries), "lookups after moving it back behind others");
+
+    // a removed archive's address may be reused by the next one mounted, so it's forgotten
+    const io::IFileArchive* removed = _fs->getFileArchive(1u);
+    for (size_t j=0u; j<mounted.size(); j++)
+    if (mounted[j].archive==removed)
+        mounted[j].archive = NULL;
+    check(_fs->removeFileArchive(1u) && lookupsMatch(_fs,mounted,queries), "lookups after removing an archive");
+    check(_fs->removeFileArchive(mounted[3].archive) && lookupsMatch(_fs,mounted,queries), "lookups after removing the archive of the other list type");
+    mounted[3].archive = NULL;
+
+    // mounted again with other flags, behind all others
+    _fs->removeFileArchive(mounted[0].archive);
+    mounted[0].ignorePaths = true;
+    check(_fs->addFileArchive(zipNames[0].c_str(),false,true,io::EFAT_ZIP,"",&mounted[0].archive) && lookupsMatch(_fs,mounted,queries), "lookups after mounting an archive again");
+
+    while (_fs->getFileArchiveCount())
+        _fs->removeFileArchive(0u);
+    check(!_fs->existFile("shared/common.txt"), "nothing found once all archives are removed");
+    for (size_t i=0u; i<zipNames.size(); i++)
+        remove(zipNames[i].c_str());
+}
+
+int main()
+{
+    IrrlichtDevice* device = createDevice(video::EDT_NULL);
+    if (!device)
+        return 1;
+    io::IFileSystem* fs = device->getFileSystem();
+
+    testFileList(fs);
+    testFileSystem(fs);
+
+    device->drop();
+
+    printf(allPassed ? "All tests passed\n" : "SOME TESTS FAILED\n");
+    return allPassed ? 0 : 1;
+}
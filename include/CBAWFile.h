@@ -106,6 +106,9 @@ namespace core
 
 	//! Cast pointer to (first byte of) file buffer to BAWFile*. 256bit header must be first member (start of file).
 	struct FORCE_EMPTY_BASE_OPT BAWFileV0 {
+		//! File-version number stored in the last 8 bytes of file header.
+		static const uint64_t VERSION = 0u;
+
 		//! 32-byte BaW binary format header, currently equal to "IrrlichtBaW BinaryFile" (and the rest filled with zeroes).
 		//! Also: last 8 bytes of file header is file-version number.
 		uint64_t fileHeader[4];
@@ -122,6 +125,54 @@ namespace core
 		size_t calcBlobsOffset() const { return calcHeadersOffset() + numOfInternalBlobs*sizeof(BlobHeaderV0); }
 	} PACK_STRUCT;
 
+	//! Entry of the root mesh index of .baw archive (file version 1).
+	struct MeshIndexEntryV1
+	{
+		//! Hash of mesh name, see BAWFileV1::hashMeshName(). Index is sorted ascending by this value, entries of equal hashes by name.
+		uint64_t nameHash;
+		//! Handle of the root mesh blob
+		uint64_t handle;
+		//! Offset of the mesh name counted from the start of file, names aren't null-terminated
+		uint64_t nameOffset;
+		//! Length of the mesh name
+		uint32_t nameLength;
+	} PACK_STRUCT;
+
+	//! Cast pointer to (first byte of) file buffer to BAWFileV1*. Version 1 of the format stores many root meshes sharing their dependency blobs.
+	/** File layout:
+		- fixed-size part (members of this struct)
+		- `MeshIndexEntryV1[numOfRootMeshes]` sorted by name hash
+		- `uint64_t[numOfInternalBlobs]` blob offsets counted from after blob-headers block
+		- `BlobHeaderV0[numOfInternalBlobs]` sorted by handle
+		- blobs data, in the same order as headers
+		- names of root meshes, in the same order as the root mesh index
+	Thanks to both tables being sorted, a single mesh along with its dependencies can be found with binary searches, without reading whole tables.
+	*/
+	struct FORCE_EMPTY_BASE_OPT BAWFileV1 {
+		//! File-version number stored in the last 8 bytes of file header.
+		static const uint64_t VERSION = 1u;
+
+		//! Same as BAWFileV0::fileHeader, with version number equal to VERSION.
+		uint64_t fileHeader[4];
+
+		//! Number of internal blobs
+		uint32_t numOfInternalBlobs;
+		//! Number of entries in root mesh index
+		uint32_t numOfRootMeshes;
+		//! Init vector
+		unsigned char iv[16];
+		//! Handle of the root mesh loaded when no name is given, the first one passed to CBAWMeshWriter::writeMeshes()
+		uint64_t defaultMeshHandle;
+
+		size_t calcMeshIndexOffset() const { return sizeof(fileHeader) + sizeof(numOfInternalBlobs) + sizeof(numOfRootMeshes) + sizeof(iv) + sizeof(defaultMeshHandle); }
+		size_t calcOffsetsOffset() const { return calcMeshIndexOffset() + numOfRootMeshes*sizeof(MeshIndexEntryV1); }
+		size_t calcHeadersOffset() const { return calcOffsetsOffset() + numOfInternalBlobs*sizeof(uint64_t); }
+		size_t calcBlobsOffset() const { return calcHeadersOffset() + numOfInternalBlobs*sizeof(BlobHeaderV0); }
+
+		//! Calculates name hash used as key of the root mesh index.
+		static uint64_t hashMeshName(const char* _name);
+	} PACK_STRUCT;
+
 	template<template<typename, typename> class SizingT, typename B, typename T>
 	struct FORCE_EMPTY_BASE_OPT SizedBlob
 	{
@@ -24,6 +24,7 @@ namespace scene
 namespace io
 {
 	class IFileSystem;
+	class CMappedReadFile;
 }
 
 namespace core
@@ -34,6 +35,8 @@ namespace core
 		scene::ISceneManager* sm;
 		io::IFileSystem* fs;
 		io::path filePath;
+		//! File being loaded if it's memory-mapped, NULL otherwise. Blobs pointing into its memory may be aliased instead of copied.
+		io::CMappedReadFile* mappedFile;
 	};
 
 	//! Class abstracting blobs version from process of loading them from *.baw file.
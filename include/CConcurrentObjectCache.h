@@ -9,82 +9,124 @@ namespace irr { namespace core
 
 namespace impl
 {
-    struct CConcurrentObjectCacheBase
+    struct CConcurrentObjectCacheLock
     {
-        struct 
-        {
-            void lockRead() const { FW_AtomicCounterIncr(ctr); }
-            void unlockRead() const { FW_AtomicCounterDecr(ctr); }
-            void lockWrite() const { FW_AtomicCounterBlock(ctr); }
-            void unlockWrite() const { FW_AtomicCounterUnBlock(ctr); }
-
-        private:
-            mutable FW_AtomicCounter ctr = 0;
-        } m_lock;
+        void lockRead() const { FW_AtomicCounterIncr(ctr); }
+        void unlockRead() const { FW_AtomicCounterDecr(ctr); }
+        void lockWrite() const { FW_AtomicCounterBlock(ctr); }
+        void unlockWrite() const { FW_AtomicCounterUnBlock(ctr); }
+
+    private:
+        mutable FW_AtomicCounter ctr{0};
     };
 }
 
+//! Thread-safe object cache partitioned into `ShardCnt` independently locked shards.
+/** Key's hash decides which shard (single CObjectCache along with its own reader/writer lock) the object goes to,
+so writers block only readers and writers of the same shard and sorted-vector inserts shift `ShardCnt` times less elements.
+Operations not involving a key (contains(), getSize()) visit all shards one by one, so they're not atomic with respect to the whole cache.
+*/
 template<
     typename K,
     typename T,
-    template<typename...> class ContainerT_T = std::vector
+    template<typename...> class ContainerT_T = std::vector,
+    size_t ShardCnt = 16u,
+    typename HashT = std::hash<K>
 >
-class CConcurrentObjectCache : private impl::CConcurrentObjectCacheBase, private CObjectCache<K, T, ContainerT_T>
+class CConcurrentObjectCache
 {
+    static_assert(ShardCnt > 0u, "ShardCnt must not be 0");
+
     using Base = CObjectCache<K, T, ContainerT_T>;
 
+    struct Shard : impl::CConcurrentObjectCacheLock, Base
+    {
+        inline void setCallbacks(const std::function<void(T*)>& _greeting, const std::function<void(T*)>& _disposal)
+        {
+            this->m_greetingFunc = _greeting;
+            this->m_disposalFunc = _disposal;
+        }
+    };
+
 public:
-    inline explicit CConcurrentObjectCache(const std::function<void(T*)>& _greeting, const std::function<void(T*)>& _disposal) : CObjectCache<K, T, ContainerT_T>(_greeting, _disposal) {}
-    inline explicit CConcurrentObjectCache(std::function<void(T*)>&& _greeting = nullptr, std::function<void(T*)>&& _disposal = nullptr) : CObjectCache<K, T, ContainerT_T>(std::move(_greeting), std::move(_disposal)) {}
+    inline explicit CConcurrentObjectCache(const std::function<void(T*)>& _greeting, const std::function<void(T*)>& _disposal)
+    {
+        for (size_t i = 0u; i < ShardCnt; ++i)
+            m_shards[i].setCallbacks(_greeting, _disposal);
+    }
+    inline explicit CConcurrentObjectCache(std::function<void(T*)>&& _greeting = nullptr, std::function<void(T*)>&& _disposal = nullptr)
+    {
+        for (size_t i = 0u; i < ShardCnt; ++i)
+            m_shards[i].setCallbacks(_greeting, _disposal);
+    }
 
 	inline bool insert(const K& _key, T* _val)
     {
-        m_lock.lockWrite();
-        const bool r = Base::insert(_key, _val);
-        m_lock.unlockWrite();
+        Shard& shard = getShard(_key);
+        shard.lockWrite();
+        const bool r = shard.insert(_key, _val);
+        shard.unlockWrite();
         return r;
     }
 
 	inline T* getByKey(const K& _key)
     {
-        m_lock.lockRead();
-        T* r = Base::getByKey(_key);
-        m_lock.unlockRead();
+        Shard& shard = getShard(_key);
+        shard.lockRead();
+        T* r = shard.getByKey(_key);
+        shard.unlockRead();
         return r;
     }
 
 	inline const T* getByKey(const K& _key) const
     {
-		m_lock.lockRead();
-		const T* const r = Base::getByKey(_key);
-		m_lock.unlockRead();
+		const Shard& shard = getShard(_key);
+		shard.lockRead();
+		const T* const r = shard.getByKey(_key);
+		shard.unlockRead();
 		return r;
     }
 
 	inline void removeByKey(const K& _key)
     {
-        m_lock.lockWrite();
-        Base::removeByKey(_key);
-        m_lock.unlockWrite();
+        Shard& shard = getShard(_key);
+        shard.lockWrite();
+        shard.removeByKey(_key);
+        shard.unlockWrite();
     }
 
 	inline bool contains(const T* _object) const
     {
-        m_lock.lockRead();
-        const bool r = Base::contains(_object);
-        m_lock.unlockRead();
-        return r;
+        for (size_t i = 0u; i < ShardCnt; ++i)
+        {
+            m_shards[i].lockRead();
+            const bool r = m_shards[i].contains(_object);
+            m_shards[i].unlockRead();
+            if (r)
+                return true;
+        }
+        return false;
     }
 
     inline size_t getSize() const
     {
-        m_lock.lockRead();
-        const size_t r = Base::getSize();
-        m_lock.unlockRead();
+        size_t r = 0u;
+        for (size_t i = 0u; i < ShardCnt; ++i)
+        {
+            m_shards[i].lockRead();
+            r += m_shards[i].getSize();
+            m_shards[i].unlockRead();
+        }
         return r;
     }
+
+private:
+    inline Shard& getShard(const K& _key) { return m_shards[HashT()(_key) % ShardCnt]; }
+    inline const Shard& getShard(const K& _key) const { return m_shards[HashT()(_key) % ShardCnt]; }
+
+    Shard m_shards[ShardCnt];
 };
 
 }}
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,66 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_INSTANCE_CULLER_H_INCLUDED__
+#define __C_INSTANCE_CULLER_H_INCLUDED__
+
+#include "IVideoDriver.h"
+#include "SViewFrustum.h"
+#include "matrix4x3.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Frustum culls boxes of instances on the CPU and sorts the survivors into levels of detail.
+/** Boxes are tested 8 at a time against the 6 planes of an SViewFrustum, one box per SIMD lane. A box is culled when it lies
+entirely in front of any plane, which like core::matrix4::isBoxInsideFrustum() keeps some boxes near the frustum's corners.
+A box which survives goes to the first LoD whose distance is more than the distance from the eye to its center.
+Boxes beyond the last LoD distance are culled, and so are empty boxes with MinEdge above MaxEdge,
+such as the unused slots CMeshSceneNodeInstanced keeps in its instance box array.
+
+The SIMD kernel is picked at runtime, an AVX2 one if os::CPU reports it and an SSE3 one otherwise.
+All kernels compute the same results, so culling doesn't change with the CPU.
+*/
+class CInstanceCuller
+{
+	public:
+		//! Instruction sets kernels exist for, in order of preference
+		enum E_SIMD_LEVEL
+		{
+			ESL_SSE3=0,
+			ESL_AVX2,
+			ESL_COUNT
+		};
+
+		//! Caps the instruction set used by cull(), mostly for benchmarking.
+		/** \return Level actually used, which is lower than `_level` if the CPU doesn't support it. */
+		static E_SIMD_LEVEL setMaxSIMDLevel(E_SIMD_LEVEL _level);
+
+		//! Returns instruction set used by cull()
+		static E_SIMD_LEVEL getSIMDLevel();
+
+		//! Culls `_count` boxes and writes indices of the ones left to an array per LoD, in ascending order.
+		/** The boxes are split into chunks culled on their own threads, the calling thread culls the first chunk.
+		The threads are kept between calls and shared by all callers, a call made while another thread's call is using them culls all chunks on its own thread.
+		Results don't depend on the number of threads.
+		\param _outIndices One array per LoD, each with room for `_count` indices.
+		\param _outCounts Receives the number of indices written to each array.
+		\param _boxes Boxes to cull in their local space.
+		\param _count Number of boxes.
+		\param _frustum Frustum in world space, its cameraPosition is where LoD distances are measured from.
+		\param _localToWorld Transformation from the space of the boxes to world space.
+		\param _lodDistancesSQ Squared distances up to which each LoD is used, `_lodCount` of them in ascending order.
+		\param _lodCount Number of LoDs, at least 1.
+		\param _threadCount Number of threads to cull with, 0 means as many as the hardware has. */
+		static void cull(uint32_t** _outIndices, size_t* _outCounts, const core::aabbox3df* _boxes, size_t _count,
+				const SViewFrustum& _frustum, const core::matrix4x3& _localToWorld, const float* _lodDistancesSQ, size_t _lodCount, uint32_t _threadCount=1);
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef __C_LRU_OBJECT_CACHE_H_INCLUDED__
+#define __C_LRU_OBJECT_CACHE_H_INCLUDED__
+
+#include <list>
+#include "CObjectCache.h"
+
+namespace irr { namespace core
+{
+
+//! Object cache bounded by capacity, evicting least recently used objects.
+/** Every object is weighted by `_sizeFunc` (e.g. byte size of CPU mesh or image), or counts as 1 if no size function is given,
+so that capacity is either memory budget or max object count. Whenever insertion would exceed the capacity,
+least recently used objects are evicted (disposal function is called on them) until the new object fits.
+Lookups through non-const getByKey() mark object as most recently used and are counted as hits or misses.
+*/
+template<
+    typename K,
+    typename T,
+    template<typename...> class ContainerT_T = std::unordered_map
+>
+class CLRUObjectCache
+{
+    static_assert(impl::is_same_templ<ContainerT_T, std::map>::value || impl::is_same_templ<ContainerT_T, std::unordered_map>::value, "ContainerT_T must be one of: std::map, std::unordered_map");
+
+    struct SEntry
+    {
+        K key;
+        T* object;
+        size_t size;
+    };
+    using ListT = std::list<SEntry>; // most recently used at front
+    using ContainerT = ContainerT_T<K, typename ListT::iterator>;
+
+public:
+    //! Statistics of cache usage since construction or last resetStats() call.
+    struct SStats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+
+        inline double getHitRate() const { return (hits + misses) ? double(hits) / double(hits + misses) : 0.0; }
+    };
+
+    inline explicit CLRUObjectCache(size_t _capacity, const std::function<size_t(const T*)>& _sizeFunc, const std::function<void(T*)>& _greeting, const std::function<void(T*)>& _disposal) :
+        m_capacity(_capacity), m_residentSize(0u), m_stats{0u, 0u, 0u}, m_sizeFunc(_sizeFunc), m_greetingFunc(_greeting), m_disposalFunc(_disposal) {}
+    inline explicit CLRUObjectCache(size_t _capacity, std::function<size_t(const T*)>&& _sizeFunc = nullptr, std::function<void(T*)>&& _greeting = nullptr, std::function<void(T*)>&& _disposal = nullptr) :
+        m_capacity(_capacity), m_residentSize(0u), m_stats{0u, 0u, 0u}, m_sizeFunc(std::move(_sizeFunc)), m_greetingFunc(std::move(_greeting)), m_disposalFunc(std::move(_disposal)) {}
+
+    inline virtual ~CLRUObjectCache()
+    {
+        for (auto it = m_lru.begin(); it != m_lru.end(); it++)
+            dispose(it->object);
+    }
+
+    //! Inserts object as most recently used, evicting other objects if needed.
+    /** @returns false if `_val` is NULL, the key is already present or object alone doesn't fit in capacity.*/
+    inline bool insert(const K& _key, T* _val)
+    {
+        if (!_val || m_container.find(_key) != std::end(m_container))
+            return false;
+
+        const size_t size = m_sizeFunc ? m_sizeFunc(_val) : 1u;
+        if (size > m_capacity)
+            return false;
+        evictUntilFits(m_capacity - size);
+
+        greet(_val);
+        m_lru.push_front(SEntry{_key, _val, size});
+        m_container.insert({_key, m_lru.begin()});
+        m_residentSize += size;
+        return true;
+    }
+
+    //! Looks up object and marks it as most recently used.
+    inline T* getByKey(const K& _key)
+    {
+        auto it = m_container.find(_key);
+        if (it == std::end(m_container))
+        {
+            m_stats.misses++;
+            return nullptr;
+        }
+        m_stats.hits++;
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->object;
+    }
+
+    //! Looks up object without affecting eviction order nor statistics.
+    inline const T* getByKey(const K& _key) const
+    {
+        auto it = m_container.find(_key);
+        if (it == std::end(m_container))
+            return nullptr;
+        return it->second->object;
+    }
+
+    inline void removeByKey(const K& _key)
+    {
+        auto it = m_container.find(_key);
+        if (it != std::end(m_container))
+            erase(it);
+    }
+
+    inline bool contains(const T* _object) const
+    {
+        for (const auto& e : m_lru)
+            if (e.object == _object)
+                return true;
+        return false;
+    }
+
+    //! Changes capacity, evicting least recently used objects if resident size exceeds the new one.
+    inline void setCapacity(size_t _capacity)
+    {
+        m_capacity = _capacity;
+        evictUntilFits(m_capacity);
+    }
+    inline size_t getCapacity() const { return m_capacity; }
+
+    //! @returns Sum of sizes of all objects in cache.
+    inline size_t getResidentSize() const { return m_residentSize; }
+    inline size_t getSize() const { return m_container.size(); }
+
+    inline const SStats& getStats() const { return m_stats; }
+    inline void resetStats() { m_stats = SStats{0u, 0u, 0u}; }
+
+private:
+    inline void evictUntilFits(size_t _maxResidentSize)
+    {
+        while (m_residentSize > _maxResidentSize)
+        {
+            erase(m_container.find(m_lru.back().key));
+            m_stats.evictions++;
+        }
+    }
+
+    inline void erase(typename ContainerT::iterator _it)
+    {
+        typename ListT::iterator entry = _it->second;
+        m_residentSize -= entry->size;
+        dispose(entry->object);
+        m_lru.erase(entry);
+        m_container.erase(_it);
+    }
+
+    void dispose(T* _object) const
+    {
+        if (m_disposalFunc)
+            m_disposalFunc(_object);
+    }
+
+    void greet(T* _object) const
+    {
+        if (m_greetingFunc)
+            m_greetingFunc(_object);
+    }
+
+    ListT m_lru;
+    ContainerT m_container;
+    size_t m_capacity;
+    size_t m_residentSize;
+    SStats m_stats;
+
+    std::function<size_t(const T*)> m_sizeFunc;
+    std::function<void(T*)> m_greetingFunc, m_disposalFunc;
+};
+
+}}
+
+#endif
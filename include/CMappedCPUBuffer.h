@@ -0,0 +1,73 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_MAPPED_CPU_BUFFER_H_INCLUDED__
+#define __C_MAPPED_CPU_BUFFER_H_INCLUDED__
+
+#include <string.h>
+#include "ICPUBuffer.h"
+
+namespace irr
+{
+namespace core
+{
+
+//! CPU buffer aliasing memory owned by some other object (i.e. a memory-mapped file) instead of owning malloc'd memory.
+/** The owner is grabbed for the whole lifetime of the buffer so that aliased memory stays valid.
+Aliased memory must be writable without side effects (e.g. a private copy-on-write mapping).
+Upon first reallocation data is copied to malloc'd memory and the owner is released.
+*/
+class CMappedCPUBuffer : public ICPUBuffer
+{
+    protected:
+        virtual ~CMappedCPUBuffer()
+        {
+            if (owner)
+            {
+                data = NULL; // not ours, keep ICPUBuffer from freeing it
+                owner->drop();
+            }
+        }
+    public:
+		//! Constructor.
+		/** @param sizeInBytes Size of aliased memory in bytes.
+		@param dat Pointer to aliased memory.
+		@param _owner Object keeping `dat` alive.
+		*/
+        CMappedCPUBuffer(const size_t &sizeInBytes, void *dat, const IReferenceCounted* _owner) : ICPUBuffer(sizeInBytes, dat), owner(_owner)
+        {
+            if (owner)
+                owner->grab();
+        }
+
+        //! Returns whether the buffer still aliases memory of the owner.
+        bool isAliasing() const {return owner!=NULL;}
+
+		//! Reallocates internal data. Invalidate any sizes, pointers etc. returned before!
+		/** If actual reallocation is needed, aliased data is copied to own memory first and the owner is released. */
+        virtual bool reallocate(const size_t &newSize, const bool& forceRetentionOfData=false, const bool &reallocateIfShrink=false)
+        {
+            if (owner && size!=newSize && (reallocateIfShrink||size<newSize))
+            {
+                void* ownData = malloc(size);
+                if (!ownData)
+                    return false;
+                memcpy(ownData,data,size);
+                data = ownData;
+                owner->drop();
+                owner = NULL;
+            }
+
+            return ICPUBuffer::reallocate(newSize,forceRetentionOfData,reallocateIfShrink);
+        }
+
+    private:
+        const IReferenceCounted* owner;
+};
+
+} // end namespace core
+} // end namespace irr
+
+#endif
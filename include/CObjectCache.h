@@ -87,6 +87,12 @@ template<
 >
 class CObjectCache<K, T, ContainerT_T, true> : public impl::CObjectCacheBase<ContainerT_T, std::pair<K, T*>>
 {
+    using Base = impl::CObjectCacheBase<ContainerT_T, std::pair<K, T*>>;
+    using typename Base::ContainerT;
+    using Base::m_container;
+    using Base::greet;
+    using Base::dispose;
+
     using ValueType = std::pair<K, T*>;
 
 public:
@@ -110,7 +116,7 @@ public:
 
 	inline T* getByKey(const K& _key)
     {
-        return const_cast<T*>(const_cast<std::remove_reference<decltype(*this)>::type const&>(*this).getByKey(_key));
+        return const_cast<T*>(const_cast<typename std::remove_reference<decltype(*this)>::type const&>(*this).getByKey(_key));
     }
 
 	inline const T* getByKey(const K& _key) const
@@ -149,6 +155,11 @@ template<
 >
 class CObjectCache<K, T, ContainerT_T, false> : public impl::CObjectCacheBase<ContainerT_T, T*, K>
 {
+    using Base = impl::CObjectCacheBase<ContainerT_T, T*, K>;
+    using Base::m_container;
+    using Base::greet;
+    using Base::dispose;
+
     static_assert(impl::is_same_templ<ContainerT_T, std::map>::value || impl::is_same_templ<ContainerT_T, std::unordered_map>::value, "ContainerT_T must be one of: std::vector, std::map, std::unordered_map");
 
 public:
@@ -159,13 +170,15 @@ public:
     {
         if (!_val)
             return false;
-        _val->grab();
-        return m_container.insert({_key, _val}).second;
+        if (!m_container.insert({_key, _val}).second)
+            return false;
+        greet(_val);
+        return true;
     }
 
 	inline T* getByKey(const K& _key)
     {
-		return const_cast<T*>(const_cast<std::remove_reference<decltype(*this)>::type const&>(*this).getByKey(_key));
+		return const_cast<T*>(const_cast<typename std::remove_reference<decltype(*this)>::type const&>(*this).getByKey(_key));
     }
 	inline const T* getByKey(const K& _key) const
     {
@@ -13,7 +13,7 @@
 #include "CConcurrentObjectCache.h"
 #include "IReadFile.h"
 #include "IWriteFile.h"
-#include "CGeometryCreator.h"
+#include "IMesh.h"
 
 #define USE_MAPS_FOR_PATH_BASED_CACHE //benchmark and choose, paths can be full system paths
 
@@ -77,7 +77,7 @@ class ICPUBuffer : public IBuffer
 		*/
         virtual void* getPointer() {return data;}
 
-    private:
+    protected:
         uint64_t size;
         void* data;
 };
@@ -67,6 +67,37 @@ public:
 	\return Returns a pointer to the created file on success, or 0 on failure. */
 	virtual IReadFile* createAndOpenFile(uint32_t index) =0;
 
+	//! Opens several files based on their positions in the file list.
+	/** Archives which decompress their contents may do it on multiple threads,
+	others simply open the files one after another.
+	\param indices Zero based indices of the files.
+	\param count Number of files to open.
+	\param outFiles Receives `count` pointers to the created files, 0 for each one that couldn't be opened.
+	\param threadCount Number of threads to use, 0 means as many as hardware supports.
+	\return Returns the number of files opened successfully. */
+	virtual uint32_t createAndOpenFiles(const uint32_t* indices, uint32_t count, IReadFile** outFiles, uint32_t threadCount=0)
+	{
+		uint32_t opened = 0;
+		for (uint32_t i=0; i<count; ++i)
+		{
+			outFiles[i] = createAndOpenFile(indices[i]);
+			if (outFiles[i])
+				++opened;
+		}
+		return opened;
+	}
+
+	//! Sets how much memory can be used to keep decompressed files for reopening.
+	/** Least recently opened files are dropped first. Archives which don't decompress ignore it.
+	\param maxBytes Memory budget in bytes, 0 (default) disables caching. */
+	virtual void setDecompressedCacheSize(size_t maxBytes) {}
+
+	//! Sets from which size files are decompressed as they're read instead of all at once when opened.
+	/** Streamed files take a bounded amount of memory whatever their size, but aren't cached and seeking within them
+	may need to decompress some data again. Archives which don't decompress ignore it.
+	\param minBytes Uncompressed size from which files are streamed, 0 streams all compressed files. */
+	virtual void setStreamingThreshold(size_t minBytes) {}
+
 	//! Returns the complete file tree
 	/** \return Returns the complete directory tree for the archive,
 	including all files and folders */
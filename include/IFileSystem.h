@@ -38,6 +38,16 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IReadFile* createAndOpenFile(const path& filename) =0;
 
+	//! Sets whether files opened from disk by createAndOpenFile() are memory-mapped instead of read through stdio.
+	/** Mapped files provide IReadFile::getMappedPointer(), so loaders and archive readers parse them in place
+	instead of copying them into their own buffers, and .baw buffers can alias file memory.
+	Files which fail to map are opened the usual way. Disabled by default.
+	\param enabled: True to map files opened from now on. */
+	virtual void setFileMappingEnabled(bool enabled) =0;
+
+	//! Returns whether files opened from disk are memory-mapped, see setFileMappingEnabled().
+	virtual bool isFileMappingEnabled() const =0;
+
 	//! Creates an IReadFile interface for accessing memory like a file.
 	/** This allows you to use a pointer to memory where an IReadFile is requested.
 	\param memory: A pointer to the start of the file in memory
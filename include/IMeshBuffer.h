@@ -16,6 +16,7 @@
 #include "IGPUBuffer.h"
 #include "SMaterial.h"
 #include "vectorSIMD.h"
+#include "vectorSIMDBatch.h"
 #include "coreutil.h"
 #include "CBAWFile.h"
 #include "assert.h"
@@ -1727,6 +1728,9 @@ GL_INVALID_OPERATION is generated by glVertexAttribPointer if size is GL_BGRA an
                 return;
             }
 
+            if (recalculateFloatBoundingBox())
+                return;
+
             for (size_t j=0; j<indexCount; j++)
             {
                 size_t ix;
@@ -1755,6 +1759,75 @@ GL_INVALID_OPERATION is generated by glVertexAttribPointer if size is GL_BGRA an
                     boundingBox.reset(getPosition(ix).getAsVector3df());
             }
 		}
+
+	private:
+		//! Fast path of recalculateBoundingBox() for float positions, gathers them four at a time.
+		/** @returns false without touching the box if positions aren't floats or some index is out of range, as getPosition() has to deal with those. */
+		inline bool recalculateFloatBoundingBox()
+		{
+		    const E_COMPONENTS_PER_ATTRIBUTE components = meshLayout->getAttribComponentCount(posAttrId);
+		    if (meshLayout->getAttribType(posAttrId)!=ECT_FLOAT || (components!=ECPA_THREE&&components!=ECPA_FOUR))
+                return false;
+
+            const uint8_t* positions = getAttribPointer(posAttrId);
+            if (!positions)
+                return false;
+
+            // vertices from `vertexLimit` on don't fit in the buffer whole
+            const core::ICPUBuffer* mappedAttrBuf = meshLayout->getMappedBuffer(posAttrId);
+            const size_t stride = meshLayout->getMappedBufferStride(posAttrId);
+            const size_t bytesLeft = reinterpret_cast<const uint8_t*>(mappedAttrBuf->getPointer())+mappedAttrBuf->getSize()-positions;
+            size_t vertexLimit = 0;
+            if (bytesLeft>=3*sizeof(float))
+                vertexLimit = stride ? (bytesLeft-3*sizeof(float))/stride+1:~size_t(0);
+
+            const void* indices = getIndices();
+            if (!indices)
+                return indexCount<=vertexLimit && recalculateFloatBoundingBox<uint32_t>(positions,stride,NULL);
+
+            switch (indexType)
+            {
+                case video::EIT_32BIT:
+                    return maxIndex(reinterpret_cast<const uint32_t*>(indices))<vertexLimit && recalculateFloatBoundingBox(positions,stride,reinterpret_cast<const uint32_t*>(indices));
+                case video::EIT_16BIT:
+                    return maxIndex(reinterpret_cast<const uint16_t*>(indices))<vertexLimit && recalculateFloatBoundingBox(positions,stride,reinterpret_cast<const uint16_t*>(indices));
+                default:
+                    return false;
+            }
+		}
+
+		template<typename IndexT>
+		inline bool recalculateFloatBoundingBox(const uint8_t* positions, size_t stride, const IndexT* indices)
+		{
+		    if (!indexCount)
+                return true;
+
+		    core::vector3dfSIMDBatch minPt, maxPt;
+            for (size_t j=0; j<indexCount; j+=core::vector3dfSIMDBatch::BATCH_SIZE)
+            {
+                const uint32_t count = std::min<uint64_t>(indexCount-j,core::vector3dfSIMDBatch::BATCH_SIZE);
+                const core::vector3dfSIMDBatch batch = indices ? core::vector3dfSIMDBatch::loadIndexed(positions,stride,indices+j,count):core::vector3dfSIMDBatch::loadStrided(positions+j*stride,stride,count);
+                if (j)
+                {
+                    minPt = core::min_(minPt,batch);
+                    maxPt = core::max_(maxPt,batch);
+                }
+                else
+                    minPt = maxPt = batch;
+            }
+            boundingBox.MinEdge = core::reduceMin(minPt).getAsVector3df();
+            boundingBox.MaxEdge = core::reduceMax(maxPt).getAsVector3df();
+            return true;
+		}
+
+		template<typename IndexT>
+		inline size_t maxIndex(const IndexT* indices) const
+		{
+		    IndexT retval = 0;
+            for (size_t j=0; j<indexCount; j++)
+                retval = std::max(retval,indices[j]);
+            return retval;
+		}
 	};
 
 	class IGPUMeshBuffer : public IMeshBuffer<video::IGPUBuffer>
@@ -35,6 +35,8 @@ public:
 
     typedef scene::IMeshDataFormatDesc<video::IGPUBuffer>* (*VaoSetupOverrideFunc)(ISceneManager*,video::IGPUBuffer*,const size_t&,const scene::IMeshDataFormatDesc<video::IGPUBuffer>*, void* userData);
     typedef void (*CPUCullingFunc)(uint8_t**,const size_t&,const core::aabbox3df&,const size_t&,const core::matrix4x3&,const uint8_t*,const size_t&,scene::ISceneManager*,void*);
+    //! Writes `dataSizePerInstanceOutput` bytes of output for one visible instance, arguments are the output, the instance's input data, its LoD, the node's absolute transformation, the scene manager and user data
+    typedef void (*CPUCullingOutputFunc)(uint8_t*,const uint8_t*,const uint32_t&,const core::matrix4x3&,scene::ISceneManager*,void*);
 
 	//! Constructor
 	/** Use setMesh() to set the mesh to display.
@@ -73,6 +75,18 @@ public:
 	    cpuCullingUserData = data;
 	}
 
+	//! Culls on the CPU with CInstanceCuller when setLoDMeshes() wasn't given a CPUCullingFunc, off by default.
+	/** Like a CPUCullingFunc it's used below getGPUCullingThreshold() instances. Instances outside the view frustum or beyond the last
+	LoD distance are culled and the rest go to the LoD their bounding box center's distance from the camera falls in.
+	The same vertex shader draws instances culled on the GPU and the CPU, so `outputFunc` has to write each visible instance's
+	output in the layout the "lodSelectionShader" writes it. It gets the user data from setUserCPUCullingData().
+	\param outputFunc Writer of a visible instance's output, NULL turns the built-in culling off.
+	\param threadCount Number of threads to cull with, 0 means as many as the hardware has. */
+	virtual void setBuiltinCPUCulling(CPUCullingOutputFunc outputFunc, uint32_t threadCount=0) = 0;
+
+	//! Returns whether setBuiltinCPUCulling() turned the built-in CPU culling on
+	virtual bool isBuiltinCPUCullingEnabled() const = 0;
+
 	virtual const size_t& getInstanceCount() const = 0;
 
 	virtual const core::aabbox3df& getLoDInvariantBBox() const = 0;
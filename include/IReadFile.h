@@ -42,11 +42,20 @@ namespace io
 		//! Get name of file.
 		/** \return File name as zero terminated character string. */
 		virtual const io::path& getFileName() const = 0;
+
+		//! Get contiguous view of the whole file, if it resides in memory.
+		/** Memory-mapped files, memory files and limited views of either return a pointer loaders can parse in place
+		instead of reading a copy of the contents. It stays valid as long as the file object is alive and must not be written through.
+		Position in the file is unaffected.
+		\return Pointer to the first byte of the file or 0 if contents aren't available in memory. */
+		virtual const void* getMappedPointer() const {return 0;}
 	};
 
 	//! Internal function, please do not use.
 	IReadFile* createReadFile(const io::path& fileName);
 	//! Internal function, please do not use.
+	IReadFile* createMappedReadFile(const io::path& fileName);
+	//! Internal function, please do not use.
 	IReadFile* createLimitReadFile(const io::path& fileName, IReadFile* alreadyOpenedFile, const size_t& pos, const size_t& areaSize);
 	//! Internal function, please do not use.
 	IReadFile* createMemoryReadFile(const void* memory, const size_t& size, const io::path& fileName, bool deleteMemoryWhenDropped);
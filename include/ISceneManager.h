@@ -20,6 +20,7 @@
 #include "IMeshCache.h"
 #include "ISkinnedMesh.h"
 #include "ISkinnedMeshSceneNode.h"
+#include <future>
 
 namespace irr
 {
@@ -273,6 +274,26 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual ICPUMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Loads a mesh on a thread of the mesh loading pool, so the calling thread doesn't wait for it.
+		/** All requests for a file made while it's loading share the same load and get the same future,
+		and getMesh(const io::path&) of the same file waits for the load instead of starting its own.
+		Loaded meshes are added to the mesh cache by the next call of getMesh(), getMeshAsync() or getMeshCache(),
+		so like meshes loaded by getMesh() they stay until IMeshCache::removeMesh() and requesting them again returns a ready future.
+		Call it from the thread which uses the mesh cache, only the loading happens on other threads.
+		Loaders are serialized one by one, so different formats load in parallel while each loader only ever loads one file
+		at a time. Loaders which get textures from the video driver (e.g. .obj and .x with materials) do so on the loading
+		thread though, which is only safe with drivers that can create textures on any thread. External loaders should be
+		added before the first call.
+		\param filename Filename of the mesh to load.
+		\return Future of the mesh, which gets null if loading failed. The mesh should not be dropped. */
+		virtual std::shared_future<ICPUMesh*> getMeshAsync(const io::path& filename) = 0;
+
+		//! Sets number of threads getMeshAsync() loads meshes on, 0 means as many as the hardware has.
+		virtual void setMeshLoadingThreadCount(uint32_t count) = 0;
+
+		//! Returns number of threads set with setMeshLoadingThreadCount().
+		virtual uint32_t getMeshLoadingThreadCount() const = 0;
+
 		//! Get interface to the mesh cache which is shared beween all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
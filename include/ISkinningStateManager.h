@@ -191,6 +191,12 @@ namespace scene
                         }
                     }
 
+                    //! Manager the bone belongs to
+                    inline ISkinningStateManager* getOwner() const {return ownerManager;}
+
+                    //! ID of the instance the bone belongs to
+                    inline const uint32_t& getInstanceID() const {return InstanceID;}
+
                     inline bool getTransformChangedBoningHint() const {return lastTimePulledAbsoluteTFormForBoning<lastTimeRelativeTransRead[3];}
 
                     inline void setTransformChangedBoningHint() {lastTimePulledAbsoluteTFormForBoning = lastTimeRelativeTransRead[3];}
@@ -206,7 +212,7 @@ namespace scene
             //! Constructor
             ISkinningStateManager(const E_BONE_UPDATE_MODE& boneControl, video::IVideoDriver* driver, const CFinalBoneHierarchy* sourceHierarchy)
                     : usingGPUorCPUBoning(-100), boneControlMode(boneControl), referenceHierarchy(sourceHierarchy), instanceData(NULL), instanceDataSize(0),
-                    firstDirtyInstance(0xdeadbeefu), lastDirtyInstance(0), firstDirtyBone(0xdeadbeefu), lastDirtyBone(0)
+                    firstDirtyInstance(0xdeadbeefu), lastDirtyInstance(0), firstDirtyBone(0xdeadbeefu), lastDirtyBone(0), boningThreadCount(1u)
             {
                 referenceHierarchy->grab();
 
@@ -229,6 +235,13 @@ namespace scene
 
             virtual void performBoning() = 0;
 
+            //! Sets number of threads performBoning() may split instances across.
+            /** Every thread bones a contiguous range of instances, small instance counts are boned on the calling thread regardless.
+            Worker threads are started on first use and kept until the manager is destroyed.
+            @param threadCount Max number of threads (including calling one), 1 (default) means serial boning, 0 means as many as hardware supports.*/
+            inline void setBoningThreadCount(const uint32_t& threadCount) {boningThreadCount = threadCount;}
+            inline const uint32_t& getBoningThreadCount() const {return boningThreadCount;}
+
 
             virtual void createBones(const size_t& instanceID) = 0;
 
@@ -351,6 +364,7 @@ namespace scene
             video::IMetaGranularGPUMappedBuffer* finalBoneDataInstanceBuffer;
             uint32_t firstDirtyBone,lastDirtyBone;
             uint32_t firstDirtyInstance,lastDirtyInstance;
+            uint32_t boningThreadCount;
 
             size_t actualSizeOfInstanceDataElement;
             class BoneHierarchyInstanceData
@@ -0,0 +1,57 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __I_STREAMING_MESH_LOADER_H_INCLUDED__
+#define __I_STREAMING_MESH_LOADER_H_INCLUDED__
+
+#include <functional>
+#include "IMeshLoader.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Limits of out-of-core mesh import, see IStreamingMeshLoader.
+struct SStreamingMeshImportParams
+{
+	//! Size in bytes of a single read from the file.
+	size_t ReadWindowSize = 0x1u<<20;
+	//! Upper bound on memory taken by geometry waiting in not yet emitted clusters.
+	/** Whenever it's exceeded, the biggest cluster is emitted early (so a spatial cluster may end up split into several buffers).*/
+	size_t MaxResidentBytes = 0x1u<<26;
+	//! Max number of vertices in a single emitted mesh buffer.
+	uint32_t MaxVerticesPerBuffer = 0x1u<<16;
+	//! Number of clusters along each axis of the grid laid over the file's bounding box.
+	uint32_t GridResolution = 8u;
+};
+
+//! Extension of IMeshLoader for files which don't fit into memory.
+/** Instead of one ICPUMesh, the file is read through a bounded window and its geometry is binned into a uniform grid of spatial clusters.
+Each cluster is handed over as a separate ICPUMeshBuffer as soon as it's full, so peak memory depends only on SStreamingMeshImportParams
+and not on the input size. Buffers can be forwarded to a renderer, spatial structure or written out (e.g. one .baw per cluster) right away.
+Loaders implementing it can be found with dynamic_cast on ISceneManager::getMeshLoader().
+*/
+class IStreamingMeshLoader
+{
+public:
+	//! Receives every finished mesh buffer along with the index of the grid cell it comes from.
+	/** The buffer is dropped after the call returns, so grab() it to keep it. Returning false aborts the import.*/
+	typedef std::function<bool(ICPUMeshBuffer*, uint32_t)> MeshBufferCallback;
+
+	virtual ~IStreamingMeshLoader() {}
+
+	//! Streams the file's geometry into spatially clustered mesh buffers.
+	/** @param file File to read, its read position is undefined afterwards.
+	@param _callback Called for each mesh buffer, possibly several times for the same cluster.
+	@param _params Memory limits and clustering granularity.
+	@returns false if the file couldn't be parsed or the callback aborted the import.*/
+	virtual bool streamMesh(io::IReadFile* file, const MeshBufferCallback& _callback, const SStreamingMeshImportParams& _params = SStreamingMeshImportParams()) = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
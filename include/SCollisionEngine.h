@@ -4,22 +4,44 @@
 #include "irrlicht.h"
 #include "SCompoundCollider.h"
 #include "SViewFrustum.h"
+#include "SDynamicAABBTree.h"
+#include <unordered_map>
 
 namespace irr
 {
 namespace core
 {
 
+//! Collision world, keeps colliders in a dynamic AABB tree so that queries only visit colliders near the ray or volume.
+/** The tree stores world space bounds of colliders, which are computed when a collider gets added and refreshed by
+updateCompoundCollider() or updateColliders(). Colliders attached to moving scene nodes have to be updated
+after the nodes move (i.e. after ISceneManager::drawAll() or after updating absolute positions), otherwise queries
+may skip them.
+*/
 class SCollisionEngine
 {
-        array<SCompoundCollider*> colliders;
+        struct SBroadphaseEntry
+        {
+            SBroadphaseEntry() : collider(NULL) {}
+            SBroadphaseEntry(SCompoundCollider* _collider, const aabbox3df& _worldBox) : collider(_collider), worldBox(_worldBox) {}
+
+            SCompoundCollider* collider;
+            aabbox3df worldBox; //! tight bounds, tree only knows the fattened ones
+        };
+
+        SDynamicAABBTree<SBroadphaseEntry> broadphase;
+        std::unordered_map<SCompoundCollider*,int32_t> proxies;
 
     public:
+		//! Constructor.
+		/** @param fatMargin Fraction of collider's size by which it may move before it needs to be reinserted into the tree, see SDynamicAABBTree. */
+        SCollisionEngine(const float& fatMargin=0.1f) : broadphase(fatMargin) {}
+
 		//! Destructor.
         ~SCollisionEngine()
         {
-			for (size_t i=0; i<colliders.size(); i++)
-				colliders[i]->drop();
+            for (auto it=proxies.begin(); it!=proxies.end(); it++)
+                it->first->drop();
         }
 
 		//! Returns a 3d ray which would go through the 2d screen coodinates.
@@ -102,37 +124,107 @@ class SCollisionEngine
 		}
 
 		//! Adds a collider
-		/** @param collider A pointer to collider. */
+		/** Its world bounds are computed from current absolute transformation of the attached node.
+		@param collider A pointer to collider. */
         inline void addCompoundCollider(SCompoundCollider* collider)
         {
-            if (!collider)
+            if (!collider||proxies.find(collider)!=proxies.end())
                 return;
 
             collider->grab();
-            colliders.push_back(collider);
+            const aabbox3df worldBox = collider->getWorldBoundingBox();
+            proxies[collider] = broadphase.createProxy(worldBox,SBroadphaseEntry(collider,worldBox));
         }
 
 		//! Removes collider pointed by `collider`
 		/** @param collider Pointer to collider. s*/
         inline void removeCompoundCollider(SCompoundCollider* collider)
         {
-            if (!collider)
-                return;
-
-            int32_t ix = colliders.binary_search(collider);
-            if (ix<0)
+            auto found = proxies.find(collider);
+            if (found==proxies.end())
 			{
 //				FW_WriteToLog(kLogError,"removeCompoundCollider collider not found!\n");
                 return;
 			}
 
+            broadphase.destroyProxy(found->second);
+            proxies.erase(found);
 			collider->drop();
-            colliders.erase(ix);
+        }
+
+		//! Recomputes world bounds of the collider after its attached node (or instance) moved.
+		/** Cheap if the collider didn't leave its fattened bounds, otherwise it gets reinserted into the tree.
+		@param collider Pointer to collider, must have been added to this engine.
+		@returns Whether collider was found. */
+        inline bool updateCompoundCollider(SCompoundCollider* collider)
+        {
+            auto found = proxies.find(collider);
+            if (found==proxies.end())
+                return false;
+
+            updateProxy(found->second);
+            return true;
+        }
+
+		//! Recomputes world bounds of all colliders, call once per tick after moving the scene nodes.
+        inline void updateColliders()
+        {
+            for (auto it=proxies.begin(); it!=proxies.end(); it++)
+                updateProxy(it->second);
         }
 
 		//! Gets current amount of colliders
 		/** @rturns Current amount of colliders. */
-        inline size_t getColliderCount() const { return colliders.size(); }
+        inline size_t getColliderCount() const { return proxies.size(); }
+
+		//! Gets colliders whose world space bounding boxes intersect a box.
+		/**
+		@param[out] outColliders Array to which colliders get appended.
+		@param[in] box Box in world space.
+		@returns Number of colliders found.
+		*/
+        inline size_t getCollidersIntersectingBox(array<SCompoundCollider*>& outColliders, const aabbox3df& box) const
+        {
+            const size_t prevSize = outColliders.size();
+            broadphase.queryBox(box,[&](const int32_t& proxy) -> bool
+                {
+                    const SBroadphaseEntry& entry = broadphase.getUserData(proxy);
+                    if (entry.worldBox.intersectsWithBox(box))
+                        outColliders.push_back(entry.collider);
+                    return true;
+                });
+            return outColliders.size()-prevSize;
+        }
+
+		//! Gets colliders whose world space bounding boxes intersect an axis aligned ellipsoid.
+		/**
+		@param[out] outColliders Array to which colliders get appended.
+		@param[in] centr Center of the ellipsoid in world space.
+		@param[in] axisLengths Lengths of the ellipsoid's semi-axes along X, Y and Z.
+		@returns Number of colliders found.
+		*/
+        inline size_t getCollidersIntersectingEllipsoid(array<SCompoundCollider*>& outColliders, const vectorSIMDf& centr, const vectorSIMDf& axisLengths) const
+        {
+            const vectorSIMDf invAxisLengths = vectorSIMDf(1.f)/axisLengths;
+            const size_t prevSize = outColliders.size();
+            broadphase.queryBox(aabbox3df((centr-axisLengths).getAsVector3df(),(centr+axisLengths).getAsVector3df()),[&](const int32_t& proxy) -> bool
+                {
+                    const SBroadphaseEntry& entry = broadphase.getUserData(proxy);
+                    // closest point of the box to the center, in space where ellipsoid is a unit sphere
+                    vectorSIMDf closest;
+                    closest.set(entry.worldBox.MinEdge);
+                    closest = max_(closest,centr);
+                    vectorSIMDf maxEdge;
+                    maxEdge.set(entry.worldBox.MaxEdge);
+                    closest = min_(closest,maxEdge);
+                    closest = (closest-centr)*invAxisLengths;
+                    closest.W = 0.f;
+                    if (dot(closest,closest).X<=1.f)
+                        outColliders.push_back(entry.collider);
+                    return true;
+                });
+            return outColliders.size()-prevSize;
+        }
 
 		//! Performs collision test with a given ray defined by `origin`, `direction` and `maxRayLen` parameters
 		/**
@@ -147,18 +239,84 @@ class SCollisionEngine
             bool retval = false;
 
             collisionDistance = maxRayLen;
-            for (size_t i=0; i<colliders.size(); i++)
+            broadphase.queryRay(origin,direction,maxRayLen,[&](const int32_t& proxy, const float& maxDist) -> float
+                {
+                    const SCompoundCollider* collider = broadphase.getUserData(proxy).collider;
+                    float tmpDist;
+                    if (collider->CollideWithRay(tmpDist,origin,direction,maxDist)&&tmpDist<maxDist)
+                    {
+                        collisionDistance = tmpDist;
+                        hitPointObjectData = collider->getColliderData();
+                        retval = true;
+                        return tmpDist;
+                    }
+                    return maxDist;
+                });
+
+            return retval;
+        }
+
+		//! Batched version of FastCollide(), casting rays in SIMD packets of 4.
+		/** Every packet is tested against colliders together, so coherent rays (i.e. originating from one point in similar directions) benefit the most.
+		Inputs and outputs are in SoA layout.
+		@param[out] hitPointObjectData Array of `rayCount` collider data, entries of rays which didn't hit anything don't get touched.
+		@param[out] collisionDistances Array of `rayCount` distances, `maxRayLen` for rays which didn't hit anything.
+		@param[in] originX X coordinates of origins of the rays, analogously `originY` and `originZ`.
+		@param[in] dirX X coordinates of normalized directions of the rays, analogously `dirY` and `dirZ`.
+		@param[in] rayCount Number of rays.
+		@param[in] maxRayLen Length of the rays.
+		@returns Number of rays which hit any collider.
+		*/
+        inline uint32_t FastCollideBatch(SColliderData* hitPointObjectData, float* collisionDistances,
+                                        const float* originX, const float* originY, const float* originZ,
+                                        const float* dirX, const float* dirY, const float* dirZ,
+                                        uint32_t rayCount, const float& maxRayLen=FLT_MAX) const
+        {
+            uint32_t hitCount = 0u;
+            for (uint32_t first=0u; first<rayCount; first+=4u)
             {
-                float tmpDist;
-                if (colliders[i]->CollideWithRay(tmpDist,origin,direction,collisionDistance)&&tmpDist<collisionDistance)
+                const uint32_t laneCount = std::min(rayCount-first,4u);
+                const int activeMask = (1<<laneCount)-1;
+
+                vectorSIMDf origin[3], direction[3];
+                vectorSIMDf distances(maxRayLen);
+                for (uint32_t lane=0u; lane<4u; lane++)
+                {
+                    const uint32_t ix = first+std::min(lane,laneCount-1u); // inactive lanes get copy of last ray
+                    origin[0].pointer[lane] = originX[ix];
+                    origin[1].pointer[lane] = originY[ix];
+                    origin[2].pointer[lane] = originZ[ix];
+                    direction[0].pointer[lane] = dirX[ix];
+                    direction[1].pointer[lane] = dirY[ix];
+                    direction[2].pointer[lane] = dirZ[ix];
+                }
+
+                int packetHits = 0;
+                broadphase.queryRayPacket(distances,origin,direction,activeMask,[&](const int32_t& proxy, const int& mask)
+                    {
+                        const SCompoundCollider* collider = broadphase.getUserData(proxy).collider;
+                        const int hits = collider->CollideWithRayPacket(distances,origin,direction,mask);
+                        for (uint32_t lane=0u; lane<laneCount; lane++)
+                        if (hits&(1<<lane))
+                            hitPointObjectData[first+lane] = collider->getColliderData();
+                        packetHits |= hits;
+                    });
+
+                for (uint32_t lane=0u; lane<laneCount; lane++)
                 {
-                    collisionDistance = tmpDist;
-                    hitPointObjectData = colliders[i]->getColliderData();
-                    retval = true;
+                    collisionDistances[first+lane] = distances.pointer[lane];
+                    hitCount += (packetHits>>lane)&1;
                 }
             }
+            return hitCount;
+        }
 
-            return retval;
+    private:
+        inline void updateProxy(const int32_t& proxy)
+        {
+            SBroadphaseEntry& entry = broadphase.getUserData(proxy);
+            entry.worldBox = entry.collider->getWorldBoundingBox();
+            broadphase.moveProxy(proxy,entry.worldBox);
         }
 };
 
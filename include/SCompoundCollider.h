@@ -211,10 +211,134 @@ class SCompoundCollider : public IReferenceCounted
             return false;
         }
 
+		//! Performs collision test with packet of 4 rays.
+		/** Box culling and triangle mesh hierarchy traversal are done for all rays at once with SSE, other shapes are tested ray by ray.
+		Unlike CollideWithRay(), which returns the first hit shape, the closest hit among all shapes is found for every ray.
+		@param[in,out] collisionDistances Per-ray max distance on input, updated for rays which hit the collider closer than that.
+		@param[in] origin Origins of the rays in SoA layout (X, Y and Z of all four rays).
+		@param[in] direction Normalized directions of the rays in SoA layout.
+		@param[in] activeMask Bitmask of rays to test, bit `i` corresponds to i-th ray.
+		@returns Bitmask of rays for which `collisionDistances` got updated.
+		*/
+        inline int CollideWithRayPacket(vectorSIMDf& collisionDistances, const vectorSIMDf origin[3], const vectorSIMDf direction[3], int activeMask) const
+        {
+            vectorSIMDf o[3] = {origin[0],origin[1],origin[2]};
+            vectorSIMDf dir[3] = {direction[0],direction[1],direction[2]};
+            if (colliderData.attachedNode)
+            {
+                // transforms are computed once per packet, rays get transformed one by one
+                matrix4x3 absoluteTransform = colliderData.attachedNode->getAbsoluteTransformation();
+                if (!absoluteTransform.makeInverse())
+                    return 0;
+                const bool instanced = colliderData.attachedNode->getType()==scene::ESNT_MESH_INSTANCED;
+                matrix4x3 instanceTform;
+                if (instanced)
+                {
+                    instanceTform = static_cast<scene::IMeshSceneNodeInstanced*>(colliderData.attachedNode)->getInstanceTransform(colliderData.instanceID);
+                    if (!instanceTform.makeInverse())
+                        return 0;
+                }
+
+                for (size_t i=0; i<4; i++)
+                {
+                    vectorSIMDf rayO(o[0].pointer[i],o[1].pointer[i],o[2].pointer[i]);
+                    vectorSIMDf rayD(dir[0].pointer[i],dir[1].pointer[i],dir[2].pointer[i]);
+                    absoluteTransform.transformVect(rayO.pointer,rayO.pointer);
+                    absoluteTransform.mulSub3x3With3x1(rayD.pointer,rayD.pointer);
+                    if (instanced)
+                    {
+                        instanceTform.transformVect(rayO.pointer,rayO.pointer);
+                        instanceTform.mulSub3x3With3x1(rayD.pointer,rayD.pointer);
+                    }
+                    for (size_t j=0; j<3; j++)
+                    {
+                        o[j].pointer[i] = rayO.pointer[j];
+                        dir[j].pointer[i] = rayD.pointer[j];
+                    }
+                }
+            }
+
+            // packet vs bounding box
+            {
+                __m128 tNear = _mm_setzero_ps();
+                __m128 tFar = collisionDistances.getAsRegister();
+                const float* const minEdge = &BBox.Box.MinEdge.X;
+                const float* const maxEdge = &BBox.Box.MaxEdge.X;
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (size_t j=0; j<3; j++)
+                {
+                    const __m128 invDir = _mm_max_ps(_mm_min_ps(_mm_div_ps(_mm_set1_ps(1.f),dir[j].getAsRegister()),_mm_set1_ps(1e30f)),_mm_set1_ps(-1e30f));
+                    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(minEdge[j]),o[j].getAsRegister()),invDir);
+                    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(maxEdge[j]),o[j].getAsRegister()),invDir);
+                    tNear = _mm_max_ps(tNear,_mm_min_ps(t0,t1));
+                    tFar = _mm_min_ps(tFar,_mm_max_ps(t0,t1));
+                    inside = _mm_and_ps(inside,_mm_and_ps(_mm_cmpge_ps(o[j].getAsRegister(),_mm_set1_ps(minEdge[j])),_mm_cmple_ps(o[j].getAsRegister(),_mm_set1_ps(maxEdge[j]))));
+                }
+                activeMask &= _mm_movemask_ps(_mm_or_ps(inside,_mm_cmple_ps(tNear,tFar)));
+                if (!activeMask)
+                    return 0;
+            }
+
+            int hitMask = 0;
+            for (size_t i=0; i<Shapes.size(); i++)
+            {
+                if (Shapes[i].objectType==SCollisionShapeDef::ECST_TRIANGLE_MESH)
+                {
+                    hitMask |= static_cast<STriangleMeshCollider*>(Shapes[i].object)->CollideWithRayPacket(collisionDistances,o,dir,activeMask);
+                    continue;
+                }
+
+                for (size_t lane=0; lane<4; lane++)
+                {
+                    if (!(activeMask&(1<<lane)))
+                        continue;
+
+                    const vectorSIMDf rayO(o[0].pointer[lane],o[1].pointer[lane],o[2].pointer[lane]);
+                    const vectorSIMDf rayD(dir[0].pointer[lane],dir[1].pointer[lane],dir[2].pointer[lane]);
+                    float& maxDist = collisionDistances.pointer[lane];
+                    float dist;
+                    bool hit = false;
+                    switch (Shapes[i].objectType)
+                    {
+                        case SCollisionShapeDef::ECST_AABOX:
+                            hit = static_cast<SAABoxCollider*>(Shapes[i].object)->CollideWithRay(dist,rayO,rayD,maxDist,reciprocal(rayD));
+                            break;
+                        case SCollisionShapeDef::ECST_ELLIPSOID:
+                            hit = static_cast<SEllipsoidCollider*>(Shapes[i].object)->CollideWithRay(dist,rayO,rayD,maxDist);
+                            break;
+                        case SCollisionShapeDef::ECST_TRIANGLE:
+                            hit = static_cast<STriangleCollider*>(Shapes[i].object)->CollideWithRay(dist,rayO,rayD,maxDist);
+                            break;
+                        default:
+                            break;
+                    }
+                    if (hit&&dist<maxDist)
+                    {
+                        maxDist = dist;
+                        hitMask |= 1<<lane;
+                    }
+                }
+            }
+            return hitMask;
+        }
+
 		inline const size_t getShapeCount() const { return Shapes.size(); }
 		inline const SAABoxCollider& getBoundingBox() const { return BBox; }
         inline const SColliderData& getColliderData() const {return colliderData;}
 
+		//! @returns Bounding box transformed by current transforms of the attached node and instance (if any).
+        inline aabbox3df getWorldBoundingBox() const
+        {
+            aabbox3df box = BBox.Box;
+            if (colliderData.attachedNode)
+            {
+                if (colliderData.attachedNode->getType()==scene::ESNT_MESH_INSTANCED)
+                    static_cast<scene::IMeshSceneNodeInstanced*>(colliderData.attachedNode)->getInstanceTransform(colliderData.instanceID).transformBoxEx(box);
+                colliderData.attachedNode->getAbsoluteTransformation().transformBoxEx(box);
+            }
+            return box;
+        }
+
 		//! Sets collider data.
 		/** @param data The collider data.
 		*/
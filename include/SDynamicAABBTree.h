@@ -0,0 +1,434 @@
+#ifndef __S_DYNAMIC_AABB_TREE_H_INCLUDED__
+#define __S_DYNAMIC_AABB_TREE_H_INCLUDED__
+
+#include "vectorSIMD.h"
+#include "aabbox3d.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace core
+{
+
+//! Dynamic bounding volume hierarchy of axis aligned boxes, meant as a broadphase for objects which get added, removed and moved at runtime.
+/** Every object is represented by a proxy (leaf node) storing user data and a box fattened by a fraction of the object's size,
+so that small movements don't require any tree modification. Leaves are inserted next to the sibling giving the smallest
+surface area increase and the tree is kept height-balanced with rotations, similar to the dynamic trees of popular physics engines.
+Proxy IDs stay valid until destroyProxy() gets called on them.
+*/
+template<typename T>
+class SDynamicAABBTree
+{
+    public:
+        enum E_TREE_CONSTANTS
+        {
+            NULL_NODE = -1,
+            MAX_STACK_SIZE = 128 //! tree is balanced, so it's never even close to that deep
+        };
+
+		//! Constructor.
+		/** @param fatMargin Fraction of the object's longest box extent by which the stored box gets enlarged in every direction.*/
+        SDynamicAABBTree(const float& fatMargin=0.1f) : root(NULL_NODE), freeList(NULL_NODE), proxyCount(0u), margin(fatMargin) {}
+
+		//! Creates a proxy for an object.
+		/**
+		@param box Bounding box of the object.
+		@param userData Data returned to query callbacks.
+		@returns ID of the proxy.
+		*/
+        inline int32_t createProxy(const aabbox3df& box, const T& userData)
+        {
+            const int32_t proxy = allocateNode();
+            nodes[proxy].box = fatten(box);
+            nodes[proxy].userData = userData;
+            nodes[proxy].height = 0;
+            insertLeaf(proxy);
+            proxyCount++;
+            return proxy;
+        }
+
+		//! Removes proxy from the tree.
+        inline void destroyProxy(const int32_t& proxy)
+        {
+            removeLeaf(proxy);
+            freeNode(proxy);
+            proxyCount--;
+        }
+
+		//! Updates bounding box of the object.
+		/** @returns Whether the new box escaped the fattened one and the proxy had to be reinserted. */
+        inline bool moveProxy(const int32_t& proxy, const aabbox3df& box)
+        {
+            if (box.isFullInside(nodes[proxy].box))
+                return false;
+
+            removeLeaf(proxy);
+            nodes[proxy].box = fatten(box);
+            insertLeaf(proxy);
+            return true;
+        }
+
+        inline T& getUserData(const int32_t& proxy) { return nodes[proxy].userData; }
+        inline const T& getUserData(const int32_t& proxy) const { return nodes[proxy].userData; }
+		//! @returns Fattened box stored for the proxy.
+        inline const aabbox3df& getFatBox(const int32_t& proxy) const { return nodes[proxy].box; }
+
+        inline uint32_t getProxyCount() const { return proxyCount; }
+        inline int32_t getHeight() const { return root==NULL_NODE ? 0:nodes[root].height; }
+
+		//! Calls `callback(proxy)` for every proxy whose fattened box intersects `box`, stops early when the callback returns false.
+        template<class F>
+        inline void queryBox(const aabbox3df& box, F callback) const
+        {
+            if (root==NULL_NODE)
+                return;
+
+            int32_t stack[MAX_STACK_SIZE];
+            uint32_t stackSize = 0u;
+            stack[stackSize++] = root;
+            while (stackSize)
+            {
+                const SNode& node = nodes[stack[--stackSize]];
+                if (!node.box.intersectsWithBox(box))
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    if (!callback(int32_t(&node-nodes.const_pointer())))
+                        return;
+                }
+                else
+                {
+                    stack[stackSize++] = node.child[0];
+                    stack[stackSize++] = node.child[1];
+                }
+            }
+        }
+
+		//! Calls `callback(proxy,maxDistance)` for every proxy whose fattened box is hit by the ray closer than `maxDistance`.
+		/** The callback returns new max distance, so after finding a hit it can shorten the ray to cull the rest of the tree,
+		returning a negative value terminates the query.
+		@param origin Start point of the ray.
+		@param direction Direction of the ray, distances are measured in its multiples.
+		@param maxDistance Length of the ray.
+		@param callback Called for leaves.
+		*/
+        template<class F>
+        inline void queryRay(const vectorSIMDf& origin, const vectorSIMDf& direction, float maxDistance, F callback) const
+        {
+            if (root==NULL_NODE)
+                return;
+
+            float invDir[3];
+            for (size_t j=0; j<3; j++)
+                invDir[j] = core::max_(core::min_(1.f/direction.pointer[j],1e30f),-1e30f);
+
+            int32_t stack[MAX_STACK_SIZE];
+            uint32_t stackSize = 0u;
+            stack[stackSize++] = root;
+            while (stackSize)
+            {
+                const SNode& node = nodes[stack[--stackSize]];
+
+                float tNear = 0.f;
+                float tFar = maxDistance;
+                const float* const minEdge = &node.box.MinEdge.X;
+                const float* const maxEdge = &node.box.MaxEdge.X;
+                for (size_t j=0; j<3; j++)
+                {
+                    const float t0 = (minEdge[j]-origin.pointer[j])*invDir[j];
+                    const float t1 = (maxEdge[j]-origin.pointer[j])*invDir[j];
+                    tNear = core::max_(tNear,core::min_(t0,t1));
+                    tFar = core::min_(tFar,core::max_(t0,t1));
+                }
+                if (tNear>tFar)
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    maxDistance = callback(int32_t(&node-nodes.const_pointer()),maxDistance);
+                    if (maxDistance<0.f)
+                        return;
+                }
+                else
+                {
+                    stack[stackSize++] = node.child[0];
+                    stack[stackSize++] = node.child[1];
+                }
+            }
+        }
+
+		//! Packet version of queryRay(), culls the tree for 4 rays at once with SSE.
+		/**
+		@param maxDistances Per-ray max distances, re-read after every callback so that the callback may shorten them through a reference.
+		@param origin Origins of the rays in SoA layout.
+		@param direction Directions of the rays in SoA layout.
+		@param activeMask Bitmask of rays to test.
+		@param callback Called as `callback(proxy,mask)` for leaves, where `mask` is the subset of `activeMask` hitting the leaf's fattened box.
+		*/
+        template<class F>
+        inline void queryRayPacket(const vectorSIMDf& maxDistances, const vectorSIMDf origin[3], const vectorSIMDf direction[3], int activeMask, F callback) const
+        {
+            if (root==NULL_NODE||!activeMask)
+                return;
+
+            __m128 invDir[3];
+            for (size_t j=0; j<3; j++)
+                invDir[j] = _mm_max_ps(_mm_min_ps(_mm_div_ps(_mm_set1_ps(1.f),direction[j].getAsRegister()),_mm_set1_ps(1e30f)),_mm_set1_ps(-1e30f));
+
+            int32_t stack[MAX_STACK_SIZE];
+            uint32_t stackSize = 0u;
+            stack[stackSize++] = root;
+            while (stackSize)
+            {
+                const SNode& node = nodes[stack[--stackSize]];
+
+                __m128 tNear = _mm_setzero_ps();
+                __m128 tFar = maxDistances.getAsRegister();
+                const float* const minEdge = &node.box.MinEdge.X;
+                const float* const maxEdge = &node.box.MaxEdge.X;
+                for (size_t j=0; j<3; j++)
+                {
+                    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(minEdge[j]),origin[j].getAsRegister()),invDir[j]);
+                    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(maxEdge[j]),origin[j].getAsRegister()),invDir[j]);
+                    tNear = _mm_max_ps(tNear,_mm_min_ps(t0,t1));
+                    tFar = _mm_min_ps(tFar,_mm_max_ps(t0,t1));
+                }
+                const int mask = activeMask&_mm_movemask_ps(_mm_cmple_ps(tNear,tFar));
+                if (!mask)
+                    continue;
+
+                if (node.isLeaf())
+                    callback(int32_t(&node-nodes.const_pointer()),mask);
+                else
+                {
+                    stack[stackSize++] = node.child[0];
+                    stack[stackSize++] = node.child[1];
+                }
+            }
+        }
+
+    private:
+        struct SNode
+        {
+            aabbox3df box;
+            T userData;
+            int32_t parent; //! next free node when the node is on free list
+            int32_t child[2];
+            int32_t height; //! leaves have 0, free nodes -1
+
+            inline bool isLeaf() const { return child[0]==NULL_NODE; }
+        };
+
+        inline aabbox3df fatten(const aabbox3df& box) const
+        {
+            const vector3df extent = box.getExtent();
+            const float m = margin*core::max_(extent.X,extent.Y,extent.Z);
+            return aabbox3df(box.MinEdge-vector3df(m),box.MaxEdge+vector3df(m));
+        }
+
+        static inline aabbox3df merge(const aabbox3df& a, const aabbox3df& b)
+        {
+            aabbox3df retval(a);
+            retval.addInternalBox(b);
+            return retval;
+        }
+
+        inline int32_t allocateNode()
+        {
+            int32_t ix;
+            if (freeList==NULL_NODE)
+            {
+                ix = nodes.size();
+                nodes.push_back(SNode());
+            }
+            else
+            {
+                ix = freeList;
+                freeList = nodes[ix].parent;
+            }
+            nodes[ix].parent = NULL_NODE;
+            nodes[ix].child[0] = NULL_NODE;
+            nodes[ix].child[1] = NULL_NODE;
+            nodes[ix].height = 0;
+            return ix;
+        }
+
+        inline void freeNode(const int32_t& ix)
+        {
+            nodes[ix].userData = T();
+            nodes[ix].parent = freeList;
+            nodes[ix].height = -1;
+            freeList = ix;
+        }
+
+        inline void insertLeaf(const int32_t& leaf)
+        {
+            if (root==NULL_NODE)
+            {
+                root = leaf;
+                nodes[root].parent = NULL_NODE;
+                return;
+            }
+
+            // descend to the sibling which minimizes surface area increase of the tree
+            const aabbox3df leafBox = nodes[leaf].box;
+            int32_t index = root;
+            while (!nodes[index].isLeaf())
+            {
+                const SNode& node = nodes[index];
+                const float area = node.box.getArea();
+                const float combinedArea = merge(node.box,leafBox).getArea();
+
+                // cost of creating new parent for this node and the new leaf
+                const float cost = 2.f*combinedArea;
+                // minimum cost of pushing the leaf further down the tree
+                const float inheritanceCost = 2.f*(combinedArea-area);
+
+                float childCost[2];
+                for (size_t i=0; i<2; i++)
+                {
+                    const SNode& child = nodes[node.child[i]];
+                    childCost[i] = merge(child.box,leafBox).getArea()+inheritanceCost;
+                    if (!child.isLeaf())
+                        childCost[i] -= child.box.getArea();
+                }
+
+                if (cost<childCost[0]&&cost<childCost[1])
+                    break;
+
+                index = node.child[childCost[0]<childCost[1] ? 0:1];
+            }
+
+            const int32_t sibling = index;
+            const int32_t oldParent = nodes[sibling].parent;
+            const int32_t newParent = allocateNode(); // can reallocate `nodes`
+            nodes[newParent].parent = oldParent;
+            nodes[newParent].box = merge(leafBox,nodes[sibling].box);
+            nodes[newParent].height = nodes[sibling].height+1;
+            nodes[newParent].child[0] = sibling;
+            nodes[newParent].child[1] = leaf;
+            nodes[sibling].parent = newParent;
+            nodes[leaf].parent = newParent;
+
+            if (oldParent!=NULL_NODE)
+                nodes[oldParent].child[nodes[oldParent].child[0]==sibling ? 0:1] = newParent;
+            else
+                root = newParent;
+
+            refitAncestors(nodes[leaf].parent);
+        }
+
+        inline void removeLeaf(const int32_t& leaf)
+        {
+            if (leaf==root)
+            {
+                root = NULL_NODE;
+                return;
+            }
+
+            const int32_t parent = nodes[leaf].parent;
+            const int32_t grandParent = nodes[parent].parent;
+            const int32_t sibling = nodes[parent].child[nodes[parent].child[0]==leaf ? 1:0];
+
+            if (grandParent!=NULL_NODE)
+            {
+                // sibling takes the place of the parent
+                nodes[grandParent].child[nodes[grandParent].child[0]==parent ? 0:1] = sibling;
+                nodes[sibling].parent = grandParent;
+                freeNode(parent);
+                refitAncestors(grandParent);
+            }
+            else
+            {
+                root = sibling;
+                nodes[sibling].parent = NULL_NODE;
+                freeNode(parent);
+            }
+        }
+
+		//! Walks up from `index` to the root rebalancing and recomputing boxes and heights.
+        inline void refitAncestors(int32_t index)
+        {
+            while (index!=NULL_NODE)
+            {
+                index = balance(index);
+
+                SNode& node = nodes[index];
+                const SNode& child0 = nodes[node.child[0]];
+                const SNode& child1 = nodes[node.child[1]];
+                node.height = 1+core::max_(child0.height,child1.height);
+                node.box = merge(child0.box,child1.box);
+
+                index = node.parent;
+            }
+        }
+
+		//! Performs left or right rotation if node `iA` is imbalanced.
+		/** @returns Index of the node which took place of `iA`. */
+        inline int32_t balance(const int32_t& iA)
+        {
+            SNode& A = nodes[iA];
+            if (A.isLeaf()||A.height<2)
+                return iA;
+
+            const int32_t iB = A.child[0];
+            const int32_t iC = A.child[1];
+            const int32_t heightDiff = nodes[iC].height-nodes[iB].height;
+            if (heightDiff>1) // rotate C up
+                return rotate(iA,1);
+            if (heightDiff<-1) // rotate B up
+                return rotate(iA,0);
+            return iA;
+        }
+
+		//! Swaps node `iA` with its child at `side`, the lower of the child's children becomes `iA`'s child.
+        inline int32_t rotate(const int32_t& iA, const size_t& side)
+        {
+            SNode& A = nodes[iA];
+            const int32_t iC = A.child[side];
+            const int32_t iOther = A.child[side^1u];
+            SNode& C = nodes[iC];
+            const int32_t iF = C.child[0];
+            const int32_t iG = C.child[1];
+            SNode& F = nodes[iF];
+            SNode& G = nodes[iG];
+
+            // C takes the place of A
+            C.child[0] = iA;
+            C.parent = A.parent;
+            A.parent = iC;
+            if (C.parent!=NULL_NODE)
+                nodes[C.parent].child[nodes[C.parent].child[0]==iA ? 0:1] = iC;
+            else
+                root = iC;
+
+            // taller of C's children stays with C, the other one goes to A
+            int32_t iKeep = iF, iGive = iG;
+            if (F.height<G.height)
+            {
+                iKeep = iG;
+                iGive = iF;
+            }
+            C.child[1] = iKeep;
+            A.child[side] = iGive;
+            nodes[iGive].parent = iA;
+
+            A.box = merge(nodes[iOther].box,nodes[iGive].box);
+            A.height = 1+core::max_(nodes[iOther].height,nodes[iGive].height);
+            C.box = merge(A.box,nodes[iKeep].box);
+            C.height = 1+core::max_(A.height,nodes[iKeep].height);
+            return iC;
+        }
+
+        array<SNode> nodes;
+        int32_t root;
+        int32_t freeList;
+        uint32_t proxyCount;
+        float margin;
+};
+
+}
+}
+
+#endif
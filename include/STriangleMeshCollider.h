@@ -1,6 +1,9 @@
 #ifndef __S_TRIANGLE_MESH_COLLIDER_H_INCLUDED__
 #define __S_TRIANGLE_MESH_COLLIDER_H_INCLUDED__
 
+#include <cfloat>
+#include <vector>
+#include <algorithm>
 #include "SAABoxCollider.h"
 #include "IReferenceCounted.h"
 
@@ -21,8 +24,10 @@ class STriangleCollider
                 validTriangle = false;
                 return;
             }
-            boundaryPlanes[0] = cross(normal,B-A);
-            boundaryPlanes[1] = cross(C-A,normal);
+            // boundary planes are scaled so that they give barycentric coordinates of C and B respectively
+            const vectorSIMDf normalLen2Rcp = vectorSIMDf(1.f)/dot(normal,normal);
+            boundaryPlanes[0] = cross(normal,B-A)*normalLen2Rcp;
+            boundaryPlanes[1] = cross(C-A,normal)*normalLen2Rcp;
 
             planeEq.W = dot(planeEq,A).X;
             boundaryPlanes[0].W = dot(boundaryPlanes[0],A).X;
@@ -30,24 +35,26 @@ class STriangleCollider
             validTriangle = true;
         }
 
+        //! W components of `origin` and `direction` are ignored
         inline bool CollideWithRay(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier) const
         {
-            float NdotD = dot(direction,planeEq).X;
-            if (NdotD!=0.f)
-                return false;
+            const vectorSIMDf xyzMask(_mm_castsi128_ps(_mm_set_epi32(0,-1,-1,-1)));
+            const vectorSIMDf o = origin&xyzMask;
+            const vectorSIMDf dir = direction&xyzMask;
 
-            float NdotOrigin = -dot(origin,planeEq).X;
-            float d = planeEq.W;
+            float NdotD = dot(dir,planeEq).X;
+            if (NdotD==0.f)
+                return false;
 
-            float t = (NdotOrigin-d)/NdotD;
+            float t = (planeEq.W-dot(o,planeEq).X)/NdotD;
             if (t>=dirMaxMultiplier||t<0.f)
                 return false;
 
-            vectorSIMDf outPoint = origin+direction*t;
+            vectorSIMDf outPoint = o+dir*t;
 
-            vectorSIMDf outPointW1 = outPoint|vectorSIMDf(0.f,0.f,0.f,1.f);
-
-            if (dot(outPointW1,boundaryPlanes[0]).X>=0.f&&dot(outPointW1,boundaryPlanes[1]).X>=0.f)
+            const float v = dot(outPoint,boundaryPlanes[0]).X-boundaryPlanes[0].W;
+            const float u = dot(outPoint,boundaryPlanes[1]).X-boundaryPlanes[1].W;
+            if (u>=0.f&&v>=0.f&&u+v<=1.f)
             {
                 collisionDistance = t;
                 return true;
@@ -65,10 +72,37 @@ class STriangleMeshCollider : public IReferenceCounted
 {
 	    _IRR_INTERFACE_CHILD(STriangleMeshCollider) {}
 
+        //! Node of flattened bounding volume hierarchy, 32 bytes so that two nodes share a cache line.
+        /** Nodes are stored in depth-first order, so left child of an interior node always directly follows it.*/
+        struct SBVHNode
+        {
+            float bboxMin[3];
+            //! Index of right child for interior nodes, index of first triangle for leaves
+            uint32_t rightChildOrFirstTriangle;
+            float bboxMax[3];
+            //! 0 for interior nodes
+            uint32_t triangleCount;
+        };
+        //! Triangle's bounds, used only while building the hierarchy
+        struct STriangleBounds
+        {
+            float bboxMin[3];
+            float bboxMax[3];
+            float centroid[3];
+        };
+
+        enum
+        {
+            BVH_MAX_LEAF_SIZE = 8,
+            BVH_SAH_BIN_COUNT = 16,
+            BVH_MAX_DEPTH = 64
+        };
+
         SAABoxCollider BBox;
         ///matrix4x3 cachedTransformInverse;
         ///matrix4x3 cachedTransform;
         array<STriangleCollider> triangles;
+        array<SBVHNode> nodes;
     public:
         STriangleMeshCollider() : BBox(core::aabbox3df()) {}
 
@@ -77,82 +111,457 @@ class STriangleMeshCollider : public IReferenceCounted
 
         inline size_t getTriangleCount() const {return triangles.size();}
 
+        inline size_t getBVHNodeCount() const {return nodes.size();}
+
+        //! Builds triangle colliders and bounding volume hierarchy over them (binned SAH).
         inline bool Init(float* vertices, const size_t &indexCount, uint32_t* indices=NULL)
         {
-            bool firstPoint = true;
-            if (indices)
+            triangles.clear();
+            nodes.clear();
+
+            std::vector<STriangleBounds> bounds;
+            bounds.reserve(indexCount/3);
+            for (size_t i=0; i+2<indexCount; i+=3)
             {
-                for (size_t i=0; i<indexCount; i+=3)
+                const size_t ix[3] = {indices ? indices[i+0]:(i+0), indices ? indices[i+1]:(i+1), indices ? indices[i+2]:(i+2)};
+                vectorSIMDf A(vertices[ix[0]*3+0],vertices[ix[0]*3+1],vertices[ix[0]*3+2]);
+                vectorSIMDf B(vertices[ix[1]*3+0],vertices[ix[1]*3+1],vertices[ix[1]*3+2]);
+                vectorSIMDf C(vertices[ix[2]*3+0],vertices[ix[2]*3+1],vertices[ix[2]*3+2]);
+
+                bool useful = false;
+                STriangleCollider triangle(A,B,C,useful);
+                if (useful)
                 {
-                    vectorSIMDf A(vertices[indices[i+0]*3+0],vertices[indices[i+0]*3+1],vertices[indices[i+0]*3+2]);
-                    vectorSIMDf B(vertices[indices[i+1]*3+0],vertices[indices[i+1]*3+1],vertices[indices[i+1]*3+2]);
-                    vectorSIMDf C(vertices[indices[i+2]*3+0],vertices[indices[i+2]*3+1],vertices[indices[i+2]*3+2]);
+                    if (!triangles.size())
+                        BBox.Box.reset(A.getAsVector3df());
+                    else
+                        BBox.Box.addInternalPoint(A.getAsVector3df());
+                    BBox.Box.addInternalPoint(B.getAsVector3df());
+                    BBox.Box.addInternalPoint(C.getAsVector3df());
+                    triangles.push_back(triangle);
+
+                    STriangleBounds b;
+                    for (size_t j=0; j<3; j++)
+                    {
+                        b.bboxMin[j] = std::min(std::min(A.pointer[j],B.pointer[j]),C.pointer[j]);
+                        b.bboxMax[j] = std::max(std::max(A.pointer[j],B.pointer[j]),C.pointer[j]);
+                        b.centroid[j] = (b.bboxMin[j]+b.bboxMax[j])*0.5f;
+                    }
+                    bounds.push_back(b);
+                }
+            }
+
+            if (triangles.size())
+                buildBVH(bounds);
 
-                    bool useful = false;
-                    STriangleCollider triangle(A,B,C,useful);
-                    if (useful)
+            return triangles.size();
+        }
+
+        //! Finds closest intersection of the ray with the mesh.
+        inline bool CollideWithRay(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier) const
+        {
+            return traverseBVH<false>(collisionDistance,origin,direction,dirMaxMultiplier);
+        }
+
+        //! @copydoc CollideWithRay() `direction_reciprocal` is not used since hierarchy traversal needs exact reciprocal, kept for consistency with other colliders.
+        inline bool CollideWithRay(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier, const vectorSIMDf& direction_reciprocal) const
+        {
+            return traverseBVH<false>(collisionDistance,origin,direction,dirMaxMultiplier);
+        }
+
+        //! Finds any intersection of the ray with the mesh (not necessarily the closest one), useful for occlusion and line-of-sight queries.
+        inline bool CollideWithRayAnyHit(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier) const
+        {
+            return traverseBVH<true>(collisionDistance,origin,direction,dirMaxMultiplier);
+        }
+
+        //! Finds closest intersections of packet of 4 rays with the mesh, traversing the hierarchy once for all of them.
+        /**
+        @param[in,out] collisionDistances Per-ray max distance on input, updated for rays which hit the mesh closer than that.
+        @param[in] origin Origins of the rays in SoA layout (X, Y and Z of all four rays).
+        @param[in] direction Directions of the rays in SoA layout.
+        @param[in] activeMask Bitmask of rays to test, bit `i` corresponds to i-th ray.
+        @returns Bitmask of rays for which `collisionDistances` got updated.
+        */
+        inline int CollideWithRayPacket(vectorSIMDf& collisionDistances, const vectorSIMDf origin[3], const vectorSIMDf direction[3], int activeMask) const
+        {
+            if (!nodes.size() || !activeMask)
+                return 0;
+
+            const __m128 o[3] = {origin[0].getAsRegister(),origin[1].getAsRegister(),origin[2].getAsRegister()};
+            const __m128 d[3] = {direction[0].getAsRegister(),direction[1].getAsRegister(),direction[2].getAsRegister()};
+            __m128 invDir[3];
+            for (size_t j=0; j<3; j++) // clamp infinities so that 0*inf doesn't produce NaN in slab test
+                invDir[j] = _mm_max_ps(_mm_min_ps(_mm_div_ps(_mm_set1_ps(1.f),d[j]),_mm_set1_ps(1e30f)),_mm_set1_ps(-1e30f));
+            __m128 closest = collisionDistances.getAsRegister();
+            int hitMask = 0;
+
+            uint32_t stack[BVH_MAX_DEPTH];
+            uint32_t stackSize = 0u;
+            uint32_t current = 0u;
+            float dummyT;
+            if (!intersectNodePacket(dummyT,nodes[0],o,invDir,closest,activeMask))
+                return 0;
+            while (true)
+            {
+                const SBVHNode& node = nodes[current];
+                if (node.triangleCount)
+                {
+                    for (uint32_t i=node.rightChildOrFirstTriangle; i<node.rightChildOrFirstTriangle+node.triangleCount; i++)
                     {
-                        if (firstPoint)
+                        const STriangleCollider& tri = triangles[i];
+                        const __m128 n[3] = {_mm_set1_ps(tri.planeEq.X),_mm_set1_ps(tri.planeEq.Y),_mm_set1_ps(tri.planeEq.Z)};
+                        const __m128 NdotD = dotSoA(n,d);
+                        const __m128 t = _mm_div_ps(_mm_sub_ps(_mm_set1_ps(tri.planeEq.W),dotSoA(n,o)),NdotD);
+                        __m128 valid = _mm_and_ps(_mm_cmpneq_ps(NdotD,_mm_setzero_ps()),_mm_and_ps(_mm_cmpge_ps(t,_mm_setzero_ps()),_mm_cmplt_ps(t,closest)));
+                        if (!(_mm_movemask_ps(valid)&activeMask))
+                            continue;
+
+                        const __m128 p[3] = {_mm_add_ps(o[0],_mm_mul_ps(d[0],t)),_mm_add_ps(o[1],_mm_mul_ps(d[1],t)),_mm_add_ps(o[2],_mm_mul_ps(d[2],t))};
+                        const __m128 bp0[3] = {_mm_set1_ps(tri.boundaryPlanes[0].X),_mm_set1_ps(tri.boundaryPlanes[0].Y),_mm_set1_ps(tri.boundaryPlanes[0].Z)};
+                        const __m128 bp1[3] = {_mm_set1_ps(tri.boundaryPlanes[1].X),_mm_set1_ps(tri.boundaryPlanes[1].Y),_mm_set1_ps(tri.boundaryPlanes[1].Z)};
+                        const __m128 v = _mm_sub_ps(dotSoA(bp0,p),_mm_set1_ps(tri.boundaryPlanes[0].W));
+                        const __m128 u = _mm_sub_ps(dotSoA(bp1,p),_mm_set1_ps(tri.boundaryPlanes[1].W));
+                        valid = _mm_and_ps(valid,_mm_and_ps(_mm_cmpge_ps(u,_mm_setzero_ps()),_mm_cmpge_ps(v,_mm_setzero_ps())));
+                        valid = _mm_and_ps(valid,_mm_cmple_ps(_mm_add_ps(u,v),_mm_set1_ps(1.f)));
+
+                        const int laneHits = _mm_movemask_ps(valid)&activeMask;
+                        if (laneHits)
                         {
-                            BBox.Box.reset(A.getAsVector3df());
-                            firstPoint = false;
+                            const __m128 laneHitsMask = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_and_si128(_mm_set1_epi32(laneHits),_mm_set_epi32(8,4,2,1)),_mm_setzero_si128()));
+                            closest = _mm_or_ps(_mm_and_ps(laneHitsMask,t),_mm_andnot_ps(laneHitsMask,closest));
+                            hitMask |= laneHits;
                         }
-                        else
-                            BBox.Box.addInternalPoint(A.getAsVector3df());
-                        BBox.Box.addInternalPoint(B.getAsVector3df());
-                        BBox.Box.addInternalPoint(C.getAsVector3df());
-                        triangles.push_back(triangle);
                     }
                 }
+                else
+                {
+                    uint32_t nearChild = current+1u;
+                    uint32_t farChild = node.rightChildOrFirstTriangle;
+                    float nearT, farT;
+                    const bool nearHit = intersectNodePacket(nearT,nodes[nearChild],o,invDir,closest,activeMask);
+                    const bool farHit = intersectNodePacket(farT,nodes[farChild],o,invDir,closest,activeMask);
+                    if (nearHit&&farHit)
+                    {
+                        if (farT<nearT)
+                            std::swap(nearChild,farChild);
+                        stack[stackSize++] = farChild;
+                        current = nearChild;
+                        continue;
+                    }
+                    else if (nearHit||farHit)
+                    {
+                        current = nearHit ? nearChild:farChild;
+                        continue;
+                    }
+                }
+
+                if (!stackSize)
+                    break;
+                current = stack[--stackSize];
             }
-            else
+
+            _mm_store_ps(collisionDistances.pointer,closest);
+            return hitMask;
+        }
+
+    private:
+        static inline __m128 dotSoA(const __m128* a, const __m128* b)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0],b[0]),_mm_mul_ps(a[1],b[1])),_mm_mul_ps(a[2],b[2]));
+        }
+
+        //! Slab test of packet of rays against node's box.
+        /** @param[out] minEntryT Smallest entry distance among active rays hitting the box.
+        @returns Whether any of active rays hits the box.*/
+        static inline bool intersectNodePacket(float& minEntryT, const SBVHNode& node, const __m128* origin, const __m128* invDir, const __m128& maxT, int activeMask)
+        {
+            __m128 tNear = _mm_setzero_ps();
+            __m128 tFar = maxT;
+            for (size_t j=0; j<3; j++)
             {
-                for (size_t i=0; i<indexCount; i+=3)
-                {
-                    vectorSIMDf A(vertices[(i+0)*3+0],vertices[(i+0)*3+1],vertices[(i+0)*3+2]);
-                    vectorSIMDf B(vertices[(i+1)*3+0],vertices[(i+1)*3+1],vertices[(i+1)*3+2]);
-                    vectorSIMDf C(vertices[(i+2)*3+0],vertices[(i+2)*3+1],vertices[(i+2)*3+2]);
+                const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bboxMin[j]),origin[j]),invDir[j]);
+                const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.bboxMax[j]),origin[j]),invDir[j]);
+                tNear = _mm_max_ps(tNear,_mm_min_ps(t0,t1));
+                tFar = _mm_min_ps(tFar,_mm_max_ps(t0,t1));
+            }
+            const __m128 hit = _mm_cmple_ps(tNear,tFar);
+            const int mask = _mm_movemask_ps(hit)&activeMask;
+            if (!mask)
+                return false;
+
+            // horizontal min of entry distances of hitting rays
+            __m128 entry = _mm_or_ps(_mm_and_ps(hit,tNear),_mm_andnot_ps(hit,_mm_set1_ps(FLT_MAX)));
+            entry = _mm_min_ps(entry,_mm_shuffle_ps(entry,entry,_MM_SHUFFLE(2,3,0,1)));
+            entry = _mm_min_ps(entry,_mm_shuffle_ps(entry,entry,_MM_SHUFFLE(1,0,3,2)));
+            minEntryT = _mm_cvtss_f32(entry);
+            return true;
+        }
+
+        //! Slab test of ray against node's box. @returns Entry distance or FLT_MAX if the ray misses the box within [0,maxT].
+        static inline float intersectNode(const SBVHNode& node, const float* origin, const float* invDir, const float& maxT)
+        {
+            float tNear = 0.f;
+            float tFar = maxT;
+            for (size_t j=0; j<3; j++)
+            {
+                float t0 = (node.bboxMin[j]-origin[j])*invDir[j];
+                float t1 = (node.bboxMax[j]-origin[j])*invDir[j];
+                if (t0>t1)
+                    std::swap(t0,t1);
+                // NaN (0*inf when ray lies in slab's plane) fails both comparisons and doesn't narrow the interval
+                if (t0>tNear)
+                    tNear = t0;
+                if (t1<tFar)
+                    tFar = t1;
+            }
+            return tNear<=tFar ? tNear:FLT_MAX;
+        }
+
+        template<bool AnyHit>
+        inline bool traverseBVH(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier) const
+        {
+            if (!nodes.size())
+                return false;
+
+            const float invDir[3] = {1.f/direction.X,1.f/direction.Y,1.f/direction.Z};
+            float closest = dirMaxMultiplier;
+            bool hit = false;
 
-                    bool useful;
-                    STriangleCollider triangle(A,B,C,useful);
-                    if (useful)
+            uint32_t stack[BVH_MAX_DEPTH];
+            float stackT[BVH_MAX_DEPTH]; // entry distances of nodes on stack
+            uint32_t stackSize = 0u;
+            uint32_t current = 0u;
+            if (intersectNode(nodes[0],origin.pointer,invDir,closest)==FLT_MAX)
+                return false;
+            while (true)
+            {
+                const SBVHNode& node = nodes[current];
+                if (node.triangleCount)
+                {
+                    for (uint32_t i=node.rightChildOrFirstTriangle; i<node.rightChildOrFirstTriangle+node.triangleCount; i++)
                     {
-                        if (firstPoint)
+                        float dist;
+                        if (triangles[i].CollideWithRay(dist,origin,direction,closest))
                         {
-                            BBox.Box.reset(A.getAsVector3df());
-                            firstPoint = false;
+                            closest = dist;
+                            hit = true;
+                            if (AnyHit)
+                            {
+                                collisionDistance = closest;
+                                return true;
+                            }
                         }
-                        else
-                            BBox.Box.addInternalPoint(A.getAsVector3df());
-                        BBox.Box.addInternalPoint(B.getAsVector3df());
-                        BBox.Box.addInternalPoint(C.getAsVector3df());
-                        triangles.push_back(triangle);
                     }
                 }
+                else
+                {
+                    // visit nearer child first, so that farther one can get culled by closer hit
+                    uint32_t nearChild = current+1u;
+                    uint32_t farChild = node.rightChildOrFirstTriangle;
+                    float nearT = intersectNode(nodes[nearChild],origin.pointer,invDir,closest);
+                    float farT = intersectNode(nodes[farChild],origin.pointer,invDir,closest);
+                    if (farT<nearT)
+                    {
+                        std::swap(nearChild,farChild);
+                        std::swap(nearT,farT);
+                    }
+                    if (nearT!=FLT_MAX)
+                    {
+                        if (farT!=FLT_MAX)
+                        {
+                            stack[stackSize] = farChild;
+                            stackT[stackSize++] = farT;
+                        }
+                        current = nearChild;
+                        continue;
+                    }
+                }
+
+                // pop nodes which are still in front of the closest hit found so far
+                while (stackSize && stackT[stackSize-1u]>closest)
+                    stackSize--;
+                if (!stackSize)
+                    break;
+                current = stack[--stackSize];
             }
 
-            return triangles.size();
+            if (hit)
+                collisionDistance = closest;
+            return hit;
         }
 
-        inline bool CollideWithRay(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier) const
+        inline void buildBVH(const std::vector<STriangleBounds>& bounds)
         {
-            return CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier,reciprocal(direction));
+            std::vector<uint32_t> order(triangles.size());
+            for (uint32_t i=0u; i<order.size(); i++)
+                order[i] = i;
+
+            struct SBuildItem
+            {
+                uint32_t begin, end;
+                uint32_t parent; // index of parent node if this is right child, ~0u otherwise
+                uint32_t depth;
+            };
+            std::vector<SBuildItem> toBuild;
+            toBuild.push_back(SBuildItem{0u,static_cast<uint32_t>(order.size()),~0u,0u});
+            nodes.reallocate(2u*triangles.size());
+
+            while (!toBuild.empty())
+            {
+                const SBuildItem item = toBuild.back();
+                toBuild.pop_back();
+
+                const uint32_t nodeIx = nodes.size();
+                if (item.parent!=~0u)
+                    nodes[item.parent].rightChildOrFirstTriangle = nodeIx;
+
+                SBVHNode node;
+                float centroidMin[3] = {FLT_MAX,FLT_MAX,FLT_MAX};
+                float centroidMax[3] = {-FLT_MAX,-FLT_MAX,-FLT_MAX};
+                for (size_t j=0; j<3; j++)
+                {
+                    node.bboxMin[j] = FLT_MAX;
+                    node.bboxMax[j] = -FLT_MAX;
+                }
+                for (uint32_t i=item.begin; i<item.end; i++)
+                {
+                    const STriangleBounds& b = bounds[order[i]];
+                    for (size_t j=0; j<3; j++)
+                    {
+                        node.bboxMin[j] = std::min(node.bboxMin[j],b.bboxMin[j]);
+                        node.bboxMax[j] = std::max(node.bboxMax[j],b.bboxMax[j]);
+                        centroidMin[j] = std::min(centroidMin[j],b.centroid[j]);
+                        centroidMax[j] = std::max(centroidMax[j],b.centroid[j]);
+                    }
+                }
+
+                const uint32_t count = item.end-item.begin;
+                int32_t splitAxis = -1;
+                uint32_t splitBin = 0u;
+                if (count>1u && item.depth+1u<BVH_MAX_DEPTH)
+                {
+                    // binned surface area heuristic, cost of traversal step is assumed equal to cost of triangle test
+                    float bestCost = count<=BVH_MAX_LEAF_SIZE ? float(count):FLT_MAX;
+                    for (int32_t axis=0; axis<3; axis++)
+                    {
+                        const float extent = centroidMax[axis]-centroidMin[axis];
+                        if (extent<=0.f)
+                            continue;
+
+                        struct SBin
+                        {
+                            float bboxMin[3], bboxMax[3];
+                            uint32_t count;
+                        } bins[BVH_SAH_BIN_COUNT];
+                        for (size_t b=0; b<BVH_SAH_BIN_COUNT; b++)
+                        {
+                            bins[b].count = 0u;
+                            for (size_t j=0; j<3; j++)
+                            {
+                                bins[b].bboxMin[j] = FLT_MAX;
+                                bins[b].bboxMax[j] = -FLT_MAX;
+                            }
+                        }
+                        const float binScale = float(BVH_SAH_BIN_COUNT)/extent;
+                        for (uint32_t i=item.begin; i<item.end; i++)
+                        {
+                            const STriangleBounds& tb = bounds[order[i]];
+                            SBin& bin = bins[std::min<uint32_t>((tb.centroid[axis]-centroidMin[axis])*binScale,BVH_SAH_BIN_COUNT-1u)];
+                            bin.count++;
+                            for (size_t j=0; j<3; j++)
+                            {
+                                bin.bboxMin[j] = std::min(bin.bboxMin[j],tb.bboxMin[j]);
+                                bin.bboxMax[j] = std::max(bin.bboxMax[j],tb.bboxMax[j]);
+                            }
+                        }
+
+                        // sweep from the right to get area and count of right side for every split
+                        float rightArea[BVH_SAH_BIN_COUNT];
+                        uint32_t rightCount[BVH_SAH_BIN_COUNT];
+                        SBin acc = bins[BVH_SAH_BIN_COUNT-1];
+                        for (int32_t b=BVH_SAH_BIN_COUNT-1; b>0; b--)
+                        {
+                            if (b!=BVH_SAH_BIN_COUNT-1)
+                                mergeBin(acc,bins[b]);
+                            rightArea[b] = halfArea(acc.bboxMin,acc.bboxMax);
+                            rightCount[b] = acc.count;
+                        }
+                        acc = bins[0];
+                        for (uint32_t b=1u; b<BVH_SAH_BIN_COUNT; b++)
+                        {
+                            if (b!=1u)
+                                mergeBin(acc,bins[b-1]);
+                            if (!acc.count||!rightCount[b])
+                                continue;
+                            const float cost = 1.f+(halfArea(acc.bboxMin,acc.bboxMax)*acc.count+rightArea[b]*rightCount[b])/halfArea(node.bboxMin,node.bboxMax);
+                            if (cost<bestCost)
+                            {
+                                bestCost = cost;
+                                splitAxis = axis;
+                                splitBin = b;
+                            }
+                        }
+                    }
+                }
+
+                if (splitAxis<0)
+                {
+                    node.rightChildOrFirstTriangle = item.begin;
+                    node.triangleCount = count;
+                    nodes.push_back(node);
+                    continue;
+                }
+
+                const float binScale = float(BVH_SAH_BIN_COUNT)/(centroidMax[splitAxis]-centroidMin[splitAxis]);
+                const float axisMin = centroidMin[splitAxis];
+                const uint32_t* const mid = std::partition(order.data()+item.begin,order.data()+item.end,[&](uint32_t _tri) {
+                    return std::min<uint32_t>((bounds[_tri].centroid[splitAxis]-axisMin)*binScale,BVH_SAH_BIN_COUNT-1u)<splitBin;
+                });
+                uint32_t midIx = mid-order.data();
+                if (midIx==item.begin||midIx==item.end) // shouldn't happen as split bin has triangles on both sides, but never create empty node
+                {
+                    midIx = item.begin+count/2u;
+                    std::nth_element(order.data()+item.begin,order.data()+midIx,order.data()+item.end,[&](uint32_t _a, uint32_t _b) {
+                        return bounds[_a].centroid[splitAxis]<bounds[_b].centroid[splitAxis];
+                    });
+                }
+
+                node.rightChildOrFirstTriangle = ~0u; // patched when right child is created
+                node.triangleCount = 0u;
+                nodes.push_back(node);
+                // left child has to be created right after its parent
+                toBuild.push_back(SBuildItem{midIx,item.end,nodeIx,item.depth+1u});
+                toBuild.push_back(SBuildItem{item.begin,midIx,~0u,item.depth+1u});
+            }
+
+            // reorder triangles so that every leaf references contiguous range
+            array<STriangleCollider> sorted;
+            sorted.reallocate(triangles.size());
+            for (uint32_t i=0u; i<order.size(); i++)
+                sorted.push_back(triangles[order[i]]);
+            triangles = sorted;
         }
 
-        inline bool CollideWithRay(float& collisionDistance, const vectorSIMDf& origin, const vectorSIMDf& direction, const float& dirMaxMultiplier, const vectorSIMDf& direction_reciprocal) const
+        template<class BinT>
+        static inline void mergeBin(BinT& acc, const BinT& other)
         {
-            float dummyDist;
-            if (!BBox.CollideWithRay(dummyDist,origin,direction,dirMaxMultiplier,direction_reciprocal))
-                return false;
-
-            for (size_t i=0; i<triangles.size(); i++)
+            acc.count += other.count;
+            for (size_t j=0; j<3; j++)
             {
-                if (triangles[i].CollideWithRay(collisionDistance,origin,direction,dirMaxMultiplier))
-                    return true;
+                acc.bboxMin[j] = std::min(acc.bboxMin[j],other.bboxMin[j]);
+                acc.bboxMax[j] = std::max(acc.bboxMax[j],other.bboxMax[j]);
             }
+        }
 
-            return false;
+        static inline float halfArea(const float* bboxMin, const float* bboxMax)
+        {
+            if (bboxMin[0]>bboxMax[0])
+                return 0.f;
+            const float d[3] = {bboxMax[0]-bboxMin[0],bboxMax[1]-bboxMin[1],bboxMax[2]-bboxMin[2]};
+            return d[0]*d[1]+d[1]*d[2]+d[2]*d[0];
         }
+    public:
 /**
         inline bool UpdateTransformation(const matrix4x3& newTransform)
         {
@@ -132,6 +132,17 @@ namespace scene
         return core::min_(bestFit,core::vectorSIMDf(cubeHalfSize))+0.01f;
     }
 
+	//! Same as quantizeNormal2_10_10_10 but bypasses the global cache, hence can be called from many threads at once
+	inline uint32_t quantizeNormal2_10_10_10Uncached(const core::vectorSIMDf &normal)
+	{
+        core::vectorSIMDf fit = findBestFit(10u, normal);
+        const uint32_t xorflag = (0x1u<<10)-1;
+        uint32_t bestFit = ((uint32_t(fit.X)^(normal.X<0.f ? xorflag:0))+(normal.X<0.f ? 1:0))&xorflag;
+        bestFit |= (((uint32_t(fit.Y)^(normal.Y<0.f ? xorflag:0))+(normal.Y<0.f ? 1:0))&xorflag)<<10;
+        bestFit |= (((uint32_t(fit.Z)^(normal.Z<0.f ? xorflag:0))+(normal.Z<0.f ? 1:0))&xorflag)<<20;
+        return bestFit;
+	}
+
 	inline uint32_t quantizeNormal2_10_10_10(const core::vectorSIMDf &normal)
 	{
         QuantizationCacheEntry2_10_10_10 dummySearchVal;
@@ -142,11 +153,7 @@ namespace scene
             return found->value;
         }
 
-        core::vectorSIMDf fit = findBestFit(10u, normal);
-        const uint32_t xorflag = (0x1u<<10)-1;
-        uint32_t bestFit = ((uint32_t(fit.X)^(normal.X<0.f ? xorflag:0))+(normal.X<0.f ? 1:0))&xorflag;
-        bestFit |= (((uint32_t(fit.Y)^(normal.Y<0.f ? xorflag:0))+(normal.Y<0.f ? 1:0))&xorflag)<<10;
-        bestFit |= (((uint32_t(fit.Z)^(normal.Z<0.f ? xorflag:0))+(normal.Z<0.f ? 1:0))&xorflag)<<20;
+        const uint32_t bestFit = quantizeNormal2_10_10_10Uncached(normal);
         dummySearchVal.value = bestFit;
         normalCacheFor2_10_10_10Quant.insert(found,dummySearchVal);
 
@@ -0,0 +1,141 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __FAST_ATOF_H_INCLUDED__
+#define __FAST_ATOF_H_INCLUDED__
+
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <emmintrin.h>
+
+namespace irr
+{
+namespace core
+{
+
+//! Parses decimal float from the text buffer without copying it out or requiring null termination.
+/** Leading blanks (spaces and tabs) are skipped. Mantissa of up to 19 significant digits is accumulated as integer and scaled by
+exact power of ten, which gives the same correctly rounded result as `float(strtod())` whenever mantissa fits in 53 bits and
+exponent's magnitude doesn't exceed 22 (i.e. for any number exported by a sane tool). Other numbers, infinities and NaNs are left to strtod.
+@param _in Start of the text.
+@param _end End of the buffer, parsing never goes past it.
+@param _out Parsed value, 0 if there was no number.
+@returns Pointer to the first character after the number (or to `_in` with blanks skipped if there was no number).*/
+inline const char* fast_atof_move(const char* _in, const char* const _end, float& _out)
+{
+	static const double powersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	auto isDigit = [](const char c) { return uint32_t(c-'0')<10u; };
+
+	while (_in!=_end && (*_in==' ' || *_in=='\t'))
+		++_in;
+	const char* const start = _in;
+
+	bool negative = false;
+	if (_in!=_end && (*_in=='-' || *_in=='+'))
+		negative = *(_in++)=='-';
+
+	uint64_t mantissa = 0u;
+	int32_t exponent = 0;
+	uint32_t significantDigits = 0u;
+	bool anyDigit = false;
+	for (; _in!=_end && isDigit(*_in); ++_in)
+	{
+		anyDigit = true;
+		if (significantDigits<19u)
+		{
+			mantissa = mantissa*10u+uint32_t(*_in-'0');
+			significantDigits += mantissa ? 1u:0u;
+		}
+		else
+			exponent++;
+	}
+	if (_in!=_end && *_in=='.')
+	for (++_in; _in!=_end && isDigit(*_in); ++_in)
+	{
+		anyDigit = true;
+		if (significantDigits<19u)
+		{
+			mantissa = mantissa*10u+uint32_t(*_in-'0');
+			significantDigits += mantissa ? 1u:0u;
+			exponent--;
+		}
+	}
+	if (anyDigit && _in!=_end && (*_in=='e' || *_in=='E'))
+	{
+		const char* expPtr = _in+1;
+		bool negativeExp = false;
+		if (expPtr!=_end && (*expPtr=='-' || *expPtr=='+'))
+			negativeExp = *(expPtr++)=='-';
+		if (expPtr!=_end && isDigit(*expPtr))
+		{
+			int32_t expValue = 0;
+			for (; expPtr!=_end && isDigit(*expPtr); ++expPtr)
+			if (expValue<100000)
+				expValue = expValue*10+(*expPtr-'0');
+			exponent += negativeExp ? -expValue:expValue;
+			_in = expPtr;
+		}
+	}
+
+	if (anyDigit && mantissa<=(0x1ull<<53) && exponent>=-22 && exponent<=22)
+	{
+		double value = double(mantissa);
+		if (exponent<0)
+			value /= powersOfTen[-exponent];
+		else
+			value *= powersOfTen[exponent];
+		_out = float(negative ? -value:value);
+		return _in;
+	}
+
+	// rare case, copy the word out so strtod doesn't run past the buffer
+	char word[64];
+	size_t length = 0u;
+	for (; start+length!=_end && length<sizeof(word)-1u && start[length]!='\n' && start[length]!='\r'; length++)
+		word[length] = start[length];
+	word[length] = 0;
+	char* wordEnd;
+	_out = float(strtod(word, &wordEnd));
+	return start+(wordEnd-word);
+}
+
+//! Parses null-terminated decimal float, see fast_atof_move().
+inline float fast_atof(const char* _in)
+{
+	float retval;
+	fast_atof_move(_in, _in+strlen(_in), retval);
+	return retval;
+}
+
+//! Finds first '\n' or '\r' in the buffer, comparing 16 characters at once.
+/** @returns Pointer to the line break or `_end` if there's none.*/
+inline const char* findLineBreak(const char* _in, const char* const _end)
+{
+	const __m128i lf = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	for (; _end-_in>=16; _in+=16)
+	{
+		const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_in));
+		const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars,lf),_mm_cmpeq_epi8(chars,cr)));
+		if (mask)
+		{
+			uint32_t i = 0u;
+			while (!(mask&(0x1<<i)))
+				i++;
+			return _in+i;
+		}
+	}
+	while (_in!=_end && *_in!='\n' && *_in!='\r')
+		++_in;
+	return _in;
+}
+
+} // end namespace core
+} // end namespace irr
+
+#endif
@@ -75,6 +75,18 @@ For functions:		template<class T> _IRR_DEPRECATED_ void test4(void) {}
 #define _IRR_DEPRECATED_  __attribute__ ((deprecated))
 #else
 #define _IRR_DEPRECATED_
-#endif
+#endif
+
+//! Lets a function use intrinsics of an instruction set above the one the file is compiled for
+/** Such a function may only be called after checking at runtime that the CPU supports the set.
+MSVC needs no annotation as it always accepts the intrinsics.
+**/
+#if defined(__GNUC__) || defined(__clang__)
+#define _IRR_TARGET_SSSE3_ __attribute__ ((target("ssse3")))
+#define _IRR_TARGET_AVX2_ __attribute__ ((target("avx2")))
+#else
+#define _IRR_TARGET_SSSE3_
+#define _IRR_TARGET_AVX2_
+#endif
 
 #endif // __IRR_MACROS_H_INCLUDED__
@@ -126,6 +126,7 @@
 #include "vector2d.h"
 #include "vector3d.h"
 #include "vectorSIMD.h"
+#include "vectorSIMDBatch.h"
 
 
 #include "SIrrCreationParameters.h"
@@ -107,6 +107,27 @@ struct matrix3x4SIMD : private AlignedBase<_IRR_MATRIX_ALIGNMENT>
 		return out;
 	}
 
+	//! Instruction sets the functions working on whole arrays of matrices, vectors or boxes can use
+	enum E_SIMD_LEVEL
+	{
+		ESL_SSE3=0,
+		ESL_AVX2,
+		ESL_COUNT
+	};
+
+	//! Caps the instruction set used by the array versions of concatenateBFollowedByA(), transformVect(), mulSub3x3With3x1() and transformBoxEx().
+	/** By default the best set the CPU supports is used, results are bit for bit the same whichever it is. Not meant to be called
+	while other threads use the functions.
+	\return The set actually used, never above the best one the CPU supports. */
+	IRRLICHT_API static E_SIMD_LEVEL setMaxSIMDLevel(E_SIMD_LEVEL _level);
+
+	//! Returns the instruction set the array functions currently use.
+	IRRLICHT_API static E_SIMD_LEVEL getSIMDLevel();
+
+	//! Concatenates `_count` pairs of matrices, same as `_out[i] = concatenateBFollowedByA(_a[i], _b[i])` for every i.
+	/** `_out` may be the same array as `_a` or `_b`, otherwise the arrays must not overlap. */
+	IRRLICHT_API static void concatenateBFollowedByA(matrix3x4SIMD* _out, const matrix3x4SIMD* _a, const matrix3x4SIMD* _b, size_t _count);
+
 	inline matrix3x4SIMD& concatenateAfter(const matrix3x4SIMD& _other)
 	{
 		return *this = concatenateBFollowedByA(*this, _other);
@@ -263,6 +284,11 @@ struct matrix3x4SIMD : private AlignedBase<_IRR_MATRIX_ALIGNMENT>
 		memcpy(_in_out, out, 3*4);
 	}
 
+	//! Transforms `_count` points, w of the inputs is ignored and w of the results is 1.
+	/** Products are summed in a different order than in transformVect(const float*), so the last bit of the results may differ.
+	`_out` may be the same array as `_in`, otherwise the arrays must not overlap. */
+	IRRLICHT_API void transformVect(vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count) const;
+
 	inline void pseudoMulWith4x1(float* _out, const float* _in) const
 	{
 		transformVect(_out, _in);
@@ -295,6 +321,11 @@ struct matrix3x4SIMD : private AlignedBase<_IRR_MATRIX_ALIGNMENT>
 		mulSub3x3With3x1(_in_out, _in_out);
 	}
 
+	//! Multiplies `_count` vectors, e.g. normals, by the 3x3 part of the matrix, w of the inputs is ignored and w of the results is 0.
+	/** Products are summed in a different order than in mulSub3x3With3x1(const float*), so the last bit of the results may differ.
+	`_out` may be the same array as `_in`, otherwise the arrays must not overlap. */
+	IRRLICHT_API void mulSub3x3With3x1(vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count) const;
+
 	inline static matrix3x4SIMD buildCameraLookAtMatrixLH(
 		const core::vectorSIMDf& position,
 		const core::vectorSIMDf& target,
@@ -629,6 +660,10 @@ inline aabbox3df transformBoxEx(const aabbox3df& box, const matrix3x4SIMD& _mat)
 	return aabbox3df(minPt.getAsVector3df(),maxPt.getAsVector3df());
 }
 
+//! Transforms `_count` boxes, each by its own matrix, same as `_out[i] = transformBoxEx(_in[i], _mats[i])` for every i.
+/** `_out` may be the same array as `_in`, otherwise the arrays must not overlap. */
+IRRLICHT_API void transformBoxEx(aabbox3df* _out, const aabbox3df* _in, const matrix3x4SIMD* _mats, size_t _count);
+
 }}
 
 #endif
@@ -0,0 +1,210 @@
+#ifndef __IRR_VECTOR_SIMD_BATCH_H_INCLUDED__
+#define __IRR_VECTOR_SIMD_BATCH_H_INCLUDED__
+
+#include "vectorSIMD.h"
+#include "ICPUBuffer.h"
+
+namespace irr
+{
+namespace core
+{
+
+//! Four 3D float vectors in structure of arrays layout, one vectorSIMDf for each component.
+/** Lane i of X, Y and Z is vector i, so per-vector math such as dot products or cross products needs no shuffles
+and uses all four lanes, unlike vectorSIMDf which spends its W lane and needs horizontal adds.
+Only SSE is used, so the class works wherever vectorSIMDf does without any extra compiler flags.
+*/
+class vector3dfSIMDBatch
+{
+	public:
+		enum
+		{
+			BATCH_SIZE = 4
+		};
+
+		vectorSIMDf X, Y, Z;
+
+		//! Constructor, all vectors are zero
+		inline vector3dfSIMDBatch() {}
+
+		//! Constructor from components of the four vectors
+		inline vector3dfSIMDBatch(const vectorSIMDf& _x, const vectorSIMDf& _y, const vectorSIMDf& _z) : X(_x), Y(_y), Z(_z) {}
+
+		//! Constructor making all four vectors equal to XYZ of `_v`
+		inline explicit vector3dfSIMDBatch(const vectorSIMDf& _v) : X(_v.xxxx()), Y(_v.yyyy()), Z(_v.zzzz()) {}
+
+		//! Gathers `_count` vectors, vector i being the first three floats at `_data` plus `i*_stride` bytes.
+		/** Lanes from `_count` up repeat the first vector, so they don't change results of min or max reductions.
+		Never reads past the third float of a vector, so tightly packed positions can be loaded up to the very end of a buffer.
+		\param _count Number of vectors, 1 to BATCH_SIZE. */
+		static inline vector3dfSIMDBatch loadStrided(const void* _data, size_t _stride, uint32_t _count=BATCH_SIZE)
+		{
+			const uint8_t* data = reinterpret_cast<const uint8_t*>(_data);
+			const __m128 v0 = loadXYZ(data);
+			return fromVectors(v0, _count>1u ? loadXYZ(data+_stride):v0, _count>2u ? loadXYZ(data+2u*_stride):v0, _count>3u ? loadXYZ(data+3u*_stride):v0);
+		}
+
+		//! Gathers `_count` vectors, vector i being the first three floats at `_data` plus `_indices[i]*_stride` bytes.
+		/** Lanes from `_count` up repeat the first vector, same as loadStrided().
+		\param _count Number of vectors, 1 to BATCH_SIZE. */
+		template<typename IndexT>
+		static inline vector3dfSIMDBatch loadIndexed(const void* _data, size_t _stride, const IndexT* _indices, uint32_t _count=BATCH_SIZE)
+		{
+			const uint8_t* data = reinterpret_cast<const uint8_t*>(_data);
+			const __m128 v0 = loadXYZ(data+size_t(_indices[0])*_stride);
+			return fromVectors(v0, _count>1u ? loadXYZ(data+size_t(_indices[1])*_stride):v0, _count>2u ? loadXYZ(data+size_t(_indices[2])*_stride):v0,
+				_count>3u ? loadXYZ(data+size_t(_indices[3])*_stride):v0);
+		}
+
+		//! Loads vectors `_first` to `_first+_count-1` of a float attribute with at least 3 components living in `_buffer`.
+		/** \param _offset Offset of the first vector in bytes.
+		\param _stride Distance between vectors in bytes.
+		\return False and leaves `_out` untouched if any of the vectors lies outside the buffer. */
+		static inline bool loadFromBuffer(vector3dfSIMDBatch& _out, const ICPUBuffer* _buffer, size_t _offset, size_t _stride, size_t _first, uint32_t _count=BATCH_SIZE)
+		{
+			if (!_buffer || !_count || _offset+(_first+_count-1u)*_stride+3u*sizeof(float)>_buffer->getSize())
+				return false;
+
+			_out = loadStrided(reinterpret_cast<const uint8_t*>(_buffer->getPointer())+_offset+_first*_stride, _stride, _count);
+			return true;
+		}
+
+		//! Writes XYZ of the first `_count` vectors to `_data` plus `i*_stride` bytes, anything after the third float of each is left as it was.
+		inline void storeStrided(void* _data, size_t _stride, uint32_t _count=BATCH_SIZE) const
+		{
+			uint8_t* data = reinterpret_cast<uint8_t*>(_data);
+			__m128 v0 = X.getAsRegister(), v1 = Y.getAsRegister(), v2 = Z.getAsRegister(), v3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+			storeXYZ(data, v0);
+			if (_count>1u)
+				storeXYZ(data+_stride, v1);
+			if (_count>2u)
+				storeXYZ(data+2u*_stride, v2);
+			if (_count>3u)
+				storeXYZ(data+3u*_stride, v3);
+		}
+
+		//! Stores vectors `_first` to `_first+_count-1` of a float attribute with at least 3 components living in `_buffer`.
+		/** \return False and writes nothing if any of the vectors lies outside the buffer. */
+		inline bool storeToBuffer(ICPUBuffer* _buffer, size_t _offset, size_t _stride, size_t _first, uint32_t _count=BATCH_SIZE) const
+		{
+			if (!_buffer || !_count || _offset+(_first+_count-1u)*_stride+3u*sizeof(float)>_buffer->getSize())
+				return false;
+
+			storeStrided(reinterpret_cast<uint8_t*>(_buffer->getPointer())+_offset+_first*_stride, _stride, _count);
+			return true;
+		}
+
+		//! Returns vector `_lane` with W set to 0.
+		inline vectorSIMDf getVector(uint32_t _lane) const
+		{
+			return vectorSIMDf(X.pointer[_lane], Y.pointer[_lane], Z.pointer[_lane], 0.f);
+		}
+
+		//! Writes all four vectors to `_out` in array of structures layout, W components are set to 0.
+		inline void getVectors(vectorSIMDf* _out) const
+		{
+			_out[0] = X;
+			_out[1] = Y;
+			_out[2] = Z;
+			_out[3] = vectorSIMDf(0.f);
+			transpose4(_out);
+		}
+
+		inline vector3dfSIMDBatch operator-() const { return vector3dfSIMDBatch(-X, -Y, -Z); }
+
+		inline vector3dfSIMDBatch operator+(const vector3dfSIMDBatch& _other) const { return vector3dfSIMDBatch(X+_other.X, Y+_other.Y, Z+_other.Z); }
+		inline vector3dfSIMDBatch operator-(const vector3dfSIMDBatch& _other) const { return vector3dfSIMDBatch(X-_other.X, Y-_other.Y, Z-_other.Z); }
+		inline vector3dfSIMDBatch operator*(const vector3dfSIMDBatch& _other) const { return vector3dfSIMDBatch(X*_other.X, Y*_other.Y, Z*_other.Z); }
+		inline vector3dfSIMDBatch operator/(const vector3dfSIMDBatch& _other) const { return vector3dfSIMDBatch(X/_other.X, Y/_other.Y, Z/_other.Z); }
+		//! Scales vector i by lane i of `_scale`
+		inline vector3dfSIMDBatch operator*(const vectorSIMDf& _scale) const { return vector3dfSIMDBatch(X*_scale, Y*_scale, Z*_scale); }
+		inline vector3dfSIMDBatch operator/(const vectorSIMDf& _scale) const { return vector3dfSIMDBatch(X/_scale, Y/_scale, Z/_scale); }
+
+		inline vector3dfSIMDBatch& operator+=(const vector3dfSIMDBatch& _other) { return *this = *this+_other; }
+		inline vector3dfSIMDBatch& operator-=(const vector3dfSIMDBatch& _other) { return *this = *this-_other; }
+		inline vector3dfSIMDBatch& operator*=(const vector3dfSIMDBatch& _other) { return *this = *this*_other; }
+		inline vector3dfSIMDBatch& operator*=(const vectorSIMDf& _scale) { return *this = *this*_scale; }
+
+	private:
+		//! loads (x,y,z,0) with two loads so nothing after z gets touched
+		static inline __m128 loadXYZ(const uint8_t* _src)
+		{
+			const float* src = reinterpret_cast<const float*>(_src);
+			return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(src)), _mm_load_ss(src+2));
+		}
+
+		//! stores x, y and z, leaving the float after them alone
+		static inline void storeXYZ(uint8_t* _dst, const __m128& _v)
+		{
+			float* dst = reinterpret_cast<float*>(_dst);
+			_mm_storel_pi(reinterpret_cast<__m64*>(dst), _v);
+			_mm_store_ss(dst+2, _mm_movehl_ps(_v, _v));
+		}
+
+		static inline vector3dfSIMDBatch fromVectors(__m128 _v0, __m128 _v1, __m128 _v2, __m128 _v3)
+		{
+			_MM_TRANSPOSE4_PS(_v0, _v1, _v2, _v3);
+			return vector3dfSIMDBatch(_v0, _v1, _v2);
+		}
+};
+
+//! Returns dot products of the vectors, lane i of the result being that of vectors i
+inline vectorSIMDf dot(const vector3dfSIMDBatch& _a, const vector3dfSIMDBatch& _b)
+{
+	return _a.X*_b.X+_a.Y*_b.Y+_a.Z*_b.Z;
+}
+
+inline vector3dfSIMDBatch cross(const vector3dfSIMDBatch& _a, const vector3dfSIMDBatch& _b)
+{
+	return vector3dfSIMDBatch(_a.Y*_b.Z-_a.Z*_b.Y, _a.Z*_b.X-_a.X*_b.Z, _a.X*_b.Y-_a.Y*_b.X);
+}
+
+//! Returns lengths of the vectors, lane i of the result being that of vector i
+inline vectorSIMDf length(const vector3dfSIMDBatch& _v)
+{
+	return sqrt(dot(_v, _v));
+}
+
+//! Normalizes the vectors, precision follows normalize(const vectorSIMDf&)
+inline vector3dfSIMDBatch normalize(const vector3dfSIMDBatch& _v)
+{
+#ifdef IRRLICHT_FAST_MATH
+	return _v*inversesqrt(dot(_v, _v));
+#else
+	return _v/sqrt(dot(_v, _v));
+#endif
+}
+
+//! Component-wise minimum of each pair of vectors
+inline vector3dfSIMDBatch min_(const vector3dfSIMDBatch& _a, const vector3dfSIMDBatch& _b)
+{
+	return vector3dfSIMDBatch(min_(_a.X, _b.X), min_(_a.Y, _b.Y), min_(_a.Z, _b.Z));
+}
+
+//! Component-wise maximum of each pair of vectors
+inline vector3dfSIMDBatch max_(const vector3dfSIMDBatch& _a, const vector3dfSIMDBatch& _b)
+{
+	return vector3dfSIMDBatch(max_(_a.X, _b.X), max_(_a.Y, _b.Y), max_(_a.Z, _b.Z));
+}
+
+//! Returns component-wise minimum of all four vectors in XYZ, W is 0
+inline vectorSIMDf reduceMin(const vector3dfSIMDBatch& _v)
+{
+	vectorSIMDf v[vector3dfSIMDBatch::BATCH_SIZE];
+	_v.getVectors(v);
+	return min_(min_(v[0], v[1]), min_(v[2], v[3]));
+}
+
+//! Returns component-wise maximum of all four vectors in XYZ, W is 0
+inline vectorSIMDf reduceMax(const vector3dfSIMDBatch& _v)
+{
+	vectorSIMDf v[vector3dfSIMDBatch::BATCH_SIZE];
+	_v.getVectors(v);
+	return max_(max_(v[0], v[1]), max_(v[2], v[3]));
+}
+
+} // end namespace core
+} // end namespace irr
+
+#endif
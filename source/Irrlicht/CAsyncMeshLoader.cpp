@@ -0,0 +1,154 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#include "CAsyncMeshLoader.h"
+
+namespace irr
+{
+namespace scene
+{
+
+CAsyncMeshLoader::CAsyncMeshLoader(const LoadFunc_T& load)
+	: Load(load), JobAdded(&Mutex), ThreadCount(0u), RunningThreads(0u), IdleThreads(0u), Stop(false)
+{
+}
+
+
+CAsyncMeshLoader::~CAsyncMeshLoader()
+{
+	Mutex.Get();
+	Stop = true;
+	JobAdded.SignalConditionToAll();
+	Mutex.Release();
+
+	for (size_t i=0u; i<Threads.size(); i++)
+		Threads[i].join();
+
+	// nobody is left to load these
+	for (size_t i=0u; i<Jobs.size(); i++)
+		Jobs[i].Promise.set_value(0);
+
+	for (auto it=Loaded.begin(); it!=Loaded.end(); it++)
+		it->second->drop();
+}
+
+
+void CAsyncMeshLoader::setThreadCount(uint32_t count)
+{
+	Mutex.Get();
+	ThreadCount = count;
+	// threads above the new count exit once they're done with their current job
+	JobAdded.SignalConditionToAll();
+	Mutex.Release();
+}
+
+
+std::shared_future<ICPUMesh*> CAsyncMeshLoader::request(const io::path& filename)
+{
+	const std::string key(filename.c_str());
+
+	Mutex.Get();
+	auto found = InFlight.find(key);
+	if (found!=InFlight.end())
+	{
+		std::shared_future<ICPUMesh*> retval = found->second;
+		Mutex.Release();
+		return retval;
+	}
+
+	auto loaded = Loaded.find(key);
+	if (loaded!=Loaded.end())
+	{
+		std::promise<ICPUMesh*> ready;
+		ready.set_value(loaded->second);
+		Mutex.Release();
+		return ready.get_future().share();
+	}
+
+	Jobs.push_back(SJob());
+	Jobs.back().Filename = key;
+	std::shared_future<ICPUMesh*> retval = Jobs.back().Promise.get_future().share();
+	InFlight[key] = retval;
+
+	if (Jobs.size()>IdleThreads && RunningThreads<getWantedThreadCount())
+	{
+		RunningThreads++;
+		Threads.push_back(std::thread(&CAsyncMeshLoader::work,this));
+	}
+	JobAdded.SignalConditionOnce();
+	Mutex.Release();
+	return retval;
+}
+
+
+bool CAsyncMeshLoader::waitFor(const io::path& filename)
+{
+	Mutex.Get();
+	auto found = InFlight.find(std::string(filename.c_str()));
+	if (found==InFlight.end())
+	{
+		Mutex.Release();
+		return false;
+	}
+	std::shared_future<ICPUMesh*> future = found->second;
+	Mutex.Release();
+
+	future.wait();
+	return true;
+}
+
+
+void CAsyncMeshLoader::takeLoadedMeshes(const std::function<void(const io::path&,ICPUMesh*)>& take)
+{
+	Mutex.Get();
+	std::map<std::string,ICPUMesh*> taken;
+	taken.swap(Loaded);
+	Mutex.Release();
+
+	for (auto it=taken.begin(); it!=taken.end(); it++)
+	{
+		take(it->first.c_str(),it->second);
+		it->second->drop();
+	}
+}
+
+
+void CAsyncMeshLoader::work()
+{
+	Mutex.Get();
+	for (;;)
+	{
+		IdleThreads++;
+		while (Jobs.empty() && !Stop && RunningThreads<=getWantedThreadCount())
+			JobAdded.WaitForCondition(&Mutex);
+		IdleThreads--;
+		if (Stop || RunningThreads>getWantedThreadCount())
+			break;
+
+		SJob job(std::move(Jobs.front()));
+		Jobs.pop_front();
+		Mutex.Release();
+
+		ICPUMesh* mesh = Load(job.Filename.c_str());
+
+		Mutex.Get();
+		// keeps the reference from Load(), requests are coalesced so the file can't be in Loaded already
+		if (mesh)
+			Loaded[job.Filename] = mesh;
+		InFlight.erase(job.Filename);
+		job.Promise.set_value(mesh);
+	}
+	RunningThreads--;
+	Mutex.Release();
+}
+
+
+uint32_t CAsyncMeshLoader::getWantedThreadCount() const
+{
+	return ThreadCount ? ThreadCount:std::max(std::thread::hardware_concurrency(),1u);
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,96 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_ASYNC_MESH_LOADER_H_INCLUDED__
+#define __C_ASYNC_MESH_LOADER_H_INCLUDED__
+
+#include "IMesh.h"
+#include "path.h"
+#include "FW_Mutex.h"
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Loads meshes on a pool of threads, any number of requests for the same file share one load.
+	/** Threads are started as requests come in, up to getThreadCount() of them, and live until the loader is destroyed.
+	Meshes loaded successfully are held until the owner takes them with takeLoadedMeshes() to put them in its mesh cache,
+	so the loader never keeps a mesh the owner has already taken. Requesting a mesh which is loaded but not taken yet
+	returns a ready future. Failed loads aren't remembered and are retried by the next request for the file.
+	*/
+	class CAsyncMeshLoader
+	{
+		public:
+			//! Loads the file on whatever thread calls it, returns a grabbed mesh or 0 on failure.
+			typedef std::function<ICPUMesh*(const io::path&)> LoadFunc_T;
+
+			//! Constructor
+			CAsyncMeshLoader(const LoadFunc_T& load);
+
+			//! Destructor, waits for loads in progress, gives null meshes to requests nobody started loading yet and drops meshes not taken.
+			~CAsyncMeshLoader();
+
+			//! Sets number of loading threads, 0 means as many as the hardware has.
+			void setThreadCount(uint32_t count);
+
+			//! Returns number of loading threads set with setThreadCount().
+			uint32_t getThreadCount() const { return ThreadCount; }
+
+			//! Returns a future of the mesh, starting to load it unless it's loaded and not taken yet or being loaded already.
+			std::shared_future<ICPUMesh*> request(const io::path& filename);
+
+			//! Waits for the mesh if it's being loaded.
+			/** \return Whether a load of the file was in progress. */
+			bool waitFor(const io::path& filename);
+
+			//! Calls `take(filename,mesh)` for every mesh loaded since the last call and drops the loader's reference to it.
+			void takeLoadedMeshes(const std::function<void(const io::path&,ICPUMesh*)>& take);
+
+		private:
+			struct SJob
+			{
+				std::string Filename;
+				std::promise<ICPUMesh*> Promise;
+			};
+
+			//! takes jobs off Jobs until told to stop or there are more threads than wanted
+			void work();
+
+			//! returns ThreadCount with 0 turned into the hardware's thread count
+			uint32_t getWantedThreadCount() const;
+
+			LoadFunc_T Load;
+
+			//! guards everything below
+			FW_Mutex Mutex;
+			FW_ConditionVariable JobAdded;
+
+			std::deque<SJob> Jobs;
+			//! futures of meshes queued or being loaded, by file name
+			std::map<std::string,std::shared_future<ICPUMesh*> > InFlight;
+			//! grabbed meshes loaded but not taken yet, by file name
+			std::map<std::string,ICPUMesh*> Loaded;
+
+			uint32_t ThreadCount;
+			std::vector<std::thread> Threads;
+			//! threads which haven't exited, Threads also has exited ones until the destructor joins them
+			uint32_t RunningThreads;
+			//! running threads waiting for a job
+			uint32_t IdleThreads;
+			bool Stop;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // __C_ASYNC_MESH_LOADER_H_INCLUDED__
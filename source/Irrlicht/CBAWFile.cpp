@@ -9,6 +9,7 @@
 #include "SSkinMeshBuffer.h"
 #include "CFinalBoneHierarchy.h"
 #include "coreutil.h"
+#include "lz4/xxhash.h"
 
 #ifdef _IRR_COMPILE_WITH_OPENSSL_
 #include <openssl/evp.h>
@@ -45,6 +46,11 @@ bool core::BlobHeaderV0::validate(const void* _data) const
 }
 
 
+uint64_t BAWFileV1::hashMeshName(const char* _name)
+{
+	return XXH64(_name, strlen(_name), 0ull);
+}
+
 MeshBlobV0::MeshBlobV0(const scene::ICPUMesh* _mesh) : box(_mesh->getBoundingBox()), meshBufCnt(_mesh->getMeshBufferCount())
 {
 	for (uint32_t i = 0; i < meshBufCnt; ++i)
@@ -6,6 +6,9 @@
 #include "CBAWMeshFileLoader.h"
 
 #include <stack>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 #include "CFinalBoneHierarchy.h"
 #include "SMesh.h"
@@ -22,7 +25,7 @@ CBAWMeshFileLoader::~CBAWMeshFileLoader()
 		m_fileSystem->drop();
 }
 
-CBAWMeshFileLoader::CBAWMeshFileLoader(scene::ISceneManager* _sm, io::IFileSystem* _fs) : m_sceneMgr(_sm), m_fileSystem(_fs)
+CBAWMeshFileLoader::CBAWMeshFileLoader(scene::ISceneManager* _sm, io::IFileSystem* _fs) : m_sceneMgr(_sm), m_fileSystem(_fs), m_decodingThreadCnt(1u)
 {
 #ifdef _DEBUG
 	setDebugName("CBAWMeshFileLoader");
@@ -38,96 +41,149 @@ ICPUMesh* CBAWMeshFileLoader::createMesh(io::IReadFile* _file)
 }
 
 ICPUMesh* CBAWMeshFileLoader::createMesh(io::IReadFile * _file, unsigned char _pwd[16])
+{
+	return createMesh(_file, NULL, _pwd);
+}
+
+ICPUMesh* CBAWMeshFileLoader::createMesh(io::IReadFile* _file, const char* _meshName, unsigned char _pwd[16])
 {
 #ifdef _DEBUG
 	uint32_t time = os::Timer::getRealTime();
 #endif // _DEBUG
 
-	SContext ctx{ _file };
+	SContext ctx{ _file, dynamic_cast<io::CMappedReadFile*>(_file) };
 	if (!verifyFile(ctx))
 		return NULL;
 
-	uint32_t blobCnt;
-	uint32_t* offsets;
-	core::BlobHeaderV0* headers;
-	if (!validateHeaders(&blobCnt, &offsets, (void**)&headers, ctx))
-		return NULL;
-	ctx.filePath = ctx.file->getFileName();
-	if (ctx.filePath[ctx.filePath.size() - 1] != '/')
-		ctx.filePath += "/";
-
-	const uint32_t BLOBS_FILE_OFFSET = core::BAWFileV0{ {}, blobCnt }.calcBlobsOffset();
-
-	std::unordered_map<uint64_t, SBlobData>::iterator meshBlobDataIter;
-
-	for (int i = 0; i < blobCnt; ++i)
+	core::BlobHeaderV0* headers = NULL; // only version 0 loads all headers upfront
+	SBlobData* meshBlobData = NULL;
+	if (ctx.fileVersion == core::BAWFileV0::VERSION)
 	{
-		SBlobData data(headers + i, BLOBS_FILE_OFFSET + offsets[i]);
-		const std::unordered_map<uint64_t, SBlobData>::iterator it = ctx.blobs.insert(std::make_pair(headers[i].handle, data)).first;
-		if (data.header->blobType == core::Blob::EBT_MESH || data.header->blobType == core::Blob::EBT_SKINNED_MESH)
-			meshBlobDataIter = it;
-	}
-	free(offsets);
+		if (_meshName)
+			return NULL;
 
-	const core::BlobLoadingParams params{ m_sceneMgr, m_fileSystem, ctx.filePath };
-	std::stack<SBlobData*> toLoad, toFinalize;
-	toLoad.push(&meshBlobDataIter->second);
-	while (!toLoad.empty())
-	{
-		SBlobData* data = toLoad.top();
-		toLoad.pop();
+		uint32_t* offsets;
+		if (!validateHeaders(&ctx.blobCnt, &offsets, (void**)&headers, ctx))
+			return NULL;
 
-		const uint64_t handle = data->header->handle;
-		const uint32_t size = data->header->blobSizeDecompr;
-		const uint32_t blobType = data->header->blobType;
-		const void* blob = data->heapBlob = tryReadBlobOnStack(*data, ctx, _pwd);
+		const uint32_t BLOBS_FILE_OFFSET = core::BAWFileV0{{}, ctx.blobCnt, {}, {}}.calcBlobsOffset();
 
-		if (!blob)
+		for (int i = 0; i < ctx.blobCnt; ++i)
 		{
-			ctx.releaseLoadedObjects();
-			free(headers);
-			return NULL;
+			SBlobData data(headers + i, BLOBS_FILE_OFFSET + offsets[i]);
+			SBlobData* const inserted = &ctx.blobs.insert(std::make_pair(headers[i].handle, data)).first->second;
+			if (data.header->blobType == core::Blob::EBT_MESH || data.header->blobType == core::Blob::EBT_SKINNED_MESH)
+				meshBlobData = inserted;
 		}
+		free(offsets);
+	}
+	else
+	{
+		uint64_t meshHandle;
+		if (!readHeaderV1(ctx) || !findRootMeshV1(_meshName, &meshHandle, ctx))
+			return NULL;
+		meshBlobData = getBlobData(meshHandle, ctx);
+	}
+	if (!meshBlobData)
+	{
+		free(headers);
+		return NULL;
+	}
+	const uint64_t meshHandle = meshBlobData->header->handle;
 
-		std::unordered_set<uint64_t> deps = ctx.loadingMgr.getNeededDeps(blobType, blob);
-		for (std::unordered_set<uint64_t>::iterator it = deps.begin(); it != deps.end(); ++it)
-			if (ctx.createdObjs.find(*it) == ctx.createdObjs.end())
-				toLoad.push(&ctx.blobs[*it]);
+	ctx.filePath = ctx.file->getFileName();
+	if (ctx.filePath[ctx.filePath.size() - 1] != '/')
+		ctx.filePath += "/";
 
-		bool fail = !(ctx.createdObjs[handle] = ctx.loadingMgr.instantiateEmpty(blobType, blob, size, params));
+	const core::BlobLoadingParams params{ m_sceneMgr, m_fileSystem, ctx.filePath, ctx.mappedFile };
+	const uint32_t decodingThreadCnt = m_decodingThreadCnt ? m_decodingThreadCnt : std::max(std::thread::hardware_concurrency(), 1u);
 
-		if (fail)
+	void* retval = NULL;
+	if (decodingThreadCnt > 1u)
+	{
+		if (!(retval = loadBlobsParallel(meshBlobData, ctx, _pwd, decodingThreadCnt, params)))
 		{
-			ctx.releaseLoadedObjects();
 			free(headers);
 			return NULL;
 		}
-
-		if (!deps.size())
+	}
+	else
+	{
+		std::stack<SBlobData*> toLoad, toFinalize;
+		toLoad.push(meshBlobData);
+		while (!toLoad.empty())
 		{
-			ctx.loadingMgr.finalize(blobType, ctx.createdObjs[handle], blob, size, ctx.createdObjs, params);
-			free(data->heapBlob);
-			blob = data->heapBlob = NULL;
+			SBlobData* data = toLoad.top();
+			toLoad.pop();
+
+			const uint64_t handle = data->header->handle;
+			const uint32_t size = data->header->blobSizeDecompr;
+			const uint32_t blobType = data->header->blobType;
+			if ((data->heapBlob = tryGetMappedBlob(*data, ctx)))
+			{
+				data->mapped = true;
+				if (!data->header->validate(data->heapBlob))
+					data->releaseBlob();
+			}
+			else
+				data->heapBlob = tryReadBlobOnStack(*data, ctx, _pwd);
+			const void* blob = data->heapBlob;
+
+			if (!blob)
+			{
+				ctx.releaseLoadedObjects();
+				free(headers);
+				return NULL;
+			}
+
+			bool fail = false;
+			std::unordered_set<uint64_t> deps = ctx.loadingMgr.getNeededDeps(blobType, blob);
+			for (std::unordered_set<uint64_t>::iterator it = deps.begin(); it != deps.end(); ++it)
+			{
+				if (ctx.createdObjs.find(*it) == ctx.createdObjs.end())
+				{
+					SBlobData* const depData = getBlobData(*it, ctx);
+					if (!depData)
+						fail = true;
+					else
+						toLoad.push(depData);
+				}
+			}
+
+			fail = fail || !(ctx.createdObjs[handle] = ctx.loadingMgr.instantiateEmpty(blobType, blob, size, params));
+
+			if (fail)
+			{
+				ctx.releaseLoadedObjects();
+				free(headers);
+				return NULL;
+			}
+
+			if (!deps.size())
+			{
+				ctx.loadingMgr.finalize(blobType, ctx.createdObjs[handle], blob, size, ctx.createdObjs, params);
+				data->releaseBlob();
+				blob = NULL;
+			}
+			else
+				toFinalize.push(data);
 		}
-		else
-			toFinalize.push(data);
-	}
 
-	void* retval = NULL;
-	while (!toFinalize.empty())
-	{
-		SBlobData* data = toFinalize.top();
-		toFinalize.pop();
+		while (!toFinalize.empty())
+		{
+			SBlobData* data = toFinalize.top();
+			toFinalize.pop();
 
-		const void* blob = data->heapBlob;
-		const uint64_t handle = data->header->handle;
-		const uint32_t size = data->header->blobSizeDecompr;
-		const uint32_t blobType = data->header->blobType;
+			const void* blob = data->heapBlob;
+			const uint64_t handle = data->header->handle;
+			const uint32_t size = data->header->blobSizeDecompr;
+			const uint32_t blobType = data->header->blobType;
 
-		retval = ctx.loadingMgr.finalize(blobType, ctx.createdObjs[handle], blob, size, ctx.createdObjs, params); // last one will always be mesh
+			retval = ctx.loadingMgr.finalize(blobType, ctx.createdObjs[handle], blob, size, ctx.createdObjs, params); // last one will always be mesh
+		}
 	}
 
-	ctx.releaseAllButThisOne(meshBlobDataIter); // call drop on all loaded objects except mesh
+	ctx.releaseAllButThisOne(meshHandle); // call drop on all loaded objects except mesh
 	free(headers);
 
 #ifdef _DEBUG
@@ -153,7 +209,7 @@ bool CBAWMeshFileLoader::verifyFile(SContext& _ctx) const
 		return false;
 
 	_ctx.fileVersion = ((uint64_t*)headerStr)[3];
-	if (_ctx.fileVersion >= 1)
+	if (_ctx.fileVersion > core::BAWFileV1::VERSION)
         return false;
 
 	return true;
@@ -180,7 +236,7 @@ bool CBAWMeshFileLoader::validateHeaders(uint32_t* _blobCnt, uint32_t** _offsets
 	if (!safeRead(_ctx.file, headers, *_blobCnt * sizeof(core::BlobHeaderV0)))
 		nope = true;
 
-	const uint32_t offsetRelByte = core::BAWFileV0{{}, *_blobCnt}.calcBlobsOffset(); // num of byte to which offsets are relative
+	const uint32_t offsetRelByte = core::BAWFileV0{{}, *_blobCnt, {}, {}}.calcBlobsOffset(); // num of byte to which offsets are relative
 	for (uint32_t i = 0; i < *_blobCnt-1; ++i) // whether offsets are in ascending order none of them points past the end of file
 		if (offsets[i] >= offsets[i+1] || offsetRelByte + offsets[i] >= _ctx.file->getSize())
 			nope = true;
@@ -204,6 +260,118 @@ bool CBAWMeshFileLoader::validateHeaders(uint32_t* _blobCnt, uint32_t** _offsets
 	return true;
 }
 
+bool CBAWMeshFileLoader::readHeaderV1(SContext& _ctx) const
+{
+	_ctx.file->seek(sizeof(core::BAWFileV1::fileHeader));
+	if (!safeRead(_ctx.file, &_ctx.blobCnt, sizeof(_ctx.blobCnt)))
+		return false;
+	if (!safeRead(_ctx.file, &_ctx.rootCnt, sizeof(_ctx.rootCnt)))
+		return false;
+	if (!safeRead(_ctx.file, _ctx.iv, 16))
+		return false;
+	if (!safeRead(_ctx.file, &_ctx.defaultMeshHandle, sizeof(_ctx.defaultMeshHandle)))
+		return false;
+
+	// whether all index tables fit in file
+	return _ctx.blobCnt && _ctx.rootCnt && core::BAWFileV1{{}, _ctx.blobCnt, _ctx.rootCnt, {}, 0u}.calcBlobsOffset() <= _ctx.file->getSize();
+}
+
+bool CBAWMeshFileLoader::findRootMeshV1(const char* _meshName, uint64_t* _outHandle, SContext& _ctx) const
+{
+	if (!_meshName)
+	{
+		*_outHandle = _ctx.defaultMeshHandle;
+		return true;
+	}
+
+	const size_t indexOffset = core::BAWFileV1{{}, _ctx.blobCnt, _ctx.rootCnt, {}, 0u}.calcMeshIndexOffset();
+	const uint64_t nameHash = core::BAWFileV1::hashMeshName(_meshName);
+	const size_t nameLength = strlen(_meshName);
+	core::MeshIndexEntryV1 entry;
+
+	// find the first entry of matching hash, names have to be compared since different names may hash the same
+	uint32_t lo = 0u, hi = _ctx.rootCnt;
+	while (lo < hi)
+	{
+		const uint32_t mid = lo + (hi-lo)/2u;
+		_ctx.file->seek(indexOffset + mid*sizeof(core::MeshIndexEntryV1));
+		if (!safeRead(_ctx.file, &entry, sizeof(entry)))
+			return false;
+
+		if (entry.nameHash < nameHash)
+			lo = mid + 1u;
+		else
+			hi = mid;
+	}
+
+	core::array<char> name;
+	for (; lo < _ctx.rootCnt; ++lo)
+	{
+		_ctx.file->seek(indexOffset + lo*sizeof(core::MeshIndexEntryV1));
+		if (!safeRead(_ctx.file, &entry, sizeof(entry)))
+			return false;
+		if (entry.nameHash != nameHash)
+			break;
+		if (entry.nameLength != nameLength)
+			continue;
+		if (entry.nameOffset + entry.nameLength > uint64_t(_ctx.file->getSize()))
+			return false;
+
+		name.set_used(nameLength);
+		_ctx.file->seek(entry.nameOffset);
+		if (!safeRead(_ctx.file, name.pointer(), nameLength))
+			return false;
+		if (memcmp(name.const_pointer(), _meshName, nameLength) == 0)
+		{
+			*_outHandle = entry.handle;
+			return true;
+		}
+	}
+#ifdef _DEBUG
+	os::Printer::log("No mesh of such name in .baw archive", _meshName, ELL_WARNING);
+#endif
+	return false;
+}
+
+CBAWMeshFileLoader::SBlobData* CBAWMeshFileLoader::getBlobData(uint64_t _handle, SContext& _ctx) const
+{
+	std::unordered_map<uint64_t, SBlobData>::iterator found = _ctx.blobs.find(_handle);
+	if (found != _ctx.blobs.end())
+		return &found->second;
+	if (_ctx.fileVersion == core::BAWFileV0::VERSION) // all blobs of version 0 file are known upfront
+		return NULL;
+
+	const core::BAWFileV1 bawFile{{}, _ctx.blobCnt, _ctx.rootCnt, {}, 0u};
+	core::BlobHeaderV0 header;
+	uint32_t lo = 0u, hi = _ctx.blobCnt;
+	while (lo < hi)
+	{
+		const uint32_t mid = lo + (hi-lo)/2u;
+		_ctx.file->seek(bawFile.calcHeadersOffset() + mid*sizeof(core::BlobHeaderV0));
+		if (!safeRead(_ctx.file, &header, sizeof(header)))
+			return NULL;
+
+		if (header.handle < _handle)
+			lo = mid + 1u;
+		else if (_handle < header.handle)
+			hi = mid;
+		else
+		{
+			uint64_t offset;
+			_ctx.file->seek(bawFile.calcOffsetsOffset() + mid*sizeof(uint64_t));
+			if (!safeRead(_ctx.file, &offset, sizeof(offset)))
+				return NULL;
+			const uint64_t absOffset = bawFile.calcBlobsOffset() + offset;
+			if (offset >= _ctx.file->getSize() || absOffset + header.effectiveSize() > _ctx.file->getSize()) // whether blob doesn't "go out of file"
+				return NULL;
+
+			core::BlobHeaderV0* const hd = &(_ctx.lazyHeaders[_handle] = header);
+			return &_ctx.blobs.insert(std::make_pair(_handle, SBlobData(hd, absOffset))).first->second;
+		}
+	}
+	return NULL;
+}
+
 bool CBAWMeshFileLoader::safeRead(io::IReadFile * _file, void * _buf, size_t _size) const
 {
 	if (_file->getPos() + _size > _file->getSize())
@@ -305,6 +473,189 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData & _data, SContext &
 	return dst;
 }
 
+void* CBAWMeshFileLoader::loadBlobsParallel(SBlobData* _root, SContext& _ctx, unsigned char _pwd[16], uint32_t _threadCnt, const core::BlobLoadingParams& _params) const
+{
+	// blobs in order of discovery (breadth-first), each level of dependency graph is decoded concurrently
+	std::vector<SBlobData*> loadOrder;
+	std::unordered_map<uint64_t, std::unordered_set<uint64_t> > depsOf;
+	std::unordered_set<uint64_t> discovered;
+
+	std::vector<SBlobData*> level(1, _root);
+	discovered.insert(_root->header->handle);
+	while (!level.empty())
+	{
+		// IReadFile is not thread-safe, so reading stays on this thread
+		std::vector<void*> raw(level.size());
+		for (size_t i = 0u; i < level.size(); ++i)
+		{
+			if ((level[i]->heapBlob = tryGetMappedBlob(*level[i], _ctx)))
+			{
+				level[i]->mapped = true;
+				raw[i] = NULL;
+			}
+			else
+				raw[i] = readRawBlob(*level[i], _ctx);
+		}
+
+		std::atomic<size_t> next(0u);
+		auto decodeJob = [&](const uint32_t&) {
+			for (size_t i = next++; i < level.size(); i = next++)
+			{
+				if (!raw[i]) // mapped, needs validation only
+				{
+					if (!level[i]->header->validate(level[i]->heapBlob))
+						level[i]->releaseBlob();
+				}
+				else
+					level[i]->heapBlob = decodeRawBlob(*level[i], raw[i], _ctx.iv, _pwd);
+			}
+		};
+		m_decodingWorkers.run(std::min<size_t>(_threadCnt, level.size()), decodeJob); // calling thread decodes too
+
+		std::vector<SBlobData*> nextLevel;
+		for (size_t i = 0u; i < level.size(); ++i)
+		{
+			if (!level[i]->heapBlob)
+				return NULL;
+
+			const uint64_t handle = level[i]->header->handle;
+			std::unordered_set<uint64_t>& deps = depsOf[handle] = _ctx.loadingMgr.getNeededDeps(level[i]->header->blobType, level[i]->heapBlob);
+			for (std::unordered_set<uint64_t>::iterator it = deps.begin(); it != deps.end(); ++it)
+			{
+				if (!discovered.insert(*it).second)
+					continue;
+				SBlobData* const found = getBlobData(*it, _ctx);
+				if (!found)
+					return NULL;
+				nextLevel.push_back(found);
+			}
+			loadOrder.push_back(level[i]);
+		}
+		level.swap(nextLevel);
+	}
+
+	for (size_t i = 0u; i < loadOrder.size(); ++i)
+	{
+		const core::BlobHeaderV0* hd = loadOrder[i]->header;
+		if (!(_ctx.createdObjs[hd->handle] = _ctx.loadingMgr.instantiateEmpty(hd->blobType, loadOrder[i]->heapBlob, hd->blobSizeDecompr, _params)))
+		{
+			_ctx.createdObjs.erase(hd->handle);
+			_ctx.releaseLoadedObjects();
+			return NULL;
+		}
+	}
+
+	// finalize in post-order of dependency graph so that every object gets finalized after all of its dependencies
+	void* retval = NULL;
+	std::unordered_set<uint64_t> finalized;
+	std::stack<std::pair<SBlobData*, bool> > toFinalize;
+	toFinalize.push(std::make_pair(_root, false));
+	while (!toFinalize.empty())
+	{
+		SBlobData* data = toFinalize.top().first;
+		const uint64_t handle = data->header->handle;
+		if (finalized.find(handle) != finalized.end())
+		{
+			toFinalize.pop();
+			continue;
+		}
+		if (!toFinalize.top().second)
+		{
+			toFinalize.top().second = true;
+			const std::unordered_set<uint64_t>& deps = depsOf[handle];
+			for (std::unordered_set<uint64_t>::const_iterator it = deps.begin(); it != deps.end(); ++it)
+				if (finalized.find(*it) == finalized.end())
+					toFinalize.push(std::make_pair(&_ctx.blobs[*it], false));
+			continue;
+		}
+		toFinalize.pop();
+
+		retval = _ctx.loadingMgr.finalize(data->header->blobType, _ctx.createdObjs[handle], data->heapBlob, data->header->blobSizeDecompr, _ctx.createdObjs, _params); // last one will always be root
+		finalized.insert(handle);
+		data->releaseBlob();
+	}
+
+	return retval;
+}
+
+void* CBAWMeshFileLoader::tryGetMappedBlob(const SBlobData& _data, SContext& _ctx) const
+{
+	if (_data.header->compressionType != core::Blob::EBCT_RAW)
+		return NULL;
+	if (_ctx.mappedFile) // private mapping, blob may be written to
+		return (uint8_t*)_ctx.mappedFile->getMappedPointer() + _data.absOffset;
+
+	// blobs are only read from, so any contiguous view of the file will do
+	const uint8_t* const view = (const uint8_t*)_ctx.file->getMappedPointer();
+	if (!view || _data.absOffset + _data.header->effectiveSize() > _ctx.file->getSize())
+		return NULL;
+	return const_cast<uint8_t*>(view) + _data.absOffset;
+}
+
+void* CBAWMeshFileLoader::readRawBlob(const SBlobData& _data, SContext& _ctx) const
+{
+	void* raw = malloc(_data.header->effectiveSize());
+	_ctx.file->seek(_data.absOffset);
+	_ctx.file->read(raw, _data.header->effectiveSize());
+	return raw;
+}
+
+void* CBAWMeshFileLoader::decodeRawBlob(const SBlobData& _data, void* _raw, const unsigned char _iv[16], const unsigned char _pwd[16]) const
+{
+	if (!_data.header->validate(_raw))
+	{
+#ifdef _DEBUG
+		os::Printer::log("Blob validation failed!", ELL_ERROR);
+#endif
+		free(_raw);
+		return NULL;
+	}
+
+	if (_data.header->compressionType & core::Blob::EBCT_AES128_GCM)
+	{
+#ifdef _IRR_COMPILE_WITH_OPENSSL_
+		const size_t size = _data.header->effectiveSize();
+		void* out = malloc(size);
+		const bool ok = core::decAes128gcm(_raw, size, out, size, _pwd, _iv, _data.header->gcmTag);
+		free(_raw);
+		if (!ok)
+		{
+			free(out);
+#ifdef _DEBUG
+			os::Printer::log("Blob decryption failed!", ELL_ERROR);
+#endif
+			return NULL;
+		}
+		_raw = out;
+#else
+		free(_raw);
+		return NULL;
+#endif
+	}
+
+	const uint8_t comprType = _data.header->compressionType;
+	if (!(comprType & core::Blob::EBCT_LZ4) && !(comprType & core::Blob::EBCT_LZMA))
+		return _raw;
+
+	void* dst = malloc(_data.header->blobSizeDecompr);
+	bool res = false;
+	if (comprType & core::Blob::EBCT_LZ4)
+		res = decompressLz4(dst, _data.header->blobSizeDecompr, _raw, _data.header->blobSize);
+	else if (comprType & core::Blob::EBCT_LZMA)
+		res = decompressLzma(dst, _data.header->blobSizeDecompr, _raw, _data.header->blobSize);
+	free(_raw);
+
+	if (!res)
+	{
+		free(dst);
+#ifdef _DEBUG
+		os::Printer::log("Blob decompression failed!", ELL_ERROR);
+#endif
+		return NULL;
+	}
+	return dst;
+}
+
 bool CBAWMeshFileLoader::decompressLzma(void* _dst, size_t _dstSize, const void* _src, size_t _srcSize) const
 {
 	SizeT dstSize = _dstSize;
@@ -15,6 +15,8 @@
 #include "IMesh.h"
 #include "CBAWFile.h"
 #include "CBlobsLoadingManager.h"
+#include "CMappedReadFile.h"
+#include "CWorkerPool.h"
 
 namespace irr { namespace scene
 {
@@ -27,10 +29,18 @@ private:
 		core::BlobHeaderV0* header;
 		size_t absOffset; // absolute
 		void* heapBlob;
+		bool mapped; // heapBlob points into file's memory (see IReadFile::getMappedPointer()), not to malloc'd memory
 		mutable bool validated;
 
-		SBlobData(core::BlobHeaderV0* _hd=NULL, size_t _offset=0xdeadbeefdeadbeef) : header(_hd), absOffset(_offset), heapBlob(NULL), validated(false) {}
-		~SBlobData() { free(heapBlob); }
+		SBlobData(core::BlobHeaderV0* _hd=NULL, size_t _offset=0xdeadbeefdeadbeef) : header(_hd), absOffset(_offset), heapBlob(NULL), mapped(false), validated(false) {}
+		~SBlobData() { releaseBlob(); }
+		void releaseBlob()
+		{
+			if (!mapped)
+				free(heapBlob);
+			heapBlob = NULL;
+			mapped = false;
+		}
 		bool validate() const {
 			validated = false;
 			return validated ? true : (validated = (heapBlob && header->validate(heapBlob)));
@@ -48,20 +58,24 @@ private:
 			for (std::unordered_map<uint64_t, void*>::iterator it = createdObjs.begin(); it != createdObjs.end(); ++it)
 				loadingMgr.releaseObj(blobs[it->first].header->blobType, it->second);
 		}
-		void releaseAllButThisOne(std::unordered_map<uint64_t, SBlobData>::iterator _thisIt)
+		void releaseAllButThisOne(uint64_t _theHandle)
 		{
-			const uint64_t theHandle = _thisIt != blobs.end() ? _thisIt->second.header->handle : 0;
 			for (std::unordered_map<uint64_t, void*>::iterator it = createdObjs.begin(); it != createdObjs.end(); ++it)
 			{
-				if (it->first != theHandle)
+				if (it->first != _theHandle)
 					loadingMgr.releaseObj(blobs[it->first].header->blobType, it->second);
 			}
 		}
 
 		io::IReadFile* file;
+		io::CMappedReadFile* mappedFile; // set only if the file's memory may be aliased by loaded buffers
 		io::path filePath;
 		uint64_t fileVersion;
+		uint32_t blobCnt;
+		uint32_t rootCnt; // only in version 1 archives
+		uint64_t defaultMeshHandle; // only in version 1 archives
 		std::unordered_map<uint64_t, SBlobData> blobs;
+		std::unordered_map<uint64_t, core::BlobHeaderV0> lazyHeaders; // headers of version 1 archives are read on demand
 		std::unordered_map<uint64_t, void*> createdObjs;
 		core::CBlobsLoadingManager loadingMgr;
 		unsigned char iv[16];
@@ -85,6 +99,20 @@ public:
 	See IReferenceCounted::drop() for more information.*/
 	virtual ICPUMesh* createMesh(io::IReadFile* file);
 	ICPUMesh* createMesh(io::IReadFile* file, unsigned char pwd[16]);
+	//! Loads mesh of given name from multi-mesh .baw archive (file version 1).
+	/** Only the requested mesh and its dependencies are read from the file.
+	@param _meshName Name the mesh was written with (see CBAWMeshWriter::writeMeshes()). If NULL, the first mesh passed to CBAWMeshWriter::writeMeshes() is loaded.
+	Files of version 0 contain single unnamed mesh, so for them only NULL name is accepted.
+	@returns Pointer to the created mesh or NULL if loading failed or there's no mesh of such name.*/
+	ICPUMesh* createMesh(io::IReadFile* _file, const char* _meshName, unsigned char _pwd[16]);
+
+	//! Sets number of threads used to decrypt and decompress blobs.
+	/** Blobs are read from file on the calling thread, but decoding of blobs independent of each other (i.e. being on the same depth of dependency graph)
+	is spread across `_cnt` worker threads. Objects are still instantiated and finalized on the calling thread in topological order.
+	Worker threads are created on first parallel load and live as long as the loader. A load started while another thread's load is using the workers decodes on its own thread only.
+	@param _cnt Number of threads. 1 (default) means fully serial loading, 0 means as many threads as hardware supports.*/
+	void setDecodingThreadCount(uint32_t _cnt) { m_decodingThreadCnt = _cnt; }
+	uint32_t getDecodingThreadCount() const { return m_decodingThreadCnt; }
 
 private:
 	//! Verifies whether given file is of appropriate format. Also reads file version and assigns it to passed context object.
@@ -92,6 +120,14 @@ private:
 	//! Loads and checks correctness of offsets and headers. Also let us know blob count.
 	/** @returns true if everythings ok, false otherwise. */
 	bool validateHeaders(uint32_t* _blobCnt, uint32_t** _offsets, void** _headers, SContext& _ctx);
+	//! Reads fixed-size part of version 1 archive (blob and mesh counts, init vector) to context.
+	bool readHeaderV1(SContext& _ctx) const;
+	//! Binary-searches mesh index of version 1 archive for mesh of given name.
+	/** @returns true and assigns `_outHandle` if mesh was found, false otherwise.*/
+	bool findRootMeshV1(const char* _meshName, uint64_t* _outHandle, SContext& _ctx) const;
+	//! Finds blob of given handle. In case of version 1 archive, its header and offset are read from file on first request.
+	/** @returns Pointer to blob data stored in `_ctx` or NULL if there's no such blob or its header/offset is corrupted.*/
+	SBlobData* getBlobData(uint64_t _handle, SContext& _ctx) const;
 
 	//! Reads `_size` bytes to `_buf` from `_file`, but previously checks whether file is big enough and returns true/false appropriately.
 	bool safeRead(io::IReadFile* _file, void* _buf, size_t _size) const;
@@ -100,12 +136,30 @@ private:
 	/** @returns `_stackPtr` if blob was read to it or pointer to malloc'd memory otherwise.*/
 	void* tryReadBlobOnStack(const SBlobData& _data, SContext& _ctx, unsigned char pwd[16], void* _stackPtr=NULL, size_t _stackSize=0) const;
 
+	//! Loads whole dependency graph of `_root` reading blobs serially and decoding them on worker threads, then instantiates and finalizes objects.
+	/** @returns Pointer to finalized `_root` object or NULL if loading failed.*/
+	void* loadBlobsParallel(SBlobData* _root, SContext& _ctx, unsigned char pwd[16], uint32_t _threadCnt, const core::BlobLoadingParams& _params) const;
+
+	//! Returns pointer to blob data inside of file's memory (mapped file, memory file) if blob doesn't need any decoding, NULL otherwise. Blob is not validated.
+	void* tryGetMappedBlob(const SBlobData& _data, SContext& _ctx) const;
+
+	//! Reads (without any decoding) blob data to malloc'd memory. Caller takes ownership of returned memory.
+	void* readRawBlob(const SBlobData& _data, SContext& _ctx) const;
+
+	//! Validates, decrypts and decompresses blob data read by readRawBlob(). Takes ownership of `_raw`.
+	/** Does not touch the file, so it's safe to call concurrently for different blobs.
+	@returns Pointer to malloc'd decoded blob or NULL if any stage failed.*/
+	void* decodeRawBlob(const SBlobData& _data, void* _raw, const unsigned char _iv[16], const unsigned char _pwd[16]) const;
+
 	bool decompressLzma(void* _dst, size_t _dstSize, const void* _src, size_t _srcSize) const;
 	bool decompressLz4(void* _dst, size_t _dstSize, const void* _src, size_t _srcSize) const;
 
 private:
 	scene::ISceneManager* m_sceneMgr;
 	io::IFileSystem* m_fileSystem;
+	uint32_t m_decodingThreadCnt;
+	//! kept alive between loads and dependency levels, so threads aren't created for every level of every mesh
+	mutable core::CWorkerPool m_decodingWorkers;
 };
 
 }} // irr::scene
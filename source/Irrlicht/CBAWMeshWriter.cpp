@@ -15,9 +15,11 @@
 #include "CFinalBoneHierarchy.h"
 #include "os.h"
 #include "lz4/lz4.h"
+#include "lz4/xxhash.h"
 #include "lzma/LzmaEnc.h"
 
-#define BAW_FILE_VERSION 0
+#include <algorithm>
+#include <sstream>
 
 
 namespace irr {namespace scene {
@@ -95,6 +97,10 @@ namespace irr {namespace scene {
 	void CBAWMeshWriter::exportAsBlob<IMeshDataFormatDesc<core::ICPUBuffer> >(IMeshDataFormatDesc<core::ICPUBuffer>* _obj, uint32_t _headerIdx, io::IWriteFile* _file, SContext& _ctx, bool _compress)
 	{
 		core::MeshDataFormatDescBlobV0 data(_obj);
+		// duplicate buffers are not written, so refer to their written twins instead
+		for (int attId = 0; attId < EVAI_COUNT; ++attId)
+			data.attrBufPtrs[attId] = resolveBufferHandle(data.attrBufPtrs[attId], _ctx);
+		data.idxBufPtr = resolveBufferHandle(data.idxBufPtr, _ctx);
 
 		tryWrite(&data, _file, _ctx, sizeof(data), _headerIdx, _compress);
 	}
@@ -124,112 +130,234 @@ namespace irr {namespace scene {
 			return false;
 		}
 
-		const uint32_t FILE_HEADER_SIZE = 32;
-		_IRR_DEBUG_BREAK_IF(FILE_HEADER_SIZE != sizeof(core::BAWFileV0::fileHeader))
-
-		uint64_t header[4];
-		memcpy(header, BAW_FILE_HEADER, FILE_HEADER_SIZE);
-		header[3] = BAW_FILE_VERSION;
-
-		_file->write(header, FILE_HEADER_SIZE);
+		writeFileHeader(_file, core::BAWFileV0::VERSION);
 
 		SContext ctx; // context of this call of `writeMesh`
 		ctx.props = &_propsStruct;
 
 		const uint32_t numOfInternalBlobs = genHeaders(_mesh, ctx);
-		const uint32_t OFFSETS_FILE_OFFSET = FILE_HEADER_SIZE + sizeof(uint32_t) + sizeof(core::BAWFileV0::iv);
-		const uint32_t HEADERS_FILE_OFFSET = OFFSETS_FILE_OFFSET + numOfInternalBlobs * sizeof(ctx.offsets[0]);
+		reportDeduplication(_propsStruct, ctx);
+		const uint32_t OFFSETS_FILE_OFFSET = core::BAWFileV0{{}, numOfInternalBlobs, {}, {}}.calcOffsetsOffset();
+		const uint32_t HEADERS_FILE_OFFSET = core::BAWFileV0{{}, numOfInternalBlobs, {}, {}}.calcHeadersOffset();
 
-		ctx.offsets.set_used(numOfInternalBlobs);
+		core::array<uint32_t> offsets; // version 0 of the format stores offsets as 32bit values
+		offsets.set_used(numOfInternalBlobs);
 
 		_file->write(&numOfInternalBlobs, sizeof(numOfInternalBlobs));
 		//_file->write(ctx.pwdVer, 2);
 		_file->write(_propsStruct.initializationVector, 16);
 		// will be overwritten after actually calculating offsets
-		_file->write(ctx.offsets.const_pointer(), ctx.offsets.size() * sizeof(ctx.offsets[0]));
+		_file->write(offsets.const_pointer(), offsets.size() * sizeof(offsets[0]));
 
 		// will be overwritten after calculating not known yet data (hash and size for texture paths)
 		_file->write(ctx.headers.const_pointer(), ctx.headers.size() * sizeof(core::BlobHeaderV0));
 
-		ctx.offsets.set_used(0); // set `used` to 0, to allow push starting from 0 index
-		for (int i = 0; i < ctx.headers.size(); ++i)
+		exportBlobs(_file, ctx);
+
+		const size_t prevPos = _file->getPos();
+
+		for (uint32_t i = 0; i < numOfInternalBlobs; ++i)
+			offsets[i] = ctx.offsets[i];
+		// overwrite offsets
+		_file->seek(OFFSETS_FILE_OFFSET);
+		_file->write(offsets.const_pointer(), offsets.size() * sizeof(offsets[0]));
+		// overwrite headers
+		_file->seek(HEADERS_FILE_OFFSET);
+		_file->write(ctx.headers.const_pointer(), ctx.headers.size() * sizeof(core::BlobHeaderV0));
+
+		_file->seek(prevPos);
+
+		return true;
+	}
+
+	bool CBAWMeshWriter::writeMeshes(io::IWriteFile* _file, const core::array<ICPUMesh*>& _meshes, const core::array<io::path>& _names, WriteProperties& _propsStruct)
+	{
+		if (!_file || !_meshes.size() || _meshes.size() != _names.size() || _propsStruct.blobLz4ComprThresh > _propsStruct.blobLzmaComprThresh)
 		{
-			switch (ctx.headers[i].blobType)
+#ifdef _DEBUG
+			if (_propsStruct.blobLz4ComprThresh > _propsStruct.blobLzmaComprThresh)
+				os::Printer::log("LZMA threshold must be greater or equal LZ4 threshold!", ELL_ERROR);
+#endif
+			return false;
+		}
+
+		SContext ctx; // context of this call of `writeMeshes`
+		ctx.props = &_propsStruct;
+
+		core::array<core::MeshIndexEntryV1> meshIndex;
+		std::unordered_set<const IReferenceCounted*> countedObjects;
+		for (uint32_t i = 0; i < _meshes.size(); ++i)
+		{
+			if (!_meshes[i])
+				return false;
+			genHeaders(_meshes[i], ctx, countedObjects);
+
+			core::MeshIndexEntryV1 entry;
+			entry.nameHash = core::BAWFileV1::hashMeshName(_names[i].c_str());
+			entry.handle = reinterpret_cast<uint64_t>(_meshes[i]);
+			entry.nameOffset = i; // index of the name until names get written
+			entry.nameLength = _names[i].size();
+			meshIndex.push_back(entry);
+		}
+		reportDeduplication(_propsStruct, ctx);
+
+		struct {
+			const core::array<io::path>* names;
+			bool operator()(const core::MeshIndexEntryV1& _a, const core::MeshIndexEntryV1& _b) const
+			{
+				if (_a.nameHash != _b.nameHash)
+					return _a.nameHash < _b.nameHash;
+				return (*names)[_a.nameOffset] < (*names)[_b.nameOffset];
+			}
+			bool operator()(const core::BlobHeaderV0& _a, const core::BlobHeaderV0& _b) const { return _a.handle < _b.handle; }
+		} lessKey;
+		lessKey.names = &_names;
+		std::sort(meshIndex.pointer(), meshIndex.pointer() + meshIndex.size(), lessKey);
+		std::sort(ctx.headers.pointer(), ctx.headers.pointer() + ctx.headers.size(), lessKey);
+		for (uint32_t i = 1; i < meshIndex.size(); ++i)
+		{
+			if (meshIndex[i-1].nameHash == meshIndex[i].nameHash && _names[meshIndex[i-1].nameOffset] == _names[meshIndex[i].nameOffset])
+			{
+#ifdef _DEBUG
+				os::Printer::log("Mesh names in .baw archive must be unique!", ELL_ERROR);
+#endif
+				return false;
+			}
+		}
+
+		writeFileHeader(_file, core::BAWFileV1::VERSION);
+
+		core::BAWFileV1 fileV1;
+		fileV1.numOfInternalBlobs = ctx.headers.size();
+		fileV1.numOfRootMeshes = meshIndex.size();
+		fileV1.defaultMeshHandle = reinterpret_cast<uint64_t>(_meshes[0]);
+		_file->write(&fileV1.numOfInternalBlobs, sizeof(fileV1.numOfInternalBlobs));
+		_file->write(&fileV1.numOfRootMeshes, sizeof(fileV1.numOfRootMeshes));
+		_file->write(_propsStruct.initializationVector, 16);
+		_file->write(&fileV1.defaultMeshHandle, sizeof(fileV1.defaultMeshHandle));
+		// will be overwritten after writing names
+		_file->write(meshIndex.const_pointer(), meshIndex.size() * sizeof(core::MeshIndexEntryV1));
+
+		ctx.offsets.set_used(fileV1.numOfInternalBlobs);
+		// will be overwritten after actually calculating offsets
+		_file->write(ctx.offsets.const_pointer(), ctx.offsets.size() * sizeof(ctx.offsets[0]));
+		// will be overwritten after calculating not known yet data (hash and size for texture paths)
+		_file->write(ctx.headers.const_pointer(), ctx.headers.size() * sizeof(core::BlobHeaderV0));
+
+		exportBlobs(_file, ctx);
+
+		for (uint32_t i = 0; i < meshIndex.size(); ++i)
+		{
+			const io::path& name = _names[meshIndex[i].nameOffset];
+			meshIndex[i].nameOffset = _file->getPos();
+			_file->write(name.c_str(), name.size());
+		}
+
+		const size_t prevPos = _file->getPos();
+
+		// overwrite mesh index
+		_file->seek(fileV1.calcMeshIndexOffset());
+		_file->write(meshIndex.const_pointer(), meshIndex.size() * sizeof(core::MeshIndexEntryV1));
+		// overwrite offsets
+		_file->seek(fileV1.calcOffsetsOffset());
+		_file->write(ctx.offsets.const_pointer(), ctx.offsets.size() * sizeof(ctx.offsets[0]));
+		// overwrite headers
+		_file->seek(fileV1.calcHeadersOffset());
+		_file->write(ctx.headers.const_pointer(), ctx.headers.size() * sizeof(core::BlobHeaderV0));
+
+		_file->seek(prevPos);
+
+		return true;
+	}
+
+	void CBAWMeshWriter::writeFileHeader(io::IWriteFile* _file, uint64_t _version) const
+	{
+		const uint32_t FILE_HEADER_SIZE = 32;
+		_IRR_DEBUG_BREAK_IF(FILE_HEADER_SIZE != sizeof(core::BAWFileV0::fileHeader))
+
+		uint64_t header[4];
+		memcpy(header, BAW_FILE_HEADER, FILE_HEADER_SIZE);
+		header[3] = _version;
+
+		_file->write(header, FILE_HEADER_SIZE);
+	}
+
+	void CBAWMeshWriter::exportBlobs(io::IWriteFile* _file, SContext& _ctx)
+	{
+		const WriteProperties& props = *_ctx.props;
+
+		_ctx.offsets.set_used(0); // set `used` to 0, to allow push starting from 0 index
+		for (int i = 0; i < _ctx.headers.size(); ++i)
+		{
+			switch (_ctx.headers[i].blobType)
 			{
 			case core::Blob::EBT_MESH:
-				exportAsBlob(reinterpret_cast<ICPUMesh*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_MESHES));
+				exportAsBlob(reinterpret_cast<ICPUMesh*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_MESHES));
 				break;
 			case core::Blob::EBT_SKINNED_MESH:
-				exportAsBlob(reinterpret_cast<ICPUSkinnedMesh*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_MESHES));
+				exportAsBlob(reinterpret_cast<ICPUSkinnedMesh*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_MESHES));
 				break;
 			case core::Blob::EBT_MESH_BUFFER:
-				exportAsBlob(reinterpret_cast<ICPUMeshBuffer*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_MESH_BUFFERS));
+				exportAsBlob(reinterpret_cast<ICPUMeshBuffer*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_MESH_BUFFERS));
 				break;
 			case core::Blob::EBT_SKINNED_MESH_BUFFER:
-				exportAsBlob(reinterpret_cast<SCPUSkinMeshBuffer*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_MESH_BUFFERS));
+				exportAsBlob(reinterpret_cast<SCPUSkinMeshBuffer*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_MESH_BUFFERS));
 				break;
 			case core::Blob::EBT_RAW_DATA_BUFFER:
-				exportAsBlob(reinterpret_cast<core::ICPUBuffer*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_RAW_BUFFERS));
+				exportAsBlob(reinterpret_cast<core::ICPUBuffer*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_RAW_BUFFERS));
 				break;
 			case core::Blob::EBT_DATA_FORMAT_DESC:
-				exportAsBlob(reinterpret_cast<IMeshDataFormatDesc<core::ICPUBuffer>*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_DATA_FORMAT_DESC));
+				exportAsBlob(reinterpret_cast<IMeshDataFormatDesc<core::ICPUBuffer>*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_DATA_FORMAT_DESC));
 				break;
 			case core::Blob::EBT_FINAL_BONE_HIERARCHY:
-				exportAsBlob(reinterpret_cast<CFinalBoneHierarchy*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_ANIMATION_DATA));
+				exportAsBlob(reinterpret_cast<CFinalBoneHierarchy*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_ANIMATION_DATA));
 				break;
 			case core::Blob::EBT_TEXTURE_PATH:
-				exportAsBlob(reinterpret_cast<video::IVirtualTexture*>(ctx.headers[i].handle), i, _file, ctx, toEncrypt(_propsStruct, EET_TEXTURE_PATHS));
+				exportAsBlob(reinterpret_cast<video::IVirtualTexture*>(_ctx.headers[i].handle), i, _file, _ctx, toEncrypt(props, EET_TEXTURE_PATHS));
 				break;
 			}
 		}
+	}
 
-		const size_t prevPos = _file->getPos();
-
-		// overwrite offsets
-		_file->seek(OFFSETS_FILE_OFFSET);
-		_file->write(ctx.offsets.const_pointer(), ctx.offsets.size() * sizeof(ctx.offsets[0]));
-		// overwrite headers
-		_file->seek(HEADERS_FILE_OFFSET);
-		_file->write(ctx.headers.const_pointer(), ctx.headers.size() * sizeof(core::BlobHeaderV0));
+	uint32_t CBAWMeshWriter::genHeaders(ICPUMesh* _mesh, SContext& _ctx)
+	{
+		_ctx.headers.clear();
 
-		_file->seek(prevPos);
+		std::unordered_set<const IReferenceCounted*> countedObjects;
+		genHeaders(_mesh, _ctx, countedObjects);
 
-		return true;
+		return _ctx.headers.size();
 	}
 
-	uint32_t CBAWMeshWriter::genHeaders(ICPUMesh* _mesh, SContext& _ctx)
+	void CBAWMeshWriter::genHeaders(ICPUMesh* _mesh, SContext& _ctx, std::unordered_set<const IReferenceCounted*>& _countedObjects)
 	{
-		_ctx.headers.clear();
+		if (!_mesh || _countedObjects.find(_mesh) != _countedObjects.end())
+			return;
 
 		bool isMeshAnimated = true;
 		ICPUSkinnedMesh* skinnedMesh = 0;
 
-		if (_mesh)
-		{
-			skinnedMesh = _mesh->getMeshType()!=EMT_ANIMATED_SKINNED ? NULL:dynamic_cast<ICPUSkinnedMesh*>(_mesh); //ICPUSkinnedMesh is a direct non-virtual inheritor
-			if (!skinnedMesh || (skinnedMesh && skinnedMesh->isStatic()))
-				isMeshAnimated = false;
+		skinnedMesh = _mesh->getMeshType()!=EMT_ANIMATED_SKINNED ? NULL:dynamic_cast<ICPUSkinnedMesh*>(_mesh); //ICPUSkinnedMesh is a direct non-virtual inheritor
+		if (!skinnedMesh || (skinnedMesh && skinnedMesh->isStatic()))
+			isMeshAnimated = false;
 
-			core::BlobHeaderV0 bh;
-			bh.handle = reinterpret_cast<uint64_t>(_mesh);
-			bh.compressionType = core::Blob::EBCT_RAW;
-			bh.blobType = isMeshAnimated ? core::Blob::EBT_SKINNED_MESH : core::Blob::EBT_MESH;
-			_ctx.headers.push_back(bh);
-			// no need to add to `countedObjects` set since there's only one mesh
-		}
-		else return 0;
+		core::BlobHeaderV0 bh;
+		bh.handle = reinterpret_cast<uint64_t>(_mesh);
+		bh.compressionType = core::Blob::EBCT_RAW;
+		bh.blobType = isMeshAnimated ? core::Blob::EBT_SKINNED_MESH : core::Blob::EBT_MESH;
+		_ctx.headers.push_back(bh);
+		_countedObjects.insert(_mesh);
 
-		if (isMeshAnimated)
+		if (isMeshAnimated && _countedObjects.find(skinnedMesh->getBoneReferenceHierarchy()) == _countedObjects.end())
 		{
 			core::BlobHeaderV0 bh;
 			bh.handle = reinterpret_cast<uint64_t>(skinnedMesh->getBoneReferenceHierarchy());
 			bh.compressionType = core::Blob::EBCT_RAW;
 			bh.blobType = core::Blob::EBT_FINAL_BONE_HIERARCHY;
 			_ctx.headers.push_back(bh);
-			// no need to add to `countedObjects` set since there's only one bone hierarchy
+			_countedObjects.insert(skinnedMesh->getBoneReferenceHierarchy());
 		}
 
-		std::unordered_set<const IReferenceCounted*> countedObjects;
 		for (uint32_t i = 0; i < _mesh->getMeshBufferCount(); ++i)
 		{
 			const ICPUMeshBuffer* const meshBuffer = _mesh->getMeshBuffer(i);
@@ -238,68 +366,98 @@ namespace irr {namespace scene {
 			if (!meshBuffer || !desc)
 				continue;
 
-			if (countedObjects.find(meshBuffer) == countedObjects.end())
+			if (_countedObjects.find(meshBuffer) == _countedObjects.end())
 			{
 				core::BlobHeaderV0 bh;
 				bh.handle = reinterpret_cast<uint64_t>(meshBuffer);
 				bh.compressionType = core::Blob::EBCT_RAW;
 				bh.blobType = isMeshAnimated ? core::Blob::EBT_SKINNED_MESH_BUFFER : core::Blob::EBT_MESH_BUFFER;
 				_ctx.headers.push_back(bh);
-				countedObjects.insert(meshBuffer);
+				_countedObjects.insert(meshBuffer);
 
 				const video::SMaterial & mat = meshBuffer->getMaterial();
 				for (int tid = 0; tid < _IRR_MATERIAL_MAX_TEXTURES_; ++tid) // texture path blob headers
 				{
 					video::IVirtualTexture* texture = mat.getTexture(tid);
-					if (mat.getTexture(tid) && countedObjects.find(texture) == countedObjects.end())
+					if (mat.getTexture(tid) && _countedObjects.find(texture) == _countedObjects.end())
 					{
 						bh.handle = reinterpret_cast<uint64_t>(texture);
 						bh.compressionType = core::Blob::EBCT_RAW;
 						bh.blobType = core::Blob::EBT_TEXTURE_PATH;
 						_ctx.headers.push_back(bh);
-						countedObjects.insert(texture);
+						_countedObjects.insert(texture);
 					}
 					else continue;
 				}
 			}
 
-			if (countedObjects.find(desc) == countedObjects.end())
+			if (_countedObjects.find(desc) == _countedObjects.end())
 			{
 				core::BlobHeaderV0 bh;
 				bh.handle = reinterpret_cast<uint64_t>(desc);
 				bh.compressionType = core::Blob::EBCT_RAW;
 				bh.blobType = core::Blob::EBT_DATA_FORMAT_DESC;
 				_ctx.headers.push_back(bh);
-				countedObjects.insert(desc);
+				_countedObjects.insert(desc);
 			}
 
-			const core::ICPUBuffer* idxBuffer = desc->getIndexBuffer();
-			if (idxBuffer && countedObjects.find(idxBuffer) == countedObjects.end())
-			{
-				core::BlobHeaderV0 bh;
-				bh.handle = reinterpret_cast<uint64_t>(idxBuffer);
-				bh.compressionType = core::Blob::EBCT_RAW;
-				bh.blobType = core::Blob::EBT_RAW_DATA_BUFFER;
-				_ctx.headers.push_back(bh);
-				countedObjects.insert(desc->getIndexBuffer());
-			}
+			genBufferHeader(desc->getIndexBuffer(), _ctx, _countedObjects);
 
 			for (int attId = 0; attId < EVAI_COUNT; ++attId)
+				genBufferHeader(desc->getMappedBuffer((E_VERTEX_ATTRIBUTE_ID)attId), _ctx, _countedObjects);
+		}
+	}
+
+	void CBAWMeshWriter::genBufferHeader(const core::ICPUBuffer* _buf, SContext& _ctx, std::unordered_set<const IReferenceCounted*>& _countedObjects) const
+	{
+		if (!_buf || _countedObjects.find(_buf) != _countedObjects.end())
+			return;
+		_countedObjects.insert(_buf);
+		++_ctx.dedupStats.bufferCnt;
+
+		if (_ctx.props->deduplicateBuffers)
+		{
+			const uint64_t hash = XXH64(_buf->getPointer(), _buf->getSize(), 0ull);
+			typedef std::unordered_multimap<uint64_t, const core::ICPUBuffer*>::const_iterator HashIter;
+			const std::pair<HashIter, HashIter> candidates = _ctx.bufferHashes.equal_range(hash);
+			for (HashIter it = candidates.first; it != candidates.second; ++it)
 			{
-				const core::ICPUBuffer* attBuffer = desc->getMappedBuffer((E_VERTEX_ATTRIBUTE_ID)attId);
-				if (attBuffer && countedObjects.find(attBuffer) == countedObjects.end())
+				const core::ICPUBuffer* twin = it->second;
+				if (twin->getSize() == _buf->getSize() && memcmp(twin->getPointer(), _buf->getPointer(), _buf->getSize()) == 0)
 				{
-					core::BlobHeaderV0 bh;
-					bh.handle = reinterpret_cast<uint64_t>(attBuffer);
-					bh.compressionType = core::Blob::EBCT_RAW;
-					bh.blobType = core::Blob::EBT_RAW_DATA_BUFFER;
-					bh.blobSize = bh.blobSizeDecompr = attBuffer->getSize();
-					_ctx.headers.push_back(bh);
-					countedObjects.insert(attBuffer);
+					_ctx.bufferAliases[_buf] = twin;
+					++_ctx.dedupStats.duplicateCnt;
+					_ctx.dedupStats.bytesSaved += _buf->getSize();
+					return;
 				}
 			}
+			_ctx.bufferHashes.insert(std::make_pair(hash, _buf));
 		}
-		return _ctx.headers.size();
+
+		core::BlobHeaderV0 bh;
+		bh.handle = reinterpret_cast<uint64_t>(_buf);
+		bh.compressionType = core::Blob::EBCT_RAW;
+		bh.blobType = core::Blob::EBT_RAW_DATA_BUFFER;
+		bh.blobSize = bh.blobSizeDecompr = _buf->getSize();
+		_ctx.headers.push_back(bh);
+	}
+
+	uint64_t CBAWMeshWriter::resolveBufferHandle(uint64_t _bufHandle, const SContext& _ctx) const
+	{
+		const std::unordered_map<const core::ICPUBuffer*, const core::ICPUBuffer*>::const_iterator found = _ctx.bufferAliases.find(reinterpret_cast<const core::ICPUBuffer*>(_bufHandle));
+		return found != _ctx.bufferAliases.end() ? reinterpret_cast<uint64_t>(found->second) : _bufHandle;
+	}
+
+	void CBAWMeshWriter::reportDeduplication(WriteProperties& _propsStruct, const SContext& _ctx) const
+	{
+		_propsStruct.deduplicationStats = _ctx.dedupStats;
+		if (!_ctx.dedupStats.duplicateCnt)
+			return;
+
+		std::ostringstream tmpString("Buffer deduplication: ");
+		tmpString.seekp(0, std::ios_base::end);
+		tmpString << _ctx.dedupStats.duplicateCnt << " of " << _ctx.dedupStats.bufferCnt << " buffers were duplicates, " << _ctx.dedupStats.bytesSaved << " bytes saved";
+		os::Printer::log(tmpString.str(), ELL_INFORMATION);
 	}
 
 	void CBAWMeshWriter::calcAndPushNextOffset(uint32_t _blobSize, SContext& _ctx) const
@@ -38,11 +38,25 @@ namespace scene
 			EET_EVERYTHING = 0xffffffffu
 		};
 
+		//! Statistics of raw data buffers deduplication.
+		/** @see @ref WriteProperties::deduplicateBuffers
+		*/
+		struct SDeduplicationStats
+		{
+			SDeduplicationStats() : bufferCnt(0u), duplicateCnt(0u), bytesSaved(0u) {}
+			//! Number of distinct buffer objects referenced by exported meshes
+			uint32_t bufferCnt;
+			//! Number of buffers which were not written because buffer of identical contents has already been written
+			uint32_t duplicateCnt;
+			//! Sum of sizes (before compression) of buffers which were not written
+			uint64_t bytesSaved;
+		};
+
 		//! Settings struct for mesh export
 		struct WriteProperties
 		{
 			//! Default constructor
-			WriteProperties() : blobLz4ComprThresh(4096u), blobLzmaComprThresh(32768u), encryptBlobBitField(EET_RAW_BUFFERS | EET_ANIMATION_DATA | EET_TEXTURES) {}
+			WriteProperties() : blobLz4ComprThresh(4096u), blobLzmaComprThresh(32768u), encryptBlobBitField(EET_RAW_BUFFERS | EET_ANIMATION_DATA | EET_TEXTURES), deduplicateBuffers(true) {}
 			//! Size of blob threshold to be compressed with LZ4. Defaulted to 4096 bytes.
 			size_t blobLz4ComprThresh;
 			//! Size of blob threshold to be compressed with LZMA. Shall always be higher than LZ4 threshold. Defaulted to 32768 bytes.
@@ -55,14 +69,23 @@ namespace scene
 			uint64_t encryptBlobBitField;
 			//! Directory to which texture paths will be relative in output mesh file
 			io::path relPath;
+			//! Whether buffers of identical contents (compared by 64bit hash and then byte-wise) are to be written only once and shared by all data format descriptors referencing any of them. Defaulted to true.
+			bool deduplicateBuffers;
+			//! Output of the writer, filled with statistics of buffers deduplication done during the last write.
+			SDeduplicationStats deduplicationStats;
 		};
 
 	private:
 		struct SContext
 		{
 			core::array<core::BlobHeaderV0> headers;
-			core::array<uint32_t> offsets;
+			core::array<uint64_t> offsets;
 			const WriteProperties* props;
+			//! Maps duplicate buffers to buffers of identical contents which are actually written
+			std::unordered_map<const core::ICPUBuffer*, const core::ICPUBuffer*> bufferAliases;
+			//! Buffers to be written by hash of their contents
+			std::unordered_multimap<uint64_t, const core::ICPUBuffer*> bufferHashes;
+			SDeduplicationStats dedupStats;
 		};
 
 	protected:
@@ -78,6 +101,14 @@ namespace scene
 		bool writeMesh(io::IWriteFile* file, scene::ICPUMesh* mesh, int32_t flags = EMWF_NONE);
 		bool writeMesh(io::IWriteFile* file, scene::ICPUMesh* mesh, WriteProperties& propsStruct);
 
+		//! Writes many meshes to single .baw archive (file version 1).
+		/** Objects referenced by more than one mesh (buffers, bone hierarchies, textures...) are written only once.
+		Any of the meshes can be later loaded by its name with CBAWMeshFileLoader::createMesh(io::IReadFile*, const char*, unsigned char[16]).
+		@param _meshes Meshes to write.
+		@param _names Names of meshes, must be unique and there must be as many as meshes.
+		@returns True on success, false otherwise.*/
+		bool writeMeshes(io::IWriteFile* _file, const core::array<ICPUMesh*>& _meshes, const core::array<io::path>& _names, WriteProperties& _propsStruct);
+
 	private:
 		//! Takes object and exports (writes to file) its data as another blob.
 		/** @param _obj Pointer to object which is to be exported.
@@ -91,6 +122,20 @@ namespace scene
 		@param _mesh Pointer to the mesh object.
 		@return Amount of generated headers.*/
 		uint32_t genHeaders(ICPUMesh* _mesh, SContext& _ctx);
+		//! Pushes blob headers of `_mesh` and all its dependencies not present in `_countedObjects` yet.
+		void genHeaders(ICPUMesh* _mesh, SContext& _ctx, std::unordered_set<const IReferenceCounted*>& _countedObjects);
+		//! Pushes header of raw data buffer, unless it has been already counted or (if deduplication is enabled) buffer of identical contents is to be written.
+		void genBufferHeader(const core::ICPUBuffer* _buf, SContext& _ctx, std::unordered_set<const IReferenceCounted*>& _countedObjects) const;
+		//! @returns Handle of the buffer which is actually written in place of `_bufHandle`.
+		uint64_t resolveBufferHandle(uint64_t _bufHandle, const SContext& _ctx) const;
+		//! Copies deduplication statistics of finished headers generation to `_propsStruct` and logs them.
+		void reportDeduplication(WriteProperties& _propsStruct, const SContext& _ctx) const;
+
+		//! Writes header of the file (the fixed 32-byte string along with version number).
+		void writeFileHeader(io::IWriteFile* _file, uint64_t _version) const;
+
+		//! Exports all objects described by `SContext::headers` as blobs, in order of headers.
+		void exportBlobs(io::IWriteFile* _file, SContext& _ctx);
 
 		//! Pushes new offset value to `SContext::offsets` array.
 		/** @param _blobSize Byte-distance from previous blob's first byte (i.e. size of previous blob).
@@ -98,7 +143,7 @@ namespace scene
 		void calcAndPushNextOffset(uint32_t _blobSize, SContext& _ctx) const;
 
 		//! Pushes corrupted offset so that, while loading resulting .baw file, it will be easy to find out something went wrong.
-		void pushCorruptedOffset(SContext& _ctx) const { _ctx.offsets.push_back(0xffffffff); }
+		void pushCorruptedOffset(SContext& _ctx) const { _ctx.offsets.push_back(0xffffffffffffffffull); }
 
 		//! Tries to write given data to file. If not possible (i.e. _data is NULL) - pushes "corrupted offset" and does not call .finalize() on blob-header.
 		void tryWrite(void* _data, io::IWriteFile* _file, SContext& _ctx, size_t _size, uint32_t _headerIdx, bool _encrypt) const;
@@ -6,6 +6,7 @@
 #define _C_BLIT_H_INCLUDED_
 
 #include "SoftwareDriver2_helper.h"
+#include "CColorConverter.h"
 
 namespace irr
 {
@@ -627,10 +628,7 @@ static void executeBlit_TextureCopy_16_to_32( const SBlitJob * job )
 	{
 		for ( uint32_t dy = 0; dy != h; ++dy )
 		{
-			for ( uint32_t dx = 0; dx != w; ++dx )
-			{
-				dst[dx] = video::A1R5G5B5toA8R8G8B8( src[dx] );
-			}
+			video::CColorConverter::convert_A1R5G5B5toA8R8G8B8(src, w, dst);
 
 			src = (uint16_t*) ( (uint8_t*) (src) + job->srcPitch );
 			dst = (uint32_t*) ( (uint8_t*) (dst) + job->dstPitch );
@@ -717,13 +715,7 @@ static void executeBlit_TextureCopy_24_to_32( const SBlitJob * job )
 	{
 		for ( int32_t dy = 0; dy != job->height; ++dy )
 		{
-			const uint8_t* s = src;
-
-			for ( int32_t dx = 0; dx != job->width; ++dx )
-			{
-				dst[dx] = 0xFF000000 | s[0] << 16 | s[1] << 8 | s[2];
-				s += 3;
-			}
+			video::CColorConverter::convert_R8G8B8toA8R8G8B8(src, w, dst);
 
 			src = src + job->srcPitch;
 			dst = (uint32_t*) ( (uint8_t*) (dst) + job->dstPitch );
@@ -763,13 +755,7 @@ static void executeBlit_TextureCopy_32_to_24( const SBlitJob * job )
 	{
 		for ( uint32_t dy = 0; dy != h; ++dy )
 		{
-			for ( uint32_t dx = 0; dx != w; ++dx )
-			{
-				uint8_t * writeTo = &dst[dx * 3];
-				*writeTo++ = (src[dx] >> 16)& 0xFF;
-				*writeTo++ = (src[dx] >> 8) & 0xFF;
-				*writeTo++ = src[dx] & 0xFF;
-			}
+			video::CColorConverter::convert_A8R8G8B8toR8G8B8(src, w, dst);
 
 			src = (uint32_t*) ( (uint8_t*) (src) + job->srcPitch );
 			dst += job->dstPitch;
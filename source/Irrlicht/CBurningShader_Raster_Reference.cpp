@@ -692,6 +692,8 @@ REALINLINE void CBurningShader_Raster_Reference::scanline2()
 	// apply top-left fill-convention, left
 	pShader.xStart = core::ceil32( line.x[0] );
 	pShader.xEnd = core::ceil32( line.x[1] ) - 1;
+	pShader.xStart = core::s32_max( pShader.xStart, Scissor.UpperLeftCorner.X );
+	pShader.xEnd = core::s32_min( pShader.xEnd, Scissor.LowerRightCorner.X - 1 );
 
 	pShader.dx = pShader.xEnd - pShader.xStart;
 	if ( pShader.dx < 0 )
@@ -757,6 +759,8 @@ REALINLINE void CBurningShader_Raster_Reference::scanline ()
 	// apply top-left fill-convention, left
 	pShader.xStart = core::ceil32( line.x[0] );
 	pShader.xEnd = core::ceil32( line.x[1] ) - 1;
+	pShader.xStart = core::s32_max( pShader.xStart, Scissor.UpperLeftCorner.X );
+	pShader.xEnd = core::s32_min( pShader.xEnd, Scissor.LowerRightCorner.X - 1 );
 
 	pShader.dx = pShader.xEnd - pShader.xStart;
 	if ( pShader.dx < 0 )
@@ -923,6 +927,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		yStart = core::s32_max( yStart, Scissor.UpperLeftCorner.Y );
+		yEnd = core::s32_min( yEnd, Scissor.LowerRightCorner.Y - 1 );
 
 		subPixel = ( (float) yStart ) - a->Pos.y;
 
@@ -1037,6 +1043,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		yStart = core::s32_max( yStart, Scissor.UpperLeftCorner.Y );
+		yEnd = core::s32_min( yEnd, Scissor.LowerRightCorner.Y - 1 );
 
 
 		subPixel = ( (float) yStart ) - b->Pos.y;
@@ -0,0 +1,210 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#include "IrrCompileConfig.h"
+#include "CBurningTileBinner.h"
+
+#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#include "CSoftwareDriver2.h"
+#include <algorithm>
+#include <thread>
+
+namespace irr
+{
+namespace video
+{
+
+CBurningTileBinner::CBurningTileBinner(CBurningVideoDriver* driver)
+	: Driver(driver), ThreadCount(1u), TilesX(0), TilesY(0), NextTile(0u)
+{
+}
+
+
+CBurningTileBinner::~CBurningTileBinner()
+{
+	clear();
+	for (size_t i=0u; i<Shaders.size(); i++)
+	if (Shaders[i])
+		Shaders[i]->drop();
+}
+
+
+void CBurningTileBinner::setState(EBurningFFShader shader, const SBurningShaderMaterial& material,
+	CSoftwareTexture2* const* textures, const int32_t* lodLevels)
+{
+	// the driver sets state way more often than it changes
+	if (!States.empty())
+	{
+		const SState& last = States.back();
+		bool same = last.Shader==shader && last.Material.org==material.org;
+		for (uint32_t i=0u; same && i<BURNING_MATERIAL_MAX_TEXTURES; i++)
+			same = last.Textures[i]==textures[i] && last.LodLevels[i]==lodLevels[i];
+		if (same)
+			return;
+	}
+
+	SState state;
+	state.Shader = shader;
+	state.Material = material;
+	for (uint32_t i=0u; i<BURNING_MATERIAL_MAX_TEXTURES; i++)
+	{
+		state.Textures[i] = textures[i];
+		state.LodLevels[i] = lodLevels[i];
+		if (textures[i])
+			textures[i]->grab();
+	}
+	States.push_back(state);
+}
+
+
+void CBurningTileBinner::addTriangle(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c, const core::rect<int32_t>& viewPort)
+{
+	if (States.empty() || !viewPort.isValid())
+		return;
+
+	const core::dimension2d<int32_t> size(viewPort.LowerRightCorner.X, viewPort.LowerRightCorner.Y);
+	const int32_t tilesX = (size.Width+TILE_SIZE-1)/TILE_SIZE;
+	const int32_t tilesY = (size.Height+TILE_SIZE-1)/TILE_SIZE;
+	if (tilesX!=TilesX || tilesY!=TilesY)
+	{
+		// only a flush can change the render target, so this happens on the first triangle
+		TilesX = tilesX;
+		TilesY = tilesY;
+		Bins.resize(TilesX*TilesY);
+	}
+
+	// shaders cover pixels from ceil(min) to ceil(max)-1, a pixel of margin covers rounding of edge interpolation
+	const float minX = core::min_(a->Pos.x, b->Pos.x, c->Pos.x);
+	const float maxX = core::max_(a->Pos.x, b->Pos.x, c->Pos.x);
+	const float minY = core::min_(a->Pos.y, b->Pos.y, c->Pos.y);
+	const float maxY = core::max_(a->Pos.y, b->Pos.y, c->Pos.y);
+	const int32_t x0 = core::max_(core::ceil32(minX)-1, viewPort.UpperLeftCorner.X);
+	const int32_t x1 = core::min_(core::ceil32(maxX), viewPort.LowerRightCorner.X-1);
+	const int32_t y0 = core::max_(core::ceil32(minY)-1, viewPort.UpperLeftCorner.Y);
+	const int32_t y1 = core::min_(core::ceil32(maxY), viewPort.LowerRightCorner.Y-1);
+	if (x0>x1 || y0>y1)
+		return;
+
+	const uint32_t index = Triangles.size();
+	Triangles.push_back(STriangle());
+	STriangle& triangle = Triangles.back();
+	triangle.State = States.size()-1u;
+	triangle.Vertices[0] = *a;
+	triangle.Vertices[1] = *b;
+	triangle.Vertices[2] = *c;
+
+	for (int32_t ty=y0/TILE_SIZE; ty<=y1/TILE_SIZE; ty++)
+	for (int32_t tx=x0/TILE_SIZE; tx<=x1/TILE_SIZE; tx++)
+		Bins[ty*TilesX+tx].push_back(index);
+}
+
+
+void CBurningTileBinner::flush(video::IImage* target, const core::rect<int32_t>& viewPort)
+{
+	if (Triangles.empty())
+	{
+		clear();
+		return;
+	}
+
+	uint32_t busyTiles = 0u;
+	for (size_t i=0u; i<Bins.size(); i++)
+	if (!Bins[i].empty())
+		busyTiles++;
+
+	uint32_t threadCount = ThreadCount ? ThreadCount:std::max(std::thread::hardware_concurrency(),1u);
+	threadCount = std::max(std::min(threadCount,busyTiles),1u);
+	while (Shaders.size()<threadCount*ETR2_COUNT)
+	{
+		IBurningShader* set[ETR2_COUNT] = {0};
+		set[ETR_GOURAUD] = createTriangleRendererGouraud2(Driver);
+		set[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(Driver);
+		set[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(Driver);
+		set[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(Driver);
+		set[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(Driver);
+		set[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2(Driver);
+		set[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(Driver);
+		set[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ(Driver);
+		set[ETR_REFERENCE] = createTriangleRendererReference(Driver);
+		Shaders.insert(Shaders.end(),set,set+ETR2_COUNT);
+	}
+
+	NextTile = 0u;
+	Workers.run(threadCount,[&](const uint32_t& worker) {rasterizeTiles(worker,target,viewPort);});
+
+	clear();
+}
+
+
+void CBurningTileBinner::rasterizeTiles(uint32_t worker, video::IImage* target, const core::rect<int32_t>& viewPort)
+{
+	IBurningShader* const* shaders = Shaders.data()+worker*ETR2_COUNT;
+	IBurningShader* shader = 0;
+	uint32_t boundState = 0xdeadbeefu;
+
+	for (uint32_t tile=NextTile++; tile<Bins.size(); tile=NextTile++)
+	{
+		const std::vector<uint32_t>& bin = Bins[tile];
+		if (bin.empty())
+			continue;
+
+		const int32_t tx = (tile%TilesX)*TILE_SIZE;
+		const int32_t ty = (tile/TilesX)*TILE_SIZE;
+		core::rect<int32_t> scissor(tx,ty,tx+TILE_SIZE,ty+TILE_SIZE);
+		scissor.clipAgainst(viewPort);
+		if (shader)
+			shader->setScissor(&scissor);
+
+		for (size_t i=0u; i<bin.size(); i++)
+		{
+			const STriangle& triangle = Triangles[bin[i]];
+			if (triangle.State!=boundState)
+			{
+				const SState& state = States[triangle.State];
+				boundState = triangle.State;
+				shader = shaders[state.Shader];
+				if (shader)
+				{
+					Driver->setShaderState(shader,state.Shader,state.Material,target,viewPort);
+					// lock() of a texture stores the mip-map level in it, every thread stores the same one for the same state
+					for (uint32_t m=0u; m<BURNING_MATERIAL_MAX_TEXTURES; m++)
+						shader->setTextureParam(m,state.Textures[m],state.LodLevels[m]);
+					shader->setScissor(&scissor);
+				}
+			}
+			if (shader)
+				shader->drawTriangle(triangle.Vertices,triangle.Vertices+1,triangle.Vertices+2);
+		}
+	}
+
+	// let go of the render target and textures
+	for (uint32_t i=0u; i<ETR2_COUNT; i++)
+	if (shaders[i])
+	{
+		shaders[i]->setRenderTarget(0,viewPort);
+		for (uint32_t m=0u; m<BURNING_MATERIAL_MAX_TEXTURES; m++)
+			shaders[i]->setTextureParam(m,0,0);
+	}
+}
+
+
+void CBurningTileBinner::clear()
+{
+	for (size_t i=0u; i<States.size(); i++)
+	for (uint32_t m=0u; m<BURNING_MATERIAL_MAX_TEXTURES; m++)
+	if (States[i].Textures[m])
+		States[i].Textures[m]->drop();
+
+	States.clear();
+	Triangles.clear();
+	for (size_t i=0u; i<Bins.size(); i++)
+		Bins[i].clear();
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_BURNINGSVIDEO_
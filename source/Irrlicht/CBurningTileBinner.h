@@ -0,0 +1,111 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_BURNING_TILE_BINNER_H_INCLUDED__
+#define __C_BURNING_TILE_BINNER_H_INCLUDED__
+
+#include "IBurningShader.h"
+#include "CSoftwareTexture2.h"
+#include "CWorkerPool.h"
+#include <atomic>
+#include <vector>
+
+namespace irr
+{
+namespace video
+{
+
+	class CBurningVideoDriver;
+
+	//! Defers triangles of CBurningVideoDriver and rasterizes them screen tile by screen tile on many threads.
+	/** Every tile keeps the triangles overlapping it in the order they were added and is rasterized by one thread only,
+	so depth testing and blending within a tile happen in the same order as drawing the triangles straight away would.
+	Shaders keep per triangle state, so every thread gets its own set of them.
+	Shaders interpolate from the tile's edges instead of stepping from the triangle's top, so a few pixels on triangle edges
+	and depth ties can differ from drawing straight away, and colors can differ by one from rounding.
+	The output is the same for any thread count above one.
+	*/
+	class CBurningTileBinner
+	{
+		public:
+			//! Side of a square tile in pixels.
+			static const int32_t TILE_SIZE = 64;
+
+			//! Constructor
+			CBurningTileBinner(CBurningVideoDriver* driver);
+
+			//! Destructor, drops everything binned without drawing it.
+			~CBurningTileBinner();
+
+			//! Sets number of threads flush() rasterizes with, 0 means as many as the hardware has. Default is 1.
+			void setThreadCount(uint32_t count) { ThreadCount = count; }
+
+			//! Returns number of threads set with setThreadCount().
+			uint32_t getThreadCount() const { return ThreadCount; }
+
+			//! Returns true if there are triangles waiting for flush().
+			bool isEmpty() const { return Triangles.empty(); }
+
+			//! Sets the shader and its inputs triangles added from now on are drawn with.
+			/** \param shader Shader to draw with.
+			\param material Material, as passed to the shader's setMaterial().
+			\param textures Texture for every stage, they're grabbed until the next flush().
+			\param lodLevels Mip-map level for every stage. */
+			void setState(EBurningFFShader shader, const SBurningShaderMaterial& material,
+				CSoftwareTexture2* const* textures, const int32_t* lodLevels);
+
+			//! Adds a triangle in device coordinates, vertices are copied.
+			/** \param viewPort Area of the render target the triangle is drawn to, pixels outside of it are never touched. */
+			void addTriangle(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c, const core::rect<int32_t>& viewPort);
+
+			//! Rasterizes all added triangles and forgets them.
+			/** \param target Render target to draw to, the same one for all triangles added since the last flush.
+			\param viewPort Viewport of the target, passed to shaders. */
+			void flush(video::IImage* target, const core::rect<int32_t>& viewPort);
+
+		private:
+			struct SState
+			{
+				EBurningFFShader Shader;
+				SBurningShaderMaterial Material;
+				CSoftwareTexture2* Textures[BURNING_MATERIAL_MAX_TEXTURES];
+				int32_t LodLevels[BURNING_MATERIAL_MAX_TEXTURES];
+			};
+
+			struct STriangle
+			{
+				uint32_t State;
+				s4DVertex Vertices[3];
+			};
+
+			//! rasterizes tiles handed out by NextTile until there are none left
+			void rasterizeTiles(uint32_t worker, video::IImage* target, const core::rect<int32_t>& viewPort);
+
+			//! drops textures of all states and forgets states and triangles
+			void clear();
+
+			CBurningVideoDriver* Driver;
+			uint32_t ThreadCount;
+
+			std::vector<SState> States;
+			std::vector<STriangle> Triangles;
+
+			//! indices into Triangles of triangles overlapping each tile, row by row
+			std::vector<std::vector<uint32_t> > Bins;
+			int32_t TilesX, TilesY;
+
+			//! ETR2_COUNT shaders for each thread, created as more threads are used
+			std::vector<IBurningShader*> Shaders;
+
+			std::atomic<uint32_t> NextTile;
+
+			//! threads kept between flushes
+			core::CWorkerPool Workers;
+	};
+
+} // end namespace video
+} // end namespace irr
+
+#endif // __C_BURNING_TILE_BINNER_H_INCLUDED__
@@ -6,12 +6,465 @@
 #include "SColor.h"
 #include "os.h"
 #include "irrString.h"
+#include <atomic>
 
 namespace irr
 {
 namespace video
 {
 
+namespace
+{
+	//! Converts the first pixels of an array, how many is up to the kernel, and returns their count so scalar code can do the rest
+	typedef int32_t (*ConversionKernel)(const void* sP, int32_t sN, void* dP);
+
+	CColorConverter::E_SIMD_LEVEL detectSIMDLevel()
+	{
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+		if (os::CPU::hasAVX2())
+			return CColorConverter::ESL_AVX2;
+		if (os::CPU::hasSSSE3())
+			return CColorConverter::ESL_SSSE3;
+		return CColorConverter::ESL_SSE2;
+#else
+		return CColorConverter::ESL_SCALAR;
+#endif
+	}
+
+	std::atomic<int32_t>& SIMDLevel()
+	{
+		static std::atomic<int32_t> level(detectSIMDLevel());
+		return level;
+	}
+
+	//! table of kernels is indexed by E_SIMD_LEVEL, 0 entries leave all pixels to scalar code
+	inline int32_t runKernel(const ConversionKernel (&kernels)[CColorConverter::ESL_COUNT], const void* sP, int32_t sN, void* dP)
+	{
+		const ConversionKernel kernel = kernels[SIMDLevel().load(std::memory_order_relaxed)];
+		return kernel ? kernel(sP, sN, dP) : 0;
+	}
+
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+	// The kernels give exactly the same results as the scalar code, so all pixels of an array can be converted by either.
+	// Unaligned loads and stores are used throughout, image rows have no alignment guarantees whatsoever.
+	namespace sse2
+	{
+		inline __m128i set32(uint32_t x) { return _mm_set1_epi32(int32_t(x)); }
+
+		//! packs 2x4 values below 0x10000 into 8 unsigned shorts, packs_epi32 saturates signed values so they're sign extended first
+		inline __m128i packU32toU16(__m128i lo, __m128i hi)
+		{
+			return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo,16),16), _mm_srai_epi32(_mm_slli_epi32(hi,16),16));
+		}
+
+		inline __m128i A8R8G8B8toA1R5G5B5(__m128i c)
+		{
+			return _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(c,16),set32(0x8000)), _mm_and_si128(_mm_srli_epi32(c,9),set32(0x7C00))),
+								_mm_or_si128(_mm_and_si128(_mm_srli_epi32(c,6),set32(0x03E0)), _mm_and_si128(_mm_srli_epi32(c,3),set32(0x001F))));
+		}
+
+		inline __m128i A8R8G8B8toR5G6B5(__m128i c)
+		{
+			return _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(c,8),set32(0xF800)), _mm_and_si128(_mm_srli_epi32(c,5),set32(0x07E0))),
+								_mm_and_si128(_mm_srli_epi32(c,3),set32(0x001F)));
+		}
+
+		//! takes zero extended A1R5G5B5, top bits of each channel are replicated into the bottom ones
+		inline __m128i A1R5G5B5toA8R8G8B8(__m128i c)
+		{
+			const __m128i a = _mm_and_si128(_mm_srai_epi32(_mm_slli_epi32(c,16),31), set32(0xFF000000u));
+			const __m128i r = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c,set32(0x7C00)),9), _mm_slli_epi32(_mm_and_si128(c,set32(0x7000)),4));
+			const __m128i g = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c,set32(0x03E0)),6), _mm_slli_epi32(_mm_and_si128(c,set32(0x0380)),1));
+			const __m128i b = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c,set32(0x001F)),3), _mm_srli_epi32(_mm_and_si128(c,set32(0x001C)),2));
+			return _mm_or_si128(_mm_or_si128(a,r), _mm_or_si128(g,b));
+		}
+
+		//! takes zero extended R5G6B5
+		inline __m128i R5G6B5toA8R8G8B8(__m128i c)
+		{
+			return _mm_or_si128(_mm_or_si128(set32(0xFF000000u), _mm_slli_epi32(_mm_and_si128(c,set32(0xF800)),8)),
+								_mm_or_si128(_mm_slli_epi32(_mm_and_si128(c,set32(0x07E0)),5), _mm_slli_epi32(_mm_and_si128(c,set32(0x001F)),3)));
+		}
+
+		int32_t A1R5G5B5toR5G6B5(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const int32_t n = sN&~7;
+			for (int32_t x = 0; x < n; x += 8)
+			{
+				const __m128i c = _mm_loadu_si128(sB++);
+				_mm_storeu_si128(dB++, _mm_or_si128(_mm_slli_epi16(_mm_and_si128(c,_mm_set1_epi16(0x7FE0)),1), _mm_and_si128(c,_mm_set1_epi16(0x001F))));
+			}
+			return n;
+		}
+
+		int32_t R5G6B5toA1R5G5B5(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const int32_t n = sN&~7;
+			for (int32_t x = 0; x < n; x += 8)
+			{
+				const __m128i c = _mm_loadu_si128(sB++);
+				const __m128i rg = _mm_srli_epi16(_mm_and_si128(c,_mm_set1_epi16(int16_t(0xFFC0))),1);
+				_mm_storeu_si128(dB++, _mm_or_si128(_mm_or_si128(rg,_mm_set1_epi16(int16_t(0x8000))), _mm_and_si128(c,_mm_set1_epi16(0x001F))));
+			}
+			return n;
+		}
+
+		template<__m128i (*F)(__m128i)>
+		int32_t from16to32(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const int32_t n = sN&~7;
+			for (int32_t x = 0; x < n; x += 8)
+			{
+				const __m128i c = _mm_loadu_si128(sB++);
+				_mm_storeu_si128(dB++, F(_mm_unpacklo_epi16(c,_mm_setzero_si128())));
+				_mm_storeu_si128(dB++, F(_mm_unpackhi_epi16(c,_mm_setzero_si128())));
+			}
+			return n;
+		}
+
+		template<__m128i (*F)(__m128i)>
+		int32_t from32to16(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const int32_t n = sN&~7;
+			for (int32_t x = 0; x < n; x += 8)
+			{
+				const __m128i lo = F(_mm_loadu_si128(sB++));
+				const __m128i hi = F(_mm_loadu_si128(sB++));
+				_mm_storeu_si128(dB++, packU32toU16(lo,hi));
+			}
+			return n;
+		}
+
+		int32_t A8R8G8B8toR3G3B2(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16)
+			{
+				__m128i c[4];
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					const __m128i s = _mm_loadu_si128(sB++);
+					c[i] = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(s,16),set32(0xE0)), _mm_and_si128(_mm_srli_epi32(s,11),set32(0x1C))),
+										_mm_and_si128(_mm_srli_epi32(s,6),set32(0x03)));
+				}
+				_mm_storeu_si128(dB++, _mm_packus_epi16(_mm_packs_epi32(c[0],c[1]), _mm_packs_epi32(c[2],c[3])));
+			}
+			return n;
+		}
+
+		int32_t B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const int32_t n = sN&~3;
+			for (int32_t x = 0; x < n; x += 4)
+			{
+				const __m128i c = _mm_loadu_si128(sB++);
+				// swap bytes in each short, then shorts in each int
+				const __m128i swapped = _mm_or_si128(_mm_slli_epi16(c,8), _mm_srli_epi16(c,8));
+				_mm_storeu_si128(dB++, _mm_shufflehi_epi16(_mm_shufflelo_epi16(swapped,_MM_SHUFFLE(2,3,0,1)),_MM_SHUFFLE(2,3,0,1)));
+			}
+			return n;
+		}
+	} // end namespace sse2
+
+	// Packed 24bit pixels are handled 16 at a time, as 48 bytes are 3 whole registers. Shuffles expand 4 pixels
+	// from the low 12 bytes of a register into 4 ints or compact them back.
+	namespace ssse3
+	{
+		_IRR_TARGET_SSSE3_ inline void load24(const uint8_t* sB, __m128i shuffle, __m128i (&out)[4])
+		{
+			const __m128i a = _mm_loadu_si128((const __m128i*)sB);
+			const __m128i b = _mm_loadu_si128((const __m128i*)(sB+16));
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB+32));
+			out[0] = _mm_shuffle_epi8(a, shuffle);
+			out[1] = _mm_shuffle_epi8(_mm_alignr_epi8(b,a,12), shuffle);
+			out[2] = _mm_shuffle_epi8(_mm_alignr_epi8(c,b,8), shuffle);
+			out[3] = _mm_shuffle_epi8(_mm_srli_si128(c,4), shuffle);
+		}
+
+		//! shuffle has to gather 12 bytes to the bottom and zero the top 4
+		_IRR_TARGET_SSSE3_ inline void store24(uint8_t* dB, __m128i shuffle, const __m128i (&in)[4])
+		{
+			const __m128i a = _mm_shuffle_epi8(in[0], shuffle);
+			const __m128i b = _mm_shuffle_epi8(in[1], shuffle);
+			const __m128i c = _mm_shuffle_epi8(in[2], shuffle);
+			const __m128i d = _mm_shuffle_epi8(in[3], shuffle);
+			_mm_storeu_si128((__m128i*)dB, _mm_or_si128(a,_mm_slli_si128(b,12)));
+			_mm_storeu_si128((__m128i*)(dB+16), _mm_or_si128(_mm_srli_si128(b,4),_mm_slli_si128(c,8)));
+			_mm_storeu_si128((__m128i*)(dB+32), _mm_or_si128(_mm_srli_si128(c,8),_mm_slli_si128(d,4)));
+		}
+
+		//! R8G8B8 bytes to A8R8G8B8 without alpha
+		_IRR_TARGET_SSSE3_ inline __m128i shuffleRGB() { return _mm_setr_epi8(2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1); }
+		//! B8G8R8 bytes to A8R8G8B8 without alpha, and A8R8G8B8 to B8G8R8 the other way
+		_IRR_TARGET_SSSE3_ inline __m128i shuffleBGR() { return _mm_setr_epi8(0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1); }
+		_IRR_TARGET_SSSE3_ inline __m128i compactBGR() { return _mm_setr_epi8(0,1,2, 4,5,6, 8,9,10, 12,13,14, -1,-1,-1,-1); }
+		_IRR_TARGET_SSSE3_ inline __m128i compactRGB() { return _mm_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1); }
+
+		template<bool bgr>
+		_IRR_TARGET_SSSE3_ int32_t from24to32(const void* sP, int32_t sN, void* dP)
+		{
+			const uint8_t* sB = (const uint8_t*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const __m128i shuffle = bgr ? shuffleBGR():shuffleRGB();
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16, sB += 48)
+			{
+				__m128i c[4];
+				load24(sB, shuffle, c);
+				for (uint32_t i = 0; i < 4; ++i)
+					_mm_storeu_si128(dB++, _mm_or_si128(c[i],sse2::set32(0xFF000000u)));
+			}
+			return n;
+		}
+
+		template<bool bgr>
+		_IRR_TARGET_SSSE3_ int32_t from32to24(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			uint8_t* dB = (uint8_t*)dP;
+			const __m128i shuffle = bgr ? compactBGR():compactRGB();
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16, dB += 48)
+			{
+				__m128i c[4];
+				for (uint32_t i = 0; i < 4; ++i)
+					c[i] = _mm_loadu_si128(sB++);
+				store24(dB, shuffle, c);
+			}
+			return n;
+		}
+
+		//! R8G8B8 is expanded to A8R8G8B8 first, which F converts to a 16bit format
+		template<__m128i (*F)(__m128i)>
+		_IRR_TARGET_SSSE3_ int32_t from24to16(const void* sP, int32_t sN, void* dP)
+		{
+			const uint8_t* sB = (const uint8_t*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const __m128i shuffle = shuffleRGB();
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16, sB += 48)
+			{
+				__m128i c[4];
+				load24(sB, shuffle, c);
+				for (uint32_t i = 0; i < 4; ++i)
+					c[i] = F(_mm_or_si128(c[i],sse2::set32(0xFF000000u)));
+				_mm_storeu_si128(dB++, sse2::packU32toU16(c[0],c[1]));
+				_mm_storeu_si128(dB++, sse2::packU32toU16(c[2],c[3]));
+			}
+			return n;
+		}
+
+		//! F takes zero extended 16bit pixels and returns the output bytes in order in the low 3 bytes of each int
+		template<__m128i (*F)(__m128i)>
+		_IRR_TARGET_SSSE3_ int32_t from16to24(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			uint8_t* dB = (uint8_t*)dP;
+			const __m128i shuffle = compactBGR();
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16, dB += 48)
+			{
+				const __m128i lo = _mm_loadu_si128(sB++);
+				const __m128i hi = _mm_loadu_si128(sB++);
+				__m128i c[4] = {F(_mm_unpacklo_epi16(lo,_mm_setzero_si128())), F(_mm_unpackhi_epi16(lo,_mm_setzero_si128())),
+								F(_mm_unpacklo_epi16(hi,_mm_setzero_si128())), F(_mm_unpackhi_epi16(hi,_mm_setzero_si128()))};
+				store24(dB, shuffle, c);
+			}
+			return n;
+		}
+
+		inline __m128i A1R5G5B5toR8G8B8(__m128i c)
+		{
+			using sse2::set32;
+			return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(c,set32(0x7C00)),9), _mm_slli_epi32(_mm_and_si128(c,set32(0x03E0)),6)),
+								_mm_slli_epi32(_mm_and_si128(c,set32(0x001F)),3));
+		}
+
+		inline __m128i A1R5G5B5toB8G8R8(__m128i c)
+		{
+			using sse2::set32;
+			return _mm_or_si128(_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c,set32(0x7C00)),7), _mm_slli_epi32(_mm_and_si128(c,set32(0x03E0)),6)),
+								_mm_slli_epi32(_mm_and_si128(c,set32(0x001F)),19));
+		}
+
+		inline __m128i R5G6B5toR8G8B8(__m128i c)
+		{
+			using sse2::set32;
+			return _mm_or_si128(_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c,set32(0xF800)),8), _mm_slli_epi32(_mm_and_si128(c,set32(0x07E0)),5)),
+								_mm_slli_epi32(_mm_and_si128(c,set32(0x001F)),19));
+		}
+
+		inline __m128i R5G6B5toB8G8R8(__m128i c)
+		{
+			using sse2::set32;
+			return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(c,set32(0xF800)),8), _mm_slli_epi32(_mm_and_si128(c,set32(0x07E0)),5)),
+								_mm_slli_epi32(_mm_and_si128(c,set32(0x001F)),3));
+		}
+
+		_IRR_TARGET_SSSE3_ int32_t B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m128i* dB = (__m128i*)dP;
+			const __m128i shuffle = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+			const int32_t n = sN&~3;
+			for (int32_t x = 0; x < n; x += 4)
+				_mm_storeu_si128(dB++, _mm_shuffle_epi8(_mm_loadu_si128(sB++),shuffle));
+			return n;
+		}
+	} // end namespace ssse3
+
+	// Only conversions between 16 and 32bit formats are worth widening, shuffles of 24bit pixels can't cross the 128bit lanes.
+	namespace avx2
+	{
+		_IRR_TARGET_AVX2_ inline __m256i set32(uint32_t x) { return _mm256_set1_epi32(int32_t(x)); }
+
+		_IRR_TARGET_AVX2_ inline __m256i A8R8G8B8toA1R5G5B5(__m256i c)
+		{
+			return _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(c,16),set32(0x8000)), _mm256_and_si256(_mm256_srli_epi32(c,9),set32(0x7C00))),
+								_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(c,6),set32(0x03E0)), _mm256_and_si256(_mm256_srli_epi32(c,3),set32(0x001F))));
+		}
+
+		_IRR_TARGET_AVX2_ inline __m256i A8R8G8B8toR5G6B5(__m256i c)
+		{
+			return _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(c,8),set32(0xF800)), _mm256_and_si256(_mm256_srli_epi32(c,5),set32(0x07E0))),
+								_mm256_and_si256(_mm256_srli_epi32(c,3),set32(0x001F)));
+		}
+
+		_IRR_TARGET_AVX2_ inline __m256i A1R5G5B5toA8R8G8B8(__m256i c)
+		{
+			const __m256i a = _mm256_and_si256(_mm256_srai_epi32(_mm256_slli_epi32(c,16),31), set32(0xFF000000u));
+			const __m256i r = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(c,set32(0x7C00)),9), _mm256_slli_epi32(_mm256_and_si256(c,set32(0x7000)),4));
+			const __m256i g = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(c,set32(0x03E0)),6), _mm256_slli_epi32(_mm256_and_si256(c,set32(0x0380)),1));
+			const __m256i b = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(c,set32(0x001F)),3), _mm256_srli_epi32(_mm256_and_si256(c,set32(0x001C)),2));
+			return _mm256_or_si256(_mm256_or_si256(a,r), _mm256_or_si256(g,b));
+		}
+
+		_IRR_TARGET_AVX2_ inline __m256i R5G6B5toA8R8G8B8(__m256i c)
+		{
+			return _mm256_or_si256(_mm256_or_si256(set32(0xFF000000u), _mm256_slli_epi32(_mm256_and_si256(c,set32(0xF800)),8)),
+								_mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(c,set32(0x07E0)),5), _mm256_slli_epi32(_mm256_and_si256(c,set32(0x001F)),3)));
+		}
+
+		_IRR_TARGET_AVX2_ int32_t A1R5G5B5toR5G6B5(const void* sP, int32_t sN, void* dP)
+		{
+			const __m256i* sB = (const __m256i*)sP;
+			__m256i* dB = (__m256i*)dP;
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16)
+			{
+				const __m256i c = _mm256_loadu_si256(sB++);
+				_mm256_storeu_si256(dB++, _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(c,_mm256_set1_epi16(0x7FE0)),1), _mm256_and_si256(c,_mm256_set1_epi16(0x001F))));
+			}
+			return n;
+		}
+
+		_IRR_TARGET_AVX2_ int32_t R5G6B5toA1R5G5B5(const void* sP, int32_t sN, void* dP)
+		{
+			const __m256i* sB = (const __m256i*)sP;
+			__m256i* dB = (__m256i*)dP;
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16)
+			{
+				const __m256i c = _mm256_loadu_si256(sB++);
+				const __m256i rg = _mm256_srli_epi16(_mm256_and_si256(c,_mm256_set1_epi16(int16_t(0xFFC0))),1);
+				_mm256_storeu_si256(dB++, _mm256_or_si256(_mm256_or_si256(rg,_mm256_set1_epi16(int16_t(0x8000))), _mm256_and_si256(c,_mm256_set1_epi16(0x001F))));
+			}
+			return n;
+		}
+
+		template<__m256i (*F)(__m256i)>
+		_IRR_TARGET_AVX2_ int32_t from16to32(const void* sP, int32_t sN, void* dP)
+		{
+			const __m128i* sB = (const __m128i*)sP;
+			__m256i* dB = (__m256i*)dP;
+			const int32_t n = sN&~7;
+			for (int32_t x = 0; x < n; x += 8)
+				_mm256_storeu_si256(dB++, F(_mm256_cvtepu16_epi32(_mm_loadu_si128(sB++))));
+			return n;
+		}
+
+		template<__m256i (*F)(__m256i)>
+		_IRR_TARGET_AVX2_ int32_t from32to16(const void* sP, int32_t sN, void* dP)
+		{
+			const __m256i* sB = (const __m256i*)sP;
+			__m256i* dB = (__m256i*)dP;
+			const int32_t n = sN&~15;
+			for (int32_t x = 0; x < n; x += 16)
+			{
+				const __m256i lo = F(_mm256_loadu_si256(sB++));
+				const __m256i hi = F(_mm256_loadu_si256(sB++));
+				// packs works within 128bit lanes, so the 64bit quarters come out as lo0 hi0 lo1 hi1
+				const __m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(lo,16),16), _mm256_srai_epi32(_mm256_slli_epi32(hi,16),16));
+				_mm256_storeu_si256(dB++, _mm256_permute4x64_epi64(packed,_MM_SHUFFLE(3,1,2,0)));
+			}
+			return n;
+		}
+
+		_IRR_TARGET_AVX2_ int32_t B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+		{
+			const __m256i* sB = (const __m256i*)sP;
+			__m256i* dB = (__m256i*)dP;
+			const __m256i shuffle = _mm256_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12, 3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+			const int32_t n = sN&~7;
+			for (int32_t x = 0; x < n; x += 8)
+				_mm256_storeu_si256(dB++, _mm256_shuffle_epi8(_mm256_loadu_si256(sB++),shuffle));
+			return n;
+		}
+	} // end namespace avx2
+
+	#define IRR_COLOR_KERNELS(SSE2,SSSE3,AVX2) {0, SSE2, SSSE3, AVX2}
+#else
+	#define IRR_COLOR_KERNELS(SSE2,SSSE3,AVX2) {0, 0, 0, 0}
+#endif // __IRR_COMPILE_WITH_X86_SIMD_
+
+	const ConversionKernel kA1R5G5B5toR8G8B8[] = IRR_COLOR_KERNELS(0, ssse3::from16to24<ssse3::A1R5G5B5toR8G8B8>, ssse3::from16to24<ssse3::A1R5G5B5toR8G8B8>);
+	const ConversionKernel kA1R5G5B5toB8G8R8[] = IRR_COLOR_KERNELS(0, ssse3::from16to24<ssse3::A1R5G5B5toB8G8R8>, ssse3::from16to24<ssse3::A1R5G5B5toB8G8R8>);
+	const ConversionKernel kA1R5G5B5toA8R8G8B8[] = IRR_COLOR_KERNELS(sse2::from16to32<sse2::A1R5G5B5toA8R8G8B8>, sse2::from16to32<sse2::A1R5G5B5toA8R8G8B8>, avx2::from16to32<avx2::A1R5G5B5toA8R8G8B8>);
+	const ConversionKernel kA1R5G5B5toR5G6B5[] = IRR_COLOR_KERNELS(sse2::A1R5G5B5toR5G6B5, sse2::A1R5G5B5toR5G6B5, avx2::A1R5G5B5toR5G6B5);
+	const ConversionKernel kA8R8G8B8toR8G8B8[] = IRR_COLOR_KERNELS(0, ssse3::from32to24<false>, ssse3::from32to24<false>);
+	const ConversionKernel kA8R8G8B8toB8G8R8[] = IRR_COLOR_KERNELS(0, ssse3::from32to24<true>, ssse3::from32to24<true>);
+	const ConversionKernel kA8R8G8B8toA1R5G5B5[] = IRR_COLOR_KERNELS(sse2::from32to16<sse2::A8R8G8B8toA1R5G5B5>, sse2::from32to16<sse2::A8R8G8B8toA1R5G5B5>, avx2::from32to16<avx2::A8R8G8B8toA1R5G5B5>);
+	const ConversionKernel kA8R8G8B8toR5G6B5[] = IRR_COLOR_KERNELS(sse2::from32to16<sse2::A8R8G8B8toR5G6B5>, sse2::from32to16<sse2::A8R8G8B8toR5G6B5>, avx2::from32to16<avx2::A8R8G8B8toR5G6B5>);
+	const ConversionKernel kA8R8G8B8toR3G3B2[] = IRR_COLOR_KERNELS(sse2::A8R8G8B8toR3G3B2, sse2::A8R8G8B8toR3G3B2, sse2::A8R8G8B8toR3G3B2);
+	const ConversionKernel kR8G8B8toA8R8G8B8[] = IRR_COLOR_KERNELS(0, ssse3::from24to32<false>, ssse3::from24to32<false>);
+	const ConversionKernel kR8G8B8toA1R5G5B5[] = IRR_COLOR_KERNELS(0, ssse3::from24to16<sse2::A8R8G8B8toA1R5G5B5>, ssse3::from24to16<sse2::A8R8G8B8toA1R5G5B5>);
+	const ConversionKernel kR8G8B8toR5G6B5[] = IRR_COLOR_KERNELS(0, ssse3::from24to16<sse2::A8R8G8B8toR5G6B5>, ssse3::from24to16<sse2::A8R8G8B8toR5G6B5>);
+	const ConversionKernel kB8G8R8toA8R8G8B8[] = IRR_COLOR_KERNELS(0, ssse3::from24to32<true>, ssse3::from24to32<true>);
+	const ConversionKernel kB8G8R8A8toA8R8G8B8[] = IRR_COLOR_KERNELS(sse2::B8G8R8A8toA8R8G8B8, ssse3::B8G8R8A8toA8R8G8B8, avx2::B8G8R8A8toA8R8G8B8);
+	const ConversionKernel kR5G6B5toR8G8B8[] = IRR_COLOR_KERNELS(0, ssse3::from16to24<ssse3::R5G6B5toR8G8B8>, ssse3::from16to24<ssse3::R5G6B5toR8G8B8>);
+	const ConversionKernel kR5G6B5toB8G8R8[] = IRR_COLOR_KERNELS(0, ssse3::from16to24<ssse3::R5G6B5toB8G8R8>, ssse3::from16to24<ssse3::R5G6B5toB8G8R8>);
+	const ConversionKernel kR5G6B5toA8R8G8B8[] = IRR_COLOR_KERNELS(sse2::from16to32<sse2::R5G6B5toA8R8G8B8>, sse2::from16to32<sse2::R5G6B5toA8R8G8B8>, avx2::from16to32<avx2::R5G6B5toA8R8G8B8>);
+	const ConversionKernel kR5G6B5toA1R5G5B5[] = IRR_COLOR_KERNELS(sse2::R5G6B5toA1R5G5B5, sse2::R5G6B5toA1R5G5B5, avx2::R5G6B5toA1R5G5B5);
+
+	#undef IRR_COLOR_KERNELS
+} // end anonymous namespace
+
+
+CColorConverter::E_SIMD_LEVEL CColorConverter::setMaxSIMDLevel(E_SIMD_LEVEL level)
+{
+	const E_SIMD_LEVEL used = core::min_(level, detectSIMDLevel());
+	SIMDLevel().store(used);
+	return used;
+}
+
+CColorConverter::E_SIMD_LEVEL CColorConverter::getSIMDLevel()
+{
+	return E_SIMD_LEVEL(SIMDLevel().load());
+}
+
+
 //! converts a monochrome bitmap to A1R5G5B5 data
 void CColorConverter::convert1BitTo16Bit(const uint8_t* in, int16_t* out, int32_t width, int32_t height, int32_t linepad, bool flip)
 {
@@ -313,10 +766,11 @@ void CColorConverter::convert32BitTo32Bit(const int32_t* in, int32_t* out, int32
 
 void CColorConverter::convert_A1R5G5B5toR8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = runKernel(kA1R5G5B5toR8G8B8, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[2] = (*sB & 0x7c00) >> 7;
 		dB[1] = (*sB & 0x03e0) >> 2;
@@ -329,10 +783,11 @@ void CColorConverter::convert_A1R5G5B5toR8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_A1R5G5B5toB8G8R8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = runKernel(kA1R5G5B5toB8G8R8, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[0] = (*sB & 0x7c00) >> 7;
 		dB[1] = (*sB & 0x03e0) >> 2;
@@ -345,10 +800,11 @@ void CColorConverter::convert_A1R5G5B5toB8G8R8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_A1R5G5B5toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = runKernel(kA1R5G5B5toA8R8G8B8, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toA8R8G8B8(*sB++);
 }
 
@@ -359,19 +815,21 @@ void CColorConverter::convert_A1R5G5B5toA1R5G5B5(const void* sP, int32_t sN, voi
 
 void CColorConverter::convert_A1R5G5B5toR5G6B5(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = runKernel(kA1R5G5B5toR5G6B5, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toR5G6B5(*sB++);
 }
 
 void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t* sB = (uint8_t*)sP;
-	uint8_t* dB = (uint8_t*)dP;
+	const int32_t done = runKernel(kA8R8G8B8toR8G8B8, sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[2];
@@ -385,10 +843,11 @@ void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_A8R8G8B8toB8G8R8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t* sB = (uint8_t*)sP;
-	uint8_t* dB = (uint8_t*)dP;
+	const int32_t done = runKernel(kA8R8G8B8toB8G8R8, sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[0];
@@ -407,19 +866,21 @@ void CColorConverter::convert_A8R8G8B8toA8R8G8B8(const void* sP, int32_t sN, voi
 
 void CColorConverter::convert_A8R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP)
 {
-	uint32_t* sB = (uint32_t*)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = runKernel(kA8R8G8B8toA1R5G5B5, sP, sN, dP);
+	uint32_t* sB = (uint32_t*)sP + done;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = A8R8G8B8toA1R5G5B5(*sB++);
 }
 
 void CColorConverter::convert_A8R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t * sB = (uint8_t *)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = runKernel(kA8R8G8B8toR5G6B5, sP, sN, dP);
+	uint8_t * sB = (uint8_t *)sP + done*4;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		int32_t r = sB[2] >> 3;
 		int32_t g = sB[1] >> 2;
@@ -434,10 +895,11 @@ void CColorConverter::convert_A8R8G8B8toR5G6B5(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_A8R8G8B8toR3G3B2(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t* sB = (uint8_t*)sP;
-	uint8_t* dB = (uint8_t*)dP;
+	const int32_t done = runKernel(kA8R8G8B8toR3G3B2, sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		uint8_t r = sB[2] & 0xe0;
 		uint8_t g = (sB[1] & 0xe0) >> 3;
@@ -457,10 +919,11 @@ void CColorConverter::convert_R8G8B8toR8G8B8(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t*  sB = (uint8_t* )sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = runKernel(kR8G8B8toA8R8G8B8, sP, sN, dP);
+	uint8_t*  sB = (uint8_t* )sP + done*3;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[0]<<16) | (sB[1]<<8) | sB[2];
 
@@ -471,10 +934,11 @@ void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t * sB = (uint8_t *)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = runKernel(kR8G8B8toA1R5G5B5, sP, sN, dP);
+	uint8_t * sB = (uint8_t *)sP + done*3;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		int32_t r = sB[0] >> 3;
 		int32_t g = sB[1] >> 3;
@@ -489,10 +953,11 @@ void CColorConverter::convert_R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t*  sB = (uint8_t* )sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = runKernel(kB8G8R8toA8R8G8B8, sP, sN, dP);
+	uint8_t*  sB = (uint8_t* )sP + done*3;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[2]<<16) | (sB[1]<<8) | sB[0];
 
@@ -503,10 +968,11 @@ void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t* sB = (uint8_t*)sP;
-	uint8_t* dB = (uint8_t*)dP;
+	const int32_t done = runKernel(kB8G8R8A8toA8R8G8B8, sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*4;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[0] = sB[3];
 		dB[1] = sB[2];
@@ -521,10 +987,11 @@ void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, voi
 
 void CColorConverter::convert_R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t * sB = (uint8_t *)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = runKernel(kR8G8B8toR5G6B5, sP, sN, dP);
+	uint8_t * sB = (uint8_t *)sP + done*3;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		int32_t r = sB[0] >> 3;
 		int32_t g = sB[1] >> 2;
@@ -544,10 +1011,11 @@ void CColorConverter::convert_R5G6B5toR5G6B5(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = runKernel(kR5G6B5toR8G8B8, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[0] = (*sB & 0xf800) >> 8;
 		dB[1] = (*sB & 0x07e0) >> 3;
@@ -560,10 +1028,11 @@ void CColorConverter::convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R5G6B5toB8G8R8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = runKernel(kR5G6B5toB8G8R8, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[2] = (*sB & 0xf800) >> 8;
 		dB[1] = (*sB & 0x07e0) >> 3;
@@ -576,19 +1045,21 @@ void CColorConverter::convert_R5G6B5toB8G8R8(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R5G6B5toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = runKernel(kR5G6B5toA8R8G8B8, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA8R8G8B8(*sB++);
 }
 
 void CColorConverter::convert_R5G6B5toA1R5G5B5(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = runKernel(kR5G6B5toA1R5G5B5, sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA1R5G5B5(*sB++);
 }
 
@@ -17,6 +17,25 @@ namespace video
 class CColorConverter
 {
 public:
+	//! Instruction sets the conversions between whole arrays of pixels can use
+	enum E_SIMD_LEVEL
+	{
+		ESL_SCALAR=0,
+		ESL_SSE2,
+		ESL_SSSE3,
+		ESL_AVX2,
+		ESL_COUNT
+	};
+
+	//! Caps the instruction set used by convert_viaFormat and the convert_ functions, e.g. to compare results or speed.
+	/** By default the best set the CPU supports is used, results are the same whichever it is. Not meant to be called
+	while other threads convert pixels.
+	\return The set actually used, never above the best one the CPU supports. */
+	static E_SIMD_LEVEL setMaxSIMDLevel(E_SIMD_LEVEL level);
+
+	//! returns the instruction set conversions currently use
+	static E_SIMD_LEVEL getSIMDLevel();
+
 
 	//! converts a monochrome bitmap to A1R5G5B5
 	static void convert1BitTo16Bit(const uint8_t* in, int16_t* out, int32_t width, int32_t height, int32_t linepad=0, bool flip=false);
@@ -39,6 +39,11 @@ uint32_t CFileList::getFileCount() const
 void CFileList::sort()
 {
 	Files.sort();
+
+	FileIndex.clear();
+	FileIndex.reserve(Files.size());
+	for (uint32_t i=0; i<Files.size(); ++i)
+		FileIndex.insert(std::make_pair(hashEntry(Files[i].FullName, Files[i].IsDirectory), i));
 }
 
 const io::path& CFileList::getFileName(uint32_t index) const
@@ -91,6 +96,9 @@ uint32_t CFileList::addItem(const io::path& fullPath, uint32_t offset, uint32_t
 	//os::Printer::log(Path.c_str(), entry.FullName);
 
 	Files.push_back(entry);
+	// list has to be sorted again before searching
+	if (!FileIndex.empty())
+		FileIndex.clear();
 
 	return Files.size() - 1;
 }
@@ -126,29 +134,58 @@ uint32_t CFileList::getFileOffset(uint32_t index) const
 //! Searches for a file or folder within the list, returns the index
 int32_t CFileList::findFile(const io::path& filename, bool isDirectory = false) const
 {
+	io::path name(filename);
+	const size_t hash = prepareLookup(name, isDirectory, IgnorePaths);
+
+	if (FileIndex.size() == Files.size())
+	{
+		typedef std::unordered_multimap<size_t,uint32_t>::const_iterator index_iterator;
+		const std::pair<index_iterator,index_iterator> range = FileIndex.equal_range(hash);
+		for (index_iterator it=range.first; it!=range.second; ++it)
+		{
+			const SFileListEntry& entry = Files[it->second];
+			if (entry.IsDirectory == isDirectory && entry.FullName.equals_ignore_case(name))
+				return it->second;
+		}
+		return -1;
+	}
+
+	// not sorted yet
 	SFileListEntry entry;
 	// we only need FullName to be set for the search
-	entry.FullName = filename;
+	entry.FullName = name;
 	entry.IsDirectory = isDirectory;
+	return Files.binary_search(entry);
+}
+
 
+size_t CFileList::prepareLookup(io::path& name, bool& isDirectory, bool ignorePaths)
+{
 	// exchange
-	handleBackslashes(&entry.FullName);
+	handleBackslashes(&name);
 
 	// remove trailing slash
-	if (entry.FullName.lastChar() == '/')
+	if (name.lastChar() == '/')
 	{
-		entry.IsDirectory = true;
-		entry.FullName[entry.FullName.size()-1] = 0;
-		entry.FullName.validate();
+		isDirectory = true;
+		name[name.size()-1] = 0;
+		name.validate();
 	}
 
-	if (IgnoreCase)
-		entry.FullName.make_lower();
+	if (ignorePaths)
+		core::deletePathFromFilename(name);
 
-	if (IgnorePaths)
-		core::deletePathFromFilename(entry.FullName);
+	return hashEntry(name, isDirectory);
+}
 
-	return Files.binary_search(entry);
+
+size_t CFileList::hashEntry(const io::path& fullName, bool isDirectory)
+{
+	// FNV-1a of lower case characters, comparisons of entries ignore case
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (uint32_t i=0; i<fullName.size(); ++i)
+		hash = (hash ^ core::locale_lower(fullName[i])) * 0x100000001b3ull;
+	return size_t(isDirectory ? ~hash : hash);
 }
 
 
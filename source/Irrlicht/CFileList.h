@@ -8,6 +8,7 @@
 #include "IFileList.h"
 #include "irrString.h"
 #include "irrArray.h"
+#include <unordered_map>
 
 
 namespace irr
@@ -111,6 +112,19 @@ class CFileList : public IFileList
         //! Returns the base path of the file list
         virtual const io::path& getPath() const;
 
+        //! Returns true if directories were stripped from names of added files
+        bool isIgnoringPaths() const { return IgnorePaths; }
+
+        //! Brings a name to the form in which findFile() compares it.
+        /** \param name Name to look for, modified in place.
+        \param isDirectory Whether a directory is looked for, set to true if the name has a trailing slash.
+        \param ignorePaths Whether directories should be stripped from the name.
+        \return Hash of the name, same as hashEntry() of a matching entry. */
+        static size_t prepareLookup(io::path& name, bool& isDirectory, bool ignorePaths);
+
+        //! Returns case insensitive hash of a file list entry's full name.
+        static size_t hashEntry(const io::path& fullName, bool isDirectory);
+
     protected:
 
         //! Ignore paths when adding or searching for files
@@ -124,6 +138,9 @@ class CFileList : public IFileList
 
         //! List of files
         core::array<SFileListEntry> Files;
+
+        //! Indices of Files by hashEntry(), rebuilt by sort() and dropped by addItem()
+        std::unordered_multimap<size_t,uint32_t> FileIndex;
 };
 
 
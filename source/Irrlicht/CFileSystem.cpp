@@ -45,7 +45,7 @@ namespace io
 {
 
 //! constructor
-CFileSystem::CFileSystem()
+CFileSystem::CFileSystem() : FileMappingEnabled(false), UnindexedArchiveCount(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CFileSystem");
@@ -105,16 +105,41 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 	IReadFile* file = 0;
 	uint32_t i;
 
-	for (i=0; i< FileArchives.size(); ++i)
+	uint32_t priority;
+	const SIndexedFile indexed = findIndexedFile(filename, priority);
+
+	// archives which aren't indexed still have to be asked in turn, if they come first
+	if (UnindexedArchiveCount)
+	for (i=0; i<priority; ++i)
 	{
+		if (ArchiveInfo[FileArchives[i]].Indexed)
+			continue;
 		file = FileArchives[i]->createAndOpenFile(filename);
 		if (file)
 			return file;
 	}
 
+	if (indexed.Archive)
+	{
+		file = indexed.Archive->createAndOpenFile(indexed.Index);
+		if (file)
+			return file;
+
+		// couldn't be opened, e.g. broken data, so look further like before
+		for (i=priority+1; i<FileArchives.size(); ++i)
+		{
+			file = FileArchives[i]->createAndOpenFile(filename);
+			if (file)
+				return file;
+		}
+	}
+
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
-	return createReadFile(getAbsolutePath(filename));
+	const io::path absolutePath = getAbsolutePath(filename);
+	if (FileMappingEnabled && (file = createMappedReadFile(absolutePath)))
+		return file;
+	return createReadFile(absolutePath);
 }
 
 
@@ -202,6 +227,7 @@ bool CFileSystem::moveFileArchive(uint32_t sourceIndex, int32_t relative)
 		FileArchives[s] = t;
 		r = true;
 	}
+	updateArchiveInfo();
 	return r;
 }
 
@@ -299,6 +325,7 @@ bool CFileSystem::addFileArchive(const io::path& filename, bool ignoreCase,
 	if (archive)
 	{
 		FileArchives.push_back(archive);
+		indexArchive(archive);
 		if (password.size())
 			archive->Password=password;
 		if (retArchive)
@@ -404,6 +431,7 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 		if (archive)
 		{
 			FileArchives.push_back(archive);
+			indexArchive(archive);
 			if (password.size())
 				archive->Password=password;
 			if (retArchive)
@@ -429,6 +457,7 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 			return false;
 	}
 	FileArchives.push_back(archive);
+	indexArchive(archive);
 	return true;
 }
 
@@ -439,8 +468,10 @@ bool CFileSystem::removeFileArchive(uint32_t index)
 	bool ret = false;
 	if (index < FileArchives.size())
 	{
+		unindexArchive(FileArchives[index]);
 		FileArchives[index]->drop();
 		FileArchives.erase(index);
+		updateArchiveInfo();
 		ret = true;
 	}
 
@@ -488,6 +519,99 @@ IFileArchive* CFileSystem::getFileArchive(uint32_t index)
 }
 
 
+//! adds files of the archive to FileIndex, only done for archives whose file list is a CFileList
+void CFileSystem::indexArchive(IFileArchive* archive)
+{
+	// other lists may not compare names the way CFileList does, so such archives are asked by name
+	const CFileList* list = dynamic_cast<const CFileList*>(archive->getFileList());
+	if (list)
+	{
+		std::unordered_multimap<size_t,SIndexedFile>& index = FileIndex[list->isIgnoringPaths() ? 1:0];
+		index.reserve(index.size()+list->getFileCount());
+		for (uint32_t i=0; i<list->getFileCount(); ++i)
+		{
+			const SIndexedFile file = {archive, i};
+			index.insert(std::make_pair(CFileList::hashEntry(list->getFullFileName(i), list->isDirectory(i)), file));
+		}
+	}
+	updateArchiveInfo();
+}
+
+
+//! removes files of the archive from FileIndex
+void CFileSystem::unindexArchive(IFileArchive* archive)
+{
+	const CFileList* list = dynamic_cast<const CFileList*>(archive->getFileList());
+	if (!list)
+		return;
+
+	std::unordered_multimap<size_t,SIndexedFile>& index = FileIndex[list->isIgnoringPaths() ? 1:0];
+	for (uint32_t i=0; i<list->getFileCount(); ++i)
+	{
+		typedef std::unordered_multimap<size_t,SIndexedFile>::iterator index_iterator;
+		const std::pair<index_iterator,index_iterator> range = index.equal_range(CFileList::hashEntry(list->getFullFileName(i), list->isDirectory(i)));
+		for (index_iterator it=range.first; it!=range.second; ++it)
+		{
+			if (it->second.Archive == archive && it->second.Index == i)
+			{
+				index.erase(it);
+				break;
+			}
+		}
+	}
+}
+
+
+//! refreshes ArchiveInfo after archives were added, removed or moved
+void CFileSystem::updateArchiveInfo()
+{
+	ArchiveInfo.clear();
+	UnindexedArchiveCount = 0;
+	for (uint32_t i=0; i<FileArchives.size(); ++i)
+	{
+		SArchiveInfo& info = ArchiveInfo[FileArchives[i]];
+		info.Priority = i;
+		info.Indexed = dynamic_cast<const CFileList*>(FileArchives[i]->getFileList()) != 0;
+		if (!info.Indexed)
+			++UnindexedArchiveCount;
+	}
+}
+
+
+//! returns the indexed file with the name from the archive which comes first, Archive is 0 if there's none
+CFileSystem::SIndexedFile CFileSystem::findIndexedFile(const io::path& filename, uint32_t& priority) const
+{
+	SIndexedFile found = {0, 0};
+	priority = FileArchives.size();
+
+	for (uint32_t ignorePaths=0; ignorePaths<2; ++ignorePaths)
+	{
+		const std::unordered_multimap<size_t,SIndexedFile>& index = FileIndex[ignorePaths];
+		if (index.empty())
+			continue;
+
+		io::path name(filename);
+		bool isDirectory = false;
+		typedef std::unordered_multimap<size_t,SIndexedFile>::const_iterator index_iterator;
+		const std::pair<index_iterator,index_iterator> range = index.equal_range(CFileList::prepareLookup(name, isDirectory, ignorePaths!=0));
+		for (index_iterator it=range.first; it!=range.second; ++it)
+		{
+			const uint32_t archivePriority = ArchiveInfo.find(it->second.Archive)->second.Priority;
+			if (archivePriority >= priority)
+				continue;
+
+			const IFileList* list = it->second.Archive->getFileList();
+			if (list->isDirectory(it->second.Index) == isDirectory && list->getFullFileName(it->second.Index).equals_ignore_case(name))
+			{
+				found = it->second;
+				priority = archivePriority;
+			}
+		}
+	}
+	return found;
+}
+
+
 //! Returns the string of the current working directory
 const io::path& CFileSystem::getWorkingDirectory()
 {
@@ -873,8 +997,13 @@ IFileList* CFileSystem::createEmptyFileList(const io::path& path, bool ignoreCas
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path& filename) const
 {
+	uint32_t priority;
+	if (findIndexedFile(filename, priority).Archive)
+		return true;
+
+	if (UnindexedArchiveCount)
 	for (uint32_t i=0; i < FileArchives.size(); ++i)
-		if (FileArchives[i]->getFileList()->findFile(filename)!=-1)
+		if (!ArchiveInfo.find(FileArchives[i])->second.Indexed && FileArchives[i]->getFileList()->findFile(filename)!=-1)
 			return true;
 
 #if defined(_MSC_VER)
@@ -7,6 +7,7 @@
 
 #include "IFileSystem.h"
 #include "irrArray.h"
+#include <unordered_map>
 
 namespace irr
 {
@@ -33,6 +34,12 @@ class CFileSystem : public IFileSystem
         //! opens a file for read access
         virtual IReadFile* createAndOpenFile(const io::path& filename);
 
+        //! sets whether files opened from disk are memory-mapped
+        virtual void setFileMappingEnabled(bool enabled) {FileMappingEnabled = enabled;}
+
+        //! returns whether files opened from disk are memory-mapped
+        virtual bool isFileMappingEnabled() const {return FileMappingEnabled;}
+
         //! Creates an IReadFile interface for accessing memory like a file.
         virtual IReadFile* createMemoryReadFile(const void* memory, const size_t& len, const io::path& fileName, bool deleteMemoryWhenDropped = false);
 
@@ -116,6 +123,33 @@ class CFileSystem : public IFileSystem
         virtual bool existFile(const io::path& filename) const;
 
     private:
+        //! a file of an archive, as found through FileIndex
+        struct SIndexedFile
+        {
+            IFileArchive* Archive;
+            uint32_t Index;
+        };
+
+        struct SArchiveInfo
+        {
+            //! position in FileArchives
+            uint32_t Priority;
+            //! whether files are in FileIndex or have to be looked up by the archive itself
+            bool Indexed;
+        };
+
+        //! adds files of the archive to FileIndex, only done for archives whose file list is a CFileList
+        void indexArchive(IFileArchive* archive);
+
+        //! removes files of the archive from FileIndex
+        void unindexArchive(IFileArchive* archive);
+
+        //! refreshes ArchiveInfo after archives were added, removed or moved
+        void updateArchiveInfo();
+
+        //! returns the indexed file with the name from the archive which comes first, Archive is 0 if there's none
+        /** \param priority Receives position of the archive, or number of archives if there's no such file. */
+        SIndexedFile findIndexedFile(const io::path& filename, uint32_t& priority) const;
 
         // don't expose, needs refactoring
         bool changeArchivePassword(const path& filename,
@@ -130,6 +164,12 @@ class CFileSystem : public IFileSystem
         core::array<IArchiveLoader*> ArchiveLoader;
         //! currently attached Archives
         core::array<IFileArchive*> FileArchives;
+        //! whether files from disk are opened with createMappedReadFile()
+        bool FileMappingEnabled;
+        //! files of all indexed archives by CFileList::hashEntry(), separately for archives ignoring paths
+        std::unordered_multimap<size_t,SIndexedFile> FileIndex[2];
+        std::unordered_map<const IFileArchive*,SArchiveInfo> ArchiveInfo;
+        uint32_t UnindexedArchiveCount;
 };
 
 
@@ -0,0 +1,371 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#include "CInstanceCuller.h"
+#include "vectorSIMDBatch.h"
+#include "CWorkerPool.h"
+#include "os.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	static_assert(sizeof(core::aabbox3df)==6u*sizeof(float), "Kernels assume boxes are tightly packed");
+
+	//! The frustum and LoDs moved to the space of the boxes, so the kernels don't have to transform every box
+	struct SCullingParams
+	{
+		//! a point p is in front of plane i, outside of the frustum, when dot(normal[i],p)+D[i]>0
+		float normal[SViewFrustum::VF_PLANE_COUNT][3];
+		float absNormal[SViewFrustum::VF_PLANE_COUNT][3];
+		float D[SViewFrustum::VF_PLANE_COUNT];
+		//! 3x3 part of the local to world transformation by rows, and its translation minus the eye position
+		float rotation[3][3];
+		float eyeToOrigin[3];
+		const float* lodDistancesSQ;
+		int32_t lodCount;
+	};
+
+	//! Culls boxes `_first` to `_first+_count-1`, appending their indices to `_out` and counting them in `_counts`
+	typedef void (*CullKernel)(uint32_t* const* _out, size_t* _counts, const core::aabbox3df* _boxes, size_t _first, size_t _count, const SCullingParams& _params);
+
+	CInstanceCuller::E_SIMD_LEVEL detectSIMDLevel()
+	{
+		if (os::CPU::hasAVX2())
+			return CInstanceCuller::ESL_AVX2;
+		return CInstanceCuller::ESL_SSE3;
+	}
+
+	std::atomic<int32_t>& SIMDLevel()
+	{
+		static std::atomic<int32_t> level(detectSIMDLevel());
+		return level;
+	}
+
+	//! shared by all callers, cull() runs every frame and shouldn't create threads every frame
+	core::CWorkerPool& cullingWorkers()
+	{
+		static core::CWorkerPool workers;
+		return workers;
+	}
+
+	//! gathers MinEdge and MaxEdge of `_count` boxes into SoA batches, lanes past `_count` repeat the first box
+	inline void loadBoxes(core::vector3dfSIMDBatch& _min, core::vector3dfSIMDBatch& _max, const core::aabbox3df* _boxes, uint32_t _count)
+	{
+		_min = core::vector3dfSIMDBatch::loadStrided(&_boxes->MinEdge.X, sizeof(core::aabbox3df), _count);
+		_max = core::vector3dfSIMDBatch::loadStrided(&_boxes->MaxEdge.X, sizeof(core::aabbox3df), _count);
+	}
+
+	//! appends `_firstIndex+lane` to the output of LoD `_lods[lane]` for every bit set in `_visible`
+	inline void appendVisible(uint32_t* const* _out, size_t* _counts, uint32_t _visible, const int32_t* _lods, uint32_t _firstIndex)
+	{
+		for (uint32_t lane=0u; _visible; lane++, _visible>>=1u)
+		{
+			if (_visible&1u)
+			{
+				const int32_t lod = _lods[lane];
+				_out[lod][_counts[lod]++] = _firstIndex+lane;
+			}
+		}
+	}
+
+	// SSE3 is what the whole engine is compiled for, the AVX2 kernel does the same operations in the same order on twice the lanes.
+	// The box is culled when its corner furthest behind a plane is in front of it. That corner's distance is the distance of the
+	// center minus dot(abs(normal),extent), which needs no per plane selects of MinEdge or MaxEdge components.
+	namespace sse3
+	{
+		//! params broadcast to all lanes
+		struct SBroadcastParams
+		{
+			SBroadcastParams(const SCullingParams& _params)
+			{
+				for (uint32_t i=0u; i<SViewFrustum::VF_PLANE_COUNT; i++)
+				{
+					for (uint32_t j=0u; j<3u; j++)
+					{
+						normal[i][j] = _mm_set1_ps(_params.normal[i][j]);
+						absNormal[i][j] = _mm_set1_ps(_params.absNormal[i][j]);
+					}
+					D[i] = _mm_set1_ps(_params.D[i]);
+				}
+				for (uint32_t i=0u; i<3u; i++)
+				{
+					for (uint32_t j=0u; j<3u; j++)
+						rotation[i][j] = _mm_set1_ps(_params.rotation[i][j]);
+					eyeToOrigin[i] = _mm_set1_ps(_params.eyeToOrigin[i]);
+				}
+			}
+
+			__m128 normal[SViewFrustum::VF_PLANE_COUNT][3];
+			__m128 absNormal[SViewFrustum::VF_PLANE_COUNT][3];
+			__m128 D[SViewFrustum::VF_PLANE_COUNT];
+			__m128 rotation[3][3];
+			__m128 eyeToOrigin[3];
+		};
+
+		//! returns a bit per box which survives and writes LoDs of all four to `_lods`
+		inline uint32_t cullBatch(int32_t* _lods, const core::aabbox3df* _boxes, uint32_t _count, const SBroadcastParams& _b, const SCullingParams& _params)
+		{
+			core::vector3dfSIMDBatch minEdge, maxEdge;
+			loadBoxes(minEdge, maxEdge, _boxes, _count);
+			const __m128 mins[3] = {minEdge.X.getAsRegister(), minEdge.Y.getAsRegister(), minEdge.Z.getAsRegister()};
+			const __m128 maxs[3] = {maxEdge.X.getAsRegister(), maxEdge.Y.getAsRegister(), maxEdge.Z.getAsRegister()};
+
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 zero = _mm_setzero_ps();
+			__m128 center[3], extent[3];
+			for (uint32_t j=0u; j<3u; j++)
+			{
+				center[j] = _mm_mul_ps(_mm_add_ps(mins[j], maxs[j]), half);
+				extent[j] = _mm_mul_ps(_mm_sub_ps(maxs[j], mins[j]), half);
+			}
+
+			// empty boxes have negative extents
+			__m128 culled = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(extent[0], zero), _mm_cmplt_ps(extent[1], zero)), _mm_cmplt_ps(extent[2], zero));
+			for (uint32_t i=0u; i<SViewFrustum::VF_PLANE_COUNT; i++)
+			{
+				__m128 dist = _mm_mul_ps(center[0], _b.normal[i][0]);
+				dist = _mm_add_ps(dist, _mm_mul_ps(center[1], _b.normal[i][1]));
+				dist = _mm_add_ps(dist, _mm_mul_ps(center[2], _b.normal[i][2]));
+				dist = _mm_add_ps(dist, _b.D[i]);
+				__m128 radius = _mm_mul_ps(extent[0], _b.absNormal[i][0]);
+				radius = _mm_add_ps(radius, _mm_mul_ps(extent[1], _b.absNormal[i][1]));
+				radius = _mm_add_ps(radius, _mm_mul_ps(extent[2], _b.absNormal[i][2]));
+				culled = _mm_or_ps(culled, _mm_cmpgt_ps(_mm_sub_ps(dist, radius), zero));
+			}
+
+			__m128 distanceSQ = zero;
+			for (uint32_t i=0u; i<3u; i++)
+			{
+				__m128 eyeToCenter = _mm_mul_ps(center[0], _b.rotation[i][0]);
+				eyeToCenter = _mm_add_ps(eyeToCenter, _mm_mul_ps(center[1], _b.rotation[i][1]));
+				eyeToCenter = _mm_add_ps(eyeToCenter, _mm_mul_ps(center[2], _b.rotation[i][2]));
+				eyeToCenter = _mm_add_ps(eyeToCenter, _b.eyeToOrigin[i]);
+				distanceSQ = _mm_add_ps(distanceSQ, _mm_mul_ps(eyeToCenter, eyeToCenter));
+			}
+			// LoD is the number of LoD distances the box is at or beyond, comparison masks are -1
+			__m128i lod = _mm_setzero_si128();
+			for (int32_t l=0; l<_params.lodCount; l++)
+				lod = _mm_sub_epi32(lod, _mm_castps_si128(_mm_cmpge_ps(distanceSQ, _mm_set1_ps(_params.lodDistancesSQ[l]))));
+			culled = _mm_or_ps(culled, _mm_castsi128_ps(_mm_cmpeq_epi32(lod, _mm_set1_epi32(_params.lodCount))));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(_lods), lod);
+
+			return uint32_t(~_mm_movemask_ps(culled))&((1u<<_count)-1u);
+		}
+
+		void cull(uint32_t* const* _out, size_t* _counts, const core::aabbox3df* _boxes, size_t _first, size_t _count, const SCullingParams& _params)
+		{
+			const SBroadcastParams broadcast(_params);
+			int32_t lods[8];
+			// two batches of four make the 8 boxes the AVX2 kernel does at a time
+			for (size_t i=0u; i<_count; i+=8u)
+			{
+				const size_t left = _count-i;
+				uint32_t visible = cullBatch(lods, _boxes+_first+i, uint32_t(std::min<size_t>(left, 4u)), broadcast, _params);
+				if (left>4u)
+					visible |= cullBatch(lods+4, _boxes+_first+i+4u, uint32_t(std::min<size_t>(left-4u, 4u)), broadcast, _params)<<4u;
+				appendVisible(_out, _counts, visible, lods, uint32_t(_first+i));
+			}
+		}
+	}
+
+	namespace avx2
+	{
+		//! (_lo,_hi) as lanes
+		_IRR_TARGET_AVX2_ inline __m256 combine(const core::vectorSIMDf& _lo, const core::vectorSIMDf& _hi)
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo.getAsRegister()), _hi.getAsRegister(), 1);
+		}
+
+		struct SBroadcastParams
+		{
+			_IRR_TARGET_AVX2_ SBroadcastParams(const SCullingParams& _params)
+			{
+				for (uint32_t i=0u; i<SViewFrustum::VF_PLANE_COUNT; i++)
+				{
+					for (uint32_t j=0u; j<3u; j++)
+					{
+						normal[i][j] = _mm256_set1_ps(_params.normal[i][j]);
+						absNormal[i][j] = _mm256_set1_ps(_params.absNormal[i][j]);
+					}
+					D[i] = _mm256_set1_ps(_params.D[i]);
+				}
+				for (uint32_t i=0u; i<3u; i++)
+				{
+					for (uint32_t j=0u; j<3u; j++)
+						rotation[i][j] = _mm256_set1_ps(_params.rotation[i][j]);
+					eyeToOrigin[i] = _mm256_set1_ps(_params.eyeToOrigin[i]);
+				}
+			}
+
+			__m256 normal[SViewFrustum::VF_PLANE_COUNT][3];
+			__m256 absNormal[SViewFrustum::VF_PLANE_COUNT][3];
+			__m256 D[SViewFrustum::VF_PLANE_COUNT];
+			__m256 rotation[3][3];
+			__m256 eyeToOrigin[3];
+		};
+
+		_IRR_TARGET_AVX2_ inline uint32_t cullBatch(int32_t* _lods, const core::aabbox3df* _boxes, uint32_t _count, const SBroadcastParams& _b, const SCullingParams& _params)
+		{
+			// gathering is the same as for SSE3, with the upper half repeating the lower when there are 4 boxes or less
+			core::vector3dfSIMDBatch minLo, maxLo, minHi, maxHi;
+			loadBoxes(minLo, maxLo, _boxes, std::min(_count, 4u));
+			if (_count>4u)
+				loadBoxes(minHi, maxHi, _boxes+4u, _count-4u);
+			else
+			{
+				minHi = minLo;
+				maxHi = maxLo;
+			}
+			const __m256 mins[3] = {combine(minLo.X, minHi.X), combine(minLo.Y, minHi.Y), combine(minLo.Z, minHi.Z)};
+			const __m256 maxs[3] = {combine(maxLo.X, maxHi.X), combine(maxLo.Y, maxHi.Y), combine(maxLo.Z, maxHi.Z)};
+
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256 zero = _mm256_setzero_ps();
+			__m256 center[3], extent[3];
+			for (uint32_t j=0u; j<3u; j++)
+			{
+				center[j] = _mm256_mul_ps(_mm256_add_ps(mins[j], maxs[j]), half);
+				extent[j] = _mm256_mul_ps(_mm256_sub_ps(maxs[j], mins[j]), half);
+			}
+
+			__m256 culled = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(extent[0], zero, _CMP_LT_OS), _mm256_cmp_ps(extent[1], zero, _CMP_LT_OS)), _mm256_cmp_ps(extent[2], zero, _CMP_LT_OS));
+			for (uint32_t i=0u; i<SViewFrustum::VF_PLANE_COUNT; i++)
+			{
+				__m256 dist = _mm256_mul_ps(center[0], _b.normal[i][0]);
+				dist = _mm256_add_ps(dist, _mm256_mul_ps(center[1], _b.normal[i][1]));
+				dist = _mm256_add_ps(dist, _mm256_mul_ps(center[2], _b.normal[i][2]));
+				dist = _mm256_add_ps(dist, _b.D[i]);
+				__m256 radius = _mm256_mul_ps(extent[0], _b.absNormal[i][0]);
+				radius = _mm256_add_ps(radius, _mm256_mul_ps(extent[1], _b.absNormal[i][1]));
+				radius = _mm256_add_ps(radius, _mm256_mul_ps(extent[2], _b.absNormal[i][2]));
+				culled = _mm256_or_ps(culled, _mm256_cmp_ps(_mm256_sub_ps(dist, radius), zero, _CMP_GT_OS));
+			}
+
+			__m256 distanceSQ = zero;
+			for (uint32_t i=0u; i<3u; i++)
+			{
+				__m256 eyeToCenter = _mm256_mul_ps(center[0], _b.rotation[i][0]);
+				eyeToCenter = _mm256_add_ps(eyeToCenter, _mm256_mul_ps(center[1], _b.rotation[i][1]));
+				eyeToCenter = _mm256_add_ps(eyeToCenter, _mm256_mul_ps(center[2], _b.rotation[i][2]));
+				eyeToCenter = _mm256_add_ps(eyeToCenter, _b.eyeToOrigin[i]);
+				distanceSQ = _mm256_add_ps(distanceSQ, _mm256_mul_ps(eyeToCenter, eyeToCenter));
+			}
+			__m256i lod = _mm256_setzero_si256();
+			for (int32_t l=0; l<_params.lodCount; l++)
+				lod = _mm256_sub_epi32(lod, _mm256_castps_si256(_mm256_cmp_ps(distanceSQ, _mm256_set1_ps(_params.lodDistancesSQ[l]), _CMP_GE_OS)));
+			culled = _mm256_or_ps(culled, _mm256_castsi256_ps(_mm256_cmpeq_epi32(lod, _mm256_set1_epi32(_params.lodCount))));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(_lods), lod);
+
+			return uint32_t(~_mm256_movemask_ps(culled))&((1u<<_count)-1u);
+		}
+
+		_IRR_TARGET_AVX2_ void cull(uint32_t* const* _out, size_t* _counts, const core::aabbox3df* _boxes, size_t _first, size_t _count, const SCullingParams& _params)
+		{
+			const SBroadcastParams broadcast(_params);
+			int32_t lods[8];
+			for (size_t i=0u; i<_count; i+=8u)
+			{
+				const uint32_t visible = cullBatch(lods, _boxes+_first+i, uint32_t(std::min<size_t>(_count-i, 8u)), broadcast, _params);
+				appendVisible(_out, _counts, visible, lods, uint32_t(_first+i));
+			}
+		}
+	}
+
+	//! indexed by E_SIMD_LEVEL
+	const CullKernel cullKernels[CInstanceCuller::ESL_COUNT] = {sse3::cull, avx2::cull};
+
+	//! fewer boxes than this per thread aren't worth starting a thread for
+	const size_t MIN_BOXES_PER_THREAD = 4096u;
+} // end anonymous namespace
+
+
+CInstanceCuller::E_SIMD_LEVEL CInstanceCuller::setMaxSIMDLevel(E_SIMD_LEVEL _level)
+{
+	const E_SIMD_LEVEL used = core::min_(_level, detectSIMDLevel());
+	SIMDLevel().store(used);
+	return used;
+}
+
+CInstanceCuller::E_SIMD_LEVEL CInstanceCuller::getSIMDLevel()
+{
+	return E_SIMD_LEVEL(SIMDLevel().load());
+}
+
+void CInstanceCuller::cull(uint32_t** _outIndices, size_t* _outCounts, const core::aabbox3df* _boxes, size_t _count,
+		const SViewFrustum& _frustum, const core::matrix4x3& _localToWorld, const float* _lodDistancesSQ, size_t _lodCount, uint32_t _threadCount)
+{
+	for (size_t l=0u; l<_lodCount; l++)
+		_outCounts[l] = 0u;
+	if (!_count||!_lodCount)
+		return;
+
+	// world space plane (N,D) is (N*R,dot(N,T)+D) for points p in local space, with world space being R*p+T
+	SCullingParams params;
+	for (uint32_t i=0u; i<SViewFrustum::VF_PLANE_COUNT; i++)
+	{
+		const core::plane3df& plane = _frustum.planes[i];
+		for (uint32_t j=0u; j<3u; j++)
+		{
+			params.normal[i][j] = plane.Normal.X*_localToWorld(0,j)+plane.Normal.Y*_localToWorld(1,j)+plane.Normal.Z*_localToWorld(2,j);
+			params.absNormal[i][j] = core::abs_(params.normal[i][j]);
+		}
+		params.D[i] = plane.Normal.dotProduct(_localToWorld.getTranslation())+plane.D;
+	}
+	for (uint32_t i=0u; i<3u; i++)
+	{
+		for (uint32_t j=0u; j<3u; j++)
+			params.rotation[i][j] = _localToWorld(i,j);
+		params.eyeToOrigin[i] = _localToWorld(i,3)-_frustum.cameraPosition.pointer[i];
+	}
+	params.lodDistancesSQ = _lodDistancesSQ;
+	params.lodCount = int32_t(_lodCount);
+
+	const CullKernel kernel = cullKernels[SIMDLevel().load(std::memory_order_relaxed)];
+
+	// chunks are whole batches of 8, chunk c writes its indices from `c*chunkSize` on in every LoD's array
+	const size_t threadCount = std::min<size_t>(_threadCount ? _threadCount:std::max(std::thread::hardware_concurrency(),1u), (_count+MIN_BOXES_PER_THREAD-1u)/MIN_BOXES_PER_THREAD);
+	const size_t chunkSize = ((_count+threadCount-1u)/threadCount+7u)&~size_t(7u);
+	const size_t chunkCount = (_count+chunkSize-1u)/chunkSize;
+	if (chunkCount<2u)
+	{
+		kernel(_outIndices, _outCounts, _boxes, 0u, _count, params);
+		return;
+	}
+
+	std::vector<uint32_t*> chunkOutputs(chunkCount*_lodCount);
+	std::vector<size_t> chunkCounts(chunkCount*_lodCount, 0u);
+	for (size_t c=0u; c<chunkCount; c++)
+	for (size_t l=0u; l<_lodCount; l++)
+		chunkOutputs[c*_lodCount+l] = _outIndices[l]+c*chunkSize;
+
+	cullingWorkers().run(chunkCount, [&](const uint32_t& c) {
+		kernel(chunkOutputs.data()+c*_lodCount, chunkCounts.data()+c*_lodCount, _boxes, c*chunkSize, std::min(chunkSize, _count-c*chunkSize), params);
+	});
+
+	// move the indices of every chunk right behind those of the one before it
+	for (size_t l=0u; l<_lodCount; l++)
+	{
+		size_t total = chunkCounts[l];
+		for (size_t c=1u; c<chunkCount; c++)
+		{
+			const size_t count = chunkCounts[c*_lodCount+l];
+			memmove(_outIndices[l]+total, chunkOutputs[c*_lodCount+l], count*sizeof(uint32_t));
+			total += count;
+		}
+		_outCounts[l] = total;
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -47,6 +47,13 @@ int32_t CLimitReadFile::read(void* buffer, uint32_t sizeToRead)
 	int32_t toRead = core::s32_min(AreaEnd, r + sizeToRead) - core::s32_max(AreaStart, r);
 	if (toRead < 0)
 		return 0;
+	// copying from parent's memory leaves its read position alone, so areas of one archive can be read on different threads
+	if (const void* mapped = getMappedPointer())
+	{
+		memcpy(buffer, reinterpret_cast<const uint8_t*>(mapped)+Pos, toRead);
+		Pos += toRead;
+		return toRead;
+	}
 	File->seek(r);
 	r = File->read(buffer, toRead);
 	Pos += r;
@@ -116,6 +123,13 @@ const io::path& CLimitReadFile::getFileName() const
 }
 
 
+const void* CLimitReadFile::getMappedPointer() const
+{
+	const uint8_t* mapped = File ? reinterpret_cast<const uint8_t*>(File->getMappedPointer()) : 0;
+	return mapped ? mapped+AreaStart : 0;
+}
+
+
 IReadFile* createLimitReadFile(const io::path& fileName, IReadFile* alreadyOpenedFile, const size_t& pos, const size_t& areaSize)
 {
 	return new CLimitReadFile(alreadyOpenedFile, pos, areaSize, fileName);
@@ -46,6 +46,9 @@ namespace io
             //! returns name of file
             virtual const io::path& getFileName() const;
 
+            //! returns pointer into the underlying file's memory if it has any
+            virtual const void* getMappedPointer() const;
+
         private:
 
             io::path Filename;
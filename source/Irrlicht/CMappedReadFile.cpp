@@ -0,0 +1,144 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#include "CMappedReadFile.h"
+#include "IrrCompileConfig.h"
+
+#include <string.h>
+
+#if defined(_IRR_WINDOWS_API_)
+#include <windows.h>
+#elif defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const io::path& fileName)
+: Mapping(0), FileSize(0), Pos(0), Filename(fileName)
+{
+	#ifdef _DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+
+	mapFile();
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+	if (!Mapping)
+		return;
+
+#if defined(_IRR_WINDOWS_API_)
+	UnmapViewOfFile(Mapping);
+#elif defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_)
+	munmap(Mapping, FileSize);
+#endif
+}
+
+
+//! returns how much was read
+int32_t CMappedReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+	if (!isOpen())
+		return 0;
+
+	if (Pos + sizeToRead > FileSize)
+		sizeToRead = FileSize - Pos;
+
+	memcpy(buffer, reinterpret_cast<const uint8_t*>(Mapping) + Pos, sizeToRead);
+	Pos += sizeToRead;
+
+	return sizeToRead;
+}
+
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	if (!isOpen())
+		return false;
+
+	const size_t newPos = relativeMovement ? Pos + finalPos : finalPos;
+	if (newPos > FileSize)
+		return false;
+
+	Pos = newPos;
+	return true;
+}
+
+
+//! maps the file
+void CMappedReadFile::mapFile()
+{
+	if (Filename.size() == 0)
+		return;
+
+#if defined(_IRR_WINDOWS_API_)
+	#if defined ( _IRR_WCHAR_FILESYSTEM )
+	HANDLE file = CreateFileW(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	#else
+	HANDLE file = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	#endif
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (mapping)
+		{
+			Mapping = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			if (Mapping)
+				FileSize = size.QuadPart;
+			CloseHandle(mapping); // view keeps the mapping alive
+		}
+	}
+	CloseHandle(file);
+#elif defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_)
+	const int fd = open(Filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		void* mapping = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED)
+		{
+			Mapping = mapping;
+			FileSize = st.st_size;
+		}
+	}
+	close(fd); // mapping stays valid after closing the descriptor
+#endif
+}
+
+
+IReadFile* createMappedReadFile(const io::path& fileName)
+{
+	CMappedReadFile* file = new CMappedReadFile(fileName);
+	if (file->isOpen())
+		return file;
+
+	file->drop();
+	return 0;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
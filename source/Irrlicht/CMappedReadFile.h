@@ -0,0 +1,72 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_MAPPED_READ_FILE_H_INCLUDED__
+#define __C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IReadFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+	/*!
+		Class for reading a real file from disk through a memory mapping of the whole file.
+		Mapping is private (copy-on-write), so memory returned by getMappedPointer() may be written to
+		without the changes ever reaching the file on disk.
+	*/
+	class CMappedReadFile : public IReadFile
+	{
+        protected:
+            virtual ~CMappedReadFile();
+
+        public:
+            CMappedReadFile(const io::path& fileName);
+
+            //! returns how much was read
+            virtual int32_t read(void* buffer, uint32_t sizeToRead);
+
+            //! changes position in file, returns true if successful
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false);
+
+            //! returns size of file
+            virtual size_t getSize() const {return FileSize;}
+
+            //! returns if file is open
+            virtual bool isOpen() const
+            {
+                return Mapping != 0;
+            }
+
+            //! returns where in the file we are.
+            virtual size_t getPos() const {return Pos;}
+
+            //! returns name of file
+            virtual const io::path& getFileName() const {return Filename;}
+
+            //! returns pointer to first byte of the mapped file, valid as long as this object is alive
+            virtual const void* getMappedPointer() const {return Mapping;}
+
+            //! returns writable pointer to first byte of the mapping, writes never reach the file on disk
+            void* getMappedPointer() {return Mapping;}
+
+        private:
+
+            //! maps the file
+            void mapFile();
+
+            void* Mapping;
+            size_t FileSize;
+            size_t Pos;
+            io::path Filename;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -88,7 +88,10 @@ namespace io
 
             //! returns how much was read
             virtual int32_t read(void* buffer, uint32_t sizeToRead);
-	};
+
+            //! returns pointer to the memory the file reads from
+            virtual const void* getMappedPointer() const {return Buffer;}
+	};
 
 	class CMemoryWriteFile : public IWriteFile, public CMemoryFile<void*>
 	{
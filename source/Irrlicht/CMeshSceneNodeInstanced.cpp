@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CMeshSceneNodeInstanced.h"
+#include "CInstanceCuller.h"
 #include "COpenGLDriver.h"
 #include "ISceneManager.h"
 #include "ICameraSceneNode.h"
@@ -21,7 +22,7 @@ uint32_t CMeshSceneNodeInstanced::recullOrder;
 CMeshSceneNodeInstanced::CMeshSceneNodeInstanced(IDummyTransformationSceneNode* parent, ISceneManager* mgr, int32_t id,
         const core::vector3df& position, const core::vector3df& rotation, const core::vector3df& scale)
     : IMeshSceneNodeInstanced(parent, mgr, id, position, rotation, scale),
-    cpuCullingFunction(NULL), cpuCullingScratchSpace(NULL),
+    cpuCullingFunction(NULL), cpuCullingScratchSpace(NULL), cpuCullingOutputFunction(NULL), cpuCullingThreadCount(0),
     instanceDataBufferChanged(false), instanceDataBuffer(NULL), instanceBBoxes(NULL), instanceBBoxesCount(0),
     flagQueryForRetrieval(false),
     gpuCulledLodInstanceDataBuffer(NULL), cpuCulledLodInstanceDataBuffer(NULL), dataPerInstanceOutputSize(0),
@@ -77,6 +78,46 @@ void CMeshSceneNodeInstanced::setGPUCullingThresholdMultiplier(const double& mul
 #endif // _IRR_COMPILE_WITH_OPENGL_
 }
 
+void CMeshSceneNodeInstanced::setBuiltinCPUCulling(CPUCullingOutputFunc outputFunc, uint32_t threadCount)
+{
+    cpuCullingOutputFunction = outputFunc;
+    cpuCullingThreadCount = threadCount;
+
+    //! without LoD meshes setLoDMeshes() will set up the rest, with a CPUCullingFunc nothing changes
+    if (!gpuCulledLodInstanceDataBuffer)
+        return;
+    if (cpuCullingFunction)
+    {
+        if (outputFunc)
+            os::Printer::log("Built-in CPU instance culling won't be used, the node's LoD meshes were set with a CPUCullingFunc.",ELL_WARNING);
+        return;
+    }
+
+    if (outputFunc)
+    {
+        setGPUCullingThresholdMultiplier(1.0);
+        if (!cpuCulledLodInstanceDataBuffer)
+            createCPUCullingBuffers();
+    }
+    else
+        instanceCountThresholdForGPU = 0;
+}
+
+void CMeshSceneNodeInstanced::createCPUCullingBuffers()
+{
+    video::IDriverMemoryBacked::SDriverMemoryRequirements reqs;
+    reqs.vulkanReqs.size = gpuCulledLodInstanceDataBuffer->getSize();
+    reqs.vulkanReqs.alignment = 0;
+    reqs.vulkanReqs.memoryTypeBits = 0xffffffffu;
+    reqs.memoryHeapLocation = video::IDriverMemoryAllocation::ESMT_DEVICE_LOCAL;
+    reqs.mappingCapability = video::IDriverMemoryAllocation::EMCAF_NO_MAPPING_ACCESS;
+    reqs.prefersDedicatedAllocation = true;
+    reqs.requiresDedicatedAllocation = true;
+    cpuCulledLodInstanceDataBuffer = SceneManager->getVideoDriver()->createGPUBuffer(reqs,true);
+
+    cpuCullingScratchSpace = reinterpret_cast<uint8_t*>(_IRR_ALIGNED_MALLOC(gpuCulledLodInstanceDataBuffer->getSize(),_IRR_SIMD_ALIGNMENT));
+}
+
 
 //! Sets a new meshbuffer
 bool CMeshSceneNodeInstanced::setLoDMeshes(std::vector<MeshLoD> levelsOfDetail, const size_t& dataSizePerInstanceOutput, const video::SMaterial& lodSelectionShader, VaoSetupOverrideFunc vaoSetupOverride, const size_t shaderLoDsPerPass, void* overrideUserData, const size_t& extraDataSizePerInstanceInput, CPUCullingFunc cpuCullFunc)
@@ -146,26 +187,17 @@ bool CMeshSceneNodeInstanced::setLoDMeshes(std::vector<MeshLoD> levelsOfDetail,
 	gpuCulledLodInstanceDataBuffer = SceneManager->getVideoDriver()->createDeviceLocalGPUBufferOnDedMem(dataSizePerInstanceOutput*instanceBBoxesCount*gpuLoDsPerPass*xfb.size());
 	instanceDataBufferChanged = false;
 
-    if (cpuCullFunc)
+    if (cpuCullFunc||cpuCullingOutputFunction)
     {
+        if (cpuCullFunc&&cpuCullingOutputFunction)
+            os::Printer::log("Built-in CPU instance culling won't be used, the node's LoD meshes were set with a CPUCullingFunc.",ELL_WARNING);
 #ifdef _IRR_COMPILE_WITH_OPENGL_
         instanceCountThresholdForGPU = static_cast<video::COpenGLDriver*>(SceneManager->getVideoDriver())->getMaxConcurrentShaderInvocations();
 #else
         instanceCountThresholdForGPU = 0;
 #endif // _IRR_COMPILE_WITH_OPENGL_
         cpuCullingFunction = cpuCullFunc;
-
-        video::IDriverMemoryBacked::SDriverMemoryRequirements reqs;
-        reqs.vulkanReqs.size = gpuCulledLodInstanceDataBuffer->getSize();
-        reqs.vulkanReqs.alignment = 0;
-        reqs.vulkanReqs.memoryTypeBits = 0xffffffffu;
-        reqs.memoryHeapLocation = video::IDriverMemoryAllocation::ESMT_DEVICE_LOCAL;
-        reqs.mappingCapability = video::IDriverMemoryAllocation::EMCAF_NO_MAPPING_ACCESS;
-        reqs.prefersDedicatedAllocation = true;
-        reqs.requiresDedicatedAllocation = true;
-        cpuCulledLodInstanceDataBuffer = SceneManager->getVideoDriver()->createGPUBuffer(reqs,true);
-
-        cpuCullingScratchSpace = reinterpret_cast<uint8_t*>(_IRR_ALIGNED_MALLOC(gpuCulledLodInstanceDataBuffer->getSize(),_IRR_SIMD_ALIGNMENT));
+        createCPUCullingBuffers();
     }
     else
         instanceCountThresholdForGPU = 0;
@@ -419,6 +451,39 @@ void CMeshSceneNodeInstanced::removeInstances(const size_t& instanceCount, const
     lodCullingPointMesh->setIndexCount(lodCullingPointMesh->getIndexCount()-instanceCount);
 }
 
+void CMeshSceneNodeInstanced::cullInstancesOnCPU(uint8_t** outputPtrs)
+{
+    video::IVideoDriver* driver = SceneManager->getVideoDriver();
+    SViewFrustum frustum(driver->getTransform(video::EPTS_PROJ_VIEW));
+    frustum.cameraPosition.set(driver->getTransform(video::E4X3TS_VIEW_INVERSE).getTranslation());
+
+    float lodDistancesSQ[_IRR_XFORM_FEEDBACK_MAX_STREAMS_];
+    uint32_t* instanceIDs[_IRR_XFORM_FEEDBACK_MAX_STREAMS_];
+    size_t instanceCounts[_IRR_XFORM_FEEDBACK_MAX_STREAMS_];
+    cpuCulledInstanceIDs.resize(LoD.size()*instanceBBoxesCount);
+    for (size_t j=0; j<LoD.size(); j++)
+    {
+        lodDistancesSQ[j] = LoD[j].distanceSQ;
+        instanceIDs[j] = cpuCulledInstanceIDs.data()+j*instanceBBoxesCount;
+    }
+
+    //! boxes are indexed by instance ID, unused IDs have empty boxes which always get culled
+    CInstanceCuller::cull(instanceIDs,instanceCounts,instanceBBoxes,instanceBBoxesCount,frustum,AbsoluteTransformation,lodDistancesSQ,LoD.size(),cpuCullingThreadCount);
+
+    const size_t instanceDataStride = extraDataInstanceSize+12*4+36+visibilityPadding;
+    const uint8_t* instanceData = reinterpret_cast<const uint8_t*>(instanceDataBuffer->getBackBufferPointer());
+    for (size_t j=0; j<LoD.size(); j++)
+    for (size_t i=0; i<instanceCounts[j]; i++)
+    {
+        const uint8_t* instance = instanceData+instanceDataBuffer->getRedirectFromID(instanceIDs[j][i])*instanceDataStride;
+        if (!instance[48+36+extraDataInstanceSize])
+            continue;
+
+        cpuCullingOutputFunction(outputPtrs[j],instance,j,AbsoluteTransformation,SceneManager,cpuCullingUserData);
+        outputPtrs[j] += dataPerInstanceOutputSize;
+    }
+}
+
 void CMeshSceneNodeInstanced::RecullInstances()
 {
     if (LoD.size()==0||!instanceDataBuffer||instanceDataBuffer->getAllocatedCount()==0||!SceneManager)
@@ -435,7 +500,8 @@ void CMeshSceneNodeInstanced::RecullInstances()
 
     video::IVideoDriver* driver = SceneManager->getVideoDriver();
 
-    if (cpuCullingFunction&&(lodCullingPointMesh->getIndexCount()<instanceCountThresholdForGPU))
+    const bool cpuCulling = cpuCullingFunction||cpuCullingOutputFunction;
+    if (cpuCulling&&(lodCullingPointMesh->getIndexCount()<instanceCountThresholdForGPU))
     {
         size_t outputSizePerLoD = dataPerInstanceOutputSize*instanceDataBuffer->getCapacity();
         if (cpuCulledLodInstanceDataBuffer->getSize()!=LoD.size()*outputSizePerLoD)
@@ -445,6 +511,7 @@ void CMeshSceneNodeInstanced::RecullInstances()
             {auto rep = SceneManager->getVideoDriver()->createGPUBufferOnDedMem(reqs,cpuCulledLodInstanceDataBuffer->canUpdateSubRange()); cpuCulledLodInstanceDataBuffer->pseudoMoveAssign(rep); rep->drop();}
 
             _IRR_ALIGNED_FREE(cpuCullingScratchSpace);
+            cpuCullingScratchSpace = reinterpret_cast<uint8_t*>(_IRR_ALIGNED_MALLOC(LoD.size()*outputSizePerLoD,_IRR_SIMD_ALIGNMENT));
         }
 
 //typedef uint32_t (*CPUCullingFunc)(uint8_t** outputPtrs, const void* instanceData, const core::matrix4& ProjViewWorldMat, const core::matrix4& ViewWorldMat, const core::matrix4& WorldMat, const float* ViewNormalMat, const float* NormalMat,
@@ -457,8 +524,11 @@ void CMeshSceneNodeInstanced::RecullInstances()
                 LoD[j].mesh->getMeshBuffer(i)->setBaseInstance(j*outputSizePerLoD/dataPerInstanceOutputSize);
         }
 
-        cpuCullingFunction(pseudoStreamPointers,dataPerInstanceOutputSize,getLoDInvariantBBox(),instanceDataBuffer->getAllocatedCount(),AbsoluteTransformation,
-                           reinterpret_cast<uint8_t*>(instanceDataBuffer->getBackBufferPointer()),(extraDataInstanceSize+12*4+36+visibilityPadding),SceneManager,cpuCullingUserData);
+        if (cpuCullingFunction)
+            cpuCullingFunction(pseudoStreamPointers,dataPerInstanceOutputSize,getLoDInvariantBBox(),instanceDataBuffer->getAllocatedCount(),AbsoluteTransformation,
+                               reinterpret_cast<uint8_t*>(instanceDataBuffer->getBackBufferPointer()),(extraDataInstanceSize+12*4+36+visibilityPadding),SceneManager,cpuCullingUserData);
+        else
+            cullInstancesOnCPU(pseudoStreamPointers);
 
         //! DO WE NEED TO DO THIS FOR CPU CULLING FRAMES?
         if (instanceDataBufferChanged)
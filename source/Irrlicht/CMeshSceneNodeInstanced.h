@@ -76,6 +76,11 @@ class CMeshSceneNodeInstanced : public IMeshSceneNodeInstanced
         virtual const core::aabbox3df& getLoDInvariantBBox() const {return LoDInvariantBox;}
 
 
+        virtual void setBuiltinCPUCulling(CPUCullingOutputFunc outputFunc, uint32_t threadCount=0);
+
+        virtual bool isBuiltinCPUCullingEnabled() const {return cpuCullingOutputFunction!=NULL;}
+
+
         virtual const size_t& getInstanceCount() const { return instanceDataBuffer->getAllocatedCount(); }
 
 
@@ -149,7 +154,15 @@ class CMeshSceneNodeInstanced : public IMeshSceneNodeInstanced
         bool lastTimeUsedGPU;
         CPUCullingFunc cpuCullingFunction;
         uint8_t* cpuCullingScratchSpace;
-
+        //! set when the built-in CPU culling is on
+        CPUCullingOutputFunc cpuCullingOutputFunction;
+        uint32_t cpuCullingThreadCount;
+        //! IDs of instances the built-in CPU culling keeps, instanceBBoxesCount of them reserved for each LoD
+        std::vector<uint32_t> cpuCulledInstanceIDs;
+
+        void createCPUCullingBuffers();
+        //! built-in replacement of a CPUCullingFunc
+        void cullInstancesOnCPU(uint8_t** outputPtrs);
         void RecullInstances();
         core::aabbox3d<float> Box;
         core::aabbox3d<float> LoDInvariantBox;
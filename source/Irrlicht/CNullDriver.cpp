@@ -746,8 +746,8 @@ ITexture* CNullDriver::addTexture(const ITexture::E_TEXTURE_TYPE& type, const st
     if (format==ECF_UNKNOWN)
         format = ECF_A1R5G5B5;
 
-    //better safe than sorry
-    if (type!=ITexture::ETT_2D||format!=ECF_A1R5G5B5)
+    //better safe than sorry, ETT_COUNT means the type is up to the images, loaded files are always 2D
+    if ((type!=ITexture::ETT_2D&&type!=ITexture::ETT_COUNT)||format!=ECF_A1R5G5B5)
         return NULL;
 
 	ITexture* t = new SDummyTexture(name);
@@ -13,6 +13,9 @@
 #include "IReadFile.h"
 #include "coreutil.h"
 #include "os.h"
+#include "fast_atof.h"
+
+#include <thread>
 
 /*
 namespace std
@@ -48,11 +51,50 @@ namespace scene
 //#endif
 
 static const uint32_t WORD_BUFFER_LENGTH = 512;
+//! Smallest part of file worth parsing on a separate thread
+static const size_t MIN_CHUNK_SIZE = 0x1u<<20;
+static const uint32_t NORMAL_CACHE_SIZE = 4093u;
+
+static inline bool isBlank(const char c)
+{
+	return c==' ' || c=='\t';
+}
+
+static inline bool isDigit(const char c)
+{
+	return uint32_t(c-'0')<10u;
+}
+
+//! Parses (possibly negative) integer, 0 if there are no digits
+static inline const char* readIndex(const char* buf, const char* const bufEnd, int32_t& out)
+{
+	const bool negative = buf!=bufEnd && *buf=='-';
+	if (negative)
+		++buf;
+	uint32_t value = 0u;
+	for (; buf!=bufEnd && isDigit(*buf); ++buf)
+		value = value*10u+uint32_t(*buf-'0');
+	out = negative ? -int32_t(value):int32_t(value);
+	return buf;
+}
+
+//! returns second word of the line, i.e. argument of the statement
+static std::string readStatementArgument(const char* buf, const char* const bufEnd)
+{
+	while (buf!=bufEnd && !core::isspace(*buf))
+		++buf;
+	while (buf!=bufEnd && isBlank(*buf))
+		++buf;
+	const char* const wordStart = buf;
+	while (buf!=bufEnd && !core::isspace(*buf))
+		++buf;
+	return std::string(wordStart, buf);
+}
 
 
 //! Constructor
 COBJMeshFileLoader::COBJMeshFileLoader(scene::ISceneManager* smgr, io::IFileSystem* fs)
-: SceneManager(smgr), FileSystem(fs), useGroups(false), useMaterials(true)
+: SceneManager(smgr), FileSystem(fs), useGroups(false), useMaterials(true), parsingThreadCnt(0u)
 {
 	#ifdef _DEBUG
 	setDebugName("COBJMeshFileLoader");
@@ -89,125 +131,141 @@ ICPUMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	if (!filesize)
 		return 0;
 
-	const uint32_t WORD_BUFFER_LENGTH = 512;
-
-	core::array<core::vector3df> vertexBuffer;
-	core::array<core::vector3df> normalsBuffer;
-	core::array<core::vector2df> textureCoordBuffer;
-
 	SObjMtl * currMtl = new SObjMtl();
 	Materials.push_back(currMtl);
-	uint32_t smoothingGroup=0;
 
 	const io::path fullName = file->getFileName();
 	const io::path relPath = io::IFileSystem::getFileDir(fullName)+"/";
 
-	char* buf = new char[filesize];
-	memset(buf, 0, filesize);
-	file->read((void*)buf, filesize);
-	const char* const bufEnd = buf+filesize;
+	// parse in place if the file is in memory already
+	const char* buf = reinterpret_cast<const char*>(file->getMappedPointer());
+	char* ownBuf = NULL;
+	const char* bufEnd = buf+filesize;
+	if (!buf)
+	{
+		buf = ownBuf = new char[filesize];
+		bufEnd = buf+core::max_<int32_t>(file->read((void*)ownBuf, filesize), 0);
+	}
 
-	// Process obj information
-	const char* bufPtr = buf;
+	// split contents at line boundaries, one chunk per thread unless it would get too small to pay off
+	const uint32_t threadCnt = parsingThreadCnt ? parsingThreadCnt : std::max(std::thread::hardware_concurrency(), 1u);
+	const size_t chunkCnt = core::max_<size_t>(core::min_<size_t>(threadCnt, (bufEnd-buf)/MIN_CHUNK_SIZE), 1u);
+	std::vector<const char*> chunkBounds(chunkCnt+1u);
+	chunkBounds[0] = buf;
+	chunkBounds[chunkCnt] = bufEnd;
+	for (size_t i=1u; i<chunkCnt; i++)
+	{
+		const char* bound = core::max_<const char*>(chunkBounds[i-1u], buf+(bufEnd-buf)*i/chunkCnt);
+		bound = core::findLineBreak(bound, bufEnd);
+		chunkBounds[i] = bound;
+	}
+
+	std::vector<SObjChunk> chunks(chunkCnt);
+	{
+		std::vector<std::thread> workers;
+		for (size_t i=1u; i<chunkCnt; i++)
+			workers.push_back(std::thread(parseChunk, chunkBounds[i], chunkBounds[i+1u], std::ref(chunks[i])));
+		parseChunk(chunkBounds[0], chunkBounds[1], chunks[0]);
+		for (size_t i=0u; i<workers.size(); i++)
+			workers[i].join();
+	}
+	// Clean up the allocate obj file contents
+	delete [] ownBuf;
+
+	// gather vertex attributes of all chunks, remembering where each chunk's ones start to resolve relative indices
+	std::vector<core::vector3df> vertexBuffer;
+	std::vector<core::vector2df> textureCoordBuffer;
+	std::vector<uint32_t> normalsBuffer;
+	std::vector<uint32_t> chunkAttrBase(3u*chunkCnt);
+	for (size_t i=0u; i<chunkCnt; i++)
+	{
+		chunkAttrBase[3u*i+0u] = vertexBuffer.size();
+		chunkAttrBase[3u*i+1u] = textureCoordBuffer.size();
+		chunkAttrBase[3u*i+2u] = normalsBuffer.size();
+		vertexBuffer.insert(vertexBuffer.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+		textureCoordBuffer.insert(textureCoordBuffer.end(), chunks[i].texcoords.begin(), chunks[i].texcoords.end());
+		normalsBuffer.insert(normalsBuffer.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+		std::vector<core::vector3df>().swap(chunks[i].positions);
+		std::vector<core::vector2df>().swap(chunks[i].texcoords);
+		std::vector<uint32_t>().swap(chunks[i].normals);
+	}
+	const int64_t attrCnt[3] = {int64_t(vertexBuffer.size()), int64_t(textureCoordBuffer.size()), int64_t(normalsBuffer.size())};
+
+	// stitch chunks in file order, resolving indices and welding vertices into per-material buffers
 	std::string grpName, mtlName;
 	bool mtlChanged=false;
-	while(bufPtr != bufEnd)
+	bool badIndices=false;
+	std::vector<SObjFaceCorner> faceIndices;
+	std::vector<uint32_t> faceCorners;
+	for (size_t c=0u; c<chunkCnt; c++)
 	{
-		switch(bufPtr[0])
-		{
-		case 'm':	// mtllib (material)
+		const SObjChunk& chunk = chunks[c];
+		std::vector<SObjStateChange>::const_iterator change = chunk.stateChanges.begin();
+		uint32_t cornerIx = 0u;
+		for (uint32_t f=0u; f<=chunk.faces.size(); f++)
 		{
-			if (useMaterials)
+			for (; change!=chunk.stateChanges.end() && change->faceIx==f; ++change)
+			switch (change->type)
 			{
-				char name[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+			case 'm':	// mtllib (material)
+				if (useMaterials)
+				{
 #ifdef _IRR_DEBUG_OBJ_LOADER_
-				os::Printer::log("Reading material file",name);
+					os::Printer::log("Reading material file",change->name.c_str());
 #endif
-				readMTL(name, relPath);
-			}
-		}
-			break;
-
-		case 'v':               // v, vn, vt
-			switch(bufPtr[1])
-			{
-			case ' ':          // vertex
-				{
-					core::vector3df vec;
-					bufPtr = readVec3(bufPtr, vec, bufEnd);
-					vertexBuffer.push_back(vec);
+					readMTL(change->name.c_str(), relPath);
 				}
 				break;
-
-			case 'n':       // normal
-				{
-					core::vector3df vec;
-					bufPtr = readVec3(bufPtr, vec, bufEnd);
-					normalsBuffer.push_back(vec);
-				}
-				break;
-
-			case 't':       // texcoord
-				{
-					core::vector2df vec;
-					bufPtr = readUV(bufPtr, vec, bufEnd);
-					textureCoordBuffer.push_back(vec);
-				}
-				break;
-			}
-			break;
-
-		case 'g': // group name
-			{
-				char grp[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(grp, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+			case 'g': // group name
 #ifdef _IRR_DEBUG_OBJ_LOADER_
-	os::Printer::log("Loaded group start",grp, ELL_DEBUG);
+				os::Printer::log("Loaded group start",change->name.c_str(), ELL_DEBUG);
 #endif
 				if (useGroups)
 				{
-					if (0 != grp[0])
-						grpName = grp;
+					if (change->name.size())
+						grpName = change->name;
 					else
 						grpName = "default";
 
-                    mtlChanged=true;
+					mtlChanged=true;
 				}
-			}
-			break;
-
-		case 's': // smoothing can be a group or off (equiv. to 0)
-			{
-				char smooth[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(smooth, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				break;
+			case 'u': // usemtl
 #ifdef _IRR_DEBUG_OBJ_LOADER_
-	os::Printer::log("Loaded smoothing group start",smooth, ELL_DEBUG);
+				os::Printer::log("Loaded material start",change->name.c_str(), ELL_DEBUG);
 #endif
-				if (core::stringc("off")==smooth)
-					smoothingGroup=0;
-				else
-                    sscanf(smooth,"%u",&smoothingGroup);
+				mtlName=change->name;
+				mtlChanged=true;
+				break;
 			}
-			break;
+			if (f==chunk.faces.size())
+				break;
 
-		case 'u': // usemtl
-			// get name of material
+			const SObjFace& face = chunk.faces[f];
+			// resolve 1-based and relative indices to 0-based ones, -1 for the index if it doesn't exist
+			faceIndices.clear();
+			bool validFace = true;
+			for (; cornerIx<face.cornersEnd; cornerIx++)
 			{
-				char matName[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(matName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-#ifdef _IRR_DEBUG_OBJ_LOADER_
-	os::Printer::log("Loaded material start",matName, ELL_DEBUG);
-#endif
-				mtlName=matName;
-				mtlChanged=true;
+				SObjFaceCorner idx;
+				for (uint32_t k=0u; k<3u; k++)
+				{
+					const int32_t raw = chunk.corners[cornerIx].idx[k];
+					const int64_t resolved = raw>0 ? int64_t(raw)-1:(int64_t(chunkAttrBase[3u*c+k])+face.attrCnt[k]+raw);
+					if (raw && resolved>=0 && resolved<attrCnt[k])
+						idx.idx[k] = resolved;
+					else
+					{
+						idx.idx[k] = -1;
+						badIndices |= raw!=0;
+					}
+				}
+				validFace &= idx.idx[0]!=-1;
+				faceIndices.push_back(idx);
 			}
-			break;
+			if (!validFace || faceIndices.size()<3u)
+				continue;
 
-		case 'f':               // face
-		{
-			char vertexWord[WORD_BUFFER_LENGTH]; // for retrieving vertex data
-			SObjVertex v;
 			// Assign vertex color from currently active material's diffuse color
 			if (mtlChanged)
 			{
@@ -219,72 +277,41 @@ ICPUMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 				mtlChanged=false;
 			}
 
-			// get all vertices data in this face (current line of obj file)
-			const core::stringc wordBuffer = copyLine(bufPtr, bufEnd);
-			const char* linePtr = wordBuffer.c_str();
-			const char* const endPtr = linePtr+wordBuffer.size();
+			faceCorners.clear();
+			for (size_t i=0u; i<faceIndices.size(); i++)
+			{
+				const int32_t* Idx = faceIndices[i].idx;
+				if ( -1 == Idx[2] )
+					currMtl->RecalculateNormals=true;
 
-			core::array<uint32_t> faceCorners;
-			faceCorners.reallocate(32); // should be large enough
+				// weld corners referencing the same v/vt/vn
+				const uint32_t vertLocation = currMtl->VertMap.findOrInsert(faceIndices[i], currMtl->Vertices.size());
+				faceCorners.push_back(vertLocation);
+				if (vertLocation!=currMtl->Vertices.size())
+					continue;
 
-			// read in all vertices
-			linePtr = goNextWord(linePtr, endPtr);
-			while (0 != linePtr[0])
-			{
-				// Array to communicate with retrieveVertexIndices()
-				// sends the buffer sizes and gets the actual indices
-				// if index not set returns -1
-				int32_t Idx[3];
-				Idx[1] = Idx[2] = -1;
-
-				// read in next vertex's data
-				uint32_t wlength = copyWord(vertexWord, linePtr, WORD_BUFFER_LENGTH, endPtr);
-				// this function will also convert obj's 1-based index to c++'s 0-based index
-				retrieveVertexIndices(vertexWord, Idx, vertexWord+wlength+1, vertexBuffer.size(), textureCoordBuffer.size(), normalsBuffer.size());
+				SObjVertex v;
 				v.pos[0] = vertexBuffer[Idx[0]].X;
 				v.pos[1] = vertexBuffer[Idx[0]].Y;
 				v.pos[2] = vertexBuffer[Idx[0]].Z;
 				//set texcoord
 				if ( -1 != Idx[1] )
-                {
+				{
 					v.uv[0] = textureCoordBuffer[Idx[1]].X;
 					v.uv[1] = textureCoordBuffer[Idx[1]].Y;
-                }
+				}
 				else
-                {
+				{
 					v.uv[0] = 0.f;
 					v.uv[1] = 0.f;
-                }
-                //set normal
+				}
+				//set normal
 				if ( -1 != Idx[2] )
-                {
-					core::vectorSIMDf simdNormal;
-					simdNormal.set(normalsBuffer[Idx[2]]);
-					v.normal32bit = quantizeNormal2_10_10_10(simdNormal);
-                }
+					v.normal32bit = normalsBuffer[Idx[2]];
 				else
-				{
 					v.normal32bit = 0;
-					currMtl->RecalculateNormals=true;
-				}
 
-				int vertLocation;
-				std::map<SObjVertex, int>::iterator n = currMtl->VertMap.find(v);
-				if (n!=currMtl->VertMap.end())
-				{
-					vertLocation = n->second;
-				}
-				else
-				{
-					currMtl->Vertices.push_back(v);
-					vertLocation = currMtl->Vertices.size() -1;
-					currMtl->VertMap.insert(std::pair<SObjVertex, int>(v, vertLocation));
-				}
-
-				faceCorners.push_back(vertLocation);
-
-				// go to next vertex
-				linePtr = goNextWord(linePtr, endPtr);
+				currMtl->Vertices.push_back(v);
 			}
 
 			// triangulate the face
@@ -295,22 +322,14 @@ ICPUMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 				currMtl->Indices.push_back( faceCorners[i] );
 				currMtl->Indices.push_back( faceCorners[0] );
 			}
-			faceCorners.set_used(0); // fast clear
-			faceCorners.reallocate(32);
 		}
-		break;
-
-		case '#': // comment
-		default:
-			break;
-		}	// end switch(bufPtr[0])
-		// eat up rest of line
-		bufPtr = goNextLine(bufPtr, bufEnd);
-	}	// end while(bufPtr && (bufPtr-buf<filesize))
-	// Clean up the allocate obj file contents
-	delete [] buf;
+	}
+	if (badIndices)
+		os::Printer::log("OBJ file contains out of range indices, ignored them in", fullName.c_str(), ELL_WARNING);
+	chunks.clear();
 
-	SCPUMesh* mesh = new SCPUMesh();
+	SCPUMesh* mesh
+ = new SCPUMesh();
 
 	// Combine all the groups (meshbuffers) into the mesh
 	for ( uint32_t m = 0; m < Materials.size(); ++m )
@@ -345,7 +364,7 @@ ICPUMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
             }
             for (size_t i=0; i<Materials[m]->Vertices.size(); i++)
             {
-                Materials[m]->Vertices[i].normal32bit = quantizeNormal2_10_10_10(newNormals[i]);
+                Materials[m]->Vertices[i].normal32bit = quantizeNormal2_10_10_10Uncached(newNormals[i]);
             }
             alctr.deallocate(newNormals);
         }
@@ -428,6 +447,129 @@ ICPUMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 }
 
 
+void COBJMeshFileLoader::parseChunk(const char* bufPtr, const char* const bufEnd, SObjChunk& chunk)
+{
+	// quantizeNormal2_10_10_10's cache is global (not thread-safe), so every chunk has its own small direct-mapped one
+	struct SQuantizedNormal
+	{
+		core::vector3df normal;
+		uint32_t quantized;
+		bool valid;
+	};
+	std::vector<SQuantizedNormal> quantizedNormals(NORMAL_CACHE_SIZE, SQuantizedNormal{core::vector3df(), 0u, false});
+	const auto hashNormal = [](const core::vector3df& n) -> uint32_t
+	{
+		uint32_t bits[3];
+		memcpy(bits, &n.X, sizeof(bits));
+		return ((bits[0]*73856093u)^(bits[1]*19349663u)^(bits[2]*83492791u))%NORMAL_CACHE_SIZE;
+	};
+
+	while (bufPtr != bufEnd)
+	{
+		// skip empty lines and indentation
+		if (core::isspace(bufPtr[0]))
+		{
+			++bufPtr;
+			continue;
+		}
+
+		const char next = bufPtr+1!=bufEnd ? bufPtr[1]:'\n';
+		switch(bufPtr[0])
+		{
+		case 'v':               // v, vn, vt
+			if (isBlank(next))	// vertex
+			{
+				core::vector3df vec;
+				const char* ptr = core::fast_atof_move(bufPtr+1, bufEnd, vec.X);
+				ptr = core::fast_atof_move(ptr, bufEnd, vec.Y);
+				core::fast_atof_move(ptr, bufEnd, vec.Z);
+				vec.X = -vec.X; // change handedness
+				chunk.positions.push_back(vec);
+			}
+			else if (next=='n')	// normal
+			{
+				core::vector3df vec;
+				const char* ptr = core::fast_atof_move(bufPtr+2, bufEnd, vec.X);
+				ptr = core::fast_atof_move(ptr, bufEnd, vec.Y);
+				core::fast_atof_move(ptr, bufEnd, vec.Z);
+				vec.X = -vec.X; // change handedness
+
+				// quantization is costly, but the same normal tends to repeat in neighbouring lines
+				SQuantizedNormal& cached = quantizedNormals[hashNormal(vec)];
+				if (!cached.valid || cached.normal!=vec)
+				{
+					core::vectorSIMDf simdNormal;
+					simdNormal.set(vec);
+					cached.normal = vec;
+					cached.quantized = quantizeNormal2_10_10_10Uncached(simdNormal);
+					cached.valid = true;
+				}
+				chunk.normals.push_back(cached.quantized);
+			}
+			else if (next=='t')	// texcoord
+			{
+				core::vector2df vec;
+				core::fast_atof_move(core::fast_atof_move(bufPtr+2, bufEnd, vec.X), bufEnd, vec.Y);
+				vec.Y = 1-vec.Y; // change handedness
+				chunk.texcoords.push_back(vec);
+			}
+			break;
+
+		case 'f':               // face
+		{
+			SObjFace face;
+			face.attrCnt[0] = chunk.positions.size();
+			face.attrCnt[1] = chunk.texcoords.size();
+			face.attrCnt[2] = chunk.normals.size();
+
+			// read in all corners' v/vt/vn until end of line (or a comment)
+			const char* ptr = bufPtr+1;
+			while (true)
+			{
+				while (ptr!=bufEnd && isBlank(*ptr))
+					++ptr;
+				if (ptr==bufEnd || !(isDigit(*ptr) || *ptr=='-'))
+					break;
+
+				SObjFaceCorner corner = {{0, 0, 0}};
+				ptr = readIndex(ptr, bufEnd, corner.idx[0]);
+				for (uint32_t i=1u; i<3u && ptr!=bufEnd && *ptr=='/'; i++)
+					ptr = readIndex(ptr+1, bufEnd, corner.idx[i]);
+				while (ptr!=bufEnd && !core::isspace(*ptr))
+					++ptr;
+				chunk.corners.push_back(corner);
+			}
+			face.cornersEnd = chunk.corners.size();
+			chunk.faces.push_back(face);
+		}
+			break;
+
+		case 'm':	// mtllib (material)
+			if (bufEnd-bufPtr>6 && !strncmp(bufPtr, "mtllib", 6))
+			{
+				SObjStateChange change = {uint32_t(chunk.faces.size()), 'm', readStatementArgument(bufPtr, bufEnd)};
+				chunk.stateChanges.push_back(change);
+			}
+			break;
+
+		case 'g': // group name
+		case 'u': // usemtl
+			{
+				SObjStateChange change = {uint32_t(chunk.faces.size()), bufPtr[0], readStatementArgument(bufPtr, bufEnd)};
+				chunk.stateChanges.push_back(change);
+			}
+			break;
+
+		case '#': // comment
+		default:
+			break;
+		}	// end switch(bufPtr[0])
+		// eat up rest of line
+		bufPtr = core::findLineBreak(bufPtr, bufEnd);
+	}
+}
+
+
 const char* COBJMeshFileLoader::readTextures(const char* bufPtr, const char* const bufEnd, SObjMtl* currMaterial, const io::path& relPath)
 {
 	uint8_t type=0; // map_Kd - diffuse color texture map
@@ -803,40 +945,6 @@ const char* COBJMeshFileLoader::readColor(const char* bufPtr, video::SColor& col
 }
 
 
-//! Read 3d vector of floats
-const char* COBJMeshFileLoader::readVec3(const char* bufPtr, core::vector3df& vec, const char* const bufEnd)
-{
-	const uint32_t WORD_BUFFER_LENGTH = 256;
-	char wordBuffer[WORD_BUFFER_LENGTH];
-
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",&vec.X);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",&vec.Y);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",&vec.Z);
-
-	vec.X = -vec.X; // change handedness
-	return bufPtr;
-}
-
-
-//! Read 2d vector of floats
-const char* COBJMeshFileLoader::readUV(const char* bufPtr, core::vector2df& vec, const char* const bufEnd)
-{
-	const uint32_t WORD_BUFFER_LENGTH = 256;
-	char wordBuffer[WORD_BUFFER_LENGTH];
-
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",&vec.X);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",&vec.Y);
-
-	vec.Y = 1-vec.Y; // change handedness
-	return bufPtr;
-}
-
-
 //! Read boolean value represented as 'on' or 'off'
 const char* COBJMeshFileLoader::readBool(const char* bufPtr, bool& tf, const char* const bufEnd)
 {
@@ -950,23 +1058,6 @@ uint32_t COBJMeshFileLoader::copyWord(char* outBuf, const char* const inBuf, uin
 }
 
 
-core::stringc COBJMeshFileLoader::copyLine(const char* inBuf, const char* bufEnd)
-{
-	if (!inBuf)
-		return core::stringc();
-
-	const char* ptr = inBuf;
-	while (ptr<bufEnd)
-	{
-		if (*ptr=='\n' || *ptr=='\r')
-			break;
-		++ptr;
-	}
-	// we must avoid the +1 in case the array is used up
-	return core::stringc(inBuf, (uint32_t)(ptr-inBuf+((ptr < bufEnd) ? 1 : 0)));
-}
-
-
 const char* COBJMeshFileLoader::goAndCopyNextWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* bufEnd)
 {
 	inBuf = goNextWord(inBuf, bufEnd, false);
@@ -975,77 +1066,6 @@ const char* COBJMeshFileLoader::goAndCopyNextWord(char* outBuf, const char* inBu
 }
 
 
-bool COBJMeshFileLoader::retrieveVertexIndices(char* vertexData, int32_t* idx, const char* bufEnd, uint32_t vbsize, uint32_t vtsize, uint32_t vnsize)
-{
-	char word[16] = "";
-	const char* p = goFirstWord(vertexData, bufEnd);
-	uint32_t idxType = 0;	// 0 = posIdx, 1 = texcoordIdx, 2 = normalIdx
-
-	uint32_t i = 0;
-	while ( p != bufEnd )
-	{
-		if ( ( core::isdigit(*p)) || (*p == '-') )
-		{
-			// build up the number
-			word[i++] = *p;
-		}
-		else if ( *p == '/' || *p == ' ' || *p == '\0' )
-		{
-			// number is completed. Convert and store it
-			word[i] = '\0';
-			// if no number was found index will become 0 and later on -1 by decrement
-			sscanf(word,"%u",idx+idxType);
-			if (idx[idxType]<0)
-			{
-				switch (idxType)
-				{
-					case 0:
-						idx[idxType] += vbsize;
-						break;
-					case 1:
-						idx[idxType] += vtsize;
-						break;
-					case 2:
-						idx[idxType] += vnsize;
-						break;
-				}
-			}
-			else
-				idx[idxType]-=1;
-
-			// reset the word
-			word[0] = '\0';
-			i = 0;
-
-			// go to the next kind of index type
-			if (*p == '/')
-			{
-				if ( ++idxType > 2 )
-				{
-					// error checking, shouldn't reach here unless file is wrong
-					idxType = 0;
-				}
-			}
-			else
-			{
-				// set all missing values to disable (=-1)
-				while (++idxType < 3)
-					idx[idxType]=-1;
-				++p;
-				break; // while
-			}
-		}
-
-		// go to the next char
-		++p;
-	}
-
-	return true;
-}
-
-
-
-
 } // end namespace scene
 } // end namespace irr
 
@@ -118,7 +118,85 @@ public:
 	//! See IReferenceCounted::drop() for more information.
 	virtual ICPUMesh* createMesh(io::IReadFile* file);
 
-private:
+	//! Sets number of threads used to parse the file.
+	/** File contents are split at line boundaries into chunks whose positions, normals, texcoords and faces are parsed concurrently.
+	Indices are then resolved and vertices welded into per-material buffers on the calling thread, in file order.
+	@param _cnt Number of threads. 0 (default) means as many threads as hardware supports, 1 means fully serial parsing.*/
+	void setParsingThreadCount(uint32_t _cnt) { parsingThreadCnt = _cnt; }
+	uint32_t getParsingThreadCount() const { return parsingThreadCnt; }
+
+private:
+
+	//! Face corner as written in the file: 1-based position, texcoord and normal indices, negative ones are relative, 0 means absent
+	//! Once resolved, 0-based indices with -1 for absent attribute
+	struct SObjFaceCorner
+	{
+		int32_t idx[3];
+	};
+
+	//! Open addressing (linear probing) hash map from resolved v/vt/vn index triple to index of welded vertex
+	class CObjVertexIndexMap
+	{
+			struct SSlot
+			{
+				SObjFaceCorner key;
+				uint32_t value;
+			};
+			static const uint32_t EMPTY = 0xffffffffu;
+
+		public:
+			CObjVertexIndexMap() : Size(0u) {}
+
+			//! @returns Vertex already welded from the same indices or `_newValue` if there's none, in which case it gets inserted
+			inline uint32_t findOrInsert(const SObjFaceCorner& _key, uint32_t _newValue)
+			{
+				// keep load factor under 1/2 so probe sequences stay short
+				if (2u*(Size+1u)>Slots.size())
+					grow();
+
+				const size_t mask = Slots.size()-1u;
+				for (size_t i=hash(_key)&mask; ; i=(i+1u)&mask)
+				{
+					SSlot& slot = Slots[i];
+					if (slot.value==EMPTY)
+					{
+						slot.key = _key;
+						slot.value = _newValue;
+						Size++;
+						return _newValue;
+					}
+					if (slot.key.idx[0]==_key.idx[0] && slot.key.idx[1]==_key.idx[1] && slot.key.idx[2]==_key.idx[2])
+						return slot.value;
+				}
+			}
+
+		private:
+			static inline size_t hash(const SObjFaceCorner& _key)
+			{
+				uint64_t h = uint32_t(_key.idx[0]);
+				h = h*0x9E3779B97F4A7C15ull^uint32_t(_key.idx[1]);
+				h = h*0x9E3779B97F4A7C15ull^uint32_t(_key.idx[2]);
+				return h^(h>>29);
+			}
+
+			void grow()
+			{
+				std::vector<SSlot> oldSlots(core::max_<size_t>(Slots.size()*2u, 64u), SSlot{{{0, 0, 0}}, EMPTY});
+				oldSlots.swap(Slots);
+				const size_t mask = Slots.size()-1u;
+				for (size_t j=0u; j<oldSlots.size(); j++)
+				if (oldSlots[j].value!=EMPTY)
+				{
+					size_t i = hash(oldSlots[j].key)&mask;
+					while (Slots[i].value!=EMPTY)
+						i = (i+1u)&mask;
+					Slots[i] = oldSlots[j];
+				}
+			}
+
+			std::vector<SSlot> Slots;
+			uint32_t Size;
+	};
 
 	class SObjMtl
 	{
@@ -140,7 +218,7 @@ private:
                 Material = o.Material;
             }
 
-            std::map<SObjVertex, int> VertMap;
+            CObjVertexIndexMap VertMap;
             std::vector<SObjVertex> Vertices;
             std::vector<uint32_t> Indices;
             video::SMaterial Material;
@@ -151,6 +229,33 @@ private:
             bool RecalculateNormals;
 	};
 
+	struct SObjFace
+	{
+		uint32_t cornersEnd;
+		//! Positions, texcoords and normals parsed in the chunk before this face, needed to resolve relative indices
+		uint32_t attrCnt[3];
+	};
+	//! `mtllib`, `usemtl` or `g` statement, applied between faces in file order once all chunks are parsed
+	struct SObjStateChange
+	{
+		uint32_t faceIx; //! number of faces of the chunk preceding the statement
+		char type;
+		std::string name;
+	};
+	//! Contents of file range starting and ending at line boundaries
+	struct SObjChunk
+	{
+		std::vector<core::vector3df> positions;
+		std::vector<core::vector2df> texcoords;
+		std::vector<uint32_t> normals; //! already quantized to 2_10_10_10
+		std::vector<SObjFaceCorner> corners;
+		std::vector<SObjFace> faces;
+		std::vector<SObjStateChange> stateChanges;
+	};
+
+	//! Parses vertex attributes, faces and state changing statements of one chunk, called concurrently for different chunks
+	static void parseChunk(const char* bufPtr, const char* const bufEnd, SObjChunk& chunk);
+
 	// helper method for material reading
 	const char* readTextures(const char* bufPtr, const char* const bufEnd, SObjMtl* currMaterial, const io::path& relPath);
 
@@ -162,8 +267,6 @@ private:
 	const char* goNextLine(const char* buf, const char* const bufEnd);
 	// copies the current word from the inBuf to the outBuf
 	uint32_t copyWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* const pBufEnd);
-	// copies the current line from the inBuf to the outBuf
-	core::stringc copyLine(const char* inBuf, const char* const bufEnd);
 
 	// combination of goNextWord followed by copyWord
 	const char* goAndCopyNextWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* const pBufEnd);
@@ -176,24 +279,16 @@ private:
 
 	//! Read RGB color
 	const char* readColor(const char* bufPtr, video::SColor& color, const char* const pBufEnd);
-	//! Read 3d vector of floats
-	const char* readVec3(const char* bufPtr, core::vector3df& vec, const char* const pBufEnd);
-	//! Read 2d vector of floats
-	const char* readUV(const char* bufPtr, core::vector2df& vec, const char* const pBufEnd);
 	//! Read boolean value represented as 'on' or 'off'
 	const char* readBool(const char* bufPtr, bool& tf, const char* const bufEnd);
 
-	// reads and convert to integer the vertex indices in a line of obj file's face statement
-	// -1 for the index if it doesn't exist
-	// indices are changed to 0-based index instead of 1-based from the obj file
-	bool retrieveVertexIndices(char* vertexData, int32_t* idx, const char* bufEnd, uint32_t vbsize, uint32_t vtsize, uint32_t vnsize);
-
 
 	scene::ISceneManager* SceneManager;
 	io::IFileSystem* FileSystem;
 
 	bool useGroups;
-	bool useMaterials;
+	bool useMaterials;
+	uint32_t parsingThreadCnt;
 
 	core::array<SObjMtl*> Materials;
 };
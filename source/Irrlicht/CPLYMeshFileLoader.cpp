@@ -13,6 +13,7 @@
 #include "SAnimatedMesh.h"
 #include "IReadFile.h"
 #include "os.h"
+#include "fast_atof.h"
 
 namespace irr
 {
@@ -232,6 +233,8 @@ ICPUMesh* CPLYMeshFileLoader::createMesh(io::IReadFile* file)
 
             std::vector<core::vectorSIMDf> attribs[4];
             std::vector<uint32_t> indices;
+            bool vertexBufferCreated = false;
+            size_t vertexCount = 0u;
 
 			bool hasNormals=true;
 			// loop through each of the elements
@@ -240,15 +243,36 @@ ICPUMesh* CPLYMeshFileLoader::createMesh(io::IReadFile* file)
 				// do we want this element type?
 				if (ElementList[i]->Name == "vertex")
 				{
-					// loop through vertex properties
-					for (uint32_t j=0; j < ElementList[i]->Count; ++j)
-						hasNormals &= readVertex(*ElementList[i], attribs);
+					// without list properties vertices can go straight to the vertex buffer
+					bool hasLists = false;
+					for (uint32_t j=0; j < ElementList[i]->Properties.size(); ++j)
+						hasLists |= ElementList[i]->Properties[j].Type == EPLYPT_LIST;
+					if (!hasLists && !vertexBufferCreated && !attribs[E_POS].size() && readVerticesFast(*ElementList[i], mb))
+					{
+						vertexBufferCreated = true;
+						vertexCount = ElementList[i]->Count;
+					}
+					else
+					{
+						// loop through vertex properties
+						for (uint32_t j=0; j < ElementList[i]->Count; ++j)
+							hasNormals &= readVertex(*ElementList[i], attribs);
+					}
 				}
 				else if (ElementList[i]->Name == "face")
 				{
+					uint32_t indicesProperty = ElementList[i]->Properties.size();
+					for (uint32_t j=0; j < ElementList[i]->Properties.size(); ++j)
+					if ((ElementList[i]->Properties[j].Name == "vertex_indices" ||
+						ElementList[i]->Properties[j].Name == "vertex_index") && ElementList[i]->Properties[j].Type == EPLYPT_LIST)
+					{
+						indicesProperty = j;
+						break;
+					}
+
 					// read faces
 					for (uint32_t j=0; j < ElementList[i]->Count; ++j)
-						readFace(*ElementList[i], indices);
+						readFace(*ElementList[i], indicesProperty, indices);
 				}
 				else
 				{
@@ -258,7 +282,9 @@ ICPUMesh* CPLYMeshFileLoader::createMesh(io::IReadFile* file)
 				}
 			}
 
-            if (!genVertBuffersForMBuffer(mb, attribs))
+            if (!vertexBufferCreated)
+                vertexCount = attribs[E_POS].size();
+            if (!vertexBufferCreated && !genVertBuffersForMBuffer(mb, attribs))
             {
                 mb->drop();
                 delete [] Buffer;
@@ -280,7 +306,7 @@ ICPUMesh* CPLYMeshFileLoader::createMesh(io::IReadFile* file)
             else
             {
                 mb->setPrimitiveType(EPT_POINTS);
-                mb->setIndexCount(attribs[E_POS].size());
+                mb->setIndexCount(vertexCount);
                 //mb->getMaterial().setFlag(video::EMF_POINTCLOUD, true);
             }
 
@@ -398,15 +424,233 @@ bool CPLYMeshFileLoader::readVertex(const SPLYElement &Element, std::vector<core
 }
 
 
-bool CPLYMeshFileLoader::readFace(const SPLYElement &Element, std::vector<uint32_t>& _outIndices)
+//! Maps vertex property name onto attribute and its component, the same names readVertex() recognizes
+static bool getVertexPropertyDestination(const core::stringc& _name, uint32_t& _attrib, uint32_t& _component)
+{
+	static const struct
+	{
+		const char* name;
+		uint32_t attrib;
+		uint32_t component;
+	} destinations[] = {
+		{"x",0u,0u}, {"y",0u,1u}, {"z",0u,2u},
+		{"red",1u,0u}, {"green",1u,1u}, {"blue",1u,2u}, {"alpha",1u,3u},
+		{"u",2u,0u}, {"s",2u,0u}, {"v",2u,1u}, {"t",2u,1u},
+		{"nx",3u,0u}, {"ny",3u,1u}, {"nz",3u,2u}
+	};
+	for (size_t i=0u; i<sizeof(destinations)/sizeof(destinations[0]); i++)
+	if (_name==destinations[i].name)
+	{
+		_attrib = destinations[i].attrib;
+		_component = destinations[i].component;
+		return true;
+	}
+	return false;
+}
+
+//! Swaps bytes of every 32-bit word, 4 words at a time with SSE2
+static void byteswap32(uint8_t* _data, size_t _wordCount)
+{
+	size_t i = 0u;
+	for (; i+4u<=_wordCount; i+=4u)
+	{
+		__m128i words = _mm_loadu_si128(reinterpret_cast<__m128i*>(_data+4u*i));
+		// swap bytes within 16-bit halves, then swap the halves
+		words = _mm_or_si128(_mm_slli_epi16(words,8),_mm_srli_epi16(words,8));
+		words = _mm_shufflehi_epi16(_mm_shufflelo_epi16(words,_MM_SHUFFLE(2,3,0,1)),_MM_SHUFFLE(2,3,0,1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_data+4u*i), words);
+	}
+	for (; i<_wordCount; i++)
+	{
+		uint32_t word;
+		memcpy(&word, _data+4u*i, 4u);
+		word = os::Byteswap::byteswap(word);
+		memcpy(_data+4u*i, &word, 4u);
+	}
+}
+
+//! Converts binary scalar property the same way getFloat() (or getInt() for integer color channels) does
+static inline float convertBinaryProperty(const uint8_t* _src, E_PLY_PROPERTY_TYPE _type, bool _normalizedColor, bool _swap)
+{
+	switch (_type)
+	{
+	case EPLYPT_INT8:
+		return _normalizedColor ? float(_src[0])/255.f : float(int8_t(_src[0]));
+	case EPLYPT_INT16:
+		{
+			uint16_t value;
+			memcpy(&value, _src, 2u);
+			if (_swap)
+				value = os::Byteswap::byteswap(value);
+			return _normalizedColor ? float(value)/255.f : float(int16_t(value));
+		}
+	case EPLYPT_INT32:
+		{
+			uint32_t value;
+			memcpy(&value, _src, 4u);
+			if (_swap)
+				value = os::Byteswap::byteswap(value);
+			return _normalizedColor ? float(value)/255.f : float(int32_t(value));
+		}
+	case EPLYPT_FLOAT32:
+		{
+			uint32_t value;
+			memcpy(&value, _src, 4u);
+			if (_swap)
+				value = os::Byteswap::byteswap(value);
+			float retval;
+			memcpy(&retval, &value, 4u);
+			return retval;
+		}
+	case EPLYPT_FLOAT64:
+		{
+			uint8_t tmp[8];
+			memcpy(tmp, _src, 8u);
+			if (_swap)
+				for (size_t i = 0u; i < 4u; ++i)
+					std::swap(tmp[i], tmp[7u-i]);
+			double retval;
+			memcpy(&retval, tmp, 8u);
+			return float(retval);
+		}
+	default:
+		return 0.f;
+	}
+}
+
+
+bool CPLYMeshFileLoader::readVerticesFast(const SPLYElement &Element, ICPUMeshBuffer* _mbuf)
+{
+	// resolve property names once for the whole element
+	bool hasAttrib[4] = {false, false, false, false};
+	bool hasComponent[4][4] = {};
+	std::vector<SPLYVertexPropertyTarget> targets;
+	std::vector<int32_t> propertyTargets(Element.Properties.size(), -1);
+	uint32_t srcOffset = 0u;
+	for (uint32_t i=0; i < Element.Properties.size(); ++i)
+	{
+		const SPLYProperty& prop = Element.Properties[i];
+		uint32_t attrib, component;
+		if (prop.Type!=EPLYPT_LIST && getVertexPropertyDestination(prop.Name, attrib, component))
+		{
+			hasAttrib[attrib] = hasComponent[attrib][component] = true;
+			// output offset isn't known until all attributes are, so store attribute and component for now
+			SPLYVertexPropertyTarget target = {prop.Type, srcOffset, attrib*4u+component, attrib==E_COL && !prop.isFloat()};
+			propertyTargets[i] = targets.size();
+			targets.push_back(target);
+		}
+		srcOffset += prop.size();
+	}
+	if (!hasAttrib[E_POS])
+		return false;
+
+	size_t offsets[4];
+	size_t stride;
+	core::ICPUBuffer* buf = createVertexBuffer(_mbuf, hasAttrib, Element.Count, offsets, stride);
+	float* const out = reinterpret_cast<float*>(buf->getPointer());
+	const size_t floatsPerVertex = stride/sizeof(float);
+	for (size_t i=0u; i<targets.size(); i++)
+		targets[i].DstIndex = offsets[targets[i].DstIndex/4u]/sizeof(float)+targets[i].DstIndex%4u;
+
+	// components absent from the file get the same defaults readVertex() gives them
+	std::vector<float> defaults(floatsPerVertex, 0.f);
+	if (hasAttrib[E_COL])
+		defaults[offsets[E_COL]/sizeof(float)+3u] = 1.f;
+	if (hasAttrib[E_NORM])
+		defaults[offsets[E_NORM]/sizeof(float)+1u] = 1.f;
+	const uint32_t componentCount[4] = {3u, 4u, 2u, 3u};
+	bool needsDefaults = false;
+	for (uint32_t a=0u; a<4u; a++)
+	for (uint32_t c=0u; hasAttrib[a] && c<componentCount[a]; c++)
+		needsDefaults |= !hasComponent[a][c];
+
+	if (IsBinaryFile)
+	{
+		const size_t recordSize = Element.KnownSize;
+
+		// native float records laid out exactly like our vertices, read them straight into the buffer
+		bool sameLayout = !IsWrongEndian && !needsDefaults && targets.size()==Element.Properties.size() && recordSize==stride;
+		for (size_t i=0u; sameLayout && i<targets.size(); i++)
+			sameLayout = targets[i].Type==EPLYPT_FLOAT32 && targets[i].SrcOffset==targets[i].DstIndex*sizeof(float);
+		if (sameLayout)
+		{
+			const size_t size = size_t(Element.Count)*stride;
+			const size_t read = readBytes(out, size);
+			memset(reinterpret_cast<uint8_t*>(out)+read, 0, size-read);
+			return true;
+		}
+
+		// big endian records of only 32-bit properties get swapped as a whole, others value by value
+		bool all32bit = true;
+		for (uint32_t i=0; i < Element.Properties.size(); ++i)
+			all32bit &= Element.Properties[i].size()==4u;
+		const bool swapBatch = IsWrongEndian && all32bit;
+		const bool swapValues = IsWrongEndian && !all32bit;
+
+		const size_t batchSize = core::max_<size_t>((0x1u<<20)/core::max_<size_t>(recordSize,1u), 1u);
+		std::vector<uint8_t> batch(batchSize*recordSize);
+		for (size_t first=0u; first<Element.Count; first+=batchSize)
+		{
+			const size_t count = core::min_<size_t>(batchSize, Element.Count-first);
+			const size_t read = readBytes(batch.data(), count*recordSize);
+			memset(batch.data()+read, 0, count*recordSize-read);
+			if (swapBatch)
+				byteswap32(batch.data(), read/4u);
+
+			for (size_t i=0u; i<count; i++)
+			{
+				const uint8_t* const src = batch.data()+i*recordSize;
+				float* const dst = out+(first+i)*floatsPerVertex;
+				if (needsDefaults)
+					memcpy(dst, defaults.data(), stride);
+				for (size_t j=0u; j<targets.size(); j++)
+					dst[targets[j].DstIndex] = convertBinaryProperty(src+targets[j].SrcOffset, targets[j].Type, targets[j].NormalizedColor, swapValues);
+			}
+		}
+	}
+	else
+	{
+		for (size_t i=0u; i<Element.Count; i++)
+		{
+			const char* ptr = getNextLine();
+			const char* const lineEnd = ptr+strlen(ptr);
+			float* const dst = out+i*floatsPerVertex;
+			if (needsDefaults)
+				memcpy(dst, defaults.data(), stride);
+
+			for (uint32_t j=0; j < Element.Properties.size(); ++j)
+			{
+				while (ptr!=lineEnd && (*ptr==' ' || *ptr=='\t'))
+					++ptr;
+				float value;
+				const char* next = core::fast_atof_move(ptr, lineEnd, value);
+				// not a number, skip the word like getNextWord() would
+				if (next==ptr)
+					while (next!=lineEnd && *next!=' ' && *next!='\t')
+						++next;
+				ptr = next;
+
+				if (propertyTargets[j]<0)
+					continue;
+				const SPLYVertexPropertyTarget& target = targets[propertyTargets[j]];
+				if (!Element.Properties[j].isFloat())
+					value = float(int32_t(value)); // atoi() truncates
+				dst[target.DstIndex] = target.NormalizedColor ? value/255.f : value;
+			}
+		}
+	}
+	return true;
+}
+
+
+bool CPLYMeshFileLoader::readFace(const SPLYElement &Element, uint32_t _indicesProperty, std::vector<uint32_t>& _outIndices)
 {
 	if (!IsBinaryFile)
 		getNextLine();
 
 	for (uint32_t i=0; i < Element.Properties.size(); ++i)
 	{
-		if ( (Element.Properties[i].Name == "vertex_indices" ||
-			Element.Properties[i].Name == "vertex_index") && Element.Properties[i].Type == EPLYPT_LIST)
+		if (i == _indicesProperty)
 		{
 			int32_t count = getInt(Element.Properties[i].Data.List.CountType);
             //_IRR_DEBUG_BREAK_IF(count != 3)
@@ -462,7 +706,7 @@ void CPLYMeshFileLoader::skipProperty(const SPLYProperty &Property)
 		int32_t count = getInt(Property.Data.List.CountType);
 
 		for (int32_t i=0; i < count; ++i)
-			getInt(Property.Data.List.CountType);
+			getInt(Property.Data.List.ItemType);
 	}
 	else
 	{
@@ -545,6 +789,29 @@ void CPLYMeshFileLoader::fillBuffer()
 }
 
 
+size_t CPLYMeshFileLoader::readBytes(void* _dst, size_t _size)
+{
+	uint8_t* const dst = reinterpret_cast<uint8_t*>(_dst);
+
+	// whatever is left in the buffer goes first
+	const size_t buffered = core::min_<size_t>(EndPointer - StartPointer, _size);
+	memcpy(dst, StartPointer, buffered);
+	StartPointer += buffered;
+
+	size_t done = buffered;
+	while (done < _size && !EndOfFile)
+	{
+		const int32_t count = File->read(dst + done, core::min_<size_t>(_size - done, 0x40000000u));
+		if (count <= 0)
+			break;
+		done += count;
+		if (File->getPos() == File->getSize())
+			EndOfFile = true;
+	}
+	return done;
+}
+
+
 // skips x bytes in the file, getting more data if required
 void CPLYMeshFileLoader::moveForward(uint32_t bytes)
 {
@@ -575,30 +842,13 @@ bool CPLYMeshFileLoader::genVertBuffersForMBuffer(ICPUMeshBuffer* _mbuf, const s
             _buf->setAttribute(v, _vaid, i++);
     };
 
-    size_t sizes[4];
-    sizes[E_POS] = !_attribs[E_POS].empty() * 3 * sizeof(float);
-    sizes[E_COL] = !_attribs[E_COL].empty() * 4 * sizeof(float);
-    sizes[E_UV] = !_attribs[E_UV].empty() * 2 * sizeof(float);
-    sizes[E_NORM] = !_attribs[E_NORM].empty() * 3 * sizeof(float);
-
-    size_t offsets[4]{ 0u };
-    for (size_t i = 1u; i < 4u; ++i)
-        offsets[i] = offsets[i-1] + sizes[i-1];
-
-    const size_t stride = std::accumulate(sizes, sizes+4, 0u);
-
-    core::ICPUBuffer* buf = new core::ICPUBuffer(_attribs[E_POS].size() * stride);
+    bool hasAttrib[4];
+    for (size_t i = 0u; i < 4u; ++i)
+        hasAttrib[i] = !_attribs[i].empty();
 
-    auto desc = _mbuf->getMeshDataAndFormat();
-    if (sizes[E_POS])
-        desc->mapVertexAttrBuffer(buf, EVAI_ATTR0, ECPA_THREE, ECT_FLOAT, stride, offsets[E_POS]);
-    if (sizes[E_COL])
-        desc->mapVertexAttrBuffer(buf, EVAI_ATTR1, ECPA_FOUR, ECT_FLOAT, stride, offsets[E_COL]);
-    if (sizes[E_UV])
-        desc->mapVertexAttrBuffer(buf, EVAI_ATTR2, ECPA_TWO, ECT_FLOAT, stride, offsets[E_UV]);
-    if (sizes[E_NORM])
-        desc->mapVertexAttrBuffer(buf, EVAI_ATTR3, ECPA_THREE, ECT_FLOAT, stride, offsets[E_NORM]);
-    buf->drop();
+    size_t offsets[4];
+    size_t stride;
+    createVertexBuffer(_mbuf, hasAttrib, _attribs[E_POS].size(), offsets, stride);
 
     E_VERTEX_ATTRIBUTE_ID vaids[4];
     vaids[E_POS] = EVAI_ATTR0;
@@ -608,16 +858,43 @@ bool CPLYMeshFileLoader::genVertBuffersForMBuffer(ICPUMeshBuffer* _mbuf, const s
 
     for (size_t i = 0u; i < 4u; ++i)
     {
-        if (sizes[i])
+        if (hasAttrib[i])
             putAttr(_mbuf, i, vaids[i]);
     }
 
-    float d[100];
-    memcpy(d, buf->getPointer(), 400);
-
     return true;
 }
 
+core::ICPUBuffer* CPLYMeshFileLoader::createVertexBuffer(ICPUMeshBuffer* _mbuf, const bool _hasAttrib[4], size_t _vertexCount, size_t _offsets[4], size_t& _stride) const
+{
+    size_t sizes[4];
+    sizes[E_POS] = _hasAttrib[E_POS] * 3 * sizeof(float);
+    sizes[E_COL] = _hasAttrib[E_COL] * 4 * sizeof(float);
+    sizes[E_UV] = _hasAttrib[E_UV] * 2 * sizeof(float);
+    sizes[E_NORM] = _hasAttrib[E_NORM] * 3 * sizeof(float);
+
+    _offsets[0] = 0u;
+    for (size_t i = 1u; i < 4u; ++i)
+        _offsets[i] = _offsets[i-1] + sizes[i-1];
+
+    _stride = std::accumulate(sizes, sizes+4, size_t(0u));
+
+    core::ICPUBuffer* buf = new core::ICPUBuffer(_vertexCount * _stride);
+
+    auto desc = _mbuf->getMeshDataAndFormat();
+    if (sizes[E_POS])
+        desc->mapVertexAttrBuffer(buf, EVAI_ATTR0, ECPA_THREE, ECT_FLOAT, _stride, _offsets[E_POS]);
+    if (sizes[E_COL])
+        desc->mapVertexAttrBuffer(buf, EVAI_ATTR1, ECPA_FOUR, ECT_FLOAT, _stride, _offsets[E_COL]);
+    if (sizes[E_UV])
+        desc->mapVertexAttrBuffer(buf, EVAI_ATTR2, ECPA_TWO, ECT_FLOAT, _stride, _offsets[E_UV]);
+    if (sizes[E_NORM])
+        desc->mapVertexAttrBuffer(buf, EVAI_ATTR3, ECPA_THREE, ECT_FLOAT, _stride, _offsets[E_NORM]);
+    buf->drop();
+
+    return buf;
+}
+
 
 E_PLY_PROPERTY_TYPE CPLYMeshFileLoader::getPropertyType(const char* typeString) const
 {
@@ -681,9 +958,7 @@ char* CPLYMeshFileLoader::getNextLine()
 	}
 
 	// begin at the start of the next line
-	char* pos = StartPointer;
-	while (pos < EndPointer && *pos && *pos != '\r' && *pos != '\n')
-		++pos;
+	char* pos = StartPointer + (core::findLineBreak(StartPointer, EndPointer) - StartPointer);
 
 	if ( pos < EndPointer && ( *(pos+1) == '\r' || *(pos+1) == '\n') )
 	{
@@ -856,7 +1131,8 @@ uint32_t CPLYMeshFileLoader::getInt(E_PLY_PROPERTY_TYPE t)
 			switch (t)
 			{
 			case EPLYPT_INT8:
-				retVal = *StartPointer;
+				// unsigned like the 16-bit case, uchar colors and list counts above 127 mustn't wrap around
+				retVal = *reinterpret_cast<uint8_t*>(StartPointer);
 				StartPointer++;
 				break;
 			case EPLYPT_INT16:
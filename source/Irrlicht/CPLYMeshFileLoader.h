@@ -120,6 +120,18 @@ private:
 
     enum { E_POS = 0, E_UV = 2, E_NORM = 3, E_COL = 1 };
 
+	//! Where scalar vertex property ends up in the interleaved vertex buffer
+	struct SPLYVertexPropertyTarget
+	{
+		E_PLY_PROPERTY_TYPE Type;
+		//! Byte offset of the property in binary vertex record
+		uint32_t SrcOffset;
+		//! Index of float in output vertex
+		uint32_t DstIndex;
+		//! Integer color channel, divided by 255
+		bool NormalizedColor;
+	};
+
 	bool allocateBuffer();
 	char* getNextLine();
 	char* getNextWord();
@@ -127,14 +139,22 @@ private:
 	E_PLY_PROPERTY_TYPE getPropertyType(const char* typeString) const;
 
 	bool readVertex(const SPLYElement &Element, std::vector<core::vectorSIMDf> _attribs[4]);
-	bool readFace(const SPLYElement &Element, std::vector<uint32_t>& _outIndices);
+	//! Reads all vertices of element without list properties straight into interleaved vertex buffer of `_mbuf`.
+	/** Property names are resolved once per element instead of once per vertex, binary records are read in large batches
+	(bulk-copied if their layout matches the output, byteswapped with SIMD if they're big endian) and ASCII ones parsed with fast_atof_move().*/
+	bool readVerticesFast(const SPLYElement &Element, ICPUMeshBuffer* _mbuf);
+	bool readFace(const SPLYElement &Element, uint32_t _indicesProperty, std::vector<uint32_t>& _outIndices);
 	void skipElement(const SPLYElement &Element);
 	void skipProperty(const SPLYProperty &Property);
 	float getFloat(E_PLY_PROPERTY_TYPE t);
 	uint32_t getInt(E_PLY_PROPERTY_TYPE t);
 	void moveForward(uint32_t bytes);
+	//! Reads binary data, first what's left in the buffer and then directly from the file. Returns number of bytes read.
+	size_t readBytes(void* _dst, size_t _size);
 
     bool genVertBuffersForMBuffer(ICPUMeshBuffer* _mbuf, const std::vector<core::vectorSIMDf> _attribs[4]) const;
+    //! Creates interleaved buffer with attributes present in `_hasAttrib` and maps them in `_mbuf`'s format descriptor, the buffer is owned by the descriptor.
+    core::ICPUBuffer* createVertexBuffer(ICPUMeshBuffer* _mbuf, const bool _hasAttrib[4], size_t _vertexCount, size_t _offsets[4], size_t& _stride) const;
 
 	core::array<SPLYElement*> ElementList;
 
@@ -13,6 +13,7 @@
 #include "coreutil.h"
 #include "os.h"
 #include "SVertexManipulator.h"
+#include "CStreamingMeshClusterer.h"
 
 #include <vector>
 
@@ -80,77 +81,17 @@ ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
 	token.reserve(32);
 	while (file->getPos() < filesize)
 	{
-		if (!binary)
-		{
-			if (getNextToken(file, token) != "facet")
-			{
-				if (token=="endsolid")
-					break;
-				mesh->drop();
-				return nullptr;
-			}
-			if (getNextToken(file, token) != "normal")
-			{
-				mesh->drop();
-				return nullptr;
-			}
-		}
-
-        {
-        core::vectorSIMDf n;
-		getNextVector(file, n, binary);
-        normals.push_back(n);
-        }
-
-		if (!binary)
-		{
-			if (getNextToken(file, token) != "outer")
-			{
-				mesh->drop();
-				return nullptr;
-			}
-			if (getNextToken(file, token) != "loop")
-			{
-				mesh->drop();
-				return nullptr;
-			}
-		}
-
-        {
-        core::vectorSIMDf p[3];
-		for (uint32_t i = 0u; i < 3u; ++i)
+		core::vectorSIMDf n, p[3];
+		bool end = false;
+		if (!readFacet(file, binary, n, p, attrib, end))
 		{
-			if (!binary)
-			{
-				if (getNextToken(file, token) != "vertex")
-				{
-					mesh->drop();
-					return nullptr;
-				}
-			}
-			getNextVector(file, p[i], binary);
-		}
-        for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
-            positions.push_back(p[2u-i]);
-        }
-
-		if (!binary)
-		{
-			if (getNextToken(file, token) != "endloop")
-			{
-				mesh->drop();
-				return nullptr;
-			}
-			if (getNextToken(file, token) != "endfacet")
-			{
-				mesh->drop();
-				return nullptr;
-			}
-		}
-		else
-		{
-			file->read(&attrib, 2);
+			if (end)
+				break;
+			mesh->drop();
+			return nullptr;
 		}
+		normals.push_back(n);
+		positions.insert(positions.end(), p, p+3);
 
         if (hasColor && (attrib & 0x8000)) // assuming VisCam/SolidView non-standard trick to store color in 2 bytes of extra attribute
         {
@@ -161,16 +102,6 @@ ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
             hasColor = false;
             colors.clear();
         }
-
-		if ((normals.back() == core::vectorSIMDf()).all())
-        {
-			normals.back().set(
-                core::plane3df(
-                    (positions.rbegin()+2)->getAsVector3df(),
-                    (positions.rbegin()+1)->getAsVector3df(),
-                    (positions.rbegin()+0)->getAsVector3df()).Normal
-            );
-        }
 	} // end while (file->getPos() < filesize)
 
     const size_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
@@ -202,6 +133,217 @@ ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
 }
 
 
+//! Plain rounding to 2_10_10_10, quantizeNormal2_10_10_10() is far too slow and its cache unbounded for streamed input
+static inline uint32_t quantizeNormalRounded2_10_10_10(const core::vectorSIMDf& _normal)
+{
+	const float length = core::length(_normal).X;
+	if (length==0.f)
+		return 0u;
+
+	uint32_t retval = 0u;
+	for (uint32_t i = 0u; i < 3u; ++i)
+	{
+		const int32_t component = core::round32(_normal.pointer[i]/length*511.f);
+		retval |= (uint32_t(component)&0x3ffu)<<(i*10u);
+	}
+	return retval;
+}
+
+bool CSTLMeshFileLoader::streamMesh(io::IReadFile* file, const MeshBufferCallback& _callback, const SStreamingMeshImportParams& _params)
+{
+	if (!file || file->getSize() < 6)
+		return false;
+
+	core::stringc token;
+	const bool binary = getNextToken(file, token) != "solid";
+	if (binary && file->getSize() < 84)
+		return false;
+
+	// first pass only finds the grid's extent and whether every facet carries a color
+	core::aabbox3df bounds;
+	bool empty = true;
+	bool hasColor = binary;
+	const bool parsed = forEachFacet(file, binary, _params.ReadWindowSize,
+		[&](const core::vectorSIMDf& _normal, const core::vectorSIMDf* _positions, uint16_t _attrib)
+		{
+			for (uint32_t i = 0u; i < 3u; ++i)
+			{
+				if (empty)
+					bounds.reset(_positions[i].getAsVector3df());
+				else
+					bounds.addInternalPoint(_positions[i].getAsVector3df());
+				empty = false;
+			}
+			hasColor &= (_attrib & 0x8000) != 0;
+			return true;
+		});
+	if (!parsed)
+		return false;
+	if (empty)
+		return true;
+
+	const size_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
+	CStreamingMeshClusterer clusterer(bounds, vtxSize,
+		[hasColor,vtxSize](ICPUMeshDataFormatDesc* _desc, core::ICPUBuffer* _vertexBuf)
+		{
+			_desc->mapVertexAttrBuffer(_vertexBuf, EVAI_ATTR0, ECPA_THREE, ECT_FLOAT, vtxSize, 0);
+			_desc->mapVertexAttrBuffer(_vertexBuf, EVAI_ATTR3, ECPA_FOUR, ECT_INT_2_10_10_10_REV, vtxSize, 12);
+			if (hasColor)
+				_desc->mapVertexAttrBuffer(_vertexBuf, EVAI_ATTR1, ECPA_REVERSED_OR_BGRA, ECT_NORMALIZED_UNSIGNED_BYTE, vtxSize, 16);
+		},
+		_callback, _params);
+
+	const bool streamed = forEachFacet(file, binary, _params.ReadWindowSize,
+		[&](const core::vectorSIMDf& _normal, const core::vectorSIMDf* _positions, uint16_t _attrib)
+		{
+			uint8_t vertices[3*20];
+			const uint32_t normal = quantizeNormalRounded2_10_10_10(_normal);
+			const uint32_t color = hasColor ? video::A1R5G5B5toA8R8G8B8(_attrib) : 0u;
+			for (uint32_t i = 0u; i < 3u; ++i)
+			{
+				uint8_t* ptr = vertices + i*vtxSize;
+				memcpy(ptr, _positions[i].pointer, 3*4);
+				memcpy(ptr+12, &normal, 4);
+				if (hasColor)
+					memcpy(ptr+16, &color, 4);
+			}
+			return clusterer.addTriangle(vertices);
+		});
+
+	return streamed && clusterer.flush();
+}
+
+
+bool CSTLMeshFileLoader::readFacet(io::IReadFile* file, bool binary, core::vectorSIMDf& _normal, core::vectorSIMDf _positions[3], uint16_t& _attrib, bool& _end) const
+{
+	core::stringc token;
+	if (!binary)
+	{
+		if (getNextToken(file, token) != "facet")
+		{
+			_end = token=="endsolid";
+			return false;
+		}
+		if (getNextToken(file, token) != "normal")
+			return false;
+	}
+	else if (file->getPos()+50 > file->getSize())
+	{
+		_end = true;
+		return false;
+	}
+
+	getNextVector(file, _normal, binary);
+
+	if (!binary)
+	{
+		if (getNextToken(file, token) != "outer")
+			return false;
+		if (getNextToken(file, token) != "loop")
+			return false;
+	}
+
+	core::vectorSIMDf p[3];
+	for (uint32_t i = 0u; i < 3u; ++i)
+	{
+		if (!binary)
+		{
+			if (getNextToken(file, token) != "vertex")
+				return false;
+		}
+		getNextVector(file, p[i], binary);
+	}
+	for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
+		_positions[i] = p[2u-i];
+
+	if (!binary)
+	{
+		if (getNextToken(file, token) != "endloop")
+			return false;
+		if (getNextToken(file, token) != "endfacet")
+			return false;
+	}
+	else
+	{
+		file->read(&_attrib, 2);
+	}
+
+	if ((_normal == core::vectorSIMDf()).all())
+	{
+		_normal.set(
+			core::plane3df(
+				_positions[0].getAsVector3df(),
+				_positions[1].getAsVector3df(),
+				_positions[2].getAsVector3df()).Normal
+		);
+	}
+	return true;
+}
+
+
+bool CSTLMeshFileLoader::forEachFacet(io::IReadFile* file, bool binary, size_t _windowSize, const FacetCallback& _func) const
+{
+	core::vectorSIMDf normal, positions[3];
+	uint16_t attrib = 0u;
+	if (!binary)
+	{
+		core::stringc token;
+		file->seek(0);
+		getNextToken(file, token);
+		goNextLine(file); // skip header
+		while (file->getPos() < file->getSize())
+		{
+			bool end = false;
+			if (!readFacet(file, false, normal, positions, attrib, end))
+				return end;
+			if (!_func(normal, positions, attrib))
+				return false;
+		}
+		return true;
+	}
+
+	// binary facets are fixed size records, so decode them straight from file's memory or read whole windows of them
+	const size_t recordSize = 50u;
+	const uint8_t* const view = reinterpret_cast<const uint8_t*>(file->getMappedPointer());
+	std::vector<uint8_t> window(view ? 0u : core::max_<size_t>(_windowSize/recordSize, 1u)*recordSize);
+	file->seek(84);
+	for (bool more = true; more;)
+	{
+		const uint8_t* data = view+84;
+		size_t read = file->getSize()-84;
+		if (view)
+			more = false;
+		else
+		{
+			data = window.data();
+			read = core::max_(file->read(window.data(), window.size()), 0);
+			more = read == window.size();
+		}
+		for (size_t offset = 0u; offset+recordSize <= read; offset += recordSize)
+		{
+			const uint8_t* record = data+offset;
+			memcpy(normal.pointer, record, 12);
+			core::vectorSIMDf p[3];
+			for (uint32_t i = 0u; i < 3u; ++i)
+			{
+				memcpy(p[i].pointer, record+12+i*12, 12);
+				p[i].X = -p[i].X;
+			}
+			normal.X = -normal.X;
+			for (uint32_t i = 0u; i < 3u; ++i) // same winding as readFacet()
+				positions[i] = p[2u-i];
+			memcpy(&attrib, record+48, 2);
+
+			if ((normal == core::vectorSIMDf()).all())
+				normal.set(core::plane3df(positions[0].getAsVector3df(), positions[1].getAsVector3df(), positions[2].getAsVector3df()).Normal);
+			if (!_func(normal, positions, attrib))
+				return false;
+		}
+	}
+	return true;
+}
+
+
 //! Read 3d vector of floats
 void CSTLMeshFileLoader::getNextVector(io::IReadFile* file, core::vectorSIMDf& vec, bool binary) const
 {
@@ -5,7 +5,7 @@
 #ifndef __C_STL_MESH_FILE_LOADER_H_INCLUDED__
 #define __C_STL_MESH_FILE_LOADER_H_INCLUDED__
 
-#include "IMeshLoader.h"
+#include "IStreamingMeshLoader.h"
 #include "irrString.h"
 #include "vectorSIMD.h"
 
@@ -15,7 +15,7 @@ namespace scene
 {
 
 //! Meshloader capable of loading STL meshes.
-class CSTLMeshFileLoader : public IMeshLoader
+class CSTLMeshFileLoader : public IMeshLoader, public IStreamingMeshLoader
 {
 public:
 
@@ -29,7 +29,19 @@ public:
 	//! See IReferenceCounted::drop() for more information.
 	virtual ICPUMesh* createMesh(io::IReadFile* file);
 
+	//! Streams the mesh as spatially clustered mesh buffers, reading the file twice (first for bounds and colors, then for geometry).
+	/** Normals are quantized by rounding instead of best-fit search, which is too slow for files of this size.*/
+	virtual bool streamMesh(io::IReadFile* file, const MeshBufferCallback& _callback, const SStreamingMeshImportParams& _params);
+
 private:
+	typedef std::function<bool(const core::vectorSIMDf&, const core::vectorSIMDf*, uint16_t)> FacetCallback;
+
+	//! Reads single facet with positions in engine's winding order and normal computed if the file has none.
+	/** @returns false on syntax error or at the end of data, in which case `_end` is set to true.*/
+	bool readFacet(io::IReadFile* file, bool binary, core::vectorSIMDf& _normal, core::vectorSIMDf _positions[3], uint16_t& _attrib, bool& _end) const;
+	//! Calls `_func` on every facet, binary files are read through a window of `_windowSize` bytes.
+	/** @returns false on syntax error or if `_func` returned false.*/
+	bool forEachFacet(io::IReadFile* file, bool binary, size_t _windowSize, const FacetCallback& _func) const;
 
 	// skips to the first non-space character available
 	void goNextWord(io::IReadFile* file) const;
@@ -11,6 +11,8 @@
 #include "IMaterialRenderer.h"
 #include "IReadFile.h"
 #include "IWriteFile.h"
+#include "CAsyncMeshLoader.h"
+#include "FW_Mutex.h"
 
 #include "os.h"
 
@@ -123,7 +125,7 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::ICursorControl* cursorControl)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs),
 	CursorControl(cursorControl),
-	ActiveCamera(0), MeshCache(0), CurrentRendertime(ESNRP_NONE),
+	ActiveCamera(0), MeshCache(0), AsyncMeshLoader(0), CurrentRendertime(ESNRP_NONE),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
 {
 	#ifdef _DEBUG
@@ -264,7 +266,9 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
         reqs.prefersDedicatedAllocation = true;
         reqs.requiresDedicatedAllocation = true;
         redundantMeshDataBuf = SceneManager->getVideoDriver()->createGPUBufferOnDedMem(reqs,true);
-        redundantMeshDataBuf->updateSubRange(video::IDriverMemoryAllocation::MemoryRange(0,reqs.vulkanReqs.size),tmpMem);
+        // the null driver has no GPU buffers
+        if (redundantMeshDataBuf)
+            redundantMeshDataBuf->updateSubRange(video::IDriverMemoryAllocation::MemoryRange(0,reqs.vulkanReqs.size),tmpMem);
         free(tmpMem);
 	}
 
@@ -316,6 +320,10 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	#ifdef _IRR_COMPILE_WITH_BAW_LOADER_
 	MeshLoaderList.push_back(new CBAWMeshFileLoader(this, FileSystem));
 	#endif
+
+	for (uint32_t i=0; i<MeshLoaderList.size(); ++i)
+		MeshLoaderLocks.push_back(new FW_Mutex());
+	AsyncMeshLoader = new CAsyncMeshLoader([this](const io::path& filename) {return loadMesh(filename);});
 }
 
 
@@ -324,6 +332,9 @@ CSceneManager::~CSceneManager()
 {
 	clearDeletionList();
 
+	// finish loads in progress while loaders are still there
+	delete AsyncMeshLoader;
+
 	//! force to remove hardwareTextures from the driver
 	//! because Scenes may hold internally data bounded to sceneNodes
 	//! which may be destroyed twice
@@ -343,7 +354,10 @@ CSceneManager::~CSceneManager()
 
 	uint32_t i;
 	for (i=0; i<MeshLoaderList.size(); ++i)
+	{
 		MeshLoaderList[i]->drop();
+		delete MeshLoaderLocks[i];
+	}
 
 	if (ActiveCamera)
 		ActiveCamera->drop();
@@ -366,10 +380,20 @@ CSceneManager::~CSceneManager()
 //! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 ICPUMesh* CSceneManager::getMesh(const io::path& filename)
 {
+	takeAsyncLoadedMeshes();
 	ICPUMesh* msh = MeshCache->getMeshByName(filename);
 	if (msh)
 		return msh;
 
+	// still loading in getMeshAsync()
+	if (AsyncMeshLoader->waitFor(filename))
+	{
+		takeAsyncLoadedMeshes();
+		msh = MeshCache->getMeshByName(filename);
+		if (msh)
+			return msh;
+	}
+
 	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
 	msh = getMesh(file);
 	if (file)
@@ -388,26 +412,77 @@ ICPUMesh* CSceneManager::getMesh(io::IReadFile* file)
 		return 0;
     }
 
-	io::path name = file->getFileName();
+	takeAsyncLoadedMeshes();
 	ICPUMesh* msh = MeshCache->getMeshByName(file->getFileName());
 	if (msh)
 		return msh;
 
+	msh = loadMesh(file);
+	if (msh)
+	{
+		MeshCache->addMesh(file->getFileName(), msh);
+		msh->drop();
+	}
+
+	return msh;
+}
+
+
+//! loads a mesh on the mesh loading threads, requests for the same file share the load.
+std::shared_future<ICPUMesh*> CSceneManager::getMeshAsync(const io::path& filename)
+{
+	takeAsyncLoadedMeshes();
+	ICPUMesh* msh = MeshCache->getMeshByName(filename);
+	if (!msh)
+		return AsyncMeshLoader->request(filename);
+
+	std::promise<ICPUMesh*> ready;
+	ready.set_value(msh);
+	return ready.get_future().share();
+}
+
+
+//! moves meshes getMeshAsync() finished loading to the mesh cache
+void CSceneManager::takeAsyncLoadedMeshes()
+{
+	AsyncMeshLoader->takeLoadedMeshes([this](const io::path& filename, ICPUMesh* mesh) {MeshCache->addMesh(filename, mesh);});
+}
+
+
+//! sets number of mesh loading threads, 0 means as many as the hardware has.
+void CSceneManager::setMeshLoadingThreadCount(uint32_t count)
+{
+	AsyncMeshLoader->setThreadCount(count);
+}
+
+
+//! returns number of mesh loading threads.
+uint32_t CSceneManager::getMeshLoadingThreadCount() const
+{
+	return AsyncMeshLoader->getThreadCount();
+}
+
+
+//! tries the loaders on the file, returns a grabbed mesh or 0, can be called from any thread
+ICPUMesh* CSceneManager::loadMesh(io::IReadFile* file)
+{
+	io::path name = file->getFileName();
+	ICPUMesh* msh = 0;
+
 	// iterate the list in reverse order so user-added loaders can override the built-in ones
 	int32_t count = MeshLoaderList.size();
 	for (int32_t i=count-1; i>=0; --i)
 	{
 		if (MeshLoaderList[i]->isALoadableFileExtension(name))
 		{
+			// loaders aren't reentrant, but different ones can load at the same time
+			MeshLoaderLocks[i]->Get();
 			// reset file to avoid side effects of previous calls to createMesh
 			file->seek(0);
 			msh = MeshLoaderList[i]->createMesh(file);
+			MeshLoaderLocks[i]->Release();
 			if (msh)
-			{
-				MeshCache->addMesh(file->getFileName(), msh);
-				msh->drop();
 				break;
-			}
 		}
 	}
 
@@ -420,6 +495,22 @@ ICPUMesh* CSceneManager::getMesh(io::IReadFile* file)
 }
 
 
+//! opens the file and loads a mesh from it, returns a grabbed mesh or 0, can be called from any thread
+ICPUMesh* CSceneManager::loadMesh(const io::path& filename)
+{
+	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
+	if (!file)
+	{
+		os::Printer::log("Could not load mesh, because file could not be opened", filename.c_str(), ELL_ERROR);
+		return 0;
+	}
+
+	ICPUMesh* msh = loadMesh(file);
+	file->drop();
+	return msh;
+}
+
+
 //! returns the video driver
 video::IVideoDriver* CSceneManager::getVideoDriver()
 {
@@ -1046,6 +1137,7 @@ void CSceneManager::addExternalMeshLoader(IMeshLoader* externalLoader)
 
 	externalLoader->grab();
 	MeshLoaderList.push_back(externalLoader);
+	MeshLoaderLocks.push_back(new FW_Mutex());
 }
 
 
@@ -1232,6 +1324,7 @@ E_SCENE_NODE_RENDER_PASS CSceneManager::getSceneNodeRenderPass() const
 //! Returns an interface to the mesh cache which is shared between all existing scene managers.
 IMeshCache<ICPUMesh>* CSceneManager::getMeshCache()
 {
+	takeAsyncLoadedMeshes();
 	return MeshCache;
 }
 
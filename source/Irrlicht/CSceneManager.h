@@ -17,6 +17,8 @@
 #include <map>
 #include <string>
 
+class FW_Mutex;
+
 namespace irr
 {
 namespace io
@@ -28,6 +30,7 @@ namespace scene
 {
 	class IGeometryCreator;
 	class IAnimatedMeshSceneNode;
+	class CAsyncMeshLoader;
 
 	/*!
 		The Scene Manager manages scene nodes, mesh recources, cameras and all the other stuff.
@@ -49,6 +52,15 @@ namespace scene
 		//! gets a mesh. loads it if needed. returned pointer must not be dropped.
 		virtual ICPUMesh* getMesh(io::IReadFile* file);
 
+		//! loads a mesh on the mesh loading threads, requests for the same file share the load.
+		virtual std::shared_future<ICPUMesh*> getMeshAsync(const io::path& filename);
+
+		//! sets number of mesh loading threads, 0 means as many as the hardware has.
+		virtual void setMeshLoadingThreadCount(uint32_t count);
+
+		//! returns number of mesh loading threads.
+		virtual uint32_t getMeshLoadingThreadCount() const;
+
 		//! Returns an interface to the mesh cache which is shared beween all existing scene managers.
 		virtual IMeshCache<ICPUMesh>* getMeshCache();
 
@@ -281,6 +293,15 @@ namespace scene
 		//! clears the deletion list
 		void clearDeletionList();
 
+		//! tries the loaders on the file, returns a grabbed mesh or 0, can be called from any thread
+		ICPUMesh* loadMesh(io::IReadFile* file);
+
+		//! opens the file and loads a mesh from it, returns a grabbed mesh or 0, can be called from any thread
+		ICPUMesh* loadMesh(const io::path& filename);
+
+		//! moves meshes getMeshAsync() finished loading to the mesh cache
+		void takeAsyncLoadedMeshes();
+
 		struct DefaultNodeEntry
 		{
 				DefaultNodeEntry(ISceneNode* n) :
@@ -365,6 +386,8 @@ namespace scene
 		core::array<TransparentNodeEntry> TransparentEffectNodeList;
 
 		core::array<IMeshLoader*> MeshLoaderList;
+		//! one lock per loader, loaders keep the state of the file they load in members
+		core::array<FW_Mutex*> MeshLoaderLocks;
 		core::array<IDummyTransformationSceneNode*> DeletionList;
 
 		//! current active camera
@@ -378,6 +401,8 @@ namespace scene
 
 		//! Mesh cache
 		IMeshCache<ICPUMesh>* MeshCache;
+		//! loads meshes for getMeshAsync(), which go to MeshCache once loaded
+		CAsyncMeshLoader* AsyncMeshLoader;
 		video::IGPUBuffer* redundantMeshDataBuf;
 
 		E_SCENE_NODE_RENDER_PASS CurrentRendertime;
@@ -4,6 +4,9 @@
 
 #include "ISkinningStateManager.h"
 #include "ITextureBufferObject.h"
+#include "FW_Mutex.h"
+#include <functional>
+#include <thread>
 
 ///#define UPDATE_WHOLE_BUFFER
 
@@ -22,6 +25,8 @@ namespace scene
         protected:
             virtual ~CSkinningStateManager()
             {
+                if (boningWorkers)
+                    delete boningWorkers;
 #ifdef _IRR_COMPILE_WITH_OPENGL_
                 Driver->removeTextureBufferObject(TBO);
 #endif // _IRR_COMPILE_WITH_OPENGL_
@@ -29,7 +34,7 @@ namespace scene
 
         public:
             CSkinningStateManager(const E_BONE_UPDATE_MODE& boneControl, video::IVideoDriver* driver, const CFinalBoneHierarchy* sourceHierarchy)
-                                    : ISkinningStateManager(boneControl,driver,sourceHierarchy), Driver(driver)
+                                    : ISkinningStateManager(boneControl,driver,sourceHierarchy), Driver(driver), boningWorkers(NULL)
             {
 #ifdef _IRR_COMPILE_WITH_OPENGL_
                 TBO = driver->addTextureBufferObject(finalBoneDataInstanceBuffer->getFrontBuffer(),video::ITextureBufferObject::ETBOF_RGBA32F);
@@ -317,286 +322,476 @@ namespace scene
                 }
                 else
                 {
+                    FinalBoneData* boneData = reinterpret_cast<FinalBoneData*>(finalBoneDataInstanceBuffer->getBackBufferPointer());
+                    const size_t instanceCount = getDataInstanceCount();
+                    const uint32_t jobCount = getBoningJobCount(instanceCount);
+
+                    // every job records what it modified, merging the ranges gives the same result for any thread count
+                    SDirtyRange modified;
+                    SDirtyRange jobRanges[MAX_BONING_JOBS];
                     switch (boneControlMode)
                     {
                         case EBUM_NONE:
                         case EBUM_READ:
+                            runBoningJobs(jobCount,instanceCount,[&](const size_t& begin, const size_t& end, const uint32_t& jobIx)
+                                {
+                                    for (size_t i=begin; i<end; i++)
+                                        animateInstance(i,boneData,jobRanges[jobIx]);
+                                });
+                            for (uint32_t i=0; i<jobCount; i++)
+                                modified.merge(jobRanges[i]);
+                            break;
+                        case EBUM_CONTROL:
                             {
-                                FinalBoneData* boneData = reinterpret_cast<FinalBoneData*>(finalBoneDataInstanceBuffer->getBackBufferPointer());
-                                bool notModified = true;
-                                uint32_t localFirstDirtyInstance,localLastDirtyInstance,firstBone,lastBone;
-                                for (size_t i=0; i<getDataInstanceCount(); i++)
+                                // an attached node can be the child of another instance's bone, so it's only updated once that instance is pulled
+                                const size_t waveCount = sortControlledInstances(instanceCount);
+                                for (size_t w=0; w<waveCount; w++)
                                 {
-                                    BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
-                                    if (currentInstance->frame==currentInstance->lastAnimatedFrame) //in other modes, check if also has no bones!!!
-                                        continue;
-
-                                    core::matrix4x3 attachedNodeTform;
-                                    if (currentInstance->attachedNode)
-                                        attachedNodeTform = currentInstance->attachedNode->getAbsoluteTransformation();
-
-
-                                    float interpolationFactor;
-                                    size_t foundBoneIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame);
-                                    float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
-                                    core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolationFactor);
-
-
-                                    FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
-                                    for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
+                                    const uint32_t* wave = controlOrder.data()+controlWaveStarts[w];
+                                    const size_t waveSize = controlWaveStarts[w+1]-controlWaveStarts[w];
+                                    for (size_t k=0; k<waveSize; k++)
                                     {
-                                        if (boneDataForInstance[j].lastAnimatedFrame==currentInstance->frame)
-                                            continue;
-                                        if (notModified)
-                                        {
-                                            localFirstDirtyInstance = i;
-                                            firstBone = j;
-                                            notModified = false;
-                                        }
-                                        localLastDirtyInstance = i;
-                                        lastBone = j;
-                                        boneDataForInstance[j].lastAnimatedFrame = currentInstance->frame;
-
-                                        CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx];
-
-                                        core::matrix4x3 interpolatedLocalTform;
-                                        if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
-                                        {
-                                            CFinalBoneHierarchy::AnimationKeyData lowerFrame =  (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx-1];
-                                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3).getAsRetardedIrrlichtMatrix();
-                                        }
-                                        else
-                                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKey(upperFrame).getAsRetardedIrrlichtMatrix();
-
-                                        if (j < referenceHierarchy->getBoneLevelRangeEnd(0))
-                                            getGlobalMatrices(currentInstance)[j] = interpolatedLocalTform;
-                                        else
-                                        {
-                                            const core::matrix4x3& parentTform = getGlobalMatrices(currentInstance)[referenceHierarchy->getBoneData()[j].parentOffsetFromTop];
-                                            getGlobalMatrices(currentInstance)[j] = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(parentTform), core::matrix3x4SIMD().set(interpolatedLocalTform)).getAsRetardedIrrlichtMatrix();
-											//concatenateBFollowedByA(parentTform,interpolatedLocalTform);
-                                        }
-                                        boneDataForInstance[j].SkinningTransform = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j]), core::matrix3x4SIMD().set(referenceHierarchy->getBoneData()[j].PoseBindMatrix)).getAsRetardedIrrlichtMatrix();
-										//concatenateBFollowedByA(getGlobalMatrices(currentInstance)[j],referenceHierarchy->getBoneData()[j].PoseBindMatrix);
-
-
-                                        core::aabbox3df bbox;
-                                        bbox.MinEdge.X = referenceHierarchy->getBoneData()[j].MinBBoxEdge[0];
-                                        bbox.MinEdge.Y = referenceHierarchy->getBoneData()[j].MinBBoxEdge[1];
-                                        bbox.MinEdge.Z = referenceHierarchy->getBoneData()[j].MinBBoxEdge[2];
-                                        bbox.MaxEdge.X = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[0];
-                                        bbox.MaxEdge.Y = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[1];
-                                        bbox.MaxEdge.Z = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[2];
-                                        //boneDataForInstance[j].SkinningTransform.transformBoxEx(bbox);
-										bbox = core::transformBoxEx(bbox, core::matrix3x4SIMD().set(boneDataForInstance[j].SkinningTransform));
-                                        //
-                                        if (boneControlMode==EBUM_READ)
-                                        {
-                                            IBoneSceneNode* bone = getBones(currentInstance)[j];
-                                            if (bone)
-                                            {
-												if (bone->getSkinningSpace() != IBoneSceneNode::EBSS_LOCAL)
-													bone->setRelativeTransformationMatrix(core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(attachedNodeTform), core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j])).getAsRetardedIrrlichtMatrix()/*concatenateBFollowedByA(attachedNodeTform,getGlobalMatrices(currentInstance)[j])*/);
-                                                else
-                                                {
-                                                    bone->setRelativeTransformationMatrix(interpolatedLocalTform);
-                                                    bone->updateAbsolutePosition();
-                                                }
-                                            }
-                                        }
-
-                                        boneDataForInstance[j].MinBBoxEdge[0] = bbox.MinEdge.X;
-                                        boneDataForInstance[j].MinBBoxEdge[1] = bbox.MinEdge.Y;
-                                        boneDataForInstance[j].MinBBoxEdge[2] = bbox.MinEdge.Z;
-                                        boneDataForInstance[j].MaxBBoxEdge[0] = bbox.MaxEdge.X;
-                                        boneDataForInstance[j].MaxBBoxEdge[1] = bbox.MaxEdge.Y;
-                                        boneDataForInstance[j].MaxBBoxEdge[2] = bbox.MaxEdge.Z;
-                                        boneDataForInstance[j].SkinningTransform.getSub3x3InverseTranspose(boneDataForInstance[j].SkinningNormalMatrix);
+                                        BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+wave[k]*actualSizeOfInstanceDataElement);
+                                        if (currentInstance->attachedNode)
+                                            currentInstance->attachedNode->updateAbsolutePosition();
                                     }
-                                }
 
-                                if (!notModified)
-                                {
-                                    if (localFirstDirtyInstance<firstDirtyInstance)
-                                    {
-                                        firstDirtyInstance = localFirstDirtyInstance;
-                                        firstDirtyBone = firstBone;
-                                    }
-                                    else if (localFirstDirtyInstance==firstDirtyInstance&&firstBone<firstDirtyBone)
-                                        firstDirtyBone = firstBone;
-                                    if (localLastDirtyInstance>lastDirtyInstance)
+                                    const uint32_t waveJobCount = getBoningJobCount(waveSize);
+                                    runBoningJobs(waveJobCount,waveSize,[&](const size_t& begin, const size_t& end, const uint32_t& jobIx)
+                                        {
+                                            for (size_t k=begin; k<end; k++)
+                                                pullControlledInstance(wave[k],boneData,jobRanges[jobIx]);
+                                        });
+                                    for (uint32_t i=0; i<waveJobCount; i++)
                                     {
-                                        lastDirtyInstance = localLastDirtyInstance;
-                                        lastDirtyBone = lastBone;
+                                        modified.merge(jobRanges[i]);
+                                        jobRanges[i] = SDirtyRange();
                                     }
-                                    else if (localLastDirtyInstance==lastDirtyInstance&&lastBone>lastDirtyBone)
-                                        lastDirtyBone = lastBone;
+                                }
+                            }
+                            break;
+                        default:
+                            break;
+                    }
 
+                    if (modified.modified)
+                    {
+                        if (modified.firstInstance<firstDirtyInstance)
+                        {
+                            firstDirtyInstance = modified.firstInstance;
+                            firstDirtyBone = modified.firstBone;
+                        }
+                        else if (modified.firstInstance==firstDirtyInstance&&modified.firstBone<firstDirtyBone)
+                            firstDirtyBone = modified.firstBone;
+                        if (modified.lastInstance>lastDirtyInstance)
+                        {
+                            lastDirtyInstance = modified.lastInstance;
+                            lastDirtyBone = modified.lastBone;
+                        }
+                        else if (modified.lastInstance==lastDirtyInstance&&modified.lastBone>lastDirtyBone)
+                            lastDirtyBone = modified.lastBone;
 
-                                    TrySwapBoneBuffer();
 
-                                    for (size_t i=localFirstDirtyInstance; i<=localLastDirtyInstance; i++)
-                                    {
-                                        BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
-                                        if (currentInstance->frame==currentInstance->lastAnimatedFrame) //in other modes, check if also has no bones!!!
-                                            continue;
-                                        currentInstance->lastAnimatedFrame = currentInstance->frame;
-
-                                        core::aabbox3df nodeBBox;
-                                        FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
-                                        for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
-                                        {
-                                            core::aabbox3df bbox;
-                                            bbox.MinEdge.X = boneDataForInstance[j].MinBBoxEdge[0];
-                                            bbox.MinEdge.Y = boneDataForInstance[j].MinBBoxEdge[1];
-                                            bbox.MinEdge.Z = boneDataForInstance[j].MinBBoxEdge[2];
-                                            bbox.MaxEdge.X = boneDataForInstance[j].MaxBBoxEdge[0];
-                                            bbox.MaxEdge.Y = boneDataForInstance[j].MaxBBoxEdge[1];
-                                            bbox.MaxEdge.Z = boneDataForInstance[j].MaxBBoxEdge[2];
-                                            if (j)
-                                                nodeBBox.addInternalBox(bbox);
-                                            else
-                                                nodeBBox = bbox;
-
-                                            if (boneControlMode==EBUM_READ)
-                                            {
-                                                IBoneSceneNode* bone = getBones(currentInstance)[j];
-                                                if (!bone)
-                                                    continue;
-
-                                                bone->updateAbsolutePosition();
-                                            }
-                                        }
+                        TrySwapBoneBuffer();
 
-                                        if (currentInstance->attachedNode)
-                                            currentInstance->attachedNode->setBoundingBox(nodeBBox);
-                                    }
-                                }
-                                else
-                                    TrySwapBoneBuffer();
-                            }
-                            break;
-                        case EBUM_CONTROL:
+                        const size_t dirtyCount = modified.lastInstance+1-modified.firstInstance;
+                        runBoningJobs(getBoningJobCount(dirtyCount),dirtyCount,[&](const size_t& begin, const size_t& end, const uint32_t& jobIx)
                             {
-                                FinalBoneData* boneData = reinterpret_cast<FinalBoneData*>(finalBoneDataInstanceBuffer->getBackBufferPointer());
-                                bool notModified = true;
-                                uint32_t localFirstDirtyInstance,localLastDirtyInstance,firstBone,lastBone;
-                                for (size_t i=0; i<getDataInstanceCount(); i++)
-                                {
-                                    BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
-                                    FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
+                                for (size_t i=modified.firstInstance+begin; i<modified.firstInstance+end; i++)
+                                    updateInstanceBoundingBox(i,boneData);
+                            });
+                    }
+                    else
+                        TrySwapBoneBuffer();
+                }
+            }
 
-                                    core::matrix3x4SIMD attachedNodeInverse;
-									//core::matrix4x3 attachedNodeInverse;
-                                    if (currentInstance->attachedNode)
-                                    {
-                                        currentInstance->attachedNode->updateAbsolutePosition();
-                                        //currentInstance->attachedNode->getAbsoluteTransformation().getInverse(attachedNodeInverse); // todo maybe simd inversion?
-										core::matrix3x4SIMD().set(currentInstance->attachedNode->getAbsoluteTransformation()).getInverse(attachedNodeInverse);
-                                    }
+        private:
+            enum E_BONING_JOB_CONSTANTS
+            {
+                MAX_BONING_JOBS = 64,
+                //! less instances than that aren't worth waking up a thread for
+                MIN_INSTANCES_PER_BONING_JOB = 32
+            };
 
-                                    bool localNotModified = true;
-                                    for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
-                                    {
-                                        IBoneSceneNode* bone = getBones(currentInstance)[j];
-                                        assert(bone);
-
-                                        bone->updateAbsolutePosition();
-                                        if (!bone->getTransformChangedBoningHint())
-                                            continue;
-                                        bone->setTransformChangedBoningHint();
-
-
-										boneDataForInstance[j].SkinningTransform = core::matrix3x4SIMD::concatenateBFollowedByA(attachedNodeInverse, core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(bone->getAbsoluteTransformation()), core::matrix3x4SIMD().set(referenceHierarchy->getBoneData()[j].PoseBindMatrix))).getAsRetardedIrrlichtMatrix();
-											//concatenateBFollowedByA(attachedNodeInverse,concatenateBFollowedByA(bone->getAbsoluteTransformation(),referenceHierarchy->getBoneData()[j].PoseBindMatrix)); //!may not be FP precise enough :(
-
-                                        boneDataForInstance[j].SkinningTransform.getSub3x3InverseTranspose(boneDataForInstance[j].SkinningNormalMatrix);
-
-                                        core::aabbox3df bbox;
-                                        bbox.MinEdge.X = referenceHierarchy->getBoneData()[j].MinBBoxEdge[0];
-                                        bbox.MinEdge.Y = referenceHierarchy->getBoneData()[j].MinBBoxEdge[1];
-                                        bbox.MinEdge.Z = referenceHierarchy->getBoneData()[j].MinBBoxEdge[2];
-                                        bbox.MaxEdge.X = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[0];
-                                        bbox.MaxEdge.Y = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[1];
-                                        bbox.MaxEdge.Z = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[2];
-                                        //boneDataForInstance[j].SkinningTransform.transformBoxEx(bbox);
-										bbox = core::transformBoxEx(bbox, core::matrix3x4SIMD().set(boneDataForInstance[j].SkinningTransform));
-                                        boneDataForInstance[j].MinBBoxEdge[0] = bbox.MinEdge.X;
-                                        boneDataForInstance[j].MinBBoxEdge[1] = bbox.MinEdge.Y;
-                                        boneDataForInstance[j].MinBBoxEdge[2] = bbox.MinEdge.Z;
-                                        boneDataForInstance[j].MaxBBoxEdge[0] = bbox.MaxEdge.X;
-                                        boneDataForInstance[j].MaxBBoxEdge[1] = bbox.MaxEdge.Y;
-                                        boneDataForInstance[j].MaxBBoxEdge[2] = bbox.MaxEdge.Z;
-
-                                        if (localNotModified)
-                                        {
-                                            if (notModified)
-                                            {
-                                                localFirstDirtyInstance = i;
-                                                firstBone = j;
-                                                notModified = false;
-                                            }
-                                            localNotModified = false;
-                                        }
-                                        localLastDirtyInstance = i;
-                                        lastBone = j;
-                                    }
+            //! Range of modified bones, from first bone of first instance to last bone of last instance modified.
+            struct SDirtyRange
+            {
+                SDirtyRange() : modified(false), firstInstance(0u), firstBone(0u), lastInstance(0u), lastBone(0u) {}
 
-                                    currentInstance->needToRecomputeParentBBox = localNotModified;
-                                }
+                inline void markDirty(const uint32_t& instance, const uint32_t& bone)
+                {
+                    if (!modified)
+                    {
+                        firstInstance = instance;
+                        firstBone = bone;
+                        modified = true;
+                    }
+                    lastInstance = instance;
+                    lastBone = bone;
+                }
 
-                                if (!notModified)
-                                {
-                                    if (localFirstDirtyInstance<firstDirtyInstance)
-                                    {
-                                        firstDirtyInstance = localFirstDirtyInstance;
-                                        firstDirtyBone = firstBone;
-                                    }
-                                    else if (localFirstDirtyInstance==firstDirtyInstance&&firstBone<firstDirtyBone)
-                                        firstDirtyBone = firstBone;
-                                    if (localLastDirtyInstance>lastDirtyInstance)
-                                    {
-                                        lastDirtyInstance = localLastDirtyInstance;
-                                        lastDirtyBone = lastBone;
-                                    }
-                                    else if (localLastDirtyInstance==lastDirtyInstance&&lastBone>lastDirtyBone)
-                                        lastDirtyBone = lastBone;
+                inline void merge(const SDirtyRange& other)
+                {
+                    if (!other.modified)
+                        return;
+                    if (!modified)
+                    {
+                        *this = other;
+                        return;
+                    }
+                    if (other.firstInstance<firstInstance||(other.firstInstance==firstInstance&&other.firstBone<firstBone))
+                    {
+                        firstInstance = other.firstInstance;
+                        firstBone = other.firstBone;
+                    }
+                    if (other.lastInstance>lastInstance||(other.lastInstance==lastInstance&&other.lastBone>lastBone))
+                    {
+                        lastInstance = other.lastInstance;
+                        lastBone = other.lastBone;
+                    }
+                }
 
+                bool modified;
+                uint32_t firstInstance,firstBone,lastInstance,lastBone;
+            };
 
-                                    TrySwapBoneBuffer();
+            inline uint32_t getBoningJobCount(const size_t& instanceCount) const
+            {
+                uint32_t threadCount = boningThreadCount ? boningThreadCount:std::max(std::thread::hardware_concurrency(),1u);
+                threadCount = std::min<uint32_t>(threadCount,MAX_BONING_JOBS);
+                return std::max<uint32_t>(std::min<size_t>(threadCount,instanceCount/MIN_INSTANCES_PER_BONING_JOB),1u);
+            }
 
-                                    for (size_t i=localFirstDirtyInstance; i<=localLastDirtyInstance; i++)
-                                    {
-                                        BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
-                                        if (!currentInstance->attachedNode || currentInstance->needToRecomputeParentBBox)
-                                            continue;
+            //! Threads kept between performBoning() calls, worker `i` runs job `i+1` of every batch with more than `i+1` jobs.
+            class CBoningWorkers
+            {
+                public:
+                    CBoningWorkers() : jobReady(&mutex), jobsDone(&mutex), job(NULL), jobCount(0u), batch(0u), pendingJobs(0u), stop(false) {}
 
-                                        core::aabbox3df nodeBBox;
-                                        FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
-                                        for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
-                                        {
-                                            core::aabbox3df bbox;
-                                            bbox.MinEdge.X = boneDataForInstance[j].MinBBoxEdge[0];
-                                            bbox.MinEdge.Y = boneDataForInstance[j].MinBBoxEdge[1];
-                                            bbox.MinEdge.Z = boneDataForInstance[j].MinBBoxEdge[2];
-                                            bbox.MaxEdge.X = boneDataForInstance[j].MaxBBoxEdge[0];
-                                            bbox.MaxEdge.Y = boneDataForInstance[j].MaxBBoxEdge[1];
-                                            bbox.MaxEdge.Z = boneDataForInstance[j].MaxBBoxEdge[2];
-                                            if (j)
-                                                nodeBBox.addInternalBox(bbox);
-                                            else
-                                                nodeBBox = bbox;
-                                        }
-
-                                        currentInstance->attachedNode->setBoundingBox(nodeBBox);
-                                    }
-                                }
-                                else
-                                    TrySwapBoneBuffer();
-                            }
-                            break;
+                    ~CBoningWorkers()
+                    {
+                        mutex.Get();
+                        stop = true;
+                        jobReady.SignalConditionToAll();
+                        mutex.Release();
+
+                        for (size_t i=0; i<threads.size(); i++)
+                            threads[i].join();
+                    }
+
+                    //! Calls `_job(jobIndex)` for every job index below `_jobCount` and returns once all are done, job 0 runs on the calling thread.
+                    inline void run(const uint32_t& _jobCount, const std::function<void(const uint32_t&)>& _job)
+                    {
+                        mutex.Get();
+                        while (threads.size()+1u<_jobCount)
+                            threads.push_back(std::thread(&CBoningWorkers::work,this,uint32_t(threads.size()),batch));
+                        job = &_job;
+                        jobCount = _jobCount;
+                        pendingJobs = _jobCount-1u;
+                        batch++;
+                        jobReady.SignalConditionToAll();
+                        mutex.Release();
+
+                        _job(0u);
+
+                        mutex.Get();
+                        while (pendingJobs)
+                            jobsDone.WaitForCondition(&mutex);
+                        mutex.Release();
                     }
+
+                private:
+                    inline void work(const uint32_t workerIx, uint64_t lastBatch)
+                    {
+                        mutex.Get();
+                        while (true)
+                        {
+                            while (!stop&&batch==lastBatch)
+                                jobReady.WaitForCondition(&mutex);
+                            if (stop)
+                                break;
+                            lastBatch = batch;
+                            if (workerIx+1u>=jobCount)
+                                continue;
+
+                            // a batch can't end before this job is done, so `job` stays valid
+                            mutex.Release();
+                            (*job)(workerIx+1u);
+                            mutex.Get();
+                            if (--pendingJobs==0u)
+                                jobsDone.SignalConditionOnce();
+                        }
+                        mutex.Release();
+                    }
+
+                    //! guards everything below
+                    FW_Mutex mutex;
+                    FW_ConditionVariable jobReady,jobsDone;
+
+                    std::vector<std::thread> threads;
+                    const std::function<void(const uint32_t&)>* job;
+                    uint32_t jobCount;
+                    //! incremented for every run() so workers can tell a new batch from a spurious wakeup
+                    uint64_t batch;
+                    uint32_t pendingJobs;
+                    bool stop;
+            };
+            CBoningWorkers* boningWorkers;
+
+            //! Splits instances into `jobCount` contiguous ranges and calls `job(begin,end,jobIndex)` for each on a separate worker thread, first one on the calling thread.
+            template<class F>
+            inline void runBoningJobs(const uint32_t& jobCount, const size_t& instanceCount, const F& job)
+            {
+                if (jobCount<2u)
+                {
+                    job(0u,instanceCount,0u);
+                    return;
                 }
+
+                if (!boningWorkers)
+                    boningWorkers = new CBoningWorkers();
+                boningWorkers->run(jobCount,[&](const uint32_t& jobIx)
+                    {
+                        job((instanceCount*jobIx)/jobCount,(instanceCount*(jobIx+1u))/jobCount,jobIx);
+                    });
+            }
+
+            //! Instance indices of EBUM_CONTROL boning, in waves so an instance attached to another instance's bone comes after that instance
+            std::vector<uint32_t> controlOrder;
+            //! wave `w` is controlOrder[controlWaveStarts[w]] up to controlOrder[controlWaveStarts[w+1]]
+            std::vector<size_t> controlWaveStarts;
+
+            //! Fills controlOrder and controlWaveStarts with instances of each wave in index order, returns number of waves.
+            inline size_t sortControlledInstances(const size_t& instanceCount)
+            {
+                const uint32_t none = 0xdeadbeefu;
+                std::vector<uint32_t> parentInstance(instanceCount,none);
+                for (size_t i=0; i<instanceCount; i++)
+                {
+                    BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
+                    if (!currentInstance->attachedNode)
+                        continue;
+                    IBoneSceneNode* parentBone = dynamic_cast<IBoneSceneNode*>(currentInstance->attachedNode->getParent());
+                    if (parentBone&&parentBone->getOwner()==this)
+                        parentInstance[i] = finalBoneDataInstanceBuffer->getRedirectFromID(parentBone->getInstanceID());
+                }
+
+                std::vector<uint32_t> waveOf(instanceCount,none);
+                std::vector<uint32_t> chain;
+                size_t waveCount = 1;
+                for (size_t i=0; i<instanceCount; i++)
+                {
+                    // walk up to an instance with a known wave or without a parent instance, the scene graph has no cycles
+                    uint32_t k = i;
+                    while (waveOf[k]==none&&parentInstance[k]!=none)
+                    {
+                        chain.push_back(k);
+                        k = parentInstance[k];
+                    }
+                    if (waveOf[k]==none)
+                        waveOf[k] = 0u;
+                    for (; chain.size(); chain.pop_back())
+                    {
+                        waveOf[chain.back()] = waveOf[k]+1u;
+                        k = chain.back();
+                    }
+                    waveCount = std::max<size_t>(waveCount,waveOf[i]+1u);
+                }
+
+                controlWaveStarts.assign(waveCount+1,0u);
+                for (size_t i=0; i<instanceCount; i++)
+                    controlWaveStarts[waveOf[i]+1]++;
+                for (size_t w=0; w<waveCount; w++)
+                    controlWaveStarts[w+1] += controlWaveStarts[w];
+                std::vector<size_t> waveEnds(controlWaveStarts.begin(),controlWaveStarts.end()-1);
+                controlOrder.resize(instanceCount);
+                for (size_t i=0; i<instanceCount; i++)
+                    controlOrder[waveEnds[waveOf[i]]++] = i;
+                return waveCount;
+            }
+
+            //! Interpolates keyframes and recomputes skinning data of bones which weren't already boned this frame by implicitBone().
+            /** Touches only data of instance `i` and its own bone nodes. */
+            inline void animateInstance(const size_t& i, FinalBoneData* boneData, SDirtyRange& range)
+            {
+                BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
+                if (currentInstance->frame==currentInstance->lastAnimatedFrame) //in other modes, check if also has no bones!!!
+                    return;
+
+                core::matrix4x3 attachedNodeTform;
+                if (currentInstance->attachedNode)
+                    attachedNodeTform = currentInstance->attachedNode->getAbsoluteTransformation();
+
+
+                float interpolationFactor;
+                size_t foundBoneIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame);
+                float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
+                core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolationFactor);
+
+
+                FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
+                for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
+                {
+                    if (boneDataForInstance[j].lastAnimatedFrame==currentInstance->frame)
+                        continue;
+                    range.markDirty(i,j);
+                    boneDataForInstance[j].lastAnimatedFrame = currentInstance->frame;
+
+                    CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx];
+
+                    core::matrix4x3 interpolatedLocalTform;
+                    if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
+                    {
+                        CFinalBoneHierarchy::AnimationKeyData lowerFrame =  (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx-1];
+                        interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3).getAsRetardedIrrlichtMatrix();
+                    }
+                    else
+                        interpolatedLocalTform = referenceHierarchy->getMatrixFromKey(upperFrame).getAsRetardedIrrlichtMatrix();
+
+                    if (j < referenceHierarchy->getBoneLevelRangeEnd(0))
+                        getGlobalMatrices(currentInstance)[j] = interpolatedLocalTform;
+                    else
+                    {
+                        const core::matrix4x3& parentTform = getGlobalMatrices(currentInstance)[referenceHierarchy->getBoneData()[j].parentOffsetFromTop];
+                        getGlobalMatrices(currentInstance)[j] = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(parentTform), core::matrix3x4SIMD().set(interpolatedLocalTform)).getAsRetardedIrrlichtMatrix();
+                        //concatenateBFollowedByA(parentTform,interpolatedLocalTform);
+                    }
+                    boneDataForInstance[j].SkinningTransform = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j]), core::matrix3x4SIMD().set(referenceHierarchy->getBoneData()[j].PoseBindMatrix)).getAsRetardedIrrlichtMatrix();
+                    //concatenateBFollowedByA(getGlobalMatrices(currentInstance)[j],referenceHierarchy->getBoneData()[j].PoseBindMatrix);
+
+
+                    core::aabbox3df bbox;
+                    bbox.MinEdge.X = referenceHierarchy->getBoneData()[j].MinBBoxEdge[0];
+                    bbox.MinEdge.Y = referenceHierarchy->getBoneData()[j].MinBBoxEdge[1];
+                    bbox.MinEdge.Z = referenceHierarchy->getBoneData()[j].MinBBoxEdge[2];
+                    bbox.MaxEdge.X = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[0];
+                    bbox.MaxEdge.Y = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[1];
+                    bbox.MaxEdge.Z = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[2];
+                    //boneDataForInstance[j].SkinningTransform.transformBoxEx(bbox);
+                    bbox = core::transformBoxEx(bbox, core::matrix3x4SIMD().set(boneDataForInstance[j].SkinningTransform));
+                    //
+                    if (boneControlMode==EBUM_READ)
+                    {
+                        IBoneSceneNode* bone = getBones(currentInstance)[j];
+                        if (bone)
+                        {
+                            // absolute transforms of local space bones get updated in updateInstanceBoundingBox(), parents first
+                            if (bone->getSkinningSpace() != IBoneSceneNode::EBSS_LOCAL)
+                                bone->setRelativeTransformationMatrix(core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(attachedNodeTform), core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j])).getAsRetardedIrrlichtMatrix()/*concatenateBFollowedByA(attachedNodeTform,getGlobalMatrices(currentInstance)[j])*/);
+                            else
+                                bone->setRelativeTransformationMatrix(interpolatedLocalTform);
+                        }
+                    }
+
+                    boneDataForInstance[j].MinBBoxEdge[0] = bbox.MinEdge.X;
+                    boneDataForInstance[j].MinBBoxEdge[1] = bbox.MinEdge.Y;
+                    boneDataForInstance[j].MinBBoxEdge[2] = bbox.MinEdge.Z;
+                    boneDataForInstance[j].MaxBBoxEdge[0] = bbox.MaxEdge.X;
+                    boneDataForInstance[j].MaxBBoxEdge[1] = bbox.MaxEdge.Y;
+                    boneDataForInstance[j].MaxBBoxEdge[2] = bbox.MaxEdge.Z;
+                    boneDataForInstance[j].SkinningTransform.getSub3x3InverseTranspose(boneDataForInstance[j].SkinningNormalMatrix);
+                }
+            }
+
+            //! Recomputes skinning data of bones whose nodes were moved since last boning, attached node's absolute transform must be up to date.
+            inline void pullControlledInstance(const size_t& i, FinalBoneData* boneData, SDirtyRange& range)
+            {
+                BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
+                FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
+
+                core::matrix3x4SIMD attachedNodeInverse;
+                //core::matrix4x3 attachedNodeInverse;
+                if (currentInstance->attachedNode)
+                {
+                    //currentInstance->attachedNode->getAbsoluteTransformation().getInverse(attachedNodeInverse); // todo maybe simd inversion?
+                    core::matrix3x4SIMD().set(currentInstance->attachedNode->getAbsoluteTransformation()).getInverse(attachedNodeInverse);
+                }
+
+                bool localNotModified = true;
+                for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
+                {
+                    IBoneSceneNode* bone = getBones(currentInstance)[j];
+                    assert(bone);
+
+                    bone->updateAbsolutePosition();
+                    if (!bone->getTransformChangedBoningHint())
+                        continue;
+                    bone->setTransformChangedBoningHint();
+
+
+                    boneDataForInstance[j].SkinningTransform = core::matrix3x4SIMD::concatenateBFollowedByA(attachedNodeInverse, core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(bone->getAbsoluteTransformation()), core::matrix3x4SIMD().set(referenceHierarchy->getBoneData()[j].PoseBindMatrix))).getAsRetardedIrrlichtMatrix();
+                        //concatenateBFollowedByA(attachedNodeInverse,concatenateBFollowedByA(bone->getAbsoluteTransformation(),referenceHierarchy->getBoneData()[j].PoseBindMatrix)); //!may not be FP precise enough :(
+
+                    boneDataForInstance[j].SkinningTransform.getSub3x3InverseTranspose(boneDataForInstance[j].SkinningNormalMatrix);
+
+                    core::aabbox3df bbox;
+                    bbox.MinEdge.X = referenceHierarchy->getBoneData()[j].MinBBoxEdge[0];
+                    bbox.MinEdge.Y = referenceHierarchy->getBoneData()[j].MinBBoxEdge[1];
+                    bbox.MinEdge.Z = referenceHierarchy->getBoneData()[j].MinBBoxEdge[2];
+                    bbox.MaxEdge.X = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[0];
+                    bbox.MaxEdge.Y = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[1];
+                    bbox.MaxEdge.Z = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[2];
+                    //boneDataForInstance[j].SkinningTransform.transformBoxEx(bbox);
+                    bbox = core::transformBoxEx(bbox, core::matrix3x4SIMD().set(boneDataForInstance[j].SkinningTransform));
+                    boneDataForInstance[j].MinBBoxEdge[0] = bbox.MinEdge.X;
+                    boneDataForInstance[j].MinBBoxEdge[1] = bbox.MinEdge.Y;
+                    boneDataForInstance[j].MinBBoxEdge[2] = bbox.MinEdge.Z;
+                    boneDataForInstance[j].MaxBBoxEdge[0] = bbox.MaxEdge.X;
+                    boneDataForInstance[j].MaxBBoxEdge[1] = bbox.MaxEdge.Y;
+                    boneDataForInstance[j].MaxBBoxEdge[2] = bbox.MaxEdge.Z;
+
+                    localNotModified = false;
+                    range.markDirty(i,j);
+                }
+
+                currentInstance->needToRecomputeParentBBox = localNotModified;
+            }
+
+            //! Sets attached node's bounding box to union of its bones' ones, in EBUM_READ mode also updates absolute transforms of bone nodes.
+            inline void updateInstanceBoundingBox(const size_t& i, FinalBoneData* boneData)
+            {
+                BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
+                if (boneControlMode==EBUM_CONTROL)
+                {
+                    if (!currentInstance->attachedNode || currentInstance->needToRecomputeParentBBox)
+                        return;
+                }
+                else
+                {
+                    if (currentInstance->frame==currentInstance->lastAnimatedFrame) //in other modes, check if also has no bones!!!
+                        return;
+                    currentInstance->lastAnimatedFrame = currentInstance->frame;
+                }
+
+                core::aabbox3df nodeBBox;
+                FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
+                for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
+                {
+                    core::aabbox3df bbox;
+                    bbox.MinEdge.X = boneDataForInstance[j].MinBBoxEdge[0];
+                    bbox.MinEdge.Y = boneDataForInstance[j].MinBBoxEdge[1];
+                    bbox.MinEdge.Z = boneDataForInstance[j].MinBBoxEdge[2];
+                    bbox.MaxEdge.X = boneDataForInstance[j].MaxBBoxEdge[0];
+                    bbox.MaxEdge.Y = boneDataForInstance[j].MaxBBoxEdge[1];
+                    bbox.MaxEdge.Z = boneDataForInstance[j].MaxBBoxEdge[2];
+                    if (j)
+                        nodeBBox.addInternalBox(bbox);
+                    else
+                        nodeBBox = bbox;
+
+                    if (boneControlMode==EBUM_READ)
+                    {
+                        IBoneSceneNode* bone = getBones(currentInstance)[j];
+                        if (!bone)
+                            continue;
+
+                        bone->updateAbsolutePosition();
+                    }
+                }
+
+                if (currentInstance->attachedNode)
+                    currentInstance->attachedNode->setBoundingBox(nodeBBox);
             }
     };
 
@@ -14,6 +14,8 @@
 #include "S4DVertex.h"
 #include "CBlit.h"
 
+#include <thread>
+
 
 #define MAT_TEXTURE(tex) ( (video::CSoftwareTexture2*) Material.org.getTexture ( tex ) )
 
@@ -335,8 +337,8 @@ struct program1
 CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters& params, io::IFileSystem* io, video::IImagePresenter* presenter)
 : CNullDriver(io, params.WindowSize), BackBuffer(0), Presenter(presenter),
 	WindowId(0), SceneSourceRect(0),
-	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0),
-	 DepthBuffer(0), StencilBuffer ( 0 ),
+	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShaderType(ETR_INVALID), CurrentShader(0),
+	 TileBinner(this), DepthBuffer(0), StencilBuffer ( 0 ),
 	 CurrentOut ( 12 * 2, 128 ), Temp ( 12 * 2, 128 )
 {
 	#ifdef _DEBUG
@@ -488,24 +490,96 @@ void CBurningVideoDriver::setCurrentShader()
 	//shader = ETR_REFERENCE;
 
 	// switchToTriangleRenderer
+	CurrentShaderType = shader;
 	CurrentShader = BurningShader[shader];
 	if ( CurrentShader )
-	{
-		CurrentShader->setZCompareFunc ( Material.org.ZBuffer );
-		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
-		CurrentShader->setMaterial ( Material );
+		setShaderState ( CurrentShader, shader, Material, RenderTargetSurface, ViewPort );
 
-		switch ( shader )
-		{
-			case ETR_TEXTURE_GOURAUD_ALPHA:
-			case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
-				CurrentShader->setParam ( 0, Material.org.MaterialTypeParam );
-				break;
-			default:
+}
+
+
+/*!
+	hands render states to a triangle renderer, the driver's own or one of the tile binner's.
+*/
+void CBurningVideoDriver::setShaderState(IBurningShader* shader, EBurningFFShader type, const SBurningShaderMaterial& material,
+	video::IImage* renderTarget, const core::rect<int32_t>& viewPort)
+{
+	shader->setZCompareFunc ( material.org.ZBuffer );
+	shader->setRenderTarget(renderTarget, viewPort);
+	shader->setMaterial ( material );
+
+	switch ( type )
+	{
+		case ETR_TEXTURE_GOURAUD_ALPHA:
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
+			shader->setParam ( 0, material.org.MaterialTypeParam );
 			break;
-		}
+		default:
+		break;
 	}
+}
 
+
+//! sets how many threads rasterize triangles
+void CBurningVideoDriver::setRasterizerThreadCount(uint32_t count)
+{
+	flushTriangles();
+	TileBinner.setThreadCount(count);
+}
+
+
+//! draws clipped and projected triangles with the current material
+void CBurningVideoDriver::drawDeviceTriangles(const s4DVertex* vertices, uint32_t vertexCount)
+{
+	if ( 0 == CurrentShader )
+		return;
+
+	const uint32_t threadCount = TileBinner.getThreadCount() ? TileBinner.getThreadCount() : std::thread::hardware_concurrency();
+	const bool binned = threadCount > 1;
+
+	CSoftwareTexture2* textures[BURNING_MATERIAL_MAX_TEXTURES];
+	int32_t lodLevels[BURNING_MATERIAL_MAX_TEXTURES];
+	for ( uint32_t m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+	{
+		textures[m] = MAT_TEXTURE ( m );
+		lodLevels[m] = 0;
+		if ( !binned )
+			CurrentShader->setTextureParam ( m, textures[m], lodLevels[m] );
+	}
+
+	if ( binned )
+		TileBinner.setState ( CurrentShaderType, Material, textures, lodLevels );
+	else
+		CurrentShader->setScissor ( &ViewPort );
+
+	for ( uint32_t i = 0; i + 3 <= vertexCount; i += 3 )
+	{
+		const s4DVertex* face = vertices + i;
+
+		const float dc_area =	( ( face[1].Pos.x - face[0].Pos.x ) * ( face[2].Pos.y - face[0].Pos.y ) ) -
+								( ( face[1].Pos.y - face[0].Pos.y ) * ( face[2].Pos.x - face[0].Pos.x ) );
+		if ( Material.org.BackfaceCulling && F32_LOWER_EQUAL_0( dc_area ) )
+			continue;
+		else
+		if ( Material.org.FrontfaceCulling && F32_GREATER_EQUAL_0( dc_area ) )
+			continue;
+
+		if ( binned )
+			TileBinner.addTriangle ( face, face + 1, face + 2, ViewPort );
+		else
+			CurrentShader->drawTriangle ( face, face + 1, face + 2 );
+	}
+
+	if ( !binned )
+		CurrentShader->setScissor ( 0 );
+}
+
+
+//! rasterizes all binned triangles
+void CBurningVideoDriver::flushTriangles()
+{
+	if ( !TileBinner.isEmpty() )
+		TileBinner.flush ( RenderTargetSurface, ViewPort );
 }
 
 
@@ -516,6 +590,7 @@ bool CBurningVideoDriver::beginScene(bool backBuffer, bool zBuffer,
 		core::rect<int32_t>* sourceRect)
 {
 	CNullDriver::beginScene(backBuffer, zBuffer, color, videoData, sourceRect);
+	flushTriangles();
 	WindowId = videoData.D3D9.HWnd;
 	SceneSourceRect = sourceRect;
 
@@ -533,6 +608,7 @@ bool CBurningVideoDriver::beginScene(bool backBuffer, bool zBuffer,
 bool CBurningVideoDriver::endScene()
 {
 	CNullDriver::endScene();
+	flushTriangles();
 
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
 }
@@ -548,6 +624,8 @@ bool CBurningVideoDriver::setRenderTarget(video::ITexture* texture, bool clearBa
 		return false;
 	}
 
+	flushTriangles();
+
 	if (RenderTargetTexture)
 		RenderTargetTexture->drop();
 
@@ -579,6 +657,8 @@ bool CBurningVideoDriver::setRenderTarget(video::ITexture* texture, bool clearBa
 //! sets a render target
 void CBurningVideoDriver::setRenderTarget(video::CImage* image)
 {
+	flushTriangles();
+
 	if (RenderTargetSurface)
 		RenderTargetSurface->drop();
 
@@ -606,6 +686,8 @@ void CBurningVideoDriver::setRenderTarget(video::CImage* image)
 //! sets a viewport
 void CBurningVideoDriver::setViewPort(const core::rect<int32_t>& area)
 {
+	flushTriangles();
+
 	ViewPort = area;
 
 	core::rect<int32_t> rendert(0,0,RenderTargetSize.Width,RenderTargetSize.Height);
@@ -1666,6 +1748,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 					 const core::rect<int32_t>* clipRect, SColor color,
 					 bool useAlphaChannelOfTexture)
 {
+	flushTriangles();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -1689,6 +1773,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 		const core::rect<int32_t>& sourceRect, const core::rect<int32_t>* clipRect,
 		const video::SColor* const colors, bool useAlphaChannelOfTexture)
 {
+	flushTriangles();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -1711,6 +1797,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<int32_t>& start,
 					const core::position2d<int32_t>& end,
 					SColor color)
 {
+	flushTriangles();
 	drawLine(BackBuffer, start, end, color );
 }
 
@@ -1718,6 +1805,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<int32_t>& start,
 //! Draws a pixel
 void CBurningVideoDriver::drawPixel(uint32_t x, uint32_t y, const SColor & color)
 {
+	flushTriangles();
 	BackBuffer->setPixel(x, y, color, true);
 }
 
@@ -1726,6 +1814,8 @@ void CBurningVideoDriver::drawPixel(uint32_t x, uint32_t y, const SColor & color
 void CBurningVideoDriver::draw2DRectangle(SColor color, const core::rect<int32_t>& pos,
 									 const core::rect<int32_t>* clip)
 {
+	flushTriangles();
+
 	if (clip)
 	{
 		core::rect<int32_t> p(pos);
@@ -1762,6 +1852,7 @@ void CBurningVideoDriver::OnResize(const core::dimension2d<uint32_t>& size)
 
 	if (ScreenSize != realSize)
 	{
+		flushTriangles();
 		ScreenSize = realSize;
 
 		bool resetRT = (RenderTargetSurface == BackBuffer);
@@ -1937,6 +2028,7 @@ ECOLOR_FORMAT CBurningVideoDriver::getColorFormat() const
 //! Clears the DepthBuffer.
 void CBurningVideoDriver::clearZBuffer()
 {
+	flushTriangles();
 	if (DepthBuffer)
 		DepthBuffer->clear();
 }
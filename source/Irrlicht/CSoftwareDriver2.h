@@ -7,6 +7,7 @@
 
 #include "SoftwareDriver2_compile_config.h"
 #include "IBurningShader.h"
+#include "CBurningTileBinner.h"
 #include "CNullDriver.h"
 #include "CImage.h"
 #include "os.h"
@@ -107,6 +108,25 @@ namespace video
         //! .
         virtual ITexture* addTexture(const ITexture::E_TEXTURE_TYPE& type, const std::vector<CImageData*>& images, const io::path& name, ECOLOR_FORMAT format);
 
+		//! Sets how many threads rasterize triangles, 0 means as many as the hardware has. Default is 1.
+		/** With one thread triangles are drawn straight away, with more they're binned into screen tiles
+		which are rasterized in parallel once the scene ends or something else is about to touch the render target.
+		Binned output can differ from drawing straight away in a few pixels on triangle edges and depth ties. */
+		void setRasterizerThreadCount(uint32_t count);
+
+		//! Returns number of threads set with setRasterizerThreadCount().
+		uint32_t getRasterizerThreadCount() const { return TileBinner.getThreadCount(); }
+
+		//! Draws triangles which are already clipped and projected with the current material.
+		/** \param vertices Three vertices for each triangle, as the triangle renderers take them: position in pixels
+		of the render target, 1/w in Pos.w, and colors and texture coordinates (the latter scaled to texel units of the
+		material's textures) already multiplied by 1/w when perspective correction is compiled in.
+		\param vertexCount Number of vertices, a multiple of 3. */
+		void drawDeviceTriangles(const s4DVertex* vertices, uint32_t vertexCount);
+
+		//! Rasterizes all triangles binned so far.
+		void flushTriangles();
+
 
 	protected:
 		//! sets a render target
@@ -128,9 +148,18 @@ namespace video
 		//! selects the right triangle renderer based on the render states.
 		void setCurrentShader();
 
+		//! hands render states to a triangle renderer
+		static void setShaderState(IBurningShader* shader, EBurningFFShader type, const SBurningShaderMaterial& material,
+			video::IImage* renderTarget, const core::rect<int32_t>& viewPort);
+		friend class CBurningTileBinner;
+
+		EBurningFFShader CurrentShaderType;
 		IBurningShader* CurrentShader;
 		IBurningShader* BurningShader[ETR2_COUNT];
 
+		//! defers triangles when rasterizing on many threads
+		CBurningTileBinner TileBinner;
+
 		IDepthBuffer* DepthBuffer;
 		IStencilBuffer* StencilBuffer;
 
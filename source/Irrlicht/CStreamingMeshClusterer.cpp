@@ -0,0 +1,106 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#include "CStreamingMeshClusterer.h"
+
+namespace irr
+{
+namespace scene
+{
+
+CStreamingMeshClusterer::CStreamingMeshClusterer(const core::aabbox3df& _bounds, size_t _vertexSize, const AttributeMapper& _mapper,
+	const IStreamingMeshLoader::MeshBufferCallback& _callback, const SStreamingMeshImportParams& _params)
+	: Origin(_bounds.MinEdge), Resolution(core::max_(_params.GridResolution, 1u)), VertexSize(_vertexSize),
+	MaxResidentBytes(_params.MaxResidentBytes), ResidentBytes(0u), Mapper(_mapper), Callback(_callback)
+{
+	Clusters.resize(Resolution*Resolution*Resolution);
+
+	// flat extents get single layer of cells instead of division by zero
+	const core::vector3df extent = _bounds.getExtent();
+	CellsPerUnit.X = extent.X>0.f ? float(Resolution)/extent.X : 0.f;
+	CellsPerUnit.Y = extent.Y>0.f ? float(Resolution)/extent.Y : 0.f;
+	CellsPerUnit.Z = extent.Z>0.f ? float(Resolution)/extent.Z : 0.f;
+
+	const size_t maxTriangles = core::max_<size_t>(_params.MaxVerticesPerBuffer/3u, 1u);
+	MaxClusterBytes = maxTriangles*3u*VertexSize;
+}
+
+bool CStreamingMeshClusterer::addTriangle(const void* _vertices)
+{
+	const uint8_t* const vertices = reinterpret_cast<const uint8_t*>(_vertices);
+	core::vector3df positions[3];
+	for (uint32_t i=0u; i<3u; i++)
+		memcpy(&positions[i].X, vertices+i*VertexSize, sizeof(core::vector3df));
+
+	const core::vector3df centroid = (positions[0]+positions[1]+positions[2])/3.f;
+	uint32_t cell[3];
+	const core::vector3df cellCoord = (centroid-Origin)*CellsPerUnit;
+	for (uint32_t i=0u; i<3u; i++)
+	{
+		const float c = (&cellCoord.X)[i];
+		cell[i] = c>0.f ? core::min_(uint32_t(c), Resolution-1u) : 0u;
+	}
+	const uint32_t clusterIx = (cell[2]*Resolution+cell[1])*Resolution+cell[0];
+
+	SCluster& cluster = Clusters[clusterIx];
+	if (cluster.Vertices.empty())
+		cluster.Bounds.reset(positions[0]);
+	for (uint32_t i=0u; i<3u; i++)
+		cluster.Bounds.addInternalPoint(positions[i]);
+
+	const size_t oldCapacity = cluster.Vertices.capacity();
+	cluster.Vertices.insert(cluster.Vertices.end(), vertices, vertices+3u*VertexSize);
+	ResidentBytes += cluster.Vertices.capacity()-oldCapacity;
+
+	if (cluster.Vertices.size()>=MaxClusterBytes && !emit(clusterIx))
+		return false;
+
+	// over the memory budget, get rid of the biggest clusters first
+	while (ResidentBytes>MaxResidentBytes)
+	{
+		uint32_t biggest = 0u;
+		for (uint32_t i=1u; i<Clusters.size(); i++)
+		if (Clusters[i].Vertices.capacity()>Clusters[biggest].Vertices.capacity())
+			biggest = i;
+		if (!emit(biggest))
+			return false;
+	}
+	return true;
+}
+
+bool CStreamingMeshClusterer::flush()
+{
+	for (uint32_t i=0u; i<Clusters.size(); i++)
+	if (!Clusters[i].Vertices.empty() && !emit(i))
+		return false;
+	return true;
+}
+
+bool CStreamingMeshClusterer::emit(uint32_t _clusterIx)
+{
+	SCluster& cluster = Clusters[_clusterIx];
+
+	core::ICPUBuffer* vertexBuf = new core::ICPUBuffer(cluster.Vertices.size());
+	memcpy(vertexBuf->getPointer(), cluster.Vertices.data(), cluster.Vertices.size());
+	const size_t vertexCount = cluster.Vertices.size()/VertexSize;
+	ResidentBytes -= cluster.Vertices.capacity();
+	std::vector<uint8_t>().swap(cluster.Vertices);
+
+	ICPUMeshBuffer* meshbuffer = new ICPUMeshBuffer();
+	ICPUMeshDataFormatDesc* desc = new ICPUMeshDataFormatDesc();
+	meshbuffer->setMeshDataAndFormat(desc);
+	desc->drop();
+	Mapper(desc, vertexBuf);
+	vertexBuf->drop();
+	meshbuffer->setIndexCount(vertexCount);
+	meshbuffer->setBoundingBox(cluster.Bounds);
+
+	const bool retval = Callback(meshbuffer, _clusterIx);
+	meshbuffer->drop();
+	return retval;
+}
+
+} // end namespace scene
+} // end namespace irr
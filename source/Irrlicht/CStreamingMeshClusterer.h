@@ -0,0 +1,62 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_STREAMING_MESH_CLUSTERER_H_INCLUDED__
+#define __C_STREAMING_MESH_CLUSTERER_H_INCLUDED__
+
+#include <vector>
+#include "IStreamingMeshLoader.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Bins triangle soup streamed by IStreamingMeshLoader implementations into a uniform grid of clusters and emits them as mesh buffers.
+/** Vertices are copied as opaque records of fixed size with position as the first 3 floats. A cluster is emitted once it holds
+SStreamingMeshImportParams::MaxVerticesPerBuffer vertices, or earlier if it's the biggest one when memory held by all of them
+exceeds SStreamingMeshImportParams::MaxResidentBytes. Memory of emitted clusters is freed, not kept for reuse.
+*/
+class CStreamingMeshClusterer
+{
+public:
+	//! Maps attributes of the vertex buffer of an emitted cluster into its format descriptor.
+	typedef std::function<void(ICPUMeshDataFormatDesc*, core::ICPUBuffer*)> AttributeMapper;
+
+	//! @param _bounds Bounding box of the whole input, triangles outside of it go to the border clusters.
+	CStreamingMeshClusterer(const core::aabbox3df& _bounds, size_t _vertexSize, const AttributeMapper& _mapper,
+		const IStreamingMeshLoader::MeshBufferCallback& _callback, const SStreamingMeshImportParams& _params);
+
+	//! Adds triangle made of 3 consecutive vertex records, cluster is chosen by its centroid.
+	/** @returns false if the callback aborted the import.*/
+	bool addTriangle(const void* _vertices);
+
+	//! Emits all clusters which aren't empty.
+	bool flush();
+
+	//! @returns Memory currently held by clusters waiting for emission.
+	size_t getResidentBytes() const { return ResidentBytes; }
+
+private:
+	struct SCluster
+	{
+		std::vector<uint8_t> Vertices;
+		core::aabbox3df Bounds;
+	};
+
+	bool emit(uint32_t _clusterIx);
+
+	std::vector<SCluster> Clusters;
+	core::vector3df Origin, CellsPerUnit;
+	uint32_t Resolution;
+	size_t VertexSize, MaxClusterBytes, MaxResidentBytes, ResidentBytes;
+	AttributeMapper Mapper;
+	IStreamingMeshLoader::MeshBufferCallback Callback;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
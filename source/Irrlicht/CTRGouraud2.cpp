@@ -138,6 +138,8 @@ void CTRGouraud2::scanline_bilinear ()
 	// apply top-left fill-convention, left
 	xStart = core::ceil32( line.x[0] );
 	xEnd = core::ceil32( line.x[1] ) - 1;
+	xStart = core::s32_max( xStart, Scissor.UpperLeftCorner.X );
+	xEnd = core::s32_min( xEnd, Scissor.LowerRightCorner.X - 1 );
 
 	dx = xEnd - xStart;
 
@@ -353,6 +355,8 @@ void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4D
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( a->Pos.y );
 		yEnd = core::ceil32( b->Pos.y ) - 1;
+		yStart = core::s32_max( yStart, Scissor.UpperLeftCorner.Y );
+		yEnd = core::s32_min( yEnd, Scissor.LowerRightCorner.Y - 1 );
 
 #ifdef SUBTEXEL
 		subPixel = ( (float) yStart ) - a->Pos.y;
@@ -512,6 +516,8 @@ void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4D
 		// apply top-left fill convention, top part
 		yStart = core::ceil32( b->Pos.y );
 		yEnd = core::ceil32( c->Pos.y ) - 1;
+		yStart = core::s32_max( yStart, Scissor.UpperLeftCorner.Y );
+		yEnd = core::s32_min( yEnd, Scissor.LowerRightCorner.Y - 1 );
 
 #ifdef SUBTEXEL
 
@@ -0,0 +1,113 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_WORKER_POOL_H_INCLUDED__
+#define __C_WORKER_POOL_H_INCLUDED__
+
+#include "FW_Mutex.h"
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace irr
+{
+namespace core
+{
+
+//! Threads that stay alive between batches of jobs, so a parallel loop run every frame doesn't create threads every frame.
+/** Threads are only created once a batch needs them and are joined by the destructor. */
+class CWorkerPool
+{
+    public:
+        CWorkerPool() : jobReady(&mutex), jobsDone(&mutex), job(NULL), jobCount(0u), batch(0u), pendingJobs(0u), busy(false), stop(false) {}
+
+        ~CWorkerPool()
+        {
+            mutex.Get();
+            stop = true;
+            jobReady.SignalConditionToAll();
+            mutex.Release();
+
+            for (size_t i=0; i<threads.size(); i++)
+                threads[i].join();
+        }
+
+        //! Calls `_job(jobIndex)` for every job index below `_jobCount` and returns once all are done, job 0 runs on the calling thread.
+        /** If another thread is running a batch on this pool, or a job of this pool calls run() again, all jobs run on the calling thread one after another. */
+        inline void run(const uint32_t& _jobCount, const std::function<void(const uint32_t&)>& _job)
+        {
+            mutex.Get();
+            if (busy||_jobCount<2u)
+            {
+                mutex.Release();
+                for (uint32_t i=0u; i<_jobCount; i++)
+                    _job(i);
+                return;
+            }
+            busy = true;
+            while (threads.size()+1u<_jobCount)
+                threads.push_back(std::thread(&CWorkerPool::work,this,uint32_t(threads.size()),batch));
+            job = &_job;
+            jobCount = _jobCount;
+            pendingJobs = _jobCount-1u;
+            batch++;
+            jobReady.SignalConditionToAll();
+            mutex.Release();
+
+            _job(0u);
+
+            mutex.Get();
+            while (pendingJobs)
+                jobsDone.WaitForCondition(&mutex);
+            busy = false;
+            mutex.Release();
+        }
+
+    private:
+        inline void work(const uint32_t workerIx, uint64_t lastBatch)
+        {
+            mutex.Get();
+            while (true)
+            {
+                while (!stop&&batch==lastBatch)
+                    jobReady.WaitForCondition(&mutex);
+                if (stop)
+                    break;
+                lastBatch = batch;
+                if (workerIx+1u>=jobCount)
+                    continue;
+
+                // a batch can't end before this job is done, so `job` stays valid
+                mutex.Release();
+                (*job)(workerIx+1u);
+                mutex.Get();
+                if (--pendingJobs==0u)
+                    jobsDone.SignalConditionOnce();
+            }
+            mutex.Release();
+        }
+
+        CWorkerPool(const CWorkerPool&); // no implementation
+        CWorkerPool& operator=(const CWorkerPool&); // no implementation
+
+        //! guards everything below
+        FW_Mutex mutex;
+        FW_ConditionVariable jobReady,jobsDone;
+
+        std::vector<std::thread> threads;
+        const std::function<void(const uint32_t&)>* job;
+        uint32_t jobCount;
+        //! incremented for every run() so workers can tell a new batch from a spurious wakeup
+        uint64_t batch;
+        uint32_t pendingJobs;
+        //! a batch is running, so a concurrent or nested run() doesn't overwrite it
+        bool busy;
+        bool stop;
+};
+
+} // end namespace core
+} // end namespace irr
+
+#endif // __C_WORKER_POOL_H_INCLUDED__
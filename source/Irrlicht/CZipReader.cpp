@@ -3,9 +3,15 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CZipReader.h"
+#include "CZipStreamReadFile.h"
+#include "CLimitReadFile.h"
+#include "CMemoryFile.h"
 
 #include "os.h"
-#include <sstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 // This method is used for error output from bzip2.
 extern "C" void bz_internal_error(int errorCode)
@@ -141,7 +147,10 @@ bool CArchiveLoaderZIP::isALoadableFileFormat(io::IReadFile* file) const
 // -----------------------------------------------------------------------------
 
 CZipReader::CZipReader(IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip)
- : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), File(file), IsGZip(isGZip)
+ : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), File(file), IsGZip(isGZip),
+	Cache(0u,[](const core::ICPUBuffer* data) {return size_t(data->getSize());},
+		[](core::ICPUBuffer* data) {data->grab();},[](core::ICPUBuffer* data) {data->drop();}),
+	StreamingThreshold(0x1u<<24)
 {
 	#ifdef _DEBUG
 	setDebugName("CZipReader");
@@ -154,7 +163,7 @@ CZipReader::CZipReader(IReadFile* file, bool ignoreCase, bool ignorePaths, bool
 		// load file entries
 		if (IsGZip)
 			while (scanGZipHeader()) { }
-		else
+		else if (!scanCentralDirectory())
 			while (scanZipHeader()) { }
 
 		sort();
@@ -180,6 +189,157 @@ const IFileList* CZipReader::getFileList() const
 }
 
 
+//! reads all file headers from the central directory, returns false if the archive has none (or a broken one).
+bool CZipReader::scanCentralDirectory()
+{
+	const size_t fileSize = File->getSize();
+	if (fileSize < sizeof(SZIPFileCentralDirEnd))
+		return false;
+
+	// the end record can only be followed by a comment of up to 64kB
+	const size_t tailSize = core::min_<size_t>(fileSize, sizeof(SZIPFileCentralDirEnd)+0xffff);
+	std::vector<uint8_t> tail(tailSize);
+	if (!readArchive(fileSize-tailSize, tail.data(), tailSize))
+		return false;
+
+	const uint8_t endID[] = {0x50, 0x4b, 0x05, 0x06};
+	size_t endPos = tailSize-sizeof(SZIPFileCentralDirEnd)+1;
+	do
+	{
+		if (endPos == 0)
+			return false;
+		--endPos;
+	} while (memcmp(tail.data()+endPos, endID, sizeof(endID)));
+
+	SZIPFileCentralDirEnd dirEnd;
+	memcpy(&dirEnd, tail.data()+endPos, sizeof(dirEnd));
+#ifdef __BIG_ENDIAN__
+	dirEnd.NumberDisk = os::Byteswap::byteswap(dirEnd.NumberDisk);
+	dirEnd.NumberStart = os::Byteswap::byteswap(dirEnd.NumberStart);
+	dirEnd.TotalDisk = os::Byteswap::byteswap(dirEnd.TotalDisk);
+	dirEnd.TotalEntries = os::Byteswap::byteswap(dirEnd.TotalEntries);
+	dirEnd.Size = os::Byteswap::byteswap(dirEnd.Size);
+	dirEnd.Offset = os::Byteswap::byteswap(dirEnd.Offset);
+	dirEnd.CommentLength = os::Byteswap::byteswap(dirEnd.CommentLength);
+#endif
+	// multi-disk archives and ones whose directory doesn't fit before the end record (e.g. Zip64) are left to the local header scan
+	if (dirEnd.NumberDisk != dirEnd.NumberStart || size_t(dirEnd.Offset)+dirEnd.Size > fileSize-tailSize+endPos)
+		return false;
+
+	// whole directory is taken in one read, or straight from memory
+	std::vector<uint8_t> dirCopy;
+	const uint8_t* dir = getMappedData(dirEnd.Offset, dirEnd.Size);
+	if (!dir)
+	{
+		dirCopy.resize(dirEnd.Size);
+		if (!readArchive(dirEnd.Offset, dirCopy.data(), dirEnd.Size))
+			return false;
+		dir = dirCopy.data();
+	}
+	const uint8_t* const dirEndPtr = dir+dirEnd.Size;
+
+	FileInfo.reallocate(dirEnd.TotalEntries);
+	for (uint32_t i=0; i<dirEnd.TotalEntries; ++i)
+	{
+		SZIPFileCentralDirFileHeader header;
+		if (dirEndPtr-dir < (ptrdiff_t)sizeof(header))
+			break;
+		memcpy(&header, dir, sizeof(header));
+#ifdef __BIG_ENDIAN__
+		header.Sig = os::Byteswap::byteswap(header.Sig);
+		header.VersionMadeBy = os::Byteswap::byteswap(header.VersionMadeBy);
+		header.VersionToExtract = os::Byteswap::byteswap(header.VersionToExtract);
+		header.GeneralBitFlag = os::Byteswap::byteswap(header.GeneralBitFlag);
+		header.CompressionMethod = os::Byteswap::byteswap(header.CompressionMethod);
+		header.LastModFileTime = os::Byteswap::byteswap(header.LastModFileTime);
+		header.LastModFileDate = os::Byteswap::byteswap(header.LastModFileDate);
+		header.CRC32 = os::Byteswap::byteswap(header.CRC32);
+		header.CompressedSize = os::Byteswap::byteswap(header.CompressedSize);
+		header.UncompressedSize = os::Byteswap::byteswap(header.UncompressedSize);
+		header.FilenameLength = os::Byteswap::byteswap(header.FilenameLength);
+		header.ExtraFieldLength = os::Byteswap::byteswap(header.ExtraFieldLength);
+		header.FileCommentLength = os::Byteswap::byteswap(header.FileCommentLength);
+		header.DiskNumberStart = os::Byteswap::byteswap(header.DiskNumberStart);
+		header.InternalFileAttributes = os::Byteswap::byteswap(header.InternalFileAttributes);
+		header.ExternalFileAttributes = os::Byteswap::byteswap(header.ExternalFileAttributes);
+		header.RelativeOffsetOfLocalHeader = os::Byteswap::byteswap(header.RelativeOffsetOfLocalHeader);
+#endif
+		const char* const name = reinterpret_cast<const char*>(dir+sizeof(header));
+		const uint8_t* const extra = dir+sizeof(header)+header.FilenameLength;
+		const uint8_t* const next = extra+header.ExtraFieldLength+header.FileCommentLength;
+		if (header.Sig != 0x02014b50 || next > dirEndPtr)
+			break;
+		dir = next;
+
+		SZipFileEntry entry;
+		entry.Offset = -1;
+		entry.LocalHeaderOffset = header.RelativeOffsetOfLocalHeader;
+		entry.header.Sig = 0x04034b50;
+		entry.header.VersionToExtract = header.VersionToExtract;
+		entry.header.GeneralBitFlag = header.GeneralBitFlag;
+		entry.header.CompressionMethod = header.CompressionMethod;
+		entry.header.LastModFileTime = header.LastModFileTime;
+		entry.header.LastModFileDate = header.LastModFileDate;
+		entry.header.DataDescriptor.CRC32 = header.CRC32;
+		entry.header.DataDescriptor.CompressedSize = header.CompressedSize;
+		entry.header.DataDescriptor.UncompressedSize = header.UncompressedSize;
+		entry.header.FilenameLength = header.FilenameLength;
+		// local header's extra field may differ, its length is only known once the file is opened
+		entry.header.ExtraFieldLength = 0;
+
+#ifdef _IRR_COMPILE_WITH_ZIP_ENCRYPTION_
+		// AES encryption info is repeated in the central directory
+		if ((entry.header.GeneralBitFlag & ZIP_FILE_ENCRYPTED) && (entry.header.CompressionMethod == 99))
+		{
+			for (const uint8_t* field=extra; extra+header.ExtraFieldLength-field >= (ptrdiff_t)sizeof(SZipFileExtraHeader); )
+			{
+				SZipFileExtraHeader extraHeader;
+				memcpy(&extraHeader, field, sizeof(extraHeader));
+#ifdef __BIG_ENDIAN__
+				extraHeader.ID = os::Byteswap::byteswap(extraHeader.ID);
+				extraHeader.Size = os::Byteswap::byteswap(extraHeader.Size);
+#endif
+				field += sizeof(extraHeader);
+				if (extraHeader.ID==(int16_t)0x9901 && (uint16_t)extraHeader.Size>=sizeof(SZipFileAESExtraData))
+				{
+					SZipFileAESExtraData data;
+					memcpy(&data, field, sizeof(data));
+#ifdef __BIG_ENDIAN__
+					data.Version = os::Byteswap::byteswap(data.Version);
+					data.CompressionMode = os::Byteswap::byteswap(data.CompressionMode);
+#endif
+					if (data.Vendor[0]=='A' && data.Vendor[1]=='E')
+					{
+						// encode values into Sig
+						// AE-Version | Strength | ActualMode
+						entry.header.Sig =
+							((data.Version & 0xff) << 24) |
+							(data.EncryptionStrength << 16) |
+							(data.CompressionMode);
+						break;
+					}
+				}
+				field += (uint16_t)extraHeader.Size;
+			}
+		}
+#endif
+
+		const io::path ZipFileName(name, header.FilenameLength);
+		addItem(ZipFileName, entry.LocalHeaderOffset, entry.header.DataDescriptor.UncompressedSize, ZipFileName.lastChar()=='/', FileInfo.size());
+		FileInfo.push_back(entry);
+	}
+
+	// broken directory, start over from the local headers
+	if (FileInfo.size() != dirEnd.TotalEntries)
+	{
+		FileInfo.clear();
+		Files.clear();
+		return false;
+	}
+	return true;
+}
+
+
 //! scans for a local header, returns false if there is no more local file header.
 //! The gzip file format seems to think that there can be multiple files in a gzip file
 //! but none
@@ -187,6 +347,7 @@ bool CZipReader::scanGZipHeader()
 {
 	SZipFileEntry entry;
 	entry.Offset = 0;
+	entry.LocalHeaderOffset = 0;
 	memset(&entry.header, 0, sizeof(SZIPFileHeader));
 
 	// read header
@@ -291,11 +452,12 @@ bool CZipReader::scanGZipHeader()
 }
 
 //! scans for a local header, returns false if there is no more local file header.
-bool CZipReader::scanZipHeader(bool ignoreGPBits)
+bool CZipReader::scanZipHeader()
 {
 	io::path ZipFileName = "";
 	SZipFileEntry entry;
 	entry.Offset = 0;
+	entry.LocalHeaderOffset = File->getPos();
 	memset(&entry.header, 0, sizeof(SZIPFileHeader));
 
 	File->read(&entry.header, sizeof(SZIPFileHeader));
@@ -369,56 +531,10 @@ bool CZipReader::scanZipHeader(bool ignoreGPBits)
 	if (entry.header.ExtraFieldLength)
 		File->seek(entry.header.ExtraFieldLength, true);
 
-	// if bit 3 was set, use CentralDirectory for setup
-	if (!ignoreGPBits && entry.header.GeneralBitFlag & ZIP_INFO_IN_DATA_DESCRIPTOR)
+	// if bit 3 was set, sizes are only stored in the central directory which couldn't be read
+	if (entry.header.GeneralBitFlag & ZIP_INFO_IN_DATA_DESCRIPTOR)
 	{
-		SZIPFileCentralDirEnd dirEnd;
-		FileInfo.clear();
-		Files.clear();
-		// First place where the end record could be stored
-		File->seek(File->getSize()-22);
-		const char endID[] = {0x50, 0x4b, 0x05, 0x06, 0x0};
-		char tmp[5]={'\0'};
-		bool found=false;
-		// search for the end record ID
-		while (!found && File->getPos()>0)
-		{
-			int seek=8;
-			File->read(tmp, 4);
-			switch (tmp[0])
-			{
-			case 0x50:
-				if (!strcmp(endID, tmp))
-				{
-					seek=4;
-					found=true;
-				}
-				break;
-			case 0x4b:
-				seek=5;
-				break;
-			case 0x05:
-				seek=6;
-				break;
-			case 0x06:
-				seek=7;
-				break;
-			}
-			File->seek(-seek, true);
-		}
-		File->read(&dirEnd, sizeof(dirEnd));
-#ifdef __BIG_ENDIAN__
-		dirEnd.NumberDisk = os::Byteswap::byteswap(dirEnd.NumberDisk);
-		dirEnd.NumberStart = os::Byteswap::byteswap(dirEnd.NumberStart);
-		dirEnd.TotalDisk = os::Byteswap::byteswap(dirEnd.TotalDisk);
-		dirEnd.TotalEntries = os::Byteswap::byteswap(dirEnd.TotalEntries);
-		dirEnd.Size = os::Byteswap::byteswap(dirEnd.Size);
-		dirEnd.Offset = os::Byteswap::byteswap(dirEnd.Offset);
-		dirEnd.CommentLength = os::Byteswap::byteswap(dirEnd.CommentLength);
-#endif
-		FileInfo.reallocate(dirEnd.TotalEntries);
-		File->seek(dirEnd.Offset);
-		while (scanCentralDirectoryHeader()) { }
+		os::Printer::log("Zip archive has no readable central directory, can't list files from", ZipFileName.c_str(), ELL_WARNING);
 		return false;
 	}
 
@@ -438,45 +554,168 @@ bool CZipReader::scanZipHeader(bool ignoreGPBits)
 }
 
 
-//! scans for a local header, returns false if there is no more local file header.
-bool CZipReader::scanCentralDirectoryHeader()
+//! returns pointer to `size` bytes at `offset` in the archive if it's in memory, 0 otherwise
+const uint8_t* CZipReader::getMappedData(size_t offset, size_t size) const
 {
-	io::path ZipFileName = "";
-	SZIPFileCentralDirFileHeader entry;
-	File->read(&entry, sizeof(SZIPFileCentralDirFileHeader));
+	const uint8_t* const mapped = reinterpret_cast<const uint8_t*>(File->getMappedPointer());
+	if (!mapped || offset+size > File->getSize())
+		return 0;
+	return mapped+offset;
+}
+
+
+//! reads `size` bytes at `offset` in the archive, can be called from multiple threads
+bool CZipReader::readArchive(size_t offset, void* buffer, size_t size)
+{
+	if (const uint8_t* mapped = getMappedData(offset, size))
+	{
+		memcpy(buffer, mapped, size);
+		return true;
+	}
+
+	FileMutex.Get();
+	const bool retval = File->seek(offset) && (size_t)File->read(buffer, size) == size;
+	FileMutex.Release();
+	return retval;
+}
+
 
+//! sets position of the entry's data if not known yet, reading its local header
+bool CZipReader::resolveDataOffset(SZipFileEntry& entry)
+{
+	FileMutex.Get();
+	bool retval = entry.Offset >= 0;
+	if (!retval)
+	{
+		// everything but the length of the name and extra field is already known from the central directory
+		SZIPFileHeader header;
+		if (File->seek(entry.LocalHeaderOffset) && File->read(&header, sizeof(header)) == sizeof(header))
+		{
 #ifdef __BIG_ENDIAN__
-	entry.Sig = os::Byteswap::byteswap(entry.Sig);
-	entry.VersionMadeBy = os::Byteswap::byteswap(entry.VersionMadeBy);
-	entry.VersionToExtract = os::Byteswap::byteswap(entry.VersionToExtract);
-	entry.GeneralBitFlag = os::Byteswap::byteswap(entry.GeneralBitFlag);
-	entry.CompressionMethod = os::Byteswap::byteswap(entry.CompressionMethod);
-	entry.LastModFileTime = os::Byteswap::byteswap(entry.LastModFileTime);
-	entry.LastModFileDate = os::Byteswap::byteswap(entry.LastModFileDate);
-	entry.CRC32 = os::Byteswap::byteswap(entry.CRC32);
-	entry.CompressedSize = os::Byteswap::byteswap(entry.CompressedSize);
-	entry.UncompressedSize = os::Byteswap::byteswap(entry.UncompressedSize);
-	entry.FilenameLength = os::Byteswap::byteswap(entry.FilenameLength);
-	entry.ExtraFieldLength = os::Byteswap::byteswap(entry.ExtraFieldLength);
-	entry.FileCommentLength = os::Byteswap::byteswap(entry.FileCommentLength);
-	entry.DiskNumberStart = os::Byteswap::byteswap(entry.DiskNumberStart);
-	entry.InternalFileAttributes = os::Byteswap::byteswap(entry.InternalFileAttributes);
-	entry.ExternalFileAttributes = os::Byteswap::byteswap(entry.ExternalFileAttributes);
-	entry.RelativeOffsetOfLocalHeader = os::Byteswap::byteswap(entry.RelativeOffsetOfLocalHeader);
+			header.Sig = os::Byteswap::byteswap(header.Sig);
+			header.FilenameLength = os::Byteswap::byteswap(header.FilenameLength);
+			header.ExtraFieldLength = os::Byteswap::byteswap(header.ExtraFieldLength);
 #endif
+			if (header.Sig == 0x04034b50)
+			{
+				entry.header.ExtraFieldLength = header.ExtraFieldLength;
+				entry.Offset = entry.LocalHeaderOffset+sizeof(header)+(uint16_t)header.FilenameLength+(uint16_t)header.ExtraFieldLength;
+				retval = true;
+			}
+		}
+	}
+	FileMutex.Release();
+	return retval;
+}
 
-	if (entry.Sig != 0x02014b50)
-		return false; // central dir headers end here.
-
-	const long pos = File->getPos();
-	File->seek(entry.RelativeOffsetOfLocalHeader);
-	scanZipHeader(true);
-	File->seek(pos+entry.FilenameLength+entry.ExtraFieldLength+entry.FileCommentLength);
-	FileInfo.getLast().header.DataDescriptor.CompressedSize=entry.CompressedSize;
-	FileInfo.getLast().header.DataDescriptor.UncompressedSize=entry.UncompressedSize;
-	FileInfo.getLast().header.DataDescriptor.CRC32=entry.CRC32;
-	Files.getLast().Size=entry.UncompressedSize;
-	return true;
+
+//! stored entry of an archive which isn't in memory, reads hold the archive's file mutex so other entries can be opened meanwhile
+class CZipLimitReadFile : public CLimitReadFile
+{
+	public:
+		CZipLimitReadFile(CZipReader* archive, const size_t& pos, const size_t& areaSize, const io::path& name)
+			: CLimitReadFile(archive->File, pos, areaSize, name), Archive(archive)
+		{
+			Archive->grab();
+		}
+
+		virtual int32_t read(void* buffer, uint32_t sizeToRead)
+		{
+			Archive->FileMutex.Get();
+			const int32_t retval = CLimitReadFile::read(buffer, sizeToRead);
+			Archive->FileMutex.Release();
+			return retval;
+		}
+
+	protected:
+		virtual ~CZipLimitReadFile()
+		{
+			Archive->drop();
+		}
+
+	private:
+		CZipReader* Archive;
+};
+
+
+namespace
+{
+
+//! reads decompressed contents shared with the cache and other files opened from it
+class CSharedMemoryReadFile : public CMemoryReadFile
+{
+	public:
+		CSharedMemoryReadFile(core::ICPUBuffer* data, const io::path& fileName)
+			: CMemoryReadFile(data->getPointer(), data->getSize(), fileName, false), Data(data)
+		{
+			Data->grab();
+		}
+
+	protected:
+		virtual ~CSharedMemoryReadFile()
+		{
+			Data->drop();
+		}
+
+	private:
+		core::ICPUBuffer* Data;
+};
+
+}
+
+
+//! returns file reading decompressed contents kept in the cache, or 0 if there are none
+IReadFile* CZipReader::createFromCache(uint32_t index)
+{
+	CacheMutex.Get();
+	core::ICPUBuffer* data = Cache.getCapacity() ? Cache.getByKey(index) : 0;
+	IReadFile* retval = data ? new CSharedMemoryReadFile(data, Files[index].FullName) : 0;
+	CacheMutex.Release();
+	return retval;
+}
+
+
+//! returns file reading decompressed contents, which are also kept in the cache if it has a budget
+IReadFile* CZipReader::createAndCacheFile(uint32_t index, core::ICPUBuffer* data)
+{
+	IReadFile* retval = new CSharedMemoryReadFile(data, Files[index].FullName);
+	CacheMutex.Get();
+	if (Cache.getCapacity())
+		Cache.insert(index, data);
+	CacheMutex.Release();
+	data->drop();
+	return retval;
+}
+
+
+//! sets how many bytes of decompressed files are kept for reopening
+void CZipReader::setDecompressedCacheSize(size_t maxBytes)
+{
+	CacheMutex.Get();
+	Cache.setCapacity(maxBytes);
+	CacheMutex.Release();
+}
+
+
+//! opens several files by index, decompressing them on multiple threads
+uint32_t CZipReader::createAndOpenFiles(const uint32_t* indices, uint32_t count, IReadFile** outFiles, uint32_t threadCount)
+{
+	// sizes of files vary a lot, so threads take them one at a time instead of in fixed chunks
+	std::atomic<uint32_t> next(0), opened(0);
+	auto openFiles = [&](const uint32_t&)
+	{
+		for (uint32_t i=next++; i<count; i=next++)
+		{
+			outFiles[i] = createAndOpenFile(indices[i]);
+			if (outFiles[i])
+				opened++;
+		}
+	};
+
+	const uint32_t threadCnt = core::min_(threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u), count);
+	Workers.run(threadCnt, openFiles);
+
+	return opened;
 }
 
 
@@ -523,8 +762,31 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 	//98 - PPMd - Compression Method, WinZip 10
 	//99 - AES encryption, WinZip 9
 
-	const SZipFileEntry &e = FileInfo[Files[index].ID];
+	if (index >= Files.size())
+		return 0;
+
+	if (IReadFile* cached = createFromCache(index))
+		return cached;
+
+	SZipFileEntry &e = FileInfo[Files[index].ID];
 	wchar_t buf[64];
+	if (!resolveDataOffset(e))
+	{
+		os::Printer::log("Missing local file header of", Files[index].FullName.c_str(), ELL_ERROR);
+		return 0;
+	}
+
+	// big files are decompressed as they're read rather than into memory
+	if (e.header.DataDescriptor.UncompressedSize >= StreamingThreshold && !(e.header.GeneralBitFlag & ZIP_FILE_ENCRYPTED) &&
+		e.header.CompressionMethod != 0 && CZipStreamReadFile::isSupported(e.header.CompressionMethod))
+	{
+		CZipStreamReadFile* stream = new CZipStreamReadFile(this, e, Files[index].FullName);
+		if (stream->isValid())
+			return stream;
+		stream->drop();
+		os::Printer::log("Error decompressing", Files[index].FullName.c_str(), ELL_ERROR);
+		return 0;
+	}
 	int16_t actualCompressionMethod=e.header.CompressionMethod;
 	IReadFile* decrypted=0;
 	uint8_t* decryptedBuf=0;
@@ -535,11 +797,10 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 		os::Printer::log("Reading encrypted file.");
 		uint8_t salt[16]={0};
 		const uint16_t saltSize = (((e.header.Sig & 0x00ff0000) >>16)+1)*4;
-		File->seek(e.Offset);
-		File->read(salt, saltSize);
+		readArchive(e.Offset, salt, saltSize);
 		char pwVerification[2];
 		char pwVerificationFile[2];
-		File->read(pwVerification, 2);
+		readArchive(e.Offset+saltSize, pwVerification, 2);
 		fcrypt_ctx zctx; // the encryption context
 		int rc = fcrypt_init(
 			(e.header.Sig & 0x00ff0000) >>16,
@@ -555,17 +816,16 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 		}
 		decryptedSize= e.header.DataDescriptor.CompressedSize-saltSize-12;
 		decryptedBuf= new uint8_t[decryptedSize];
+		readArchive(e.Offset+saltSize+2, decryptedBuf, decryptedSize);
 		uint32_t c = 0;
 		while ((c+32768)<=decryptedSize)
 		{
-			File->read(decryptedBuf+c, 32768);
 			fcrypt_decrypt(
 				decryptedBuf+c, // pointer to the data to decrypt
 				32768,   // how many bytes to decrypt
 				&zctx); // decryption context
 			c+=32768;
 		}
-		File->read(decryptedBuf+c, decryptedSize-c);
 		fcrypt_decrypt(
 			decryptedBuf+c, // pointer to the data to decrypt
 			decryptedSize-c,   // how many bytes to decrypt
@@ -582,7 +842,7 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 			delete [] decryptedBuf;
 			return 0;
 		}
-		File->read(fileMAC, 10);
+		readArchive(e.Offset+saltSize+2+decryptedSize, fileMAC, 10);
 		if (strncmp(fileMAC, resMAC, 10))
 		{
 			os::Printer::log("Error on encryption check");
@@ -612,25 +872,33 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 		{
 			if (decrypted)
 				return decrypted;
-			else
+			else if (File->getMappedPointer())
 				return createLimitReadFile(Files[index].FullName, File, e.Offset, decryptedSize);
+			else if (decryptedSize >= StreamingThreshold)
+				return new CZipStreamReadFile(this, e, Files[index].FullName);
+			else
+				return new CZipLimitReadFile(this, e.Offset, decryptedSize, Files[index].FullName);
 		}
 	case 8:
 		{
   			#ifdef _IRR_COMPILE_WITH_ZLIB_
 
 			const uint32_t uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			char* pBuf = new char[ uncompressedSize ];
-			if (!pBuf)
+			core::ICPUBuffer* data = new core::ICPUBuffer(uncompressedSize);
+			char* pBuf = reinterpret_cast<char*>(data->getPointer());
+			if (!pBuf && uncompressedSize)
 			{
 				swprintf ( buf, 64, L"Not enough memory for decompressing %s", Files[index].FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
+				data->drop();
 				if (decrypted)
 					decrypted->drop();
 				return 0;
 			}
 
-			uint8_t *pcData = decryptedBuf;
+			// compressed data of archives in memory (e.g. memory-mapped) is decompressed in place
+			const uint8_t* const mappedData = decryptedBuf ? 0 : getMappedData(e.Offset, decryptedSize);
+			uint8_t *pcData = decryptedBuf ? decryptedBuf : const_cast<uint8_t*>(mappedData);
 			if (!pcData)
 			{
 				pcData = new uint8_t[decryptedSize];
@@ -638,13 +906,12 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 				{
 					swprintf ( buf, 64, L"Not enough memory for decompressing %s", Files[index].FullName.c_str() );
 					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
+					data->drop();
 					return 0;
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				readArchive(e.Offset, pcData, decryptedSize);
 			}
 
 			// Setup the inflate stream.
@@ -672,18 +939,20 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 
 			if (decrypted)
 				decrypted->drop();
-			else
+			else if (!mappedData)
 				delete[] pcData;
 
 			if (err != Z_OK)
 			{
 				swprintf ( buf, 64, L"Error decompressing %s", Files[index].FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
+				data->drop();
 				return 0;
 			}
 			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+			{
+				return createAndCacheFile(index, data);
+			}
 
 			#else
 			return 0; // zlib not compiled, we cannot decompress the data.
@@ -694,17 +963,20 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
   			#ifdef _IRR_COMPILE_WITH_BZIP2_
 
 			const uint32_t uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			char* pBuf = new char[ uncompressedSize ];
-			if (!pBuf)
+			core::ICPUBuffer* data = new core::ICPUBuffer(uncompressedSize);
+			char* pBuf = reinterpret_cast<char*>(data->getPointer());
+			if (!pBuf && uncompressedSize)
 			{
 				swprintf ( buf, 64, L"Not enough memory for decompressing %s", Files[index].FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
+				data->drop();
 				if (decrypted)
 					decrypted->drop();
 				return 0;
 			}
 
-			uint8_t *pcData = decryptedBuf;
+			const uint8_t* const mappedData = decryptedBuf ? 0 : getMappedData(e.Offset, decryptedSize);
+			uint8_t *pcData = decryptedBuf ? decryptedBuf : const_cast<uint8_t*>(mappedData);
 			if (!pcData)
 			{
 				pcData = new uint8_t[decryptedSize];
@@ -712,13 +984,12 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 				{
 					swprintf ( buf, 64, L"Not enough memory for decompressing %s", Files[index].FullName.c_str() );
 					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
+					data->drop();
 					return 0;
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				readArchive(e.Offset, pcData, decryptedSize);
 			}
 
 			bz_stream bz_ctx={0};
@@ -731,6 +1002,7 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 			if(err != BZ_OK)
 			{
 				os::Printer::log("bzip2 decompression failed. File cannot be read.", ELL_ERROR);
+				data->drop();
 				return 0;
 			}
 			bz_ctx.next_in = (char*)pcData;
@@ -743,18 +1015,20 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 
 			if (decrypted)
 				decrypted->drop();
-			else
+			else if (!mappedData)
 				delete[] pcData;
 
 			if (err != BZ_OK)
 			{
 				swprintf ( buf, 64, L"Error decompressing %s", Files[index].FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
+				data->drop();
 				return 0;
 			}
 			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+			{
+				return createAndCacheFile(index, data);
+			}
 
 			#else
 			os::Printer::log("bzip2 decompression not supported. File cannot be read.", ELL_ERROR);
@@ -766,17 +1040,20 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
   			#ifdef _IRR_COMPILE_WITH_LZMA_
 
 			uint32_t uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			char* pBuf = new char[ uncompressedSize ];
-			if (!pBuf)
+			core::ICPUBuffer* data = new core::ICPUBuffer(uncompressedSize);
+			char* pBuf = reinterpret_cast<char*>(data->getPointer());
+			if (!pBuf && uncompressedSize)
 			{
 				swprintf ( buf, 64, L"Not enough memory for decompressing %s", Files[index].FullName.c_str() );
 				os::Printer::log( buf, ELL_ERROR);
+				data->drop();
 				if (decrypted)
 					decrypted->drop();
 				return 0;
 			}
 
-			uint8_t *pcData = decryptedBuf;
+			const uint8_t* const mappedData = decryptedBuf ? 0 : getMappedData(e.Offset, decryptedSize);
+			uint8_t *pcData = decryptedBuf ? decryptedBuf : const_cast<uint8_t*>(mappedData);
 			if (!pcData)
 			{
 				pcData = new uint8_t[decryptedSize];
@@ -784,13 +1061,12 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 				{
 					swprintf ( buf, 64, L"Not enough memory for decompressing %s", Files[index].FullName.c_str() );
 					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
+					data->drop();
 					return 0;
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				readArchive(e.Offset, pcData, decryptedSize);
 			}
 
 			ELzmaStatus status;
@@ -804,20 +1080,23 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 					e.header.GeneralBitFlag&0x1?LZMA_FINISH_END:LZMA_FINISH_ANY, &status,
 					&lzmaAlloc);
 			uncompressedSize = tmpDstSize; // may be different to expected value
+			data->reallocate(uncompressedSize);
 
 			if (decrypted)
 				decrypted->drop();
-			else
+			else if (!mappedData)
 				delete[] pcData;
 
 			if (err != SZ_OK)
 			{
-				os::Printer::log( "Error decompressing", Files[index].FullName, ELL_ERROR);
-				delete [] pBuf;
+				os::Printer::log( "Error decompressing", Files[index].FullName.c_str(), ELL_ERROR);
+				data->drop();
 				return 0;
 			}
 			else
-				return io::createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+			{
+				return createAndCacheFile(index, data);
+			}
 
 			#else
 			os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
@@ -14,6 +14,11 @@
 #include "irrString.h"
 #include "IFileSystem.h"
 #include "CFileList.h"
+#include "FW_Mutex.h"
+#include "CWorkerPool.h"
+#include "CLRUObjectCache.h"
+#include "ICPUBuffer.h"
+#include <vector>
 
 namespace irr
 {
@@ -128,9 +133,12 @@ namespace io
 	//! Contains extended info about zip files in the archive
 	struct SZipFileEntry
 	{
-		//! Position of data in the archive file
+		//! Position of data in the archive file, -1 until the local header is read
 		int32_t Offset;
 
+		//! Position of the local header in the archive file
+		uint32_t LocalHeaderOffset;
+
 		//! The header for this file containing compression info etc
 		SZIPFileHeader header;
 	};
@@ -174,6 +182,8 @@ namespace io
 
 /*!
 	Zip file Reader written April 2002 by N.Gebhardt.
+	The file list is taken from the central directory in one read on mount, local headers are only read when a file is first opened.
+	Files can be opened from multiple threads at once, only reads from an archive which isn't memory mapped are serialized.
 */
 	class CZipReader : public virtual IFileArchive, virtual CFileList
 	{
@@ -194,21 +204,45 @@ namespace io
             //! returns the list of files
             virtual const IFileList* getFileList() const;
 
+            //! opens several files by index, decompressing them on multiple threads
+            virtual uint32_t createAndOpenFiles(const uint32_t* indices, uint32_t count, IReadFile** outFiles, uint32_t threadCount=0);
+
+            //! sets how many bytes of decompressed files are kept for reopening
+            virtual void setDecompressedCacheSize(size_t maxBytes);
+
+            //! sets from which size files are decompressed as they're read
+            virtual void setStreamingThreshold(size_t minBytes) { StreamingThreshold = minBytes; }
+
             //! get the archive type
             virtual E_FILE_ARCHIVE_TYPE getType() const;
 
+            //! returns pointer to `size` bytes at `offset` in the archive if it's in memory, 0 otherwise
+            const uint8_t* getMappedData(size_t offset, size_t size) const;
+
+            //! reads `size` bytes at `offset` in the archive, can be called from multiple threads
+            bool readArchive(size_t offset, void* buffer, size_t size);
+
         protected:
+            friend class CZipLimitReadFile;
+
+            //! reads all file headers from the central directory at the end of a ZIP file, returns false if it couldn't be found.
+            bool scanCentralDirectory();
 
-            //! reads the next file header from a ZIP file, returns false if there are no more headers.
-            /* if ignoreGPBits is set, the item will be read despite missing
-            file information. This is used when reading items from the central
-            directory. */
-            bool scanZipHeader(bool ignoreGPBits=false);
+            //! reads the next local file header from a ZIP file, returns false if there are no more headers.
+            /** Only used for archives without a readable central directory. */
+            bool scanZipHeader();
 
             //! the same but for gzip files
             bool scanGZipHeader();
 
-            bool scanCentralDirectoryHeader();
+            //! sets position of the entry's data if not known yet, reading its local header
+            bool resolveDataOffset(SZipFileEntry& entry);
+
+            //! returns file reading decompressed contents kept in the cache, or 0 if there are none
+            IReadFile* createFromCache(uint32_t index);
+
+            //! returns file reading decompressed contents, which are also kept in the cache if it has a budget
+            IReadFile* createAndCacheFile(uint32_t index, core::ICPUBuffer* data);
 
             IReadFile* File;
 
@@ -216,6 +250,19 @@ namespace io
             core::array<SZipFileEntry> FileInfo;
 
             bool IsGZip;
+
+            //! guards File's read position and lazily resolved data offsets
+            FW_Mutex FileMutex;
+
+            //! decompressed contents of recently opened files by index, shared with the files reading them
+            FW_Mutex CacheMutex;
+            core::CLRUObjectCache<uint32_t,core::ICPUBuffer> Cache;
+
+            //! threads of createAndOpenFiles(), kept between calls
+            core::CWorkerPool Workers;
+
+            //! uncompressed size from which files are returned as CZipStreamReadFile
+            size_t StreamingThreshold;
 	};
 
 
@@ -0,0 +1,385 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#include "CZipStreamReadFile.h"
+
+#ifdef __IRR_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
+
+#include <algorithm>
+
+namespace irr
+{
+namespace io
+{
+
+namespace
+{
+	//! Size of reads from archives which aren't in memory
+	const size_t IN_BUFFER_SIZE = 0x10000u;
+
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	void* SzAlloc(ISzAllocPtr p, size_t size) { return malloc(size); }
+	void SzFree(ISzAllocPtr p, void* address) { free(address); }
+	const ISzAlloc lzmaAlloc = { SzAlloc, SzFree };
+#endif
+}
+
+
+bool CZipStreamReadFile::isSupported(int16_t compressionMethod)
+{
+	switch (compressionMethod)
+	{
+	case 0:
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	case 8:
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+	case 12:
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14:
+#endif
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+CZipStreamReadFile::CZipStreamReadFile(CZipReader* archive, const SZipFileEntry& entry, const io::path& fileName)
+	: Archive(archive), Entry(entry), Filename(fileName), Size(entry.header.DataDescriptor.UncompressedSize), Pos(0), Valid(false),
+	DecodedPos(0), WindowPos(0), InPos(0), DecoderActive(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CZipStreamReadFile");
+	#endif
+
+	Archive->grab();
+
+	// at most 256 points (8MB of windows) whatever the size of the file
+	RestartSpan = core::max_<size_t>(0x1u<<20, Size/256u);
+
+	memset(Window, 0, WINDOW_SIZE);
+	if (Entry.header.CompressionMethod && !Archive->getMappedData(Entry.Offset, Entry.header.DataDescriptor.CompressedSize))
+		InBuffer.resize(IN_BUFFER_SIZE);
+
+	Valid = restart(0);
+}
+
+
+CZipStreamReadFile::~CZipStreamReadFile()
+{
+	endDecoder();
+	Archive->drop();
+}
+
+
+//! returns how many bytes were read
+int32_t CZipStreamReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+	const size_t toRead = core::min_<size_t>(sizeToRead, Size-Pos);
+	if (!toRead)
+		return 0;
+
+	// stored data is read straight from the archive
+	if (Entry.header.CompressionMethod == 0)
+	{
+		if (!Archive->readArchive(Entry.Offset+Pos, buffer, toRead))
+			return 0;
+		Pos += toRead;
+		return toRead;
+	}
+
+	// output which left the window has to be decompressed again, and far enough forward a restart point saves decompression
+	const SRestartPoint* point = findRestartPoint(Pos);
+	if (Pos+WINDOW_SIZE < DecodedPos)
+	{
+		if (!restart(point))
+			return 0;
+	}
+	else if (point && point->Out > DecodedPos)
+	{
+		if (!restart(point))
+			return 0;
+	}
+
+	uint8_t* const out = reinterpret_cast<uint8_t*>(buffer);
+	size_t done = 0;
+	while (done < toRead)
+	{
+		if (Pos >= DecodedPos)
+		{
+			if (!decodeStep())
+				break;
+			continue;
+		}
+
+		const size_t behind = DecodedPos-Pos;
+		const size_t start = (WindowPos+WINDOW_SIZE-behind)%WINDOW_SIZE;
+		const size_t chunk = core::min_(core::min_(behind, WINDOW_SIZE-start), toRead-done);
+		memcpy(out+done, Window+start, chunk);
+		done += chunk;
+		Pos += chunk;
+	}
+	return done;
+}
+
+
+//! changes position in file, returns true if successful
+bool CZipStreamReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	const size_t target = relativeMovement ? Pos+finalPos : finalPos;
+	if (target > Size)
+		return false;
+
+	// decompression catches up on the next read
+	Pos = target;
+	return true;
+}
+
+
+bool CZipStreamReadFile::restart(const SRestartPoint* point)
+{
+	endDecoder();
+
+	InPos = point ? point->In : 0;
+	DecodedPos = point ? point->Out : 0;
+	// the window ends at the restart position, so output right before it can be read without decoding
+	WindowPos = 0;
+	if (point)
+	{
+		memcpy(Window, point->Window.data(), WINDOW_SIZE);
+		WindowPos = WINDOW_SIZE;
+	}
+
+	switch (Entry.header.CompressionMethod)
+	{
+	case 0:
+		return true;
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	case 8:
+		memset(&ZStream, 0, sizeof(ZStream));
+		// wbits < 0 indicates no zlib header inside the data
+		if (inflateInit2(&ZStream, -MAX_WBITS) != Z_OK)
+			return false;
+		DecoderActive = true;
+		if (point)
+		{
+			if (point->Bits)
+			{
+				uint8_t partial;
+				if (!Archive->readArchive(Entry.Offset+point->In-1, &partial, 1))
+					return false;
+				inflatePrime(&ZStream, point->Bits, partial >> (8-point->Bits));
+			}
+			inflateSetDictionary(&ZStream, point->Window.data(), WINDOW_SIZE);
+		}
+		return true;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+	case 12:
+		memset(&BZStream, 0, sizeof(BZStream));
+		if (BZ2_bzDecompressInit(&BZStream, 0, 0) != BZ_OK)
+			return false;
+		DecoderActive = true;
+		return true;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14:
+		{
+			// 2 bytes of version and 2 of properties' size precede the properties and the stream
+			uint8_t header[4];
+			if (!Archive->readArchive(Entry.Offset, header, 4))
+				return false;
+			const uint32_t propSize = (header[3]<<8)+header[2];
+			std::vector<uint8_t> props(propSize);
+			if (!Archive->readArchive(Entry.Offset+4, props.data(), propSize))
+				return false;
+
+			LzmaDec_Construct(&LzmaState);
+			if (LzmaDec_Allocate(&LzmaState, props.data(), propSize, &lzmaAlloc) != SZ_OK)
+				return false;
+			LzmaDec_Init(&LzmaState);
+			DecoderActive = true;
+			InPos = 4+propSize;
+			LzmaAvailable = 0;
+			return true;
+		}
+#endif
+	default:
+		return false;
+	}
+}
+
+
+void CZipStreamReadFile::endDecoder()
+{
+	if (!DecoderActive)
+		return;
+
+	switch (Entry.header.CompressionMethod)
+	{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	case 8:
+		inflateEnd(&ZStream);
+		break;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+	case 12:
+		BZ2_bzDecompressEnd(&BZStream);
+		break;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14:
+		LzmaDec_Free(&LzmaState, &lzmaAlloc);
+		break;
+#endif
+	default:
+		break;
+	}
+	DecoderActive = false;
+}
+
+
+size_t CZipStreamReadFile::decodeStep()
+{
+	size_t produced = 0;
+	while (!produced && DecoderActive)
+	{
+		if (WindowPos == WINDOW_SIZE)
+			WindowPos = 0;
+		uint8_t* const out = Window+WindowPos;
+		const size_t space = core::min_<size_t>(WINDOW_SIZE-WindowPos, Size-DecodedPos);
+
+		bool end = !space;
+		bool blockBoundary = false;
+		const uint8_t* next;
+		size_t available;
+		switch (end ? 0 : Entry.header.CompressionMethod)
+		{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+		case 8:
+			{
+				if (!ZStream.avail_in && fillInput(next, available))
+				{
+					ZStream.next_in = const_cast<Bytef*>(next);
+					ZStream.avail_in = available;
+				}
+				ZStream.next_out = out;
+				ZStream.avail_out = space;
+				// stopping at the end of each block gives a chance to place restart points
+				const int err = inflate(&ZStream, Z_BLOCK);
+				produced = space-ZStream.avail_out;
+				end = err != Z_OK;
+				blockBoundary = !end && (ZStream.data_type & 128) && !(ZStream.data_type & 64);
+			}
+			break;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+		case 12:
+			{
+				const bool inputLeft = BZStream.avail_in || fillInput(next, available);
+				if (!BZStream.avail_in && inputLeft)
+				{
+					BZStream.next_in = const_cast<char*>(reinterpret_cast<const char*>(next));
+					BZStream.avail_in = available;
+				}
+				BZStream.next_out = reinterpret_cast<char*>(out);
+				BZStream.avail_out = space;
+				const int err = BZ2_bzDecompress(&BZStream);
+				produced = space-BZStream.avail_out;
+				end = err != BZ_OK || (!produced && !inputLeft);
+			}
+			break;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+		case 14:
+			{
+				const bool inputLeft = LzmaAvailable || fillInput(next, available);
+				if (!LzmaAvailable && inputLeft)
+				{
+					LzmaNext = next;
+					LzmaAvailable = available;
+				}
+				SizeT outSize = space;
+				SizeT inSize = LzmaAvailable;
+				ELzmaStatus status;
+				const SRes err = LzmaDec_DecodeToBuf(&LzmaState, out, &outSize, LzmaNext, &inSize, LZMA_FINISH_ANY, &status);
+				LzmaNext += inSize;
+				LzmaAvailable -= inSize;
+				produced = outSize;
+				end = err != SZ_OK || status == LZMA_STATUS_FINISHED_WITH_MARK || (!produced && !inputLeft);
+			}
+			break;
+#endif
+		default:
+			end = true;
+			break;
+		}
+
+		DecodedPos += produced;
+		WindowPos += produced;
+		if (blockBoundary)
+			addRestartPoint();
+		if (end)
+			endDecoder();
+	}
+	return produced;
+}
+
+
+bool CZipStreamReadFile::fillInput(const uint8_t*& next, size_t& available)
+{
+	const size_t compressedSize = Entry.header.DataDescriptor.CompressedSize;
+	if (InPos >= compressedSize)
+		return false;
+
+	available = compressedSize-InPos;
+	next = Archive->getMappedData(Entry.Offset+InPos, available);
+	if (!next)
+	{
+		available = core::min_(available, IN_BUFFER_SIZE);
+		if (!Archive->readArchive(Entry.Offset+InPos, InBuffer.data(), available))
+			return false;
+		next = InBuffer.data();
+	}
+	InPos += available;
+	return true;
+}
+
+
+void CZipStreamReadFile::addRestartPoint()
+{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	// points are placed the first time through, replaying output after a restart doesn't get past the last one
+	const size_t lastOut = RestartPoints.empty() ? 0 : RestartPoints.back().Out;
+	if (DecodedPos < lastOut+RestartSpan || DecodedPos >= Size)
+		return;
+
+	RestartPoints.push_back(SRestartPoint());
+	SRestartPoint& point = RestartPoints.back();
+	point.Out = DecodedPos;
+	point.In = InPos-ZStream.avail_in;
+	point.Bits = ZStream.data_type & 7;
+	// unroll the circular window so it ends right before Out
+	point.Window.resize(WINDOW_SIZE);
+	memcpy(point.Window.data(), Window+WindowPos, WINDOW_SIZE-WindowPos);
+	memcpy(point.Window.data()+WINDOW_SIZE-WindowPos, Window, WindowPos);
+#endif
+}
+
+
+const CZipStreamReadFile::SRestartPoint* CZipStreamReadFile::findRestartPoint(size_t pos) const
+{
+	std::vector<SRestartPoint>::const_iterator found = std::upper_bound(RestartPoints.begin(), RestartPoints.end(), pos,
+		[](size_t _pos, const SRestartPoint& _point) { return _pos < _point.Out; });
+	return found == RestartPoints.begin() ? 0 : &(*(found-1));
+}
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif // __IRR_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
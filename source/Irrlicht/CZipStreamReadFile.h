@@ -0,0 +1,153 @@
+// Copyright (C) 2018 Mateusz "DeVsh" Kielan
+// This file is part of the "Irrlicht Engine" and "Build A World".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+// and on http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=49672
+
+#ifndef __C_ZIP_STREAM_READ_FILE_H_INCLUDED__
+#define __C_ZIP_STREAM_READ_FILE_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+#ifdef __IRR_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
+
+#include "CZipReader.h"
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+	#ifndef _IRR_USE_NON_SYSTEM_ZLIB_
+	#include <zlib.h> // use system lib
+	#else
+	#include "zlib/zlib.h"
+	#endif
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+	#ifndef _IRR_USE_NON_SYSTEM_BZLIB_
+	#include <bzlib.h>
+	#else
+	#include "bzip2/bzlib.h"
+	#endif
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	#include "lzma/LzmaDec.h"
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+	//! Reads a compressed file from a zip archive by decompressing it as read() advances, never holding all of it in memory.
+	/** The last 32kB of output are kept, so short seeks backwards are free. Deflated files also get a restart point (position
+	in compressed data and the 32kB of output before it) at a block boundary every getRestartSpan() bytes of output the first
+	time they're decompressed, so any other seek only has to decompress from the nearest point before the target.
+	bzip2 and lzma decoders have no state that cheap to capture, so seeking further back starts over from the beginning.
+	Stored files are simply read from the archive at their position, which unlike CLimitReadFile is safe to do from many threads.
+	*/
+	class CZipStreamReadFile : public IReadFile
+	{
+		public:
+			//! Size of kept output, same as the biggest distance deflate can refer back to.
+			static const uint32_t WINDOW_SIZE = 0x8000u;
+
+			//! Checks if compression method (or 0 for stored files) can be streamed in this build.
+			static bool isSupported(int16_t compressionMethod);
+
+			//! Constructor
+			/** \param archive Archive to read the compressed data from, the file keeps it alive.
+			\param entry Entry of the file with its data offset already resolved.
+			\param fileName Name returned by getFileName(). */
+			CZipStreamReadFile(CZipReader* archive, const SZipFileEntry& entry, const io::path& fileName);
+
+			//! returns false if the decoder couldn't be started, e.g. due to broken data or out of memory
+			bool isValid() const { return Valid; }
+
+			//! returns how many bytes were read
+			virtual int32_t read(void* buffer, uint32_t sizeToRead);
+
+			//! changes position in file, returns true if successful
+			virtual bool seek(const size_t& finalPos, bool relativeMovement = false);
+
+			//! returns size of file
+			virtual size_t getSize() const { return Size; }
+
+			//! returns where in the file we are.
+			virtual size_t getPos() const { return Pos; }
+
+			//! returns name of file
+			virtual const io::path& getFileName() const { return Filename; }
+
+			//! returns distance between restart points of deflated data
+			size_t getRestartSpan() const { return RestartSpan; }
+
+		protected:
+			//! destructor
+			virtual ~CZipStreamReadFile();
+
+		private:
+			struct SRestartPoint
+			{
+				//! Position in the decompressed file.
+				size_t Out;
+				//! Position in compressed data of the first byte which wasn't consumed at all.
+				size_t In;
+				//! Number of bits of byte preceding `In` which are yet to be consumed.
+				uint32_t Bits;
+				//! Output preceding `Out`.
+				std::vector<uint8_t> Window;
+			};
+
+			//! starts decoding over from the point or from the beginning if it's 0
+			bool restart(const SRestartPoint* point);
+
+			//! frees the decoder's state
+			void endDecoder();
+
+			//! decompresses next piece of data into Window, returns 0 at the end of data or on error
+			size_t decodeStep();
+
+			//! returns next piece of compressed data, straight from memory if the archive is mapped
+			bool fillInput(const uint8_t*& next, size_t& available);
+
+			//! remembers the state at a deflate block boundary if the last point is far enough behind
+			void addRestartPoint();
+
+			//! returns the last restart point at or before `pos`, 0 if there's none
+			const SRestartPoint* findRestartPoint(size_t pos) const;
+
+			CZipReader* Archive;
+			SZipFileEntry Entry;
+			io::path Filename;
+			size_t Size, Pos;
+			bool Valid;
+
+			//! position in the file of the end of decompressed data in Window
+			size_t DecodedPos;
+			//! Window is circular, WindowPos is where the decoder writes next
+			uint8_t Window[WINDOW_SIZE];
+			size_t WindowPos;
+
+			//! position in compressed data of the next byte which wasn't handed to the decoder yet
+			size_t InPos;
+			std::vector<uint8_t> InBuffer;
+
+			std::vector<SRestartPoint> RestartPoints;
+			size_t RestartSpan;
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+			z_stream ZStream;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+			bz_stream BZStream;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+			CLzmaDec LzmaState;
+			const uint8_t* LzmaNext;
+			size_t LzmaAvailable;
+#endif
+			bool DecoderActive;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif // __IRR_COMPILE_WITH_ZIP_ARCHIVE_LOADER_
+#endif // __C_ZIP_STREAM_READ_FILE_H_INCLUDED__
@@ -36,6 +36,7 @@ namespace video
 		Driver = driver;
 		RenderTarget = 0;
 		ColorMask = COLOR_BRIGHT_WHITE;
+		setScissor ( 0 );
 		DepthBuffer = (CDepthBuffer*) driver->getDepthBuffer ();
 		if ( DepthBuffer )
 			DepthBuffer->grab();
@@ -84,6 +85,17 @@ namespace video
 	}
 
 
+	//! restricts rasterization to a rectangle of the render target
+	void IBurningShader::setScissor ( const core::rect<int32_t>* scissor )
+	{
+		// far enough out to never clip, but not so far the branchless min/max overflow
+		if ( scissor )
+			Scissor = *scissor;
+		else
+			Scissor = core::rect<int32_t> ( -0x40000000, -0x40000000, 0x40000000, 0x40000000 );
+	}
+
+
 	//! sets the Texture
 	void IBurningShader::setTextureParam( uint32_t stage, video::CSoftwareTexture2* texture, int32_t lodLevel)
 	{
@@ -100,6 +100,11 @@ namespace video
 
 		virtual void setMaterial ( const SBurningShaderMaterial &material ) {};
 
+		//! restricts rasterization to a rectangle of the render target, 0 lifts the restriction
+		/** Interpolation starts at the clipped edges, so a triangle drawn tile by tile
+		can differ from drawing it whole by a pixel on its edges and by one in color rounding. */
+		void setScissor ( const core::rect<int32_t>* scissor );
+
 	protected:
 		//! destructor
 		virtual ~IBurningShader();
@@ -113,6 +118,8 @@ namespace video
 
 		sInternalTexture IT[ BURNING_MATERIAL_MAX_TEXTURES ];
 
+		core::rect<int32_t> Scissor;
+
 		static const tFixPointu dithermask[ 4 * 4];
 	};
 
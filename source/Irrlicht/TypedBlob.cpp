@@ -10,6 +10,8 @@
 #include "SMesh.h"
 #include "CSkinnedMesh.h"
 #include "CBlobsLoadingManager.h"
+#include "CMappedReadFile.h"
+#include "CMappedCPUBuffer.h"
 
 namespace irr { namespace core
 {
@@ -28,6 +30,14 @@ void* TypedBlob<RawBufferBlobV0, ICPUBuffer>::instantiateEmpty(const void* _blob
 		return NULL;
 
 	RawBufferBlobV0* blob = (RawBufferBlobV0*)_blob;
+	if (_params.mappedFile)
+	{
+		const uint8_t* const mapBegin = (const uint8_t*)_params.mappedFile->getMappedPointer();
+		const uint8_t* const blobBegin = (const uint8_t*)blob->getData();
+		if (blobBegin >= mapBegin && blobBegin + _blobSize <= mapBegin + _params.mappedFile->getSize())
+			return new core::CMappedCPUBuffer(_blobSize, blob->getData(), _params.mappedFile); // mapping is private, so no need to copy
+	}
+
 	core::ICPUBuffer* buf = new core::ICPUBuffer(_blobSize);
 	memcpy(buf->getPointer(), blob->getData(), _blobSize);
 
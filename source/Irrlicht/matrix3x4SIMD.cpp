@@ -0,0 +1,287 @@
+#include "SColor.h" // pulls vectorSIMD.h in the order it needs
+#include "matrix3x4SIMD.h"
+#include "os.h"
+#include <atomic>
+
+namespace irr
+{
+namespace core
+{
+
+namespace
+{
+	static_assert(sizeof(aabbox3df)==6u*sizeof(float), "Kernels assume boxes are tightly packed");
+
+	typedef void (*ConcatenateKernel)(matrix3x4SIMD* _out, const matrix3x4SIMD* _a, const matrix3x4SIMD* _b, size_t _count);
+	typedef void (*TransformKernel)(const matrix3x4SIMD& _mat, vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count);
+	typedef void (*BoxKernel)(aabbox3df* _out, const aabbox3df* _in, const matrix3x4SIMD* _mats, size_t _count);
+
+	matrix3x4SIMD::E_SIMD_LEVEL detectSIMDLevel()
+	{
+		if (os::CPU::hasAVX2())
+			return matrix3x4SIMD::ESL_AVX2;
+		return matrix3x4SIMD::ESL_SSE3;
+	}
+
+	std::atomic<int32_t>& SIMDLevel()
+	{
+		static std::atomic<int32_t> level(detectSIMDLevel());
+		return level;
+	}
+
+	#define BROADCAST32(fpx) _MM_SHUFFLE(fpx, fpx, fpx, fpx)
+
+	//! returns rows of the matrix transposed, with (0,0,0,1) as the fourth row
+	inline void getColumns(const matrix3x4SIMD& _mat, __m128& _c0, __m128& _c1, __m128& _c2, __m128& _c3)
+	{
+		vectorSIMDf c0 = _mat.rows[0], c1 = _mat.rows[1], c2 = _mat.rows[2], c3(0.f, 0.f, 0.f, 1.f);
+		transpose4(c0, c1, c2, c3);
+		_c0 = c0.getAsRegister();
+		_c1 = c1.getAsRegister();
+		_c2 = c2.getAsRegister();
+		_c3 = c3.getAsRegister();
+	}
+
+	// SSE3 is what the whole engine is compiled for, these are the reference the other kernels have to match bit for bit
+	namespace sse3
+	{
+		void concatenate(matrix3x4SIMD* _out, const matrix3x4SIMD* _a, const matrix3x4SIMD* _b, size_t _count)
+		{
+			for (size_t i = 0u; i < _count; ++i)
+				_out[i] = matrix3x4SIMD::concatenateBFollowedByA(_a[i], _b[i]);
+		}
+
+		void transformVect(const matrix3x4SIMD& _mat, vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count)
+		{
+			__m128 c0, c1, c2, c3;
+			getColumns(_mat, c0, c1, c2, c3);
+			for (size_t i = 0u; i < _count; ++i)
+			{
+				const __m128 v = _in[i].getAsRegister();
+				__m128 res = _mm_mul_ps(_mm_shuffle_ps(v, v, BROADCAST32(0)), c0);
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(v, v, BROADCAST32(1)), c1));
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(v, v, BROADCAST32(2)), c2));
+				_mm_store_ps(_out[i].pointer, _mm_add_ps(res, c3));
+			}
+		}
+
+		void mulSub3x3With3x1(const matrix3x4SIMD& _mat, vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count)
+		{
+			__m128 c0, c1, c2, c3;
+			getColumns(_mat, c0, c1, c2, c3);
+			for (size_t i = 0u; i < _count; ++i)
+			{
+				const __m128 v = _in[i].getAsRegister();
+				__m128 res = _mm_mul_ps(_mm_shuffle_ps(v, v, BROADCAST32(0)), c0);
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(v, v, BROADCAST32(1)), c1));
+				_mm_store_ps(_out[i].pointer, _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(v, v, BROADCAST32(2)), c2)));
+			}
+		}
+
+		void transformBox(aabbox3df* _out, const aabbox3df* _in, const matrix3x4SIMD* _mats, size_t _count)
+		{
+			for (size_t i = 0u; i < _count; ++i)
+				_out[i] = transformBoxEx(_in[i], _mats[i]);
+		}
+	}
+
+	// Every kernel does two matrices, vectors or boxes at a time, one in each 128bit lane, with the same operations in the same
+	// order as the SSE3 code, so results are identical. Only AVX instructions are needed, AVX2 is what os::CPU can check for.
+	// Sums aren't fused into FMAs as that would round differently. Odd elements at the end are left to the SSE3 code.
+	namespace avx2
+	{
+		//! (_lo,_hi) as lanes
+		_IRR_TARGET_AVX2_ inline __m256 combine(const __m128& _lo, const __m128& _hi)
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+		}
+
+		//! columns of two matrices, lane by lane
+		_IRR_TARGET_AVX2_ inline void getColumns(const matrix3x4SIMD& _m0, const matrix3x4SIMD& _m1, __m256& _c0, __m256& _c1, __m256& _c2, __m256& _c3)
+		{
+			const __m256 r0 = combine(_m0.rows[0].getAsRegister(), _m1.rows[0].getAsRegister());
+			const __m256 r1 = combine(_m0.rows[1].getAsRegister(), _m1.rows[1].getAsRegister());
+			const __m256 r2 = combine(_m0.rows[2].getAsRegister(), _m1.rows[2].getAsRegister());
+			const __m256 r3 = _mm256_setr_ps(0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f);
+
+			// same shuffles as core::transpose4, just with _pd unpacks in place of movelh/movehl which have no 256bit versions
+			const __m256d t0 = _mm256_castps_pd(_mm256_unpacklo_ps(r0, r1));
+			const __m256d t1 = _mm256_castps_pd(_mm256_unpacklo_ps(r2, r3));
+			const __m256d t2 = _mm256_castps_pd(_mm256_unpackhi_ps(r0, r1));
+			const __m256d t3 = _mm256_castps_pd(_mm256_unpackhi_ps(r2, r3));
+			_c0 = _mm256_castpd_ps(_mm256_unpacklo_pd(t0, t1));
+			_c1 = _mm256_castpd_ps(_mm256_unpackhi_pd(t0, t1));
+			_c2 = _mm256_castpd_ps(_mm256_unpacklo_pd(t2, t3));
+			_c3 = _mm256_castpd_ps(_mm256_unpackhi_pd(t2, t3));
+		}
+
+		//! rows of A in `_a` times matrices B whose rows are `_b0`,`_b1`,`_b2` lane by lane, same as matrix3x4SIMD::doJob
+		_IRR_TARGET_AVX2_ inline __m256 doJob(const __m256& _a, const __m256& _b0, const __m256& _b1, const __m256& _b2)
+		{
+			const __m256 mask = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+
+			__m256 res;
+			res = _mm256_mul_ps(_mm256_shuffle_ps(_a, _a, BROADCAST32(0)), _b0);
+			res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(_a, _a, BROADCAST32(1)), _b1));
+			res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(_a, _a, BROADCAST32(2)), _b2));
+			res = _mm256_add_ps(res, _mm256_and_ps(_a, mask));
+			return res;
+		}
+
+		_IRR_TARGET_AVX2_ void concatenate(matrix3x4SIMD* _out, const matrix3x4SIMD* _a, const matrix3x4SIMD* _b, size_t _count)
+		{
+			size_t i = 0u;
+			for (; i+2u <= _count; i += 2u)
+			{
+				// six rows of two matrices of A in three registers, the middle one straddles both
+				const __m256 a01 = combine(_a[i].rows[0].getAsRegister(), _a[i].rows[1].getAsRegister());
+				const __m256 a2n0 = combine(_a[i].rows[2].getAsRegister(), _a[i+1u].rows[0].getAsRegister());
+				const __m256 an12 = combine(_a[i+1u].rows[1].getAsRegister(), _a[i+1u].rows[2].getAsRegister());
+
+				const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(_b[i].rows[0].pointer));
+				const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(_b[i].rows[1].pointer));
+				const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(_b[i].rows[2].pointer));
+				const __m256 bn0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(_b[i+1u].rows[0].pointer));
+				const __m256 bn1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(_b[i+1u].rows[1].pointer));
+				const __m256 bn2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(_b[i+1u].rows[2].pointer));
+
+				const __m256 res01 = doJob(a01, b0, b1, b2);
+				const __m256 res2n0 = doJob(a2n0, _mm256_blend_ps(b0, bn0, 0xf0), _mm256_blend_ps(b1, bn1, 0xf0), _mm256_blend_ps(b2, bn2, 0xf0));
+				const __m256 resn12 = doJob(an12, bn0, bn1, bn2);
+
+				// everything is loaded already, so `_out` may be `_a` or `_b`
+				// rows are stored one by one since matrices may be padded in between
+				_mm_store_ps(_out[i].rows[0].pointer, _mm256_castps256_ps128(res01));
+				_mm_store_ps(_out[i].rows[1].pointer, _mm256_extractf128_ps(res01, 1));
+				_mm_store_ps(_out[i].rows[2].pointer, _mm256_castps256_ps128(res2n0));
+				_mm_store_ps(_out[i+1u].rows[0].pointer, _mm256_extractf128_ps(res2n0, 1));
+				_mm_store_ps(_out[i+1u].rows[1].pointer, _mm256_castps256_ps128(resn12));
+				_mm_store_ps(_out[i+1u].rows[2].pointer, _mm256_extractf128_ps(resn12, 1));
+			}
+			sse3::concatenate(_out+i, _a+i, _b+i, _count-i);
+		}
+
+		template<bool translate>
+		_IRR_TARGET_AVX2_ inline void transform(const matrix3x4SIMD& _mat, vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count)
+		{
+			__m256 c0, c1, c2, c3;
+			getColumns(_mat, _mat, c0, c1, c2, c3);
+
+			size_t i = 0u;
+			for (; i+2u <= _count; i += 2u)
+			{
+				const __m256 v = _mm256_loadu_ps(_in[i].pointer);
+				__m256 res = _mm256_mul_ps(_mm256_shuffle_ps(v, v, BROADCAST32(0)), c0);
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(v, v, BROADCAST32(1)), c1));
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(v, v, BROADCAST32(2)), c2));
+				if (translate)
+					res = _mm256_add_ps(res, c3);
+				_mm256_storeu_ps(_out[i].pointer, res);
+			}
+			if (translate)
+				sse3::transformVect(_mat, _out+i, _in+i, _count-i);
+			else
+				sse3::mulSub3x3With3x1(_mat, _out+i, _in+i, _count-i);
+		}
+
+		_IRR_TARGET_AVX2_ void transformVect(const matrix3x4SIMD& _mat, vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count)
+		{
+			transform<true>(_mat, _out, _in, _count);
+		}
+
+		_IRR_TARGET_AVX2_ void mulSub3x3With3x1(const matrix3x4SIMD& _mat, vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count)
+		{
+			transform<false>(_mat, _out, _in, _count);
+		}
+
+		//! `_c*mix(_a.???w, _b.???w, _c<0)` where ? is component `comp`, as in core::transformBoxEx
+		template<int comp>
+		_IRR_TARGET_AVX2_ inline __m256 pickAndScale(const __m256& _c, const __m256& _a, const __m256& _b, const __m256& _negative)
+		{
+			const __m256 a = _mm256_shuffle_ps(_a, _a, _MM_SHUFFLE(3, comp, comp, comp));
+			const __m256 b = _mm256_shuffle_ps(_b, _b, _MM_SHUFFLE(3, comp, comp, comp));
+			return _mm256_mul_ps(_c, _mm256_blendv_ps(a, b, _negative));
+		}
+
+		_IRR_TARGET_AVX2_ void transformBox(aabbox3df* _out, const aabbox3df* _in, const matrix3x4SIMD* _mats, size_t _count)
+		{
+			const __m256 mask1110 = _mm256_castsi256_ps(_mm256_setr_epi32(-1, -1, -1, 0, -1, -1, -1, 0));
+			const __m256 zero = _mm256_setzero_ps();
+
+			size_t i = 0u;
+			for (; i+2u <= _count; i += 2u)
+			{
+				__m256 c0, c1, c2, c3;
+				getColumns(_mats[i], _mats[i+1u], c0, c1, c2, c3);
+
+				// boxes are 6 floats, so only 4 floats starting at MinEdge.X or MinEdge.Z can be loaded without reading past one
+				const float* in = &_in[i].MinEdge.X;
+				const __m256 inMin = _mm256_and_ps(combine(_mm_loadu_ps(in), _mm_loadu_ps(in+6)), mask1110);
+				const __m256 inMaxZXYZ = combine(_mm_loadu_ps(in+2), _mm_loadu_ps(in+8));
+				const __m256 inMax = _mm256_and_ps(_mm256_permute_ps(inMaxZXYZ, _MM_SHUFFLE(0, 3, 2, 1)), mask1110);
+
+				const __m256 neg0 = _mm256_cmp_ps(c0, zero, _CMP_LT_OQ);
+				const __m256 neg1 = _mm256_cmp_ps(c1, zero, _CMP_LT_OQ);
+				const __m256 neg2 = _mm256_cmp_ps(c2, zero, _CMP_LT_OQ);
+				__m256 minPt = _mm256_add_ps(_mm256_add_ps(pickAndScale<0>(c0, inMin, inMax, neg0), pickAndScale<1>(c1, inMin, inMax, neg1)), pickAndScale<2>(c2, inMin, inMax, neg2));
+				__m256 maxPt = _mm256_add_ps(_mm256_add_ps(pickAndScale<0>(c0, inMax, inMin, neg0), pickAndScale<1>(c1, inMax, inMin, neg1)), pickAndScale<2>(c2, inMax, inMin, neg2));
+				minPt = _mm256_add_ps(minPt, c3);
+				maxPt = _mm256_add_ps(maxPt, c3);
+
+				// (min.x,min.y,min.z,max.x) and (min.z,max.x,max.y,max.z) cover a box with two stores which stay within it
+				const __m256 first = _mm256_blend_ps(minPt, _mm256_permute_ps(maxPt, BROADCAST32(0)), 0x88);
+				const __m256 second = _mm256_blend_ps(_mm256_permute_ps(maxPt, _MM_SHUFFLE(2, 1, 0, 0)), _mm256_permute_ps(minPt, BROADCAST32(2)), 0x11);
+				float* out = &_out[i].MinEdge.X;
+				_mm_storeu_ps(out, _mm256_castps256_ps128(first));
+				_mm_storeu_ps(out+2, _mm256_castps256_ps128(second));
+				_mm_storeu_ps(out+6, _mm256_extractf128_ps(first, 1));
+				_mm_storeu_ps(out+8, _mm256_extractf128_ps(second, 1));
+			}
+			sse3::transformBox(_out+i, _in+i, _mats+i, _count-i);
+		}
+	}
+
+	#undef BROADCAST32
+
+	//! tables are indexed by E_SIMD_LEVEL
+	const ConcatenateKernel concatenateKernels[matrix3x4SIMD::ESL_COUNT] = {sse3::concatenate, avx2::concatenate};
+	const TransformKernel transformVectKernels[matrix3x4SIMD::ESL_COUNT] = {sse3::transformVect, avx2::transformVect};
+	const TransformKernel mulSub3x3With3x1Kernels[matrix3x4SIMD::ESL_COUNT] = {sse3::mulSub3x3With3x1, avx2::mulSub3x3With3x1};
+	const BoxKernel transformBoxKernels[matrix3x4SIMD::ESL_COUNT] = {sse3::transformBox, avx2::transformBox};
+} // end anonymous namespace
+
+
+matrix3x4SIMD::E_SIMD_LEVEL matrix3x4SIMD::setMaxSIMDLevel(E_SIMD_LEVEL _level)
+{
+	const E_SIMD_LEVEL used = core::min_(_level, detectSIMDLevel());
+	SIMDLevel().store(used);
+	return used;
+}
+
+matrix3x4SIMD::E_SIMD_LEVEL matrix3x4SIMD::getSIMDLevel()
+{
+	return E_SIMD_LEVEL(SIMDLevel().load());
+}
+
+void matrix3x4SIMD::concatenateBFollowedByA(matrix3x4SIMD* _out, const matrix3x4SIMD* _a, const matrix3x4SIMD* _b, size_t _count)
+{
+	concatenateKernels[SIMDLevel().load(std::memory_order_relaxed)](_out, _a, _b, _count);
+}
+
+void matrix3x4SIMD::transformVect(vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count) const
+{
+	transformVectKernels[SIMDLevel().load(std::memory_order_relaxed)](*this, _out, _in, _count);
+}
+
+void matrix3x4SIMD::mulSub3x3With3x1(vectorSIMDf* _out, const vectorSIMDf* _in, size_t _count) const
+{
+	mulSub3x3With3x1Kernels[SIMDLevel().load(std::memory_order_relaxed)](*this, _out, _in, _count);
+}
+
+void transformBoxEx(aabbox3df* _out, const aabbox3df* _in, const matrix3x4SIMD* _mats, size_t _count)
+{
+	transformBoxKernels[SIMDLevel().load(std::memory_order_relaxed)](_out, _in, _mats, _count);
+}
+
+} // end namespace core
+} // end namespace irr
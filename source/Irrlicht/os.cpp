@@ -7,6 +7,10 @@
 #include "IrrCompileConfig.h"
 #include "irrMath.h"
 
+#if defined(__IRR_COMPILE_WITH_X86_SIMD_) && defined(_MSC_VER)
+	#include <intrin.h> // for __cpuid
+#endif
+
 #if defined(_IRR_COMPILE_WITH_SDL_DEVICE_)
 	#include <SDL/SDL_endian.h>
 	#define bswap_16(X) SDL_Swap16(X)
@@ -45,6 +49,48 @@ namespace os
 	// prevent accidental byte swapping of chars
 	uint8_t  Byteswap::byteswap(uint8_t num)  {return num;}
 	int8_t  Byteswap::byteswap(int8_t num)  {return num;}
+
+#if defined(__IRR_COMPILE_WITH_X86_SIMD_) && defined(_MSC_VER)
+	namespace
+	{
+		struct SCPUFeatures
+		{
+			SCPUFeatures() : SSSE3(false), AVX2(false)
+			{
+				int info[4];
+				__cpuid(info, 0);
+				const int maxLeaf = info[0];
+				__cpuid(info, 1);
+				SSSE3 = (info[2] & (1<<9)) != 0;
+				// AVX state has to be enabled by the OS in XCR0 too
+				const bool avx = (info[2] & (1<<27)) && (info[2] & (1<<28)) && (_xgetbv(0) & 6) == 6;
+				if (avx && maxLeaf >= 7)
+				{
+					__cpuidex(info, 7, 0);
+					AVX2 = (info[1] & (1<<5)) != 0;
+				}
+			}
+
+			bool SSSE3, AVX2;
+		};
+
+		const SCPUFeatures& getCPUFeatures()
+		{
+			static const SCPUFeatures features;
+			return features;
+		}
+	}
+
+	bool CPU::hasSSSE3() {return getCPUFeatures().SSSE3;}
+	bool CPU::hasAVX2() {return getCPUFeatures().AVX2;}
+#elif defined(__IRR_COMPILE_WITH_X86_SIMD_)
+	// the builtins check OS support of AVX state as well
+	bool CPU::hasSSSE3() {static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("ssse3")); return has;}
+	bool CPU::hasAVX2() {static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("avx2")); return has;}
+#else
+	bool CPU::hasSSSE3() {return false;}
+	bool CPU::hasAVX2() {return false;}
+#endif
 }
 }
 
@@ -42,6 +42,15 @@ namespace os
 		static ILogger* Logger;
 	};
 
+	class CPU
+	{
+	public:
+		//! returns true if both the processor and the OS support SSSE3, checked once
+		static bool hasSSSE3();
+		//! returns true if both the processor and the OS (which has to save the YMM registers) support AVX2, checked once
+		static bool hasAVX2();
+	};
+
 
 
 	class Timer
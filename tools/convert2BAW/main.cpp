@@ -9,11 +9,14 @@
 #include <vector>
 #include <cstdlib>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include "print.h"
 
 // Usage: convert2BAW [-i [list of input files delimited with spaces]] [-o [list of output files delimited with spaces]]
-//			[-rel <dir>] [-pwd <password>] [-optmesh <{ error metric settings threes delimited with commas }>]
+//			[-rel <dir>] [-pwd <password>] [-optmesh <{ error metric settings threes delimited with commas }>] [-j <thread count>]
 // Options:
 // -i [list of input files]
 // -o [list of output files]
@@ -29,9 +32,14 @@
 //	Settings must be enclosed with curly (i.e. {}) braces and grouped in threes. Threes must be delimited with commas. Order of threes is irrelevant.
 //	Elements of each group of three must be delimited with spaces and must come with strict order: atrribute-id epsilon cmp-method
 //	Attribute-id must be integer in range [0; 15]. Epsilon is floating point number. Cmp-method must be single character and one of: A - angles, Q - quaternions, P - positions (lower-case chars are also accepted)
+// -j <thread count>
+//	Number of files converted at the same time, 0 means as many as the hardware has threads. Defaults to 1.
+//	Meshes are loaded one at a time (loaders aren't thread-safe), optimization, compression and writing of many files overlap.
 
 //Example:
 //	convert2BAW -i somefile.obj someotherfile.x -o f1.baw f2.baw -rel /home/me/assets/ -pwd deadbeefbaadf00d0badcafefeeee997 -optmesh { 0 0.02 P, 3 0.003 A }
+//
+// Runs on the null video driver, so it needs neither a GPU nor a display.
 
 
 using namespace irr;
@@ -49,14 +57,46 @@ static void hexStrToIntegers(const char* _input, unsigned char* _out);
 static uint8_t hexCharToUint8(char _c);
 static bool optMesh(scene::ICPUMesh* _mesh, const scene::IMeshManipulator* _manip, const scene::IMeshManipulator::SErrorMetric* _errMetrics);
 
+//! Settings and engine objects shared by all conversions.
+struct SConversionContext
+{
+	scene::ISceneManager* smgr;
+	io::IFileSystem* fs;
+	const scene::IMeshManipulator* meshManip;
+	const std::vector<const char*>* inNames;
+	const std::vector<const char*>* outNames;
+	bool usePwd;
+	bool optimizeMesh;
+	bool printInfo;
+	const scene::CBAWMeshWriter::WriteProperties* properties;
+	const scene::IMeshManipulator::SErrorMetric* errMetrics;
+
+	//! guards the scene manager (its mesh cache and loaders) and stdout
+	std::mutex lock;
+	//! index of the next file to convert
+	std::atomic<size_t> nextFile;
+};
+
+//! Time spent on one file, in seconds.
+struct SConversionStats
+{
+	bool converted = false;
+	double load = 0.0;
+	double optimize = 0.0;
+	double write = 0.0;
+	size_t outputSize = 0u;
+};
+
+static void convertFiles(SConversionContext* _ctx, std::vector<SConversionStats>* _stats);
+static double secondsSince(const std::chrono::high_resolution_clock::time_point& _start);
+
 int main(int _optCnt, char** _options)
 {
 	--_optCnt;
 	++_options;
 
 	irr::SIrrlichtCreationParameters params;
-	params.DriverType = video::EDT_OPENGL;
-	params.WindowSize = core::dimension2d<uint32_t>(128, 128);
+	params.DriverType = video::EDT_NULL;
 	IrrlichtDevice* device = createDeviceEx(params);
 
 	if (!device)
@@ -64,7 +104,6 @@ int main(int _optCnt, char** _options)
 
 	scene::ISceneManager* const smgr = device->getSceneManager();
 	io::IFileSystem* const fs = device->getFileSystem();
-	scene::CBAWMeshWriter* const writer = dynamic_cast<scene::CBAWMeshWriter*>(smgr->createMeshWriter(irr::scene::EMWT_BAW));
 	scene::IMeshManipulator* const meshManip = smgr->getMeshManipulator();
 
 	std::vector<const char*> inNames;
@@ -74,6 +113,7 @@ int main(int _optCnt, char** _options)
 	bool usePwd = 0;
 	bool optimizeMesh = 0;
 	bool printInfo = 0;
+	uint32_t threadCnt = 1u;
 	scene::CBAWMeshWriter::WriteProperties properties;
 	scene::IMeshManipulator::SErrorMetric errMetrics[16];
 
@@ -117,6 +157,15 @@ int main(int _optCnt, char** _options)
 				properties.relPath = _options[idx];
 				continue;
 			}
+			else if (idx+1 != _optCnt && core::equalsIgnoreCase("j", _options[idx]+1))
+			{
+				++idx;
+				gatherWhat = EGT_UNDEFINED;
+				threadCnt = strtoul(_options[idx], nullptr, 10);
+				if (!threadCnt)
+					threadCnt = std::max(std::thread::hardware_concurrency(), 1u);
+				continue;
+			}
 			else if (core::equalsIgnoreCase("info", _options[idx]+1))
 			{
 				gatherWhat = EGT_UNDEFINED;
@@ -205,52 +254,142 @@ int main(int _optCnt, char** _options)
 	if (inNames.size() != outNames.size())
 	{
 		printf("Fatal error. Amounts of input and output filenames doesn't match. Exiting.\n");
-        writer->drop();
         device->drop();
 		return 1;
 	}
 
-	for (size_t i = 0u; i < inNames.size(); ++i)
+	SConversionContext ctx;
+	ctx.smgr = smgr;
+	ctx.fs = fs;
+	ctx.meshManip = meshManip;
+	ctx.inNames = &inNames;
+	ctx.outNames = &outNames;
+	ctx.usePwd = usePwd;
+	ctx.optimizeMesh = optimizeMesh;
+	ctx.printInfo = printInfo;
+	ctx.properties = &properties;
+	ctx.errMetrics = errMetrics;
+	ctx.nextFile = 0u;
+
+	threadCnt = std::max<uint32_t>(std::min<size_t>(threadCnt, inNames.size()), 1u);
+	std::vector<SConversionStats> stats(inNames.size());
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> workers;
+	for (uint32_t i = 1u; i < threadCnt; ++i)
+		workers.push_back(std::thread(convertFiles, &ctx, &stats));
+	convertFiles(&ctx, &stats);
+	for (size_t i = 0u; i < workers.size(); ++i)
+		workers[i].join();
+	const double totalTime = secondsSince(start);
+
+	SConversionStats sum;
+	size_t convertedCnt = 0u;
+	for (size_t i = 0u; i < stats.size(); ++i)
+	{
+		convertedCnt += stats[i].converted ? 1u : 0u;
+		sum.load += stats[i].load;
+		sum.optimize += stats[i].optimize;
+		sum.write += stats[i].write;
+		sum.outputSize += stats[i].outputSize;
+	}
+	printf("Converted %u of %u files (%u failed) in %.3f s on %u threads, %.1f MB written.\n",
+		(uint32_t)convertedCnt, (uint32_t)stats.size(), (uint32_t)(stats.size()-convertedCnt), totalTime, threadCnt, sum.outputSize/1048576.0);
+	printf("Time summed over files: load %.3f s, optimize %.3f s, compress and write %.3f s.\n", sum.load, sum.optimize, sum.write);
+
+	device->drop();
+
+	return convertedCnt==stats.size() ? 0:1;
+}
+
+//! Converts files handed out by `nextFile` until there are none left.
+static void convertFiles(SConversionContext* _ctx, std::vector<SConversionStats>* _stats)
+{
+	// writer is stateless, but every thread needs its own copy of the properties
+	scene::CBAWMeshWriter* writer;
 	{
-		scene::ICPUMesh* inmesh = smgr->getMesh(inNames[i]);
+		std::lock_guard<std::mutex> lock(_ctx->lock);
+		writer = dynamic_cast<scene::CBAWMeshWriter*>(_ctx->smgr->createMeshWriter(irr::scene::EMWT_BAW));
+	}
+	scene::CBAWMeshWriter::WriteProperties properties = *_ctx->properties;
+
+	for (size_t i = _ctx->nextFile++; i < _ctx->inNames->size(); i = _ctx->nextFile++)
+	{
+		const char* const inName = (*_ctx->inNames)[i];
+		const char* const outName = (*_ctx->outNames)[i];
+		SConversionStats& stats = (*_stats)[i];
+
+		std::chrono::high_resolution_clock::time_point start;
+		scene::ICPUMesh* inmesh;
+		{
+			// take the mesh out of the cache right away, so no other thread gets the same mesh if a file is listed twice
+			std::lock_guard<std::mutex> lock(_ctx->lock);
+			// time the load only, not the wait for other threads' loads
+			start = std::chrono::high_resolution_clock::now();
+			inmesh = _ctx->smgr->getMesh(inName);
+			if (inmesh)
+			{
+				inmesh->grab();
+				_ctx->smgr->getMeshCache()->removeMesh(inmesh);
+			}
+			stats.load = secondsSince(start);
+		}
 		if (!inmesh)
 		{
-			printf("Could not load mesh %s.\n", inNames[i]);
+			std::lock_guard<std::mutex> lock(_ctx->lock);
+			printf("Could not load mesh %s.\n", inName);
 			continue;
 		}
-		io::IWriteFile* outfile = fs->createAndWriteFile(outNames[i]);
+		io::IWriteFile* outfile = _ctx->fs->createAndWriteFile(outName);
 		if (!outfile)
 		{
-			printf("Could not create/open file %s.\n", outNames[i]);
-            smgr->getMeshCache()->removeMesh(inmesh);
+			std::lock_guard<std::mutex> lock(_ctx->lock);
+			printf("Could not create/open file %s.\n", outName);
+			inmesh->drop();
 			continue;
 		}
-		if (optimizeMesh && !optMesh(inmesh, meshManip, errMetrics))
+
+		start = std::chrono::high_resolution_clock::now();
+		const bool optimized = !_ctx->optimizeMesh || optMesh(inmesh, _ctx->meshManip, _ctx->errMetrics);
+		stats.optimize = secondsSince(start);
+		if (!optimized)
 		{
-			printf("Could not optimize mesh %s. Mesh not exported!\n", inNames[i]);
-			smgr->getMeshCache()->removeMesh(inmesh);
-            outfile->drop();
+			std::lock_guard<std::mutex> lock(_ctx->lock);
+			printf("Could not optimize mesh %s. Mesh not exported!\n", inName);
+			inmesh->drop();
+			outfile->drop();
 			continue;
 		}
 
-        if (printInfo)
-        {
-            printf("%s INFO:\n", inNames[i]);
-            printFullMeshInfo(stdout, inmesh);
-        }
+		if (_ctx->printInfo)
+		{
+			std::lock_guard<std::mutex> lock(_ctx->lock);
+			printf("%s INFO:\n", inName);
+			printFullMeshInfo(stdout, inmesh);
+		}
 
-		if (usePwd)
-			writer->writeMesh(outfile, inmesh, properties);
+		start = std::chrono::high_resolution_clock::now();
+		if (_ctx->usePwd)
+			stats.converted = writer->writeMesh(outfile, inmesh, properties);
 		else
-			writer->writeMesh(outfile, inmesh, scene::EMWF_WRITE_COMPRESSED);
-
-        smgr->getMeshCache()->removeMesh(inmesh);
+			stats.converted = writer->writeMesh(outfile, inmesh, scene::EMWF_WRITE_COMPRESSED);
+		stats.outputSize = outfile->getPos();
 		outfile->drop();
+		stats.write = secondsSince(start);
+
+		inmesh->drop();
+
+		std::lock_guard<std::mutex> lock(_ctx->lock);
+		printf("%s -> %s: %s, load %.1f ms, optimize %.1f ms, compress and write %.1f ms, %u bytes\n", inName, outName,
+			stats.converted ? "ok" : "FAILED", stats.load*1000.0, stats.optimize*1000.0, stats.write*1000.0, (uint32_t)stats.outputSize);
 	}
+
 	writer->drop();
-	device->drop();
+}
 
-	return 0;
+static double secondsSince(const std::chrono::high_resolution_clock::time_point& _start)
+{
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - _start).count();
 }
 
 static bool checkHex(const char* _str)